@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/CodecAdvisor.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#include <folly/Conv.h>
+#include <folly/stop_watch.h>
+
+namespace folly {
+namespace io {
+
+namespace {
+
+const char* codecTypeName(CodecType type) {
+  switch (type) {
+    case CodecType::USER_DEFINED:
+      return "USER_DEFINED";
+    case CodecType::NO_COMPRESSION:
+      return "NO_COMPRESSION";
+    case CodecType::LZ4:
+      return "LZ4";
+    case CodecType::SNAPPY:
+      return "SNAPPY";
+    case CodecType::ZLIB:
+      return "ZLIB";
+    case CodecType::LZ4_VARINT_SIZE:
+      return "LZ4_VARINT_SIZE";
+    case CodecType::LZMA2:
+      return "LZMA2";
+    case CodecType::LZMA2_VARINT_SIZE:
+      return "LZMA2_VARINT_SIZE";
+    case CodecType::ZSTD:
+      return "ZSTD";
+    case CodecType::GZIP:
+      return "GZIP";
+    case CodecType::LZ4_FRAME:
+      return "LZ4_FRAME";
+    case CodecType::BZIP2:
+      return "BZIP2";
+    case CodecType::ZSTD_FAST:
+      return "ZSTD_FAST";
+    case CodecType::NUM_CODEC_TYPES:
+      break;
+  }
+  return "UNKNOWN";
+}
+
+std::string levelName(int level) {
+  switch (level) {
+    case COMPRESSION_LEVEL_FASTEST:
+      return "fastest";
+    case COMPRESSION_LEVEL_DEFAULT:
+      return "default";
+    case COMPRESSION_LEVEL_BEST:
+      return "best";
+  }
+  return to<std::string>(level);
+}
+
+double throughput(uint64_t bytes, std::chrono::nanoseconds time) {
+  if (time.count() <= 0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return double(bytes) * 1e9 / double(time.count());
+}
+
+} // namespace
+
+std::vector<CodecCandidate> defaultCodecCandidates() {
+  // Levels as converted by the codecs in Compression.cpp, e.g. ZSTD maps
+  // both COMPRESSION_LEVEL_FASTEST and COMPRESSION_LEVEL_DEFAULT to 1.
+  static const CodecCandidate kCandidates[] = {
+      {CodecType::NO_COMPRESSION, COMPRESSION_LEVEL_DEFAULT},
+      {CodecType::LZ4, COMPRESSION_LEVEL_FASTEST},
+      {CodecType::LZ4, COMPRESSION_LEVEL_BEST},
+      {CodecType::LZ4_FRAME, COMPRESSION_LEVEL_FASTEST},
+      {CodecType::LZ4_FRAME, 9},
+      {CodecType::LZ4_FRAME, COMPRESSION_LEVEL_BEST},
+      {CodecType::SNAPPY, COMPRESSION_LEVEL_DEFAULT},
+      {CodecType::ZSTD_FAST, COMPRESSION_LEVEL_FASTEST},
+      {CodecType::ZSTD_FAST, COMPRESSION_LEVEL_DEFAULT},
+      {CodecType::ZSTD, 1},
+      {CodecType::ZSTD, 3},
+      {CodecType::ZSTD, 9},
+      {CodecType::ZSTD, 19},
+      {CodecType::ZLIB, COMPRESSION_LEVEL_FASTEST},
+      {CodecType::ZLIB, COMPRESSION_LEVEL_DEFAULT},
+      {CodecType::ZLIB, COMPRESSION_LEVEL_BEST},
+      {CodecType::LZMA2, COMPRESSION_LEVEL_FASTEST},
+      {CodecType::LZMA2, COMPRESSION_LEVEL_DEFAULT},
+      {CodecType::LZMA2, COMPRESSION_LEVEL_BEST},
+      {CodecType::BZIP2, COMPRESSION_LEVEL_FASTEST},
+      {CodecType::BZIP2, COMPRESSION_LEVEL_BEST},
+  };
+  std::vector<CodecCandidate> candidates;
+  for (const auto& candidate : kCandidates) {
+    if (hasCodec(candidate.type)) {
+      candidates.push_back(candidate);
+    }
+  }
+  return candidates;
+}
+
+double CodecMeasurement::ratio() const {
+  if (compressedBytes == 0) {
+    return 1.0;
+  }
+  return double(uncompressedBytes) / double(compressedBytes);
+}
+
+double CodecMeasurement::compressThroughput() const {
+  return throughput(uncompressedBytes, compressTime);
+}
+
+double CodecMeasurement::uncompressThroughput() const {
+  return throughput(uncompressedBytes, uncompressTime);
+}
+
+std::string CodecCandidate::name() const {
+  return to<std::string>(codecTypeName(type), ":", levelName(level));
+}
+
+std::string CodecMeasurement::toString() const {
+  return fmt::format(
+      "{} ratio {:.2f} compress {:.1f} MB/s uncompress {:.1f} MB/s",
+      CodecCandidate{type, level}.name(),
+      ratio(),
+      compressThroughput() / 1e6,
+      uncompressThroughput() / 1e6);
+}
+
+CodecAdvisor::CodecAdvisor(CodecAdvisorOptions options)
+    : options_(std::move(options)) {
+  if (options_.maxSamples == 0) {
+    throw std::invalid_argument("CodecAdvisor: maxSamples is 0");
+  }
+  if (options_.iterations == 0) {
+    throw std::invalid_argument("CodecAdvisor: iterations is 0");
+  }
+}
+
+void CodecAdvisor::addSample(std::unique_ptr<IOBuf> buf) {
+  if (!buf) {
+    return;
+  }
+  ++added_;
+  if (samples_.size() < options_.maxSamples) {
+    samples_.push_back(std::move(buf));
+    return;
+  }
+  // Reservoir sampling: the buffer is kept with probability
+  // maxSamples / added.
+  std::uniform_int_distribution<size_t> dist(0, added_ - 1);
+  auto i = dist(rng_);
+  if (i < samples_.size()) {
+    samples_[i] = std::move(buf);
+  }
+}
+
+std::vector<CodecMeasurement> CodecAdvisor::measure() const {
+  uint64_t sampleBytes = 0;
+  uint64_t largest = 0;
+  for (const auto& sample : samples_) {
+    auto length = sample->computeChainDataLength();
+    sampleBytes += length;
+    largest = std::max(largest, length);
+  }
+
+  std::vector<CodecMeasurement> measurements;
+  std::vector<std::unique_ptr<IOBuf>> compressed;
+  std::vector<std::unique_ptr<IOBuf>> uncompressed;
+  for (const auto& candidate : options_.candidates) {
+    if (!hasCodec(candidate.type)) {
+      continue;
+    }
+    auto codec = getCodec(candidate.type, candidate.level);
+    if (largest > codec->maxUncompressedLength()) {
+      continue;
+    }
+    CodecMeasurement m{candidate.type, candidate.level};
+    m.uncompressedBytes = sampleBytes;
+    m.compressTime = std::chrono::nanoseconds::max();
+    m.uncompressTime = std::chrono::nanoseconds::max();
+
+    for (size_t iter = 0; iter < options_.iterations; ++iter) {
+      compressed.clear();
+      compressed.reserve(samples_.size());
+      stop_watch<std::chrono::nanoseconds> watch;
+      for (const auto& sample : samples_) {
+        compressed.push_back(codec->compress(sample.get()));
+      }
+      m.compressTime = std::min(m.compressTime, watch.elapsed());
+    }
+    for (const auto& buf : compressed) {
+      m.compressedBytes += buf->computeChainDataLength();
+    }
+
+    bool const needsLength = codec->needsUncompressedLength();
+    for (size_t iter = 0; iter < options_.iterations; ++iter) {
+      uncompressed.clear();
+      uncompressed.reserve(samples_.size());
+      stop_watch<std::chrono::nanoseconds> watch;
+      for (size_t i = 0; i < compressed.size(); ++i) {
+        Optional<uint64_t> length;
+        if (needsLength) {
+          length = samples_[i]->computeChainDataLength();
+        }
+        uncompressed.push_back(codec->uncompress(compressed[i].get(), length));
+      }
+      m.uncompressTime = std::min(m.uncompressTime, watch.elapsed());
+    }
+    for (size_t i = 0; i < samples_.size(); ++i) {
+      if (!IOBufEqualTo()(*samples_[i], *uncompressed[i])) {
+        throw std::runtime_error(to<std::string>(
+            "CodecAdvisor: ", candidate.name(), " doesn't round trip"));
+      }
+    }
+    measurements.push_back(m);
+  }
+  return measurements;
+}
+
+Optional<CodecMeasurement> CodecAdvisor::recommend(
+    const std::vector<CodecMeasurement>& measurements,
+    const CodecBudget& budget) {
+  Optional<CodecMeasurement> best;
+  for (const auto& m : measurements) {
+    if (m.compressThroughput() < budget.minCompressThroughput ||
+        m.uncompressThroughput() < budget.minUncompressThroughput) {
+      continue;
+    }
+    if (!best || m.ratio() > best->ratio() ||
+        (m.ratio() == best->ratio() &&
+         m.compressThroughput() > best->compressThroughput())) {
+      best = m;
+    }
+  }
+  return best;
+}
+
+} // namespace io
+} // namespace folly
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/compression/Compression.h>
+#include <folly/io/IOBuf.h>
+
+/**
+ * Codec selection by measurement.
+ *
+ * CodecAdvisor keeps a sample of representative buffers, e.g. RPC payloads
+ * or log records, compresses and uncompresses every buffer of the sample
+ * with every candidate codec and level through getCodec(), and recommends
+ * the codec with the best compression ratio that is fast enough for a
+ * budget.  Measuring through getCodec() includes the context pooling and
+ * IOBuf handling of this library, so the numbers are those a caller gets.
+ *
+ * Every buffer is compressed on its own, as a message would be, and times
+ * are measured on the calling thread.
+ *
+ * Example:
+ *   CodecAdvisor advisor;
+ *   for (auto& payload : recentPayloads) {
+ *     advisor.addSample(payload->clone());
+ *   }
+ *   auto choice = advisor.recommend(
+ *       CodecBudget().setMinCompressThroughput(200e6));
+ *   if (choice) {
+ *     codec = getCodec(choice->type, choice->level);
+ *   }
+ */
+
+namespace folly {
+namespace io {
+
+struct CodecCandidate {
+  CodecType type;
+  int level;
+
+  // E.g. "ZSTD:3" or "ZLIB:best".
+  std::string name() const;
+};
+
+/**
+ * The candidates measured by default: each codec type that is compiled in,
+ * at a few levels spanning its range.  Levels of a codec type that map to
+ * the same setting are only listed once, and types that only differ from
+ * another by framing (GZIP, LZ4_VARINT_SIZE, LZMA2_VARINT_SIZE) are left
+ * out.
+ */
+std::vector<CodecCandidate> defaultCodecCandidates();
+
+struct CodecMeasurement {
+  CodecType type;
+  int level;
+  uint64_t uncompressedBytes{0};
+  uint64_t compressedBytes{0};
+  // Time to compress, and to uncompress, the whole sample.
+  std::chrono::nanoseconds compressTime{0};
+  std::chrono::nanoseconds uncompressTime{0};
+
+  // Uncompressed bytes per compressed byte.
+  double ratio() const;
+  // Uncompressed bytes per second.
+  double compressThroughput() const;
+  double uncompressThroughput() const;
+
+  // E.g. "ZSTD:3 ratio 3.52 compress 310.2 MB/s uncompress 1021.7 MB/s".
+  std::string toString() const;
+};
+
+/**
+ * The CPU a codec may use, as the lowest throughput accepted.  0 means no
+ * limit.
+ */
+struct CodecBudget {
+  // Uncompressed bytes per second.
+  double minCompressThroughput{0};
+  double minUncompressThroughput{0};
+
+  CodecBudget& setMinCompressThroughput(double throughput) {
+    minCompressThroughput = throughput;
+    return *this;
+  }
+  CodecBudget& setMinUncompressThroughput(double throughput) {
+    minUncompressThroughput = throughput;
+    return *this;
+  }
+};
+
+struct CodecAdvisorOptions {
+  std::vector<CodecCandidate> candidates{defaultCodecCandidates()};
+  // Buffers kept.  Further buffers replace kept ones at random, so the
+  // sample stays uniform over all the buffers added.
+  size_t maxSamples{1000};
+  // Times the sample is compressed and uncompressed by every candidate.
+  // The fastest time is kept, to discount warm up and noise.
+  size_t iterations{3};
+
+  CodecAdvisorOptions& setCandidates(std::vector<CodecCandidate> c) {
+    candidates = std::move(c);
+    return *this;
+  }
+  CodecAdvisorOptions& setMaxSamples(size_t samples) {
+    maxSamples = samples;
+    return *this;
+  }
+  CodecAdvisorOptions& setIterations(size_t n) {
+    iterations = n;
+    return *this;
+  }
+};
+
+class CodecAdvisor {
+ public:
+  CodecAdvisor() : CodecAdvisor(CodecAdvisorOptions()) {}
+  /**
+   * Throws std::invalid_argument if options.maxSamples or
+   * options.iterations is 0.
+   */
+  explicit CodecAdvisor(CodecAdvisorOptions options);
+
+  /**
+   * Add a buffer, which may be a chain, to the sample.
+   */
+  void addSample(std::unique_ptr<IOBuf> buf);
+
+  size_t numSamples() const { return samples_.size(); }
+  // Buffers added so far, including those not kept.
+  size_t numAdded() const { return added_; }
+
+  /**
+   * Measure every candidate on the sample, in the order of the candidates.
+   * Candidates that are not compiled in, or can't compress a buffer of the
+   * sample because of its size, are left out.
+   *
+   * Throws std::invalid_argument if a candidate level is invalid for its
+   * codec type, and std::runtime_error if a codec doesn't uncompress its
+   * output to the buffer compressed.
+   */
+  std::vector<CodecMeasurement> measure() const;
+
+  /**
+   * The measurement with the best ratio among those within budget, the
+   * fastest to compress among equal ratios.  None if no measurement is
+   * within budget.
+   */
+  static Optional<CodecMeasurement> recommend(
+      const std::vector<CodecMeasurement>& measurements,
+      const CodecBudget& budget);
+
+  /**
+   * Measure the candidates and recommend one, see measure().
+   */
+  Optional<CodecMeasurement> recommend(const CodecBudget& budget) const {
+    return recommend(measure(), budget);
+  }
+
+ private:
+  CodecAdvisorOptions options_;
+  std::vector<std::unique_ptr<IOBuf>> samples_;
+  size_t added_{0};
+  std::minstd_rand rng_;
+};
+
+} // namespace io
+} // namespace folly
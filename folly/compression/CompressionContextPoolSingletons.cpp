@@ -84,11 +84,31 @@ ZSTD_customMem huge_page_custom_mem = ZSTD_defaultCMem;
 } // anonymous namespace
 
 ZSTD_CCtx* ZSTD_CCtx_Creator::operator()() const noexcept {
-  return ZSTD_createCCtx_advanced(huge_page_custom_mem);
+  ZSTD_CCtx* ctx = ZSTD_createCCtx_advanced(huge_page_custom_mem);
+  if (ctx == nullptr) {
+    return nullptr;
+  }
+  if ((params != nullptr &&
+       ZSTD_isError(ZSTD_CCtx_setParametersUsingCCtxParams(ctx, params))) ||
+      (cdict != nullptr && ZSTD_isError(ZSTD_CCtx_refCDict(ctx, cdict)))) {
+    ZSTD_freeCCtx(ctx);
+    return nullptr;
+  }
+  return ctx;
 }
 
 ZSTD_DCtx* ZSTD_DCtx_Creator::operator()() const noexcept {
-  return ZSTD_createDCtx_advanced(huge_page_custom_mem);
+  ZSTD_DCtx* ctx = ZSTD_createDCtx_advanced(huge_page_custom_mem);
+  if (ctx == nullptr) {
+    return nullptr;
+  }
+  if ((maxWindowSize != 0 &&
+       ZSTD_isError(ZSTD_DCtx_setMaxWindowSize(ctx, maxWindowSize))) ||
+      (ddict != nullptr && ZSTD_isError(ZSTD_DCtx_refDDict(ctx, ddict)))) {
+    ZSTD_freeDCtx(ctx);
+    return nullptr;
+  }
+  return ctx;
 }
 
 void ZSTD_CCtx_Deleter::operator()(ZSTD_CCtx* ctx) const noexcept {
@@ -100,13 +120,19 @@ void ZSTD_DCtx_Deleter::operator()(ZSTD_DCtx* ctx) const noexcept {
 }
 
 void ZSTD_CCtx_Resetter::operator()(ZSTD_CCtx* ctx) const noexcept {
-  size_t const err = ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters);
+  size_t const err = ZSTD_CCtx_reset(
+      ctx,
+      sessionOnly ? ZSTD_reset_session_only
+                  : ZSTD_reset_session_and_parameters);
   assert(!ZSTD_isError(err)); // This function doesn't actually fail
   (void)err;
 }
 
 void ZSTD_DCtx_Resetter::operator()(ZSTD_DCtx* ctx) const noexcept {
-  size_t const err = ZSTD_DCtx_reset(ctx, ZSTD_reset_session_and_parameters);
+  size_t const err = ZSTD_DCtx_reset(
+      ctx,
+      sessionOnly ? ZSTD_reset_session_only
+                  : ZSTD_reset_session_and_parameters);
   assert(!ZSTD_isError(err)); // This function doesn't actually fail
   (void)err;
 }
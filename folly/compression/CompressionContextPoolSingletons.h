@@ -19,6 +19,9 @@
 #include <folly/folly-config.h>
 
 #if FOLLY_HAVE_LIBZSTD
+#ifndef ZSTD_STATIC_LINKING_ONLY
+#define ZSTD_STATIC_LINKING_ONLY
+#endif
 #include <zstd.h>
 #endif
 
@@ -36,11 +39,22 @@ namespace contexts {
 // Additional feature test macro for zstd singletons.
 #define FOLLY_COMPRESSION_HAS_ZSTD_CONTEXT_POOL_SINGLETONS
 
+/**
+ * Contexts are created clean, unless the creator is given parameters or a
+ * dictionary to load into them. That is for pools dedicated to one set of
+ * parameters and dictionary, which must outlive the pool.
+ */
 struct ZSTD_CCtx_Creator {
+  ZSTD_CCtx_params const* params{nullptr};
+  ZSTD_CDict const* cdict{nullptr};
+
   ZSTD_CCtx* operator()() const noexcept;
 };
 
 struct ZSTD_DCtx_Creator {
+  size_t maxWindowSize{0};
+  ZSTD_DDict const* ddict{nullptr};
+
   ZSTD_DCtx* operator()() const noexcept;
 };
 
@@ -52,11 +66,19 @@ struct ZSTD_DCtx_Deleter {
   void operator()(ZSTD_DCtx* ctx) const noexcept;
 };
 
+/**
+ * Contexts are reset to clean, or only end their session and keep their
+ * parameters and dictionary if sessionOnly is set.
+ */
 struct ZSTD_CCtx_Resetter {
+  bool sessionOnly{false};
+
   void operator()(ZSTD_CCtx* ctx) const noexcept;
 };
 
 struct ZSTD_DCtx_Resetter {
+  bool sessionOnly{false};
+
   void operator()(ZSTD_DCtx* ctx) const noexcept;
 };
 
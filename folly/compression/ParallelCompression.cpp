@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/ParallelCompression.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/detail/ParallelForEach.h>
+#include <folly/io/Cursor.h>
+
+namespace folly {
+namespace io {
+
+namespace {
+
+// Seek table of the zstd seekable format: a skippable frame holding an
+// entry per frame and a footer.
+constexpr uint32_t kSkippableFrameMagic = 0x184D2A5E;
+constexpr uint32_t kSeekableMagic = 0x8F92EAB1;
+constexpr size_t kSkippableHeaderSize = 8;
+constexpr size_t kFooterSize = 9;
+// Compressed and uncompressed size, followed by a checksum if the footer has
+// kChecksumFlag.  We don't write checksums and don't check them.
+constexpr size_t kEntrySize = 8;
+constexpr size_t kChecksumSize = 4;
+constexpr uint8_t kChecksumFlag = 0x80;
+constexpr uint8_t kReservedFlags = 0x7c;
+
+constexpr size_t kMaxBlockSize = size_t(1) << 30;
+
+// Runs fn(i, codec) for every block, where codec is the codec of the thread
+// working on block i, created by fn on its first block.
+template <typename Fn>
+void forEachBlock(
+    size_t numBlocks,
+    Executor::KeepAlive<> executor,
+    const ParallelCompressionOptions& options,
+    Fn fn) {
+  size_t workers = options.maxParallelism == 0
+      ? numBlocks
+      : std::min(numBlocks, options.maxParallelism);
+  std::vector<std::unique_ptr<Codec>> codecs(workers);
+  folly::detail::parallelForEach(
+      numBlocks, std::move(executor), workers, [&](size_t i, size_t worker) {
+        fn(i, codecs[worker]);
+      });
+}
+
+std::unique_ptr<IOBuf> chain(std::vector<std::unique_ptr<IOBuf>> bufs) {
+  std::unique_ptr<IOBuf> result;
+  for (auto& buf : bufs) {
+    if (!result) {
+      result = std::move(buf);
+    } else {
+      result->appendToChain(std::move(buf));
+    }
+  }
+  return result ? std::move(result) : IOBuf::create(0);
+}
+
+} // namespace
+
+bool hasParallelCodec(CodecType type) {
+  switch (type) {
+    case CodecType::ZSTD:
+    case CodecType::ZSTD_FAST:
+    case CodecType::LZ4_FRAME:
+      return hasCodec(type);
+    default:
+      return false;
+  }
+}
+
+std::unique_ptr<IOBuf> compressParallel(
+    const IOBuf* data,
+    CodecType type,
+    int level,
+    Executor::KeepAlive<> executor,
+    const ParallelCompressionOptions& options) {
+  if (!hasParallelCodec(type)) {
+    throw std::invalid_argument(to<std::string>(
+        "compressParallel: unsupported codec type ", static_cast<int>(type)));
+  }
+  if (options.blockSize == 0 || options.blockSize > kMaxBlockSize) {
+    throw std::invalid_argument(to<std::string>(
+        "compressParallel: invalid block size ", options.blockSize));
+  }
+
+  // Blocks share the buffers of data.
+  std::vector<std::unique_ptr<IOBuf>> blocks;
+  Cursor cursor(data);
+  do {
+    std::unique_ptr<IOBuf> block;
+    cursor.cloneAtMost(block, options.blockSize);
+    blocks.push_back(std::move(block));
+  } while (!cursor.isAtEnd());
+
+  std::vector<ParallelFrameInfo> frames(blocks.size());
+  std::vector<std::unique_ptr<IOBuf>> compressed(blocks.size());
+  forEachBlock(
+      blocks.size(),
+      std::move(executor),
+      options,
+      [&](size_t i, std::unique_ptr<Codec>& codec) {
+        if (!codec) {
+          codec = getCodec(type, level);
+        }
+        auto uncompressedSize = blocks[i]->computeChainDataLength();
+        compressed[i] = codec->compress(blocks[i].get());
+        auto compressedSize = compressed[i]->computeChainDataLength();
+        if (compressedSize > std::numeric_limits<uint32_t>::max()) {
+          throw std::runtime_error("compressParallel: frame too large");
+        }
+        frames[i] = {
+            uint32_t(compressedSize), uint32_t(uncompressedSize)};
+        blocks[i].reset();
+      });
+
+  size_t tableSize =
+      kSkippableHeaderSize + frames.size() * kEntrySize + kFooterSize;
+  auto table = IOBuf::create(tableSize);
+  Appender appender(table.get(), 0);
+  appender.writeLE<uint32_t>(kSkippableFrameMagic);
+  appender.writeLE<uint32_t>(uint32_t(tableSize - kSkippableHeaderSize));
+  for (const auto& frame : frames) {
+    appender.writeLE<uint32_t>(frame.compressedSize);
+    appender.writeLE<uint32_t>(frame.uncompressedSize);
+  }
+  appender.writeLE<uint32_t>(uint32_t(frames.size()));
+  appender.write<uint8_t>(0);
+  appender.writeLE<uint32_t>(kSeekableMagic);
+  DCHECK_EQ(tableSize, table->length());
+
+  compressed.push_back(std::move(table));
+  return chain(std::move(compressed));
+}
+
+std::vector<ParallelFrameInfo> getParallelFrames(const IOBuf* data) {
+  auto length = data->computeChainDataLength();
+  if (length < kSkippableHeaderSize + kFooterSize) {
+    return {};
+  }
+  Cursor footer(data);
+  footer.skip(length - kFooterSize);
+  auto numFrames = footer.readLE<uint32_t>();
+  auto descriptor = footer.read<uint8_t>();
+  if (footer.readLE<uint32_t>() != kSeekableMagic) {
+    return {};
+  }
+  if (descriptor & kReservedFlags) {
+    throw std::runtime_error("seek table: reserved bits set");
+  }
+  size_t entrySize =
+      kEntrySize + ((descriptor & kChecksumFlag) ? kChecksumSize : 0);
+  uint64_t tableSize =
+      kSkippableHeaderSize + uint64_t(numFrames) * entrySize + kFooterSize;
+  if (tableSize > length) {
+    throw std::runtime_error("seek table: too many frames");
+  }
+
+  Cursor cursor(data);
+  cursor.skip(length - tableSize);
+  if (cursor.readLE<uint32_t>() != kSkippableFrameMagic ||
+      cursor.readLE<uint32_t>() != tableSize - kSkippableHeaderSize) {
+    throw std::runtime_error("seek table: invalid skippable frame");
+  }
+  std::vector<ParallelFrameInfo> frames(numFrames);
+  uint64_t compressedSize = 0;
+  for (auto& frame : frames) {
+    frame.compressedSize = cursor.readLE<uint32_t>();
+    frame.uncompressedSize = cursor.readLE<uint32_t>();
+    cursor.skip(entrySize - kEntrySize);
+    compressedSize += frame.compressedSize;
+  }
+  if (compressedSize != length - tableSize) {
+    throw std::runtime_error("seek table: frame sizes don't match the data");
+  }
+  return frames;
+}
+
+std::unique_ptr<IOBuf> uncompressParallel(
+    const IOBuf* data,
+    CodecType type,
+    Executor::KeepAlive<> executor,
+    const ParallelCompressionOptions& options) {
+  auto frames = getParallelFrames(data);
+  if (frames.empty()) {
+    return getCodec(type)->uncompress(data);
+  }
+  if (!hasParallelCodec(type)) {
+    throw std::invalid_argument(to<std::string>(
+        "uncompressParallel: unsupported codec type ",
+        static_cast<int>(type)));
+  }
+
+  std::vector<std::unique_ptr<IOBuf>> blocks(frames.size());
+  Cursor cursor(data);
+  for (size_t i = 0; i < frames.size(); ++i) {
+    cursor.clone(blocks[i], frames[i].compressedSize);
+  }
+
+  std::vector<std::unique_ptr<IOBuf>> uncompressed(frames.size());
+  forEachBlock(
+      blocks.size(),
+      std::move(executor),
+      options,
+      [&](size_t i, std::unique_ptr<Codec>& codec) {
+        if (!codec) {
+          codec = getCodec(type);
+        }
+        uncompressed[i] = codec->uncompress(
+            blocks[i].get(), uint64_t(frames[i].uncompressedSize));
+        blocks[i].reset();
+      });
+  return chain(std::move(uncompressed));
+}
+
+} // namespace io
+} // namespace folly
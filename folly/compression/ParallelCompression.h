@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <folly/Executor.h>
+#include <folly/compression/Compression.h>
+#include <folly/io/IOBuf.h>
+
+/**
+ * Parallel compression of large buffers.
+ *
+ * compressParallel() splits its input into blocks that are compressed into
+ * independent frames on an executor, and appends a seek table in the format
+ * of zstd's seekable format (contrib/seekable_format in the zstd repository)
+ * listing the compressed and uncompressed size of every frame.  The seek
+ * table is a skippable frame, which both the zstd and the LZ4 frame formats
+ * define, so the zstd and lz4 command line tools read the output as the
+ * original data.
+ *
+ * uncompressParallel() uses the seek table to uncompress the frames on an
+ * executor.  Codec::uncompress() does not read past the first frame.
+ *
+ * Supported codec types are ZSTD, ZSTD_FAST and LZ4_FRAME, see
+ * hasParallelCodec().
+ */
+
+namespace folly {
+namespace io {
+
+struct ParallelCompressionOptions {
+  // Uncompressed bytes per frame.  Larger blocks compress better, smaller
+  // ones spread the work over more threads.  At most 1GB.
+  size_t blockSize{4 << 20};
+  // Most tasks working on one call at once, including the calling thread.
+  // 0 means one per block.
+  size_t maxParallelism{0};
+
+  ParallelCompressionOptions& setBlockSize(size_t size) {
+    blockSize = size;
+    return *this;
+  }
+  ParallelCompressionOptions& setMaxParallelism(size_t parallelism) {
+    maxParallelism = parallelism;
+    return *this;
+  }
+};
+
+/**
+ * Whether compressParallel() and uncompressParallel() support the codec type
+ * and it is compiled in.
+ */
+bool hasParallelCodec(CodecType type);
+
+/**
+ * Compress data in blocks, each with its own codec of the given type and
+ * level, on the executor.  Blocks are handed out by
+ * detail::parallelForEach(), so the calling thread compresses blocks as well.
+ *
+ * Throws std::invalid_argument if the codec type is not supported, and
+ * rethrows the first exception thrown by compressing a block.
+ */
+std::unique_ptr<IOBuf> compressParallel(
+    const IOBuf* data,
+    CodecType type,
+    int level,
+    Executor::KeepAlive<> executor,
+    const ParallelCompressionOptions& options = ParallelCompressionOptions());
+
+/**
+ * The sizes of the frames in the seek table at the end of data, empty if
+ * there is none.
+ */
+struct ParallelFrameInfo {
+  uint32_t compressedSize;
+  uint32_t uncompressedSize;
+};
+std::vector<ParallelFrameInfo> getParallelFrames(const IOBuf* data);
+
+/**
+ * Uncompress data produced by compressParallel() on the executor, each frame
+ * into its own buffer of the returned chain.  The calling thread takes part
+ * as for compressParallel().  Data without a seek table is uncompressed on
+ * the calling thread by a codec of the given type.
+ *
+ * Throws std::runtime_error if the seek table does not match the frames.
+ */
+std::unique_ptr<IOBuf> uncompressParallel(
+    const IOBuf* data,
+    CodecType type,
+    Executor::KeepAlive<> executor,
+    const ParallelCompressionOptions& options = ParallelCompressionOptions());
+
+} // namespace io
+} // namespace folly
@@ -18,9 +18,11 @@
 
 #if FOLLY_HAVE_LIBZSTD
 
+#include <array>
 #include <stdexcept>
 #include <string>
 
+#include <zdict.h>
 #include <zstd.h>
 
 #include <folly/Conv.h>
@@ -28,6 +30,7 @@
 #include <folly/ScopeGuard.h>
 #include <folly/compression/CompressionContextPoolSingletons.h>
 #include <folly/compression/Utils.h>
+#include <folly/io/Cursor.h>
 
 static_assert(
     ZSTD_VERSION_NUMBER >= 10400,
@@ -67,6 +70,7 @@ ZSTD_EndDirective zstdTranslateFlush(StreamCodec::FlushOp flush) {
 class ZSTDStreamCodec final : public StreamCodec {
  public:
   explicit ZSTDStreamCodec(Options options);
+  explicit ZSTDStreamCodec(std::shared_ptr<const Dictionary> dictionary);
 
   std::vector<std::string> validPrefixes() const override;
   bool canUncompress(
@@ -91,7 +95,9 @@ class ZSTDStreamCodec final : public StreamCodec {
   void resetCCtx();
   void resetDCtx();
 
-  Options options_;
+  // Exactly one of options_ and dictionary_ is set.
+  Optional<Options> options_;
+  std::shared_ptr<const Dictionary> dictionary_;
   ZSTD_CCtx_Pool::Ref cctx_{getNULL_ZSTD_CCtx()};
   ZSTD_DCtx_Pool::Ref dctx_{getNULL_ZSTD_DCtx()};
 };
@@ -117,6 +123,11 @@ ZSTDStreamCodec::ZSTDStreamCodec(Options options)
     : StreamCodec(codecType(options), options.level()),
       options_(std::move(options)) {}
 
+ZSTDStreamCodec::ZSTDStreamCodec(std::shared_ptr<const Dictionary> dictionary)
+    : StreamCodec(
+          codecType(dictionary->options()), dictionary->options().level()),
+      dictionary_(std::move(dictionary)) {}
+
 bool ZSTDStreamCodec::doNeedsUncompressedLength() const {
   return false;
 }
@@ -148,10 +159,16 @@ void ZSTDStreamCodec::doResetStream() {
 
 void ZSTDStreamCodec::resetCCtx() {
   DCHECK(cctx_ == nullptr);
-  cctx_ = getZSTD_CCtx(); // Gives us a clean context
-  DCHECK(cctx_ != nullptr);
-  zstdThrowIfError(
-      ZSTD_CCtx_setParametersUsingCCtxParams(cctx_.get(), options_.params()));
+  if (dictionary_) {
+    // Comes with the options and the dictionary loaded
+    cctx_ = dictionary_->getCCtx();
+    DCHECK(cctx_ != nullptr);
+  } else {
+    cctx_ = getZSTD_CCtx(); // Gives us a clean context
+    DCHECK(cctx_ != nullptr);
+    zstdThrowIfError(ZSTD_CCtx_setParametersUsingCCtxParams(
+        cctx_.get(), options_->params()));
+  }
   zstdThrowIfError(ZSTD_CCtx_setPledgedSrcSize(
       cctx_.get(), uncompressedLength().value_or(ZSTD_CONTENTSIZE_UNKNOWN)));
 }
@@ -187,11 +204,17 @@ bool ZSTDStreamCodec::doCompressStream(
 
 void ZSTDStreamCodec::resetDCtx() {
   DCHECK(dctx_ == nullptr);
+  if (dictionary_) {
+    // Comes with the maximum window size and the dictionary loaded
+    dctx_ = dictionary_->getDCtx();
+    DCHECK(dctx_ != nullptr);
+    return;
+  }
   dctx_ = getZSTD_DCtx(); // Gives us a clean context
   DCHECK(dctx_ != nullptr);
-  if (options_.maxWindowSize() != 0) {
+  if (options_->maxWindowSize() != 0) {
     zstdThrowIfError(
-        ZSTD_DCtx_setMaxWindowSize(dctx_.get(), options_.maxWindowSize()));
+        ZSTD_DCtx_setMaxWindowSize(dctx_.get(), options_->maxWindowSize()));
   }
 }
 
@@ -235,6 +258,84 @@ void Options::set(ZSTD_cParameter param, unsigned value) {
   ZSTD_freeCCtxParams(params);
 }
 
+std::string trainDictionary(
+    const std::vector<ByteRange>& samples, size_t maxSize) {
+  std::string buffer;
+  std::vector<size_t> sizes;
+  sizes.reserve(samples.size());
+  for (auto sample : samples) {
+    buffer.append(reinterpret_cast<const char*>(sample.data()), sample.size());
+    sizes.push_back(sample.size());
+  }
+  std::string dictionary(maxSize, '\0');
+  size_t const rc = ZDICT_trainFromBuffer(
+      &dictionary[0],
+      dictionary.size(),
+      buffer.data(),
+      sizes.data(),
+      static_cast<unsigned>(sizes.size()));
+  if (ZDICT_isError(rc)) {
+    throw std::runtime_error(to<std::string>(
+        "ZSTD dictionary training failed: ", ZDICT_getErrorName(rc)));
+  }
+  dictionary.resize(rc);
+  return dictionary;
+}
+
+uint32_t getDictionaryId(const IOBuf* data) {
+  // The frame header is at most 18 bytes.
+  std::array<uint8_t, 18> header;
+  io::Cursor cursor(data);
+  size_t const length = cursor.pullAtMost(header.data(), header.size());
+  return ZSTD_getDictID_fromFrame(header.data(), length);
+}
+
+Dictionary::Dictionary(ByteRange content, Options options)
+    : content_(content.begin(), content.end()),
+      options_(std::move(options)),
+      id_(ZSTD_getDictID_fromDict(content_.data(), content_.size())) {
+#if ZSTD_VERSION_NUMBER >= 10407
+  cdict_.reset(ZSTD_createCDict_advanced2(
+      content_.data(),
+      content_.size(),
+      ZSTD_dlm_byRef,
+      ZSTD_dct_auto,
+      options_.params(),
+      ZSTD_defaultCMem));
+#else
+  cdict_.reset(
+      ZSTD_createCDict(content_.data(), content_.size(), options_.level()));
+#endif
+  ddict_.reset(ZSTD_createDDict(content_.data(), content_.size()));
+  if (cdict_ == nullptr || ddict_ == nullptr) {
+    throw std::runtime_error("ZSTD: failed to load dictionary");
+  }
+  cctxPool_ = std::make_unique<ZSTD_CCtx_Pool>(
+      ZSTD_CCtx_Creator{options_.params(), cdict_.get()},
+      ZSTD_CCtx_Deleter(),
+      ZSTD_CCtx_Resetter{/* sessionOnly = */ true});
+  dctxPool_ = std::make_unique<ZSTD_DCtx_Pool>(
+      ZSTD_DCtx_Creator{options_.maxWindowSize(), ddict_.get()},
+      ZSTD_DCtx_Deleter(),
+      ZSTD_DCtx_Resetter{/* sessionOnly = */ true});
+}
+
+Dictionary::~Dictionary() = default;
+
+/* static */ std::shared_ptr<const Dictionary> Dictionary::create(
+    ByteRange content, Options options) {
+  return std::shared_ptr<const Dictionary>(
+      new Dictionary(content, std::move(options)));
+}
+
+/* static */ void Dictionary::freeCDict(ZSTD_CDict* cdict) {
+  ZSTD_freeCDict(cdict);
+}
+
+/* static */ void Dictionary::freeDDict(ZSTD_DDict* ddict) {
+  ZSTD_freeDDict(ddict);
+}
+
 std::unique_ptr<Codec> getCodec(Options options) {
   return std::make_unique<ZSTDStreamCodec>(std::move(options));
 }
@@ -243,6 +344,15 @@ std::unique_ptr<StreamCodec> getStreamCodec(Options options) {
   return std::make_unique<ZSTDStreamCodec>(std::move(options));
 }
 
+std::unique_ptr<Codec> getCodec(std::shared_ptr<const Dictionary> dictionary) {
+  return std::make_unique<ZSTDStreamCodec>(std::move(dictionary));
+}
+
+std::unique_ptr<StreamCodec> getStreamCodec(
+    std::shared_ptr<const Dictionary> dictionary) {
+  return std::make_unique<ZSTDStreamCodec>(std::move(dictionary));
+}
+
 } // namespace zstd
 } // namespace io
 } // namespace folly
@@ -18,8 +18,13 @@
 
 #include <memory.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <folly/Memory.h>
 #include <folly/Portability.h>
+#include <folly/Range.h>
 #include <folly/compression/Compression.h>
 
 #if FOLLY_HAVE_LIBZSTD
@@ -29,6 +34,8 @@
 #endif
 #include <zstd.h>
 
+#include <folly/compression/CompressionContextPoolSingletons.h>
+
 namespace folly {
 namespace io {
 namespace zstd {
@@ -80,11 +87,98 @@ class Options {
   int level_;
 };
 
+/**
+ * Train a dictionary of at most maxSize bytes on samples of the data it will
+ * be used for, typically a few thousand small messages.  Small messages
+ * compress poorly on their own, with a dictionary they share the redundancy
+ * of the samples.
+ *
+ * Throws std::runtime_error if training fails, e.g. with too few samples.
+ */
+std::string trainDictionary(
+    const std::vector<ByteRange>& samples, size_t maxSize = 110 * 1024);
+
+/**
+ * The dictionary id in the header of a zstd frame, 0 if the frame was not
+ * compressed with a dictionary or does not say which one.
+ */
+uint32_t getDictionaryId(const IOBuf* data);
+
+/**
+ * A dictionary, digested once for compression with the given options and for
+ * decompression.
+ *
+ * Each dictionary keeps its own core-local pools of contexts that have the
+ * options and the dictionary loaded, and only end their session when they
+ * return to the pool.  So codecs using the dictionary, see getCodec(), don't
+ * load it again for every message.
+ *
+ * Thread-safe; codecs share ownership of their dictionary.
+ */
+class Dictionary {
+ public:
+  /**
+   * Create a dictionary from its content, as returned by trainDictionary().
+   * Content without the zstd dictionary header is used as a raw content
+   * dictionary, with id 0.
+   */
+  static std::shared_ptr<const Dictionary> create(
+      ByteRange content, Options options);
+
+  ~Dictionary();
+
+  Dictionary(const Dictionary&) = delete;
+  Dictionary& operator=(const Dictionary&) = delete;
+
+  /// The id written to the frames compressed with the dictionary.
+  uint32_t id() const { return id_; }
+
+  ByteRange content() const { return ByteRange(StringPiece(content_)); }
+
+  const Options& options() const { return options_; }
+
+  /// A context with the options and the dictionary loaded.
+  compression::contexts::ZSTD_CCtx_Pool::Ref getCCtx() const {
+    return cctxPool_->get();
+  }
+
+  /// A context with the maximum window size and the dictionary loaded.
+  compression::contexts::ZSTD_DCtx_Pool::Ref getDCtx() const {
+    return dctxPool_->get();
+  }
+
+ private:
+  Dictionary(ByteRange content, Options options);
+
+  static void freeCDict(ZSTD_CDict* cdict);
+  static void freeDDict(ZSTD_DDict* ddict);
+
+  std::string content_;
+  Options options_;
+  uint32_t id_;
+  std::unique_ptr<ZSTD_CDict, static_function_deleter<ZSTD_CDict, &freeCDict>>
+      cdict_;
+  std::unique_ptr<ZSTD_DDict, static_function_deleter<ZSTD_DDict, &freeDDict>>
+      ddict_;
+  // Declared last, the contexts reference the dictionaries.
+  std::unique_ptr<compression::contexts::ZSTD_CCtx_Pool> cctxPool_;
+  std::unique_ptr<compression::contexts::ZSTD_DCtx_Pool> dctxPool_;
+};
+
 /// Get a zstd Codec with the given options.
 std::unique_ptr<Codec> getCodec(Options options);
 /// Get a zstd StreamCodec with the given options.
 std::unique_ptr<StreamCodec> getStreamCodec(Options options);
 
+/**
+ * Get a zstd Codec that compresses with the dictionary, at the level and with
+ * the options it was created with, and uncompresses data compressed with it.
+ */
+std::unique_ptr<Codec> getCodec(std::shared_ptr<const Dictionary> dictionary);
+/// Get a zstd StreamCodec that uses the dictionary.
+std::unique_ptr<StreamCodec> getStreamCodec(
+    std::shared_ptr<const Dictionary> dictionary);
+
 } // namespace zstd
 } // namespace io
 } // namespace folly
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/coro/StreamCompression.h>
+
+#include <stdexcept>
+
+#include <folly/Range.h>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+namespace {
+
+using FlushOp = io::StreamCodec::FlushOp;
+
+// The buffer being filled, of at most size bytes.
+class OutputBuffer {
+ public:
+  explicit OutputBuffer(size_t size) : size_(size) {}
+
+  MutableByteRange range() {
+    if (!buf_) {
+      buf_ = IOBuf::create(size_);
+    }
+    return {buf_->writableTail(), size_ - buf_->length()};
+  }
+
+  // Account for the bytes written to the range, which was advanced past them.
+  void commit(MutableByteRange range) {
+    buf_->append(range.data() - buf_->writableTail());
+  }
+
+  bool empty() const { return !buf_ || buf_->empty(); }
+  bool full() const { return buf_ && buf_->length() == size_; }
+
+  std::unique_ptr<IOBuf> take() { return std::move(buf_); }
+
+ private:
+  const size_t size_;
+  std::unique_ptr<IOBuf> buf_;
+};
+
+AsyncGenerator<std::unique_ptr<IOBuf>> compressStreamImpl(
+    AsyncGenerator<std::unique_ptr<IOBuf>> source,
+    std::unique_ptr<io::StreamCodec> codec,
+    StreamCompressionOptions options) {
+  OutputBuffer output(options.bufferSize);
+  codec->resetStream();
+  while (auto item = co_await source.next()) {
+    auto input = std::move(*item);
+    if (!input) {
+      continue;
+    }
+    for (ByteRange range : *input) {
+      while (!range.empty()) {
+        if (output.full()) {
+          co_yield output.take();
+        }
+        auto out = output.range();
+        codec->compressStream(range, out, FlushOp::NONE);
+        output.commit(out);
+      }
+    }
+    // Input buffers may be freed or reused by the producer from here on.
+    input.reset();
+    if (options.flushEachBuffer) {
+      for (bool flushed = false; !flushed;) {
+        if (output.full()) {
+          co_yield output.take();
+        }
+        ByteRange empty;
+        auto out = output.range();
+        flushed = codec->compressStream(empty, out, FlushOp::FLUSH);
+        output.commit(out);
+      }
+      if (!output.empty()) {
+        co_yield output.take();
+      }
+    }
+  }
+  for (bool ended = false; !ended;) {
+    if (output.full()) {
+      co_yield output.take();
+    }
+    ByteRange empty;
+    auto out = output.range();
+    ended = codec->compressStream(empty, out, FlushOp::END);
+    output.commit(out);
+  }
+  if (!output.empty()) {
+    co_yield output.take();
+  }
+}
+
+AsyncGenerator<std::unique_ptr<IOBuf>> uncompressStreamImpl(
+    AsyncGenerator<std::unique_ptr<IOBuf>> source,
+    std::unique_ptr<io::StreamCodec> codec,
+    StreamCompressionOptions options) {
+  OutputBuffer output(options.bufferSize);
+  bool inFrame = false;
+  while (auto item = co_await source.next()) {
+    auto input = std::move(*item);
+    if (!input) {
+      continue;
+    }
+    for (ByteRange range : *input) {
+      bool more = !range.empty();
+      while (more) {
+        if (output.full()) {
+          co_yield output.take();
+        }
+        if (!inFrame) {
+          codec->resetStream();
+          inFrame = true;
+        }
+        auto out = output.range();
+        inFrame = !codec->uncompressStream(range, out);
+        output.commit(out);
+        // A codec that filled the buffer may have more output pending.
+        more = !range.empty() || (inFrame && output.full());
+      }
+    }
+    if (options.flushEachBuffer && !output.empty()) {
+      co_yield output.take();
+    }
+  }
+  if (inFrame) {
+    throw std::runtime_error("uncompressStream: truncated input");
+  }
+  if (!output.empty()) {
+    co_yield output.take();
+  }
+}
+
+void checkOptions(const StreamCompressionOptions& options) {
+  if (options.bufferSize == 0) {
+    throw std::invalid_argument("StreamCompressionOptions: bufferSize is 0");
+  }
+}
+
+} // namespace
+
+AsyncGenerator<std::unique_ptr<IOBuf>> compressStream(
+    AsyncGenerator<std::unique_ptr<IOBuf>> source,
+    std::unique_ptr<io::StreamCodec> codec,
+    StreamCompressionOptions options) {
+  checkOptions(options);
+  if (codec->needsDataLength()) {
+    throw std::invalid_argument(
+        "compressStream: codec needs the uncompressed length");
+  }
+  return compressStreamImpl(std::move(source), std::move(codec), options);
+}
+
+AsyncGenerator<std::unique_ptr<IOBuf>> uncompressStream(
+    AsyncGenerator<std::unique_ptr<IOBuf>> source,
+    std::unique_ptr<io::StreamCodec> codec,
+    StreamCompressionOptions options) {
+  checkOptions(options);
+  return uncompressStreamImpl(std::move(source), std::move(codec), options);
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <folly/Portability.h>
+#include <folly/compression/Compression.h>
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/io/IOBuf.h>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+struct StreamCompressionOptions {
+  // Capacity of the buffers yielded.  A buffer is yielded when it is full,
+  // or holds the last output of the stream or of a flush.
+  size_t bufferSize{64 * 1024};
+  // Yield the output for every input buffer without waiting for a full
+  // buffer.  When compressing, the codec is flushed after every input buffer,
+  // so that the output yielded so far uncompresses to all the input consumed
+  // so far.  Useful for responses streamed as they are produced, at some cost
+  // in compression ratio.  Not all codecs support flushing, e.g. BZIP2
+  // doesn't.
+  bool flushEachBuffer{false};
+
+  StreamCompressionOptions& setBufferSize(size_t size) {
+    bufferSize = size;
+    return *this;
+  }
+  StreamCompressionOptions& setFlushEachBuffer(bool flush) {
+    flushEachBuffer = flush;
+    return *this;
+  }
+};
+
+/**
+ * Compress a stream of buffers into a single compressed frame, yielded as a
+ * stream of buffers of at most options.bufferSize bytes.
+ *
+ * The stream is pulled, not pushed: an input buffer is only requested from
+ * source once the output of the previous one has been consumed.  So memory
+ * is bounded by one input buffer and one output buffer plus the state of the
+ * codec, and a slow consumer slows down the producer.
+ *
+ * The codec is owned by the generator.  Codecs like zstd take their contexts
+ * from the pools of CompressionContextPoolSingletons when the stream starts
+ * and return them when it ends or the generator is destroyed.
+ *
+ * Throws std::invalid_argument if the codec needs the uncompressed length
+ * up front, or options.bufferSize is 0.  Errors of source and of the codec
+ * are rethrown by the generator.
+ *
+ * Example:
+ *   AsyncGenerator<std::unique_ptr<IOBuf>> body = ...;
+ *   auto compressed = compressStream(
+ *       std::move(body), io::getStreamCodec(io::CodecType::ZSTD));
+ *   while (auto buf = co_await compressed.next()) {
+ *     co_await transport.write(**buf);
+ *   }
+ */
+AsyncGenerator<std::unique_ptr<IOBuf>> compressStream(
+    AsyncGenerator<std::unique_ptr<IOBuf>> source,
+    std::unique_ptr<io::StreamCodec> codec,
+    StreamCompressionOptions options = {});
+
+/**
+ * Uncompress a stream of buffers holding one or more compressed frames into
+ * a stream of buffers of at most options.bufferSize bytes, see
+ * compressStream().
+ *
+ * Throws std::runtime_error if source ends within a frame.
+ */
+AsyncGenerator<std::unique_ptr<IOBuf>> uncompressStream(
+    AsyncGenerator<std::unique_ptr<IOBuf>> source,
+    std::unique_ptr<io::StreamCodec> codec,
+    StreamCompressionOptions options = {});
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
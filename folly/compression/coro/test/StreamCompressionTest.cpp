@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/coro/StreamCompression.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/experimental/coro/BlockingWait.h>
+#include <folly/experimental/coro/Task.h>
+#include <folly/portability/GTest.h>
+
+#if FOLLY_HAS_COROUTINES
+
+using namespace folly;
+using namespace folly::coro;
+using folly::io::CodecType;
+
+namespace {
+
+std::string makeData(size_t size, uint32_t seed) {
+  // Compressible, but not trivially.
+  std::mt19937 rng(seed);
+  std::string data;
+  while (data.size() < size) {
+    data += std::to_string(rng() % 1000) + (rng() % 8 == 0 ? "\n" : ",");
+  }
+  data.resize(size);
+  return data;
+}
+
+std::vector<std::string> split(const std::string& data, size_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> chunks;
+  for (size_t pos = 0; pos < data.size();) {
+    size_t n = std::min<size_t>(data.size() - pos, 1 + rng() % 10000);
+    chunks.push_back(data.substr(pos, n));
+    pos += n;
+  }
+  return chunks;
+}
+
+// Yields the chunks, counting how many were pulled.
+AsyncGenerator<std::unique_ptr<IOBuf>> generate(
+    std::vector<std::string> chunks, size_t* pulled = nullptr) {
+  for (const auto& chunk : chunks) {
+    if (pulled) {
+      ++*pulled;
+    }
+    co_yield IOBuf::copyBuffer(chunk);
+  }
+}
+
+struct Collected {
+  std::string data;
+  std::vector<size_t> sizes;
+};
+
+Collected collect(AsyncGenerator<std::unique_ptr<IOBuf>> stream) {
+  return blockingWait([&]() -> Task<Collected> {
+    Collected collected;
+    while (auto buf = co_await stream.next()) {
+      auto str = (*buf)->moveToFbString();
+      collected.sizes.push_back(str.size());
+      collected.data.append(str.data(), str.size());
+    }
+    co_return collected;
+  }());
+}
+
+} // namespace
+
+class StreamCompressionTest : public testing::TestWithParam<CodecType> {
+ protected:
+  void SetUp() override {
+    if (!io::hasStreamCodec(GetParam())) {
+      GTEST_SKIP() << "codec not available";
+    }
+  }
+
+  std::unique_ptr<io::StreamCodec> codec() {
+    return io::getStreamCodec(GetParam());
+  }
+};
+
+TEST_P(StreamCompressionTest, RoundTrip) {
+  for (size_t size : {0, 1, 1000, 100000, 1000000}) {
+    SCOPED_TRACE(size);
+    auto const data = makeData(size, 1);
+    auto const options = StreamCompressionOptions().setBufferSize(1000);
+    auto compressed =
+        collect(compressStream(generate(split(data, 2)), codec(), options));
+    for (auto s : compressed.sizes) {
+      EXPECT_LE(s, 1000);
+      EXPECT_GT(s, 0);
+    }
+    EXPECT_EQ(data, codec()->uncompress(compressed.data));
+
+    auto uncompressed = collect(uncompressStream(
+        generate(split(compressed.data, 3)), codec(), options));
+    EXPECT_EQ(data, uncompressed.data);
+    for (size_t i = 0; i < uncompressed.sizes.size(); ++i) {
+      EXPECT_GT(uncompressed.sizes[i], 0);
+      if (i + 1 < uncompressed.sizes.size()) {
+        EXPECT_EQ(1000, uncompressed.sizes[i]);
+      }
+    }
+  }
+}
+
+TEST_P(StreamCompressionTest, Backpressure) {
+  std::vector<std::string> chunks(100, makeData(65536, 1));
+  size_t pulled = 0;
+  auto compressed = compressStream(
+      generate(chunks, &pulled),
+      codec(),
+      StreamCompressionOptions().setBufferSize(4096));
+  blockingWait([&]() -> Task<void> {
+    auto buf = co_await compressed.next();
+    EXPECT_TRUE(buf.has_value());
+  }());
+  // Only what it took to fill the first buffer was pulled, up to a block of
+  // 900KB for BZIP2.
+  EXPECT_LT(pulled, 20);
+  compressed = {};
+  EXPECT_LT(pulled, 20);
+}
+
+TEST_P(StreamCompressionTest, FlushEachBuffer) {
+  if (GetParam() == CodecType::BZIP2) {
+    GTEST_SKIP() << "flush not supported";
+  }
+  auto const chunks = split(makeData(100000, 1), 2);
+  auto compressed = compressStream(
+      generate(chunks),
+      codec(),
+      StreamCompressionOptions().setFlushEachBuffer(true));
+  auto uncompressed = uncompressStream(
+      std::move(compressed),
+      codec(),
+      StreamCompressionOptions().setFlushEachBuffer(true));
+  // Every chunk is uncompressed as soon as it was compressed.
+  blockingWait([&]() -> Task<void> {
+    for (const auto& chunk : chunks) {
+      auto buf = co_await uncompressed.next();
+      if (!buf) {
+        ADD_FAILURE() << "missing output";
+        co_return;
+      }
+      EXPECT_EQ(chunk, (*buf)->moveToFbString().toStdString());
+    }
+    EXPECT_FALSE(co_await uncompressed.next());
+  }());
+}
+
+TEST_P(StreamCompressionTest, Frames) {
+  auto const first = makeData(10000, 1);
+  auto const second = makeData(20000, 2);
+  auto compressed = codec()->compress(first) + codec()->compress(second);
+  auto uncompressed = collect(
+      uncompressStream(generate(split(compressed, 3)), codec(), {}));
+  EXPECT_EQ(first + second, uncompressed.data);
+}
+
+TEST_P(StreamCompressionTest, Truncated) {
+  auto compressed = codec()->compress(makeData(100000, 1));
+  compressed.pop_back();
+  EXPECT_THROW(
+      collect(uncompressStream(generate(split(compressed, 3)), codec(), {})),
+      std::runtime_error);
+}
+
+TEST_P(StreamCompressionTest, SourceError) {
+  auto source = []() -> AsyncGenerator<std::unique_ptr<IOBuf>> {
+    co_yield IOBuf::copyBuffer("hello");
+    throw std::logic_error("source");
+  };
+  EXPECT_THROW(
+      collect(compressStream(source(), codec(), {})), std::logic_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    StreamCompressionTest,
+    StreamCompressionTest,
+    testing::Values(
+        CodecType::ZLIB,
+        CodecType::GZIP,
+        CodecType::BZIP2,
+        CodecType::ZSTD,
+        CodecType::LZ4_FRAME));
+
+TEST(StreamCompression, InvalidArguments) {
+  if (!io::hasStreamCodec(CodecType::ZLIB)) {
+    GTEST_SKIP() << "codec not available";
+  }
+  EXPECT_THROW(
+      uncompressStream(
+          generate({}),
+          io::getStreamCodec(CodecType::ZLIB),
+          StreamCompressionOptions().setBufferSize(0)),
+      std::invalid_argument);
+}
+
+#endif // FOLLY_HAS_COROUTINES
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/CodecAdvisor.h>
+
+#include <random>
+#include <string>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+using namespace folly::io;
+
+namespace {
+
+std::string makeMessage(size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::string message;
+  while (message.size() < size) {
+    message += "{\"id\":" + std::to_string(rng() % 1000) + ",\"ok\":true},";
+  }
+  message.resize(size);
+  return message;
+}
+
+CodecMeasurement makeMeasurement(
+    CodecType type, uint64_t compressedBytes, int64_t compressNs) {
+  CodecMeasurement m{type, COMPRESSION_LEVEL_DEFAULT};
+  m.uncompressedBytes = 1000000;
+  m.compressedBytes = compressedBytes;
+  m.compressTime = std::chrono::nanoseconds(compressNs);
+  m.uncompressTime = std::chrono::nanoseconds(compressNs / 4);
+  return m;
+}
+
+} // namespace
+
+TEST(CodecAdvisorTest, DefaultCandidates) {
+  auto const candidates = defaultCodecCandidates();
+  EXPECT_FALSE(candidates.empty());
+  for (const auto& candidate : candidates) {
+    EXPECT_TRUE(hasCodec(candidate.type));
+    EXPECT_NO_THROW(getCodec(candidate.type, candidate.level));
+  }
+}
+
+TEST(CodecAdvisorTest, Measure) {
+  CodecAdvisor advisor(CodecAdvisorOptions().setIterations(1));
+  for (uint32_t i = 0; i < 20; ++i) {
+    auto buf = IOBuf::copyBuffer(makeMessage(1000, i));
+    // Chains are measured as they are.
+    buf->appendToChain(IOBuf::copyBuffer(makeMessage(500, i + 100)));
+    advisor.addSample(std::move(buf));
+  }
+  EXPECT_EQ(20, advisor.numSamples());
+
+  auto const measurements = advisor.measure();
+  EXPECT_EQ(defaultCodecCandidates().size(), measurements.size());
+  for (const auto& m : measurements) {
+    SCOPED_TRACE(m.toString());
+    EXPECT_EQ(30000, m.uncompressedBytes);
+    EXPECT_GT(m.compressedBytes, 0);
+    EXPECT_GT(m.compressThroughput(), 0);
+    EXPECT_GT(m.uncompressThroughput(), 0);
+    if (m.type == CodecType::NO_COMPRESSION) {
+      EXPECT_EQ(1.0, m.ratio());
+    } else {
+      EXPECT_GT(m.ratio(), 1.5);
+    }
+  }
+}
+
+TEST(CodecAdvisorTest, Reservoir) {
+  CodecAdvisor advisor(CodecAdvisorOptions().setMaxSamples(10));
+  for (size_t i = 0; i < 1000; ++i) {
+    advisor.addSample(IOBuf::copyBuffer(std::to_string(i)));
+  }
+  advisor.addSample(nullptr);
+  EXPECT_EQ(10, advisor.numSamples());
+  EXPECT_EQ(1000, advisor.numAdded());
+}
+
+TEST(CodecAdvisorTest, Recommend) {
+  std::vector<CodecMeasurement> measurements = {
+      makeMeasurement(CodecType::NO_COMPRESSION, 1000000, 100000),
+      makeMeasurement(CodecType::LZ4, 500000, 2000000),
+      makeMeasurement(CodecType::ZSTD, 300000, 4000000),
+      makeMeasurement(CodecType::LZMA2, 200000, 100000000),
+  };
+  auto recommend = [&](double compress, double uncompress) {
+    auto m = CodecAdvisor::recommend(
+        measurements,
+        CodecBudget()
+            .setMinCompressThroughput(compress)
+            .setMinUncompressThroughput(uncompress));
+    return m ? m->type : CodecType::USER_DEFINED;
+  };
+  EXPECT_EQ(CodecType::LZMA2, recommend(0, 0));
+  EXPECT_EQ(CodecType::ZSTD, recommend(100e6, 0));
+  EXPECT_EQ(CodecType::LZ4, recommend(300e6, 0));
+  EXPECT_EQ(CodecType::LZ4, recommend(0, 2e9));
+  EXPECT_EQ(CodecType::NO_COMPRESSION, recommend(1e9, 0));
+  EXPECT_EQ(CodecType::USER_DEFINED, recommend(1e12, 0));
+
+  // Equal ratios go to the faster codec.
+  measurements.push_back(makeMeasurement(CodecType::ZLIB, 200000, 50000000));
+  EXPECT_EQ(CodecType::ZLIB, recommend(0, 0));
+}
+
+TEST(CodecAdvisorTest, RecommendMeasured) {
+  if (!hasCodec(CodecType::ZLIB)) {
+    GTEST_SKIP() << "codec not available";
+  }
+  CodecAdvisor advisor(
+      CodecAdvisorOptions().setIterations(1).setCandidates({
+          {CodecType::NO_COMPRESSION, COMPRESSION_LEVEL_DEFAULT},
+          {CodecType::ZLIB, COMPRESSION_LEVEL_BEST},
+      }));
+  for (uint32_t i = 0; i < 10; ++i) {
+    advisor.addSample(IOBuf::copyBuffer(makeMessage(10000, i)));
+  }
+  auto m = advisor.recommend(CodecBudget());
+  ASSERT_TRUE(m.has_value());
+  EXPECT_EQ(CodecType::ZLIB, m->type);
+  EXPECT_EQ(COMPRESSION_LEVEL_BEST, m->level);
+  EXPECT_EQ("ZLIB:best", m->toString().substr(0, 9));
+}
+
+TEST(CodecAdvisorTest, InvalidArguments) {
+  EXPECT_THROW(
+      CodecAdvisor(CodecAdvisorOptions().setMaxSamples(0)),
+      std::invalid_argument);
+  EXPECT_THROW(
+      CodecAdvisor(CodecAdvisorOptions().setIterations(0)),
+      std::invalid_argument);
+
+  CodecAdvisor advisor(CodecAdvisorOptions().setCandidates(
+      {{CodecType::NO_COMPRESSION, 42}}));
+  advisor.addSample(IOBuf::copyBuffer("hello"));
+  EXPECT_THROW(advisor.measure(), std::invalid_argument);
+}
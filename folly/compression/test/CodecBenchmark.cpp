@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/CodecAdvisor.h>
+
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/init/Init.h>
+#include <folly/portability/GFlags.h>
+
+DEFINE_bool(
+    advisor,
+    false,
+    "Print the CodecAdvisor measurements of every corpus instead of running "
+    "the benchmarks");
+
+using namespace folly;
+using namespace folly::io;
+
+namespace {
+
+// Small messages with a common structure, like RPC payloads.
+std::string makeMessage(std::mt19937& rng, size_t size) {
+  static const char* const kStatus[] = {"active", "idle", "away", "blocked"};
+  std::string message = "[";
+  while (message.size() < size) {
+    auto id = rng() % 1000000;
+    toAppend(
+        R"({"user_id":)",
+        id,
+        R"(,"name":"user_)",
+        id,
+        R"(","status":")",
+        kStatus[rng() % 4],
+        R"(","score":)",
+        rng() % 10000,
+        "},",
+        &message);
+  }
+  message.back() = ']';
+  return message;
+}
+
+// Large buffers of log lines.
+std::string makeLog(std::mt19937& rng, size_t size) {
+  static const char* const kLevel[] = {"INFO", "INFO", "WARN", "ERROR"};
+  std::string log;
+  while (log.size() < size) {
+    toAppend(
+        "2024-01-01 12:",
+        rng() % 60,
+        ":",
+        rng() % 60,
+        ".",
+        rng() % 1000000,
+        " ",
+        kLevel[rng() % 4],
+        " server.cpp:",
+        rng() % 2000,
+        "] request ",
+        rng(),
+        " took ",
+        rng() % 100000,
+        "us\n",
+        &log);
+  }
+  log.resize(size);
+  return log;
+}
+
+struct Corpus {
+  std::string name;
+  std::vector<std::unique_ptr<IOBuf>> buffers;
+};
+
+std::vector<Corpus> makeCorpora() {
+  std::mt19937 rng(1);
+  std::vector<Corpus> corpora(2);
+  corpora[0].name = "message_1k";
+  for (size_t i = 0; i < 1000; ++i) {
+    corpora[0].buffers.push_back(IOBuf::copyBuffer(makeMessage(rng, 1024)));
+  }
+  corpora[1].name = "log_1m";
+  for (size_t i = 0; i < 4; ++i) {
+    corpora[1].buffers.push_back(IOBuf::copyBuffer(makeLog(rng, 1 << 20)));
+  }
+  return corpora;
+}
+
+// Every candidate compresses and uncompresses one buffer of the corpus per
+// iteration, reporting the average sizes per buffer.
+void addCodecBenchmarks(const Corpus& corpus) {
+  static std::deque<std::string> names;
+  for (const auto& candidate : defaultCodecCandidates()) {
+    auto codec = std::shared_ptr<Codec>(
+        getCodec(candidate.type, candidate.level).release());
+    auto compressed = std::make_shared<std::vector<std::unique_ptr<IOBuf>>>();
+    int64_t bytes = 0;
+    int64_t compressedBytes = 0;
+    for (const auto& buf : corpus.buffers) {
+      compressed->push_back(codec->compress(buf.get()));
+      bytes += buf->computeChainDataLength();
+      compressedBytes += compressed->back()->computeChainDataLength();
+    }
+    bytes /= corpus.buffers.size();
+    compressedBytes /= corpus.buffers.size();
+    auto const name = fmt::format("{} {}", candidate.name(), corpus.name);
+    auto const* buffers = &corpus.buffers;
+
+    names.push_back("compress " + name);
+    addBenchmark(
+        __FILE__,
+        names.back(),
+        [=](UserCounters& counters, unsigned iters) {
+          counters["bytes"] = bytes;
+          counters["compressed"] = compressedBytes;
+          for (unsigned i = 0; i < iters; ++i) {
+            doNotOptimizeAway(
+                codec->compress((*buffers)[i % buffers->size()].get()));
+          }
+          return iters;
+        });
+
+    names.push_back("uncompress " + name);
+    bool const needsLength = codec->needsUncompressedLength();
+    addBenchmark(
+        __FILE__,
+        names.back(),
+        [=](UserCounters& counters, unsigned iters) {
+          counters["bytes"] = bytes;
+          counters["compressed"] = compressedBytes;
+          for (unsigned i = 0; i < iters; ++i) {
+            auto j = i % compressed->size();
+            Optional<uint64_t> length;
+            if (needsLength) {
+              length = (*buffers)[j]->computeChainDataLength();
+            }
+            doNotOptimizeAway(
+                codec->uncompress((*compressed)[j].get(), length));
+          }
+          return iters;
+        });
+  }
+  addBenchmark(__FILE__, "-", []() { return 0; });
+}
+
+void printAdvisor(const Corpus& corpus) {
+  CodecAdvisor advisor;
+  for (const auto& buf : corpus.buffers) {
+    advisor.addSample(buf->clone());
+  }
+  std::cout << corpus.name << ":\n";
+  for (const auto& m : advisor.measure()) {
+    std::cout << "  " << m.toString() << "\n";
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  static auto const corpora = makeCorpora();
+  for (const auto& corpus : corpora) {
+    if (FLAGS_advisor) {
+      printAdvisor(corpus);
+    } else {
+      addCodecBenchmarks(corpus);
+    }
+  }
+  if (!FLAGS_advisor) {
+    folly::runBenchmarks();
+  }
+  return 0;
+}
@@ -25,6 +25,7 @@
 
 #include <glog/logging.h>
 
+#include <folly/Conv.h>
 #include <folly/Random.h>
 #include <folly/Varint.h>
 #include <folly/hash/Hash.h>
@@ -1468,6 +1469,112 @@ TEST(ZstdTest, NegativeLevels) {
   EXPECT_EQ(original, uncompressed);
 }
 
+// Small messages with a common structure, like RPC payloads.
+std::vector<std::string> makeMessages(size_t count, uint32_t seed) {
+  static const char* const kStatus[] = {"active", "idle", "away", "blocked"};
+  std::mt19937 rng(seed);
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < count; ++i) {
+    auto id = rng() % 1000000;
+    messages.push_back(to<std::string>(
+        R"({"user_id":)",
+        id,
+        R"(,"name":"user_)",
+        id,
+        R"(","status":")",
+        kStatus[rng() % 4],
+        R"(","region":"region-)",
+        rng() % 8,
+        R"(","last_seen":)",
+        1700000000 + rng() % 1000000,
+        R"(,"score":)",
+        rng() % 10000,
+        R"(,"flags":{"verified":true,"premium":false}})"));
+  }
+  return messages;
+}
+
+std::string trainDictionary() {
+  std::vector<ByteRange> samples;
+  for (auto const& message : makeMessages(2000, 1)) {
+    samples.push_back(ByteRange(StringPiece(message)));
+  }
+  return zstd::trainDictionary(samples, 4096);
+}
+
+TEST(ZstdDictionaryTest, RoundTrip) {
+  auto const dictionary = zstd::Dictionary::create(
+      ByteRange(StringPiece(trainDictionary())), zstd::Options(3));
+  EXPECT_NE(0, dictionary->id());
+  EXPECT_LE(dictionary->content().size(), 4096);
+  auto codec = zstd::getCodec(dictionary);
+  auto plainCodec = getCodec(CodecType::ZSTD, 3);
+  EXPECT_EQ(CodecType::ZSTD, codec->type());
+
+  size_t size = 0;
+  size_t compressedSize = 0;
+  size_t plainCompressedSize = 0;
+  for (auto const& message : makeMessages(100, 2)) {
+    auto const compressed = codec->compress(message);
+    EXPECT_EQ(message, codec->uncompress(compressed));
+    auto const buf = IOBuf::wrapBuffer(StringPiece(compressed));
+    EXPECT_EQ(dictionary->id(), zstd::getDictionaryId(buf.get()));
+    size += message.size();
+    compressedSize += compressed.size();
+    plainCompressedSize += plainCodec->compress(message).size();
+  }
+  EXPECT_LT(compressedSize * 2, plainCompressedSize);
+  EXPECT_LT(compressedSize * 3, size);
+
+  // A codec without the dictionary can't uncompress.
+  auto const message = makeMessages(1, 3)[0];
+  EXPECT_THROW(
+      plainCodec->uncompress(codec->compress(message)), std::runtime_error);
+  auto const plainCompressed = plainCodec->compress(message);
+  EXPECT_EQ(
+      0,
+      zstd::getDictionaryId(
+          IOBuf::wrapBuffer(StringPiece(plainCompressed)).get()));
+}
+
+TEST(ZstdDictionaryTest, Options) {
+  zstd::Options options(1);
+  options.set(ZSTD_c_checksumFlag, 1);
+  auto const dictionary = zstd::Dictionary::create(
+      ByteRange(StringPiece(trainDictionary())), std::move(options));
+  auto codec = zstd::getStreamCodec(dictionary);
+  // Contexts keep the options and the dictionary across messages.
+  for (auto const& message : makeMessages(10, 2)) {
+    auto const compressed = codec->compress(message);
+    ZSTD_frameHeader zfh;
+    ASSERT_EQ(
+        0, ZSTD_getFrameHeader(&zfh, compressed.data(), compressed.size()));
+    EXPECT_EQ(1, zfh.checksumFlag);
+    EXPECT_EQ(dictionary->id(), zfh.dictID);
+    EXPECT_EQ(message, codec->uncompress(compressed));
+  }
+}
+
+TEST(ZstdDictionaryTest, RawContent) {
+  auto const messages = makeMessages(10, 2);
+  auto const dictionary = zstd::Dictionary::create(
+      ByteRange(StringPiece(messages[0])), zstd::Options(3));
+  EXPECT_EQ(0, dictionary->id());
+  auto codec = zstd::getCodec(dictionary);
+  for (auto const& message : messages) {
+    EXPECT_EQ(message, codec->uncompress(codec->compress(message)));
+  }
+  EXPECT_LT(codec->compress(messages[0]).size(), 32);
+}
+
+TEST(ZstdDictionaryTest, TooFewSamples) {
+  std::vector<ByteRange> samples;
+  for (auto const& message : makeMessages(2, 1)) {
+    samples.push_back(ByteRange(StringPiece(message)));
+  }
+  EXPECT_THROW(zstd::trainDictionary(samples, 4096), std::runtime_error);
+}
+
 #endif
 
 #if FOLLY_HAVE_LIBZ
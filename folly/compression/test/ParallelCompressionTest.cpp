@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/ParallelCompression.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/InlineExecutor.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+namespace folly {
+namespace io {
+namespace test {
+
+namespace {
+
+// Compressible data with some variation, in a chain of odd-sized buffers.
+std::unique_ptr<IOBuf> makeData(size_t size) {
+  IOBufQueue queue(IOBufQueue::cacheChainLength());
+  std::string chunk;
+  for (size_t i = 0; chunk.size() < 12345; ++i) {
+    chunk += std::to_string(i * i % 1000) + ",";
+  }
+  while (queue.chainLength() < size) {
+    auto n = std::min(chunk.size(), size - queue.chainLength());
+    queue.append(IOBuf::copyBuffer(chunk.data(), n));
+  }
+  return queue.empty() ? IOBuf::create(0) : queue.move();
+}
+
+} // namespace
+
+class ParallelCompressionTest : public testing::TestWithParam<CodecType> {
+ protected:
+  void SetUp() override {
+    if (!hasParallelCodec(GetParam())) {
+      GTEST_SKIP() << "codec not available";
+    }
+  }
+
+  CPUThreadPoolExecutor executor_{4};
+};
+
+TEST_P(ParallelCompressionTest, RoundTrip) {
+  auto type = GetParam();
+  for (size_t size : {0, 1, 1000, 65536, 65537, 1000000}) {
+    SCOPED_TRACE(size);
+    auto data = makeData(size);
+    auto compressed = compressParallel(
+        data.get(),
+        type,
+        COMPRESSION_LEVEL_DEFAULT,
+        &executor_,
+        ParallelCompressionOptions().setBlockSize(65536));
+
+    auto frames = getParallelFrames(compressed.get());
+    ASSERT_EQ(std::max<size_t>(1, (size + 65535) / 65536), frames.size());
+    size_t total = 0;
+    for (auto& frame : frames) {
+      EXPECT_LE(frame.uncompressedSize, 65536);
+      total += frame.uncompressedSize;
+    }
+    EXPECT_EQ(size, total);
+
+    // Every frame is a standard frame of the codec.
+    auto codec = getCodec(type);
+    std::unique_ptr<IOBuf> frame;
+    Cursor(compressed.get()).clone(frame, frames[0].compressedSize);
+    auto first = codec->uncompress(frame.get());
+    EXPECT_EQ(frames[0].uncompressedSize, first->computeChainDataLength());
+
+    auto uncompressed = uncompressParallel(compressed.get(), type, &executor_);
+    EXPECT_TRUE(IOBufEqualTo()(*data, *uncompressed));
+  }
+}
+
+TEST_P(ParallelCompressionTest, CallerOnly) {
+  // Every block is compressed on the calling thread if the executor's
+  // threads are all busy.
+  auto type = GetParam();
+  auto data = makeData(300000);
+  CPUThreadPoolExecutor busy(1);
+  Baton<> release;
+  busy.add([&] { release.wait(); });
+  auto compressed = compressParallel(
+      data.get(),
+      type,
+      COMPRESSION_LEVEL_DEFAULT,
+      &busy,
+      ParallelCompressionOptions().setBlockSize(10000).setMaxParallelism(2));
+  auto uncompressed = uncompressParallel(
+      compressed.get(),
+      type,
+      &busy,
+      ParallelCompressionOptions().setMaxParallelism(2));
+  release.post();
+  EXPECT_TRUE(IOBufEqualTo()(*data, *uncompressed));
+}
+
+TEST_P(ParallelCompressionTest, AddThrows) {
+  // Holds the tasks added and fails the second add.
+  struct FailingExecutor : Executor {
+    void add(Func f) override {
+      if (tasks.size() == 1) {
+        throw std::runtime_error("queue full");
+      }
+      tasks.push_back(std::move(f));
+    }
+    std::vector<Func> tasks;
+  };
+  auto type = GetParam();
+  auto data = makeData(100000);
+  FailingExecutor executor;
+  EXPECT_THROW(
+      compressParallel(
+          data.get(),
+          type,
+          COMPRESSION_LEVEL_DEFAULT,
+          &executor,
+          ParallelCompressionOptions().setBlockSize(10000)),
+      std::runtime_error);
+  // The calling thread compressed every block before rethrowing, so the task
+  // left doesn't touch the blocks or the output.
+  data.reset();
+  ASSERT_EQ(1, executor.tasks.size());
+  executor.tasks[0]();
+}
+
+TEST_P(ParallelCompressionTest, NoSeekTable) {
+  auto type = GetParam();
+  auto data = makeData(100000);
+  auto compressed = getCodec(type)->compress(data.get());
+  EXPECT_TRUE(getParallelFrames(compressed.get()).empty());
+  auto uncompressed = uncompressParallel(compressed.get(), type, &executor_);
+  EXPECT_TRUE(IOBufEqualTo()(*data, *uncompressed));
+}
+
+TEST_P(ParallelCompressionTest, Corrupted) {
+  auto type = GetParam();
+  auto data = makeData(100000);
+  auto compressed = compressParallel(
+      data.get(),
+      type,
+      COMPRESSION_LEVEL_DEFAULT,
+      &InlineExecutor::instance(),
+      ParallelCompressionOptions().setBlockSize(10000));
+  compressed->coalesce();
+
+  // Claim that the first frame is larger than it is.
+  auto copy = compressed->clone();
+  copy->unshare();
+  auto entry = copy->writableTail() - 9 - 10 * 8;
+  entry[0] += 1;
+  EXPECT_THROW(getParallelFrames(copy.get()), std::runtime_error);
+
+  // Corrupt the data of a frame.
+  copy = compressed->clone();
+  copy->unshare();
+  copy->writableData()[copy->length() / 2] ^= 0xff;
+  EXPECT_ANY_THROW(uncompressParallel(copy.get(), type, &executor_));
+}
+
+TEST(ParallelCompression, Unsupported) {
+  auto data = makeData(1000);
+  EXPECT_FALSE(hasParallelCodec(CodecType::ZLIB));
+  EXPECT_THROW(
+      compressParallel(
+          data.get(),
+          CodecType::ZLIB,
+          COMPRESSION_LEVEL_DEFAULT,
+          &InlineExecutor::instance()),
+      std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParallelCompressionTest,
+    ParallelCompressionTest,
+    testing::Values(
+        CodecType::ZSTD, CodecType::ZSTD_FAST, CodecType::LZ4_FRAME));
+
+} // namespace test
+} // namespace io
+} // namespace folly
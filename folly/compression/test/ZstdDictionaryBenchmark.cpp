@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/Zstd.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/init/Init.h>
+
+#if FOLLY_HAVE_LIBZSTD
+
+using namespace folly;
+using namespace folly::io;
+
+namespace {
+
+constexpr int kLevel = 3;
+constexpr size_t kDictionarySize = 16 * 1024;
+
+// Messages of about the given size with a common structure, like RPC
+// payloads: a list of records with varying values.
+std::vector<std::string> makeMessages(
+    size_t count, size_t size, uint32_t seed) {
+  static const char* const kStatus[] = {"active", "idle", "away", "blocked"};
+  std::mt19937 rng(seed);
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < count; ++i) {
+    std::string message = R"({"request_id":)" + to<std::string>(rng()) +
+        R"(,"users":[)";
+    while (message.size() < size) {
+      auto id = rng() % 1000000;
+      toAppend(
+          R"({"user_id":)",
+          id,
+          R"(,"name":"user_)",
+          id,
+          R"(","status":")",
+          kStatus[rng() % 4],
+          R"(","region":"region-)",
+          rng() % 8,
+          R"(","score":)",
+          rng() % 10000,
+          "},",
+          &message);
+    }
+    message.back() = ']';
+    message += '}';
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
+struct Corpus {
+  std::vector<std::string> messages;
+  std::shared_ptr<const zstd::Dictionary> dictionary;
+  std::vector<std::string> compressed;
+  std::vector<std::string> dictionaryCompressed;
+};
+
+const Corpus& corpus(size_t size) {
+  static auto corpora = new std::map<size_t, Corpus>();
+  auto& corpus = (*corpora)[size];
+  if (corpus.messages.empty()) {
+    auto const samples = makeMessages(2000, size, 1);
+    std::vector<ByteRange> ranges;
+    for (auto const& sample : samples) {
+      ranges.push_back(ByteRange(StringPiece(sample)));
+    }
+    corpus.dictionary = zstd::Dictionary::create(
+        ByteRange(StringPiece(zstd::trainDictionary(ranges, kDictionarySize))),
+        zstd::Options(kLevel));
+    corpus.messages = makeMessages(1000, size, 2);
+    auto codec = getCodec(CodecType::ZSTD, kLevel);
+    auto dictionaryCodec = zstd::getCodec(corpus.dictionary);
+    for (auto const& message : corpus.messages) {
+      corpus.compressed.push_back(codec->compress(message));
+      corpus.dictionaryCompressed.push_back(dictionaryCodec->compress(message));
+    }
+  }
+  return corpus;
+}
+
+void setCounters(
+    UserCounters& counters,
+    const std::vector<std::string>& messages,
+    const std::vector<std::string>& compressed) {
+  size_t bytes = 0;
+  size_t compressedBytes = 0;
+  for (size_t i = 0; i < messages.size(); ++i) {
+    bytes += messages[i].size();
+    compressedBytes += compressed[i].size();
+  }
+  counters["bytes"] = int64_t(bytes / messages.size());
+  counters["compressed"] = int64_t(compressedBytes / messages.size());
+}
+
+void compressPlain(UserCounters& counters, size_t iters, size_t size) {
+  std::unique_ptr<Codec> codec;
+  const Corpus* c;
+  BENCHMARK_SUSPEND {
+    c = &corpus(size);
+    codec = getCodec(CodecType::ZSTD, kLevel);
+    setCounters(counters, c->messages, c->compressed);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    doNotOptimizeAway(codec->compress(c->messages[i % c->messages.size()]));
+  }
+}
+
+// What the pooled contexts save: loading the dictionary for every message.
+void compressLoadDictionary(UserCounters& counters, size_t iters, size_t size) {
+  const Corpus* c;
+  std::string output;
+  BENCHMARK_SUSPEND {
+    c = &corpus(size);
+    output.resize(ZSTD_compressBound(size * 2));
+    setCounters(counters, c->messages, c->dictionaryCompressed);
+  }
+  auto content = c->dictionary->content();
+  for (size_t i = 0; i < iters; ++i) {
+    auto const& message = c->messages[i % c->messages.size()];
+    auto cctx = compression::contexts::getZSTD_CCtx();
+    ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel, kLevel);
+    ZSTD_CCtx_loadDictionary(cctx.get(), content.data(), content.size());
+    doNotOptimizeAway(ZSTD_compress2(
+        cctx.get(), &output[0], output.size(), message.data(), message.size()));
+  }
+}
+
+void compressDictionary(UserCounters& counters, size_t iters, size_t size) {
+  std::unique_ptr<Codec> codec;
+  const Corpus* c;
+  BENCHMARK_SUSPEND {
+    c = &corpus(size);
+    codec = zstd::getCodec(c->dictionary);
+    setCounters(counters, c->messages, c->dictionaryCompressed);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    doNotOptimizeAway(codec->compress(c->messages[i % c->messages.size()]));
+  }
+}
+
+void uncompressPlain(size_t iters, size_t size) {
+  std::unique_ptr<Codec> codec;
+  const Corpus* c;
+  BENCHMARK_SUSPEND {
+    c = &corpus(size);
+    codec = getCodec(CodecType::ZSTD, kLevel);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    doNotOptimizeAway(
+        codec->uncompress(c->compressed[i % c->compressed.size()]));
+  }
+}
+
+void uncompressDictionary(size_t iters, size_t size) {
+  std::unique_ptr<Codec> codec;
+  const Corpus* c;
+  BENCHMARK_SUSPEND {
+    c = &corpus(size);
+    codec = zstd::getCodec(c->dictionary);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    doNotOptimizeAway(codec->uncompress(
+        c->dictionaryCompressed[i % c->dictionaryCompressed.size()]));
+  }
+}
+
+} // namespace
+
+BENCHMARK_COUNTERS(compress_plain_256, counters, iters) {
+  compressPlain(counters, iters, 256);
+}
+BENCHMARK_COUNTERS_RELATIVE(compress_load_dictionary_256, counters, iters) {
+  compressLoadDictionary(counters, iters, 256);
+}
+BENCHMARK_COUNTERS_RELATIVE(compress_dictionary_256, counters, iters) {
+  compressDictionary(counters, iters, 256);
+}
+BENCHMARK_NAMED_PARAM(uncompressPlain, 256, 256)
+BENCHMARK_RELATIVE_NAMED_PARAM(uncompressDictionary, 256, 256)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_COUNTERS(compress_plain_1k, counters, iters) {
+  compressPlain(counters, iters, 1024);
+}
+BENCHMARK_COUNTERS_RELATIVE(compress_load_dictionary_1k, counters, iters) {
+  compressLoadDictionary(counters, iters, 1024);
+}
+BENCHMARK_COUNTERS_RELATIVE(compress_dictionary_1k, counters, iters) {
+  compressDictionary(counters, iters, 1024);
+}
+BENCHMARK_NAMED_PARAM(uncompressPlain, 1k, 1024)
+BENCHMARK_RELATIVE_NAMED_PARAM(uncompressDictionary, 1k, 1024)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_COUNTERS(compress_plain_4k, counters, iters) {
+  compressPlain(counters, iters, 4096);
+}
+BENCHMARK_COUNTERS_RELATIVE(compress_load_dictionary_4k, counters, iters) {
+  compressLoadDictionary(counters, iters, 4096);
+}
+BENCHMARK_COUNTERS_RELATIVE(compress_dictionary_4k, counters, iters) {
+  compressDictionary(counters, iters, 4096);
+}
+BENCHMARK_NAMED_PARAM(uncompressPlain, 4k, 4096)
+BENCHMARK_RELATIVE_NAMED_PARAM(uncompressDictionary, 4k, 4096)
+
+#endif
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+#include <folly/system/HardwareConcurrency.h>
+
+namespace folly {
+
+/**
+ * A thread-safe LRU evicting cache, sharded by key hash into independent
+ * EvictingCacheMap segments, each behind its own lock.
+ *
+ * Wrapping an EvictingCacheMap in a Synchronized serializes every access,
+ * lookups included since they reorder the LRU. Here two operations only
+ * contend when their keys land in the same shard, so with enough shards
+ * (by default the next power of two above the number of hardware threads)
+ * most accesses take an uncontended lock.
+ *
+ * The price is that LRU order and capacity are per shard: each shard holds
+ * at most ceil(maxSize / numShards) entries and evicts its own least
+ * recently used ones. With a reasonable hash the total is close to maxSize
+ * and the evicted entries are close to the globally least recently used,
+ * but neither is exact. maxSize == 0 disables automatic evictions, as in
+ * EvictingCacheMap.
+ *
+ * Since entries can be evicted by other threads at any time, lookups return
+ * copies of the values rather than references or iterators. Use visit() to
+ * work on a value in place, under its shard's lock.
+ *
+ * Prune hooks have the same signature and are called for the same evictions
+ * as with EvictingCacheMap, but after the shard lock is released, so they
+ * may use the cache. Like with EvictingCacheMap, an exception thrown by the
+ * hook propagates out of the operation that triggered the eviction; the
+ * entries evicted along with it that were not passed to the hook yet are
+ * destroyed.
+ */
+template <
+    class TKey,
+    class TValue,
+    class THash = HeterogeneousAccessHash<TKey>,
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class Mutex = std::mutex>
+class ConcurrentEvictingCacheMap {
+ private:
+  using ECM = EvictingCacheMap<TKey, TValue, THash, TKeyEqual>;
+
+ public:
+  using PruneHookCall = typename ECM::PruneHookCall;
+
+  // public type aliases for convenience
+  using key_type = TKey;
+  using mapped_type = TValue;
+  using hasher = THash;
+
+  static constexpr std::size_t kApproximateEntryMemUsage =
+      ECM::kApproximateEntryMemUsage;
+
+  /**
+   * Construct a ConcurrentEvictingCacheMap
+   * @param maxSize approximate maximum size of the cache map, split evenly
+   *     between the shards.
+   * @param numShards number of independent shards, rounded up to a power of
+   *     two. 0 picks one based on the number of hardware threads.
+   * @param clearSize the number of elements a shard clears at a time when
+   *     automatic eviction on insert is triggered.
+   */
+  explicit ConcurrentEvictingCacheMap(
+      std::size_t maxSize,
+      std::size_t numShards = 0,
+      std::size_t clearSize = 1,
+      const THash& keyHash = THash(),
+      const TKeyEqual& keyEqual = TKeyEqual())
+      : keyHash_(keyHash),
+        numShards_(shardCount(numShards)),
+        shardShift_(64 - findLastSet(numShards_ - 1)),
+        shards_(new Shard[numShards_]),
+        maxSize_(maxSize) {
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      shards_[i].map.emplace(
+          shardMaxSize(maxSize), clearSize, keyHash, keyEqual);
+    }
+  }
+
+  ConcurrentEvictingCacheMap(const ConcurrentEvictingCacheMap&) = delete;
+  ConcurrentEvictingCacheMap& operator=(const ConcurrentEvictingCacheMap&) =
+      delete;
+
+  std::size_t numShards() const { return numShards_; }
+
+  /**
+   * Adjust the approximate max size, evicting as needed. 0 removes the limit.
+   * @param maxSize new approximate maximum size of the cache map.
+   * @param pruneHook eviction callback to use INSTEAD OF the configured one
+   */
+  void setMaxSize(std::size_t maxSize, PruneHookCall pruneHook = nullptr) {
+    maxSize_.store(maxSize, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      withShard(shards_[i], pruneHook, [&](ECM& map, PruneHookCall const& ph) {
+        map.setMaxSize(shardMaxSize(maxSize), ph);
+      });
+    }
+  }
+
+  std::size_t getMaxSize() const {
+    return maxSize_.load(std::memory_order_relaxed);
+  }
+
+  void setClearSize(std::size_t clearSize) {
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      std::lock_guard<Mutex> lock(shards_[i].mutex);
+      shards_[i].map->setClearSize(clearSize);
+    }
+  }
+
+  /**
+   * Check for existence of a specific key in the map.  This operation has
+   *     no effect on LRU order.
+   */
+  template <typename K>
+  bool exists(const K& key) const {
+    auto& shard = shardFor(key);
+    std::lock_guard<Mutex> lock(shard.mutex);
+    return shard.map->exists(key);
+  }
+
+  /**
+   * Get a copy of the value associated with a specific key, or none if it
+   *     does not exist.  This function always promotes a found value to the
+   *     head of its shard's LRU.
+   */
+  template <typename K>
+  Optional<TValue> get(const K& key) {
+    auto& shard = shardFor(key);
+    std::lock_guard<Mutex> lock(shard.mutex);
+    auto it = shard.map->find(key);
+    if (it == shard.map->end()) {
+      return none;
+    }
+    return it->second;
+  }
+
+  /**
+   * Same as get(), but never promotes a found value.
+   */
+  template <typename K>
+  Optional<TValue> getWithoutPromotion(const K& key) const {
+    auto& shard = shardFor(key);
+    std::lock_guard<Mutex> lock(shard.mutex);
+    auto it = shard.map->findWithoutPromotion(key);
+    if (it == shard.map->end()) {
+      return none;
+    }
+    return it->second;
+  }
+
+  /**
+   * Call fn(TValue&) on the value associated with a specific key, holding
+   *     its shard's lock, and promote it.  fn must not use the cache.
+   * @return true if the key existed
+   */
+  template <typename K, typename Fn>
+  bool visit(const K& key, Fn&& fn) {
+    auto& shard = shardFor(key);
+    std::lock_guard<Mutex> lock(shard.mutex);
+    auto it = shard.map->find(key);
+    if (it == shard.map->end()) {
+      return false;
+    }
+    std::forward<Fn>(fn)(it->second);
+    return true;
+  }
+
+  /**
+   * Erase the key-value pair associated with key if it exists. Prune hook
+   * is not called unless one passed in here.
+   * @return true if the key existed and was erased, else false
+   */
+  template <typename K>
+  bool erase(const K& key, PruneHookCall eraseHook = nullptr) {
+    auto& shard = shardFor(key);
+    Optional<std::pair<TKey, TValue>> erased;
+    {
+      std::lock_guard<Mutex> lock(shard.mutex);
+      if (!eraseHook) {
+        return shard.map->erase(key);
+      }
+      auto it = shard.map->findWithoutPromotion(key);
+      if (it == shard.map->end()) {
+        return false;
+      }
+      shard.map->erase(it, [&](TKey k, TValue&& v) {
+        erased.emplace(std::move(k), std::move(v));
+      });
+    }
+    eraseHook(std::move(erased->first), std::move(erased->second));
+    return true;
+  }
+
+  /**
+   * Set a key-value pair in the dictionary
+   * @param promote whether to move an existing entry to the front of its
+   *     shard's LRU.
+   * @param pruneHook eviction callback to use INSTEAD OF the configured one
+   */
+  template <typename K, typename V>
+  void set(
+      const K& key,
+      V&& value,
+      bool promote = true,
+      PruneHookCall pruneHook = nullptr) {
+    withShard(shardFor(key), pruneHook, [&](ECM& map, PruneHookCall const& ph) {
+      map.set(key, std::forward<V>(value), promote, ph);
+    });
+  }
+
+  /**
+   * Insert a new key-value pair in the dictionary if no element exists for
+   * key.
+   * @param pruneHook eviction callback to use INSTEAD OF the configured one
+   * @return whether the insertion took place
+   */
+  template <typename K, typename V>
+  bool insert(const K& key, V&& value, PruneHookCall pruneHook = nullptr) {
+    bool inserted = false;
+    withShard(shardFor(key), pruneHook, [&](ECM& map, PruneHookCall const& ph) {
+      inserted = map.insert(key, std::forward<V>(value), ph).second;
+    });
+    return inserted;
+  }
+
+  /**
+   * Get the number of elements in the dictionary. Shards are counted one
+   * after the other, so under concurrent updates this is approximate.
+   */
+  std::size_t size() const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      std::lock_guard<Mutex> lock(shards_[i].mutex);
+      total += shards_[i].map->size();
+    }
+    return total;
+  }
+
+  bool empty() const {
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      std::lock_guard<Mutex> lock(shards_[i].mutex);
+      if (!shards_[i].map->empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Remove all entries (as if all evicted)
+   * @param pruneHook eviction callback to use INSTEAD OF the configured one
+   */
+  void clear(PruneHookCall pruneHook = nullptr) {
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      withShard(shards_[i], pruneHook, [](ECM& map, PruneHookCall const& ph) {
+        map.clear(ph);
+      });
+    }
+  }
+
+  /**
+   * Set the prune hook, which is the function invoked on the key and value
+   *     on each eviction. Like with EvictingCacheMap, it is not called on
+   *     entries explicitly erase()ed nor on remaining entries at destruction
+   *     time.
+   * @param pruneHook eviction callback to set as default, or nullptr to clear
+   */
+  void setPruneHook(PruneHookCall pruneHook) {
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      std::lock_guard<Mutex> lock(shards_[i].mutex);
+      shards_[i].pruneHook = pruneHook;
+    }
+  }
+
+  /**
+   * Prune about pruneSize entries, spread evenly over the shards, from the
+   * back of each shard's LRU.
+   * @param pruneHook eviction callback to use INSTEAD OF the configured one
+   */
+  void prune(std::size_t pruneSize, PruneHookCall pruneHook = nullptr) {
+    auto perShard = (pruneSize + numShards_ - 1) / numShards_;
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      withShard(shards_[i], pruneHook, [&](ECM& map, PruneHookCall const& ph) {
+        map.prune(perShard, ph);
+      });
+    }
+  }
+
+ private:
+  struct alignas(hardware_destructive_interference_size) Shard {
+    mutable Mutex mutex;
+    // Constructed in place: EvictingCacheMap has no default constructor.
+    Optional<ECM> map;
+    PruneHookCall pruneHook;
+  };
+
+  static std::size_t shardCount(std::size_t numShards) {
+    if (numShards == 0) {
+      numShards = std::max(hardware_concurrency(), 1u);
+    }
+    return nextPowTwo(numShards);
+  }
+
+  std::size_t shardMaxSize(std::size_t maxSize) const {
+    return (maxSize + numShards_ - 1) / numShards_;
+  }
+
+  template <typename K>
+  Shard& shardFor(const K& key) const {
+    // The shard maps use the low hash bits, pick the shard from the high
+    // bits of a remix so that each shard still sees well spread hashes.
+    uint64_t h = hash::twang_mix64(keyHash_(key));
+    return shards_[shardShift_ == 64 ? 0 : h >> shardShift_];
+  }
+
+  // Runs fn(map, hook) under the shard's lock. Entries it evicts are passed
+  // to pruneHook, or to the shard's hook, once the lock is released.
+  template <typename Fn>
+  void withShard(Shard& shard, PruneHookCall const& pruneHook, Fn&& fn) {
+    std::vector<std::pair<TKey, TValue>> evicted;
+    PruneHookCall hook;
+    {
+      std::lock_guard<Mutex> lock(shard.mutex);
+      if (!pruneHook && !shard.pruneHook) {
+        fn(*shard.map, PruneHookCall());
+        return;
+      }
+      fn(*shard.map, [&](TKey k, TValue&& v) {
+        evicted.emplace_back(std::move(k), std::move(v));
+      });
+      if (evicted.empty()) {
+        return;
+      }
+      hook = pruneHook ? pruneHook : shard.pruneHook;
+    }
+    for (auto& [k, v] : evicted) {
+      hook(std::move(k), std::move(v));
+    }
+  }
+
+  THash keyHash_;
+  const std::size_t numShards_;
+  const int shardShift_;
+  const std::unique_ptr<Shard[]> shards_;
+  std::atomic<std::size_t> maxSize_;
+};
+
+} // namespace folly
@@ -17,18 +17,50 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <exception>
 #include <functional>
 
 #include <boost/intrusive/list.hpp>
 #include <boost/iterator/iterator_adaptor.hpp>
 
+#include <folly/CppAttributes.h>
+#include <folly/container/EvictionPolicy.h>
 #include <folly/container/F14Set.h>
 #include <folly/container/HeterogeneousAccess.h>
 #include <folly/lang/Exception.h>
 
 namespace folly {
 
+namespace detail {
+
+struct EvictingCacheMapSegmentTag;
+using EvictingCacheMapSegmentHook = boost::intrusive::list_base_hook<
+    boost::intrusive::tag<EvictingCacheMapSegmentTag>,
+    boost::intrusive::link_mode<boost::intrusive::normal_link>>;
+
+// With an admission policy, entries are first in the admission window, then
+// on probation until they are used again, which protects them.
+enum class EvictingCacheMapSegment : uint8_t {
+  Protected,
+  Window,
+  Probation,
+};
+
+// Per-entry state of an admission policy: the segment, linked in the list
+// of the window or probation ones, and the key hash the policy's estimates
+// are looked up with.
+template <bool Admission>
+struct EvictingCacheMapPolicyNode {};
+
+template <>
+struct EvictingCacheMapPolicyNode<true> : public EvictingCacheMapSegmentHook {
+  std::size_t hash = 0;
+  EvictingCacheMapSegment segment = EvictingCacheMapSegment::Protected;
+};
+
+} // namespace detail
+
 /**
  * A general purpose LRU evicting cache designed to support constant time
  * set/get/insert/erase ops. The only required configuration parameter is the
@@ -57,12 +89,20 @@ namespace folly {
  *
  * NOTE: Previous versions of this structure used a hash table size that was
  * fixed at creation time, but that limitation is no longer present.
+ *
+ * Which entry automatic eviction picks is up to TPolicy, see
+ * EvictionPolicy.h. With the default LruEvictionPolicy it is the least
+ * recently used one. With TinyLfuEvictionPolicy, new entries first go
+ * through an admission window and the ones leaving it are only kept if
+ * they are used more often than the entry they would replace, which makes
+ * the cache resistant to scans. Explicit prune() always trims in LRU order.
  */
 template <
     class TKey,
     class TValue,
     class THash = HeterogeneousAccessHash<TKey>,
-    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>>
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class TPolicy = LruEvictionPolicy>
 class EvictingCacheMap {
  private:
   // typedefs for brevity
@@ -72,6 +112,8 @@ class EvictingCacheMap {
   struct KeyValueEqual;
   using NodeMap = F14VectorSet<Node*, KeyHasher, KeyValueEqual>;
   using TPair = std::pair<const TKey, TValue>;
+  static constexpr bool kAdmission = TPolicy::kAdmission;
+  using PolicyNode = detail::EvictingCacheMapPolicyNode<kAdmission>;
 
  public:
   using PruneHookCall = std::function<void(TKey, TValue&&)>;
@@ -115,6 +157,7 @@ class EvictingCacheMap {
   using key_type = TKey;
   using mapped_type = TValue;
   using hasher = THash;
+  using policy_type = TPolicy;
 
   /*
    * Approximate size of memory used by each entry added to the cache,
@@ -157,17 +200,24 @@ class EvictingCacheMap {
    *     maxSize, the map will begin to evict.
    * @param clearSize the number of elements to clear at a time when automatic
    *     eviction on insert is triggered.
+   * @param policy the eviction policy, see EvictionPolicy.h.
    */
   explicit EvictingCacheMap(
       std::size_t maxSize,
       std::size_t clearSize = 1,
       const THash& keyHash = THash(),
-      const TKeyEqual& keyEqual = TKeyEqual())
+      const TKeyEqual& keyEqual = TKeyEqual(),
+      const TPolicy& policy = TPolicy())
       : keyHash_(keyHash),
         keyEqual_(keyEqual),
         index_(maxSize + /*transient*/ 1, keyHash_, keyEqual_),
         maxSize_(maxSize),
-        clearSize_(clearSize) {}
+        clearSize_(clearSize),
+        policy_(policy) {
+    if constexpr (kAdmission) {
+      policy_.setCapacity(maxSize);
+    }
+  }
 
   EvictingCacheMap(const EvictingCacheMap&) = delete;
   EvictingCacheMap& operator=(const EvictingCacheMap&) = delete;
@@ -192,6 +242,10 @@ class EvictingCacheMap {
       prune(std::max(size() - maxSize, clearSize_), pruneHook);
     }
     maxSize_ = maxSize;
+    if constexpr (kAdmission) {
+      policy_.setCapacity(maxSize ? maxSize : size());
+      trimWindow();
+    }
   }
 
   std::size_t getMaxSize() const { return maxSize_; }
@@ -440,18 +494,55 @@ class EvictingCacheMap {
     auto& ph = (nullptr == pruneHook) ? pruneHook_ : pruneHook;
 
     for (std::size_t i = 0; i < pruneSize && !lru_.empty(); i++) {
-      auto* node = &(*lru_.rbegin());
-      std::unique_ptr<Node> node_owner(node);
-
-      lru_.erase(lru_.iterator_to(*node));
-      index_.erase(node);
-      if (ph) {
-        // NOTE: might throw, so we are in an exception-safe state
-        ph(node->pr.first, std::move(node->pr.second));
+      pruneNode(&(*lru_.rbegin()), ph);
+    }
+  }
+
+  /**
+   * Evict the minimum of evictSize and size() entries chosen by the eviction
+   * policy, like automatic eviction on insert does. The entry at the head of
+   * the LRU is only evicted if it is the last one. Same as prune() with
+   * LruEvictionPolicy. Will throw if pruneHook throws.
+   * @param evictSize minimum number of elements to evict
+   * @param pruneHook eviction callback to use INSTEAD OF the configured one
+   */
+  void evict(std::size_t evictSize, PruneHookCall pruneHook = nullptr) {
+    if constexpr (!kAdmission) {
+      prune(evictSize, pruneHook);
+    } else {
+      auto& ph = (nullptr == pruneHook) ? pruneHook_ : pruneHook;
+      for (std::size_t i = 0; i < evictSize && !lru_.empty();) {
+        auto& window = segments_.window;
+        Node* candidate = nullptr;
+        // Without a maximum size, e.g. when sized by weight, making room for
+        // one entry may take several evictions: the whole window goes
+        // through admission before anything else is evicted.
+        if (!window.empty() &&
+            (maxSize_ == 0 || window.size() > policy_.windowSize())) {
+          candidate = &window.back();
+          leaveSegment(candidate);
+        }
+        Node* victim = findVictim(candidate);
+        if (candidate) {
+          if (candidate == &lru_.front() || !victim) {
+            // Just used, or with nothing to compare it against.
+            enterProbation(candidate);
+            continue;
+          }
+          if (policy_.admit(candidate->hash, victim->hash)) {
+            enterProbation(candidate);
+          } else {
+            victim = candidate;
+          }
+        }
+        pruneNode(victim, ph);
+        ++i;
       }
     }
   }
 
+  const TPolicy& getPolicy() const { return policy_; }
+
   // Iterators and such
   iterator begin() { return iterator(lru_.begin()); }
   iterator end() { return iterator(lru_.end()); }
@@ -480,7 +571,8 @@ class EvictingCacheMap {
 
  private:
   struct Node : public boost::intrusive::list_base_hook<
-                    boost::intrusive::link_mode<boost::intrusive::safe_link>> {
+                    boost::intrusive::link_mode<boost::intrusive::safe_link>>,
+                public PolicyNode {
     template <typename K>
     Node(const K& key, TValue&& value) : pr(key, std::move(value)) {}
     TPair pr;
@@ -514,6 +606,34 @@ class EvictingCacheMap {
     }
   };
 
+  // Entries of a segment, most recently added first. They are owned by lru_
+  // so, like the hooks, this never touches them when cleared, moved or
+  // destroyed.
+  using SegmentListBase = boost::intrusive::list<
+      Node,
+      boost::intrusive::base_hook<detail::EvictingCacheMapSegmentHook>>;
+  struct SegmentList : public SegmentListBase {
+    SegmentList() {}
+    SegmentList& operator=(SegmentList&& that) noexcept {
+      // Forget our entries before the swap in the base move operator would
+      // relink them: lru_ may have deleted them already.
+      this->clear();
+      SegmentListBase& this_parent = *this;
+      SegmentListBase&& that_parent = std::move(that);
+      this_parent = std::move(that_parent);
+      return *this;
+    }
+    SegmentList(SegmentList&& that) noexcept { *this = std::move(that); }
+  };
+  struct AdmissionSegments {
+    SegmentList window;
+    SegmentList probation;
+  };
+  struct NoAdmissionSegments {};
+  using Segments =
+      std::conditional_t<kAdmission, AdmissionSegments, NoAdmissionSegments>;
+  using Segment = detail::EvictingCacheMapSegment;
+
   struct KeyHasher {
     using is_transparent = void;
     using folly_is_avalanching = IsAvalanchingHasher<THash, TKey>;
@@ -570,9 +690,13 @@ class EvictingCacheMap {
   template <typename Self, typename K>
   static auto findImpl(Self& self, const K& key) {
     Node* ptr = self.findInIndex(key);
+    if constexpr (kAdmission) {
+      self.policy_.recordLookup(self.keyHash_(key), ptr != nullptr);
+    }
     if (!ptr) {
       return self.end();
     }
+    self.recordHit(ptr);
     self.lru_.splice(self.lru_.begin(), self.lru_, self.lru_.iterator_to(*ptr));
     return self_iterator_t<Self>(self.lru_.iterator_to(*ptr));
   }
@@ -598,6 +722,7 @@ class EvictingCacheMap {
       typename NodeList::const_iterator base_iter,
       PruneHookCall eraseHook) {
     std::unique_ptr<Node> node_owner(ptr);
+    leaveSegment(ptr);
     index_.erase(ptr);
     auto next_base_iter = lru_.erase(base_iter);
     if (eraseHook) {
@@ -621,8 +746,10 @@ class EvictingCacheMap {
   void setImpl(
       const K& key, TValue&& value, bool promote, PruneHookCall pruneHook) {
     Node* ptr = findInIndex(key);
+    std::size_t hash = recordAccess(key, ptr != nullptr);
     if (ptr) {
       ptr->pr.second = std::move(value);
+      recordHit(ptr);
       if (promote) {
         lru_.splice(lru_.begin(), lru_, lru_.iterator_to(*ptr));
       }
@@ -630,10 +757,13 @@ class EvictingCacheMap {
       auto node = new Node(key, std::move(value));
       index_.insert(node);
       lru_.push_front(*node);
+      enterWindow(node, hash);
 
       // no evictions if maxSize_ is 0 i.e. unlimited capacity
       if (maxSize_ > 0 && size() > maxSize_) {
-        prune(clearSize_, pruneHook);
+        evict(clearSize_, pruneHook);
+      } else {
+        trimWindow();
       }
     }
   }
@@ -642,8 +772,10 @@ class EvictingCacheMap {
   auto insertImpl(const K& key, TValue&& value, PruneHookCall pruneHook) {
     auto node_owner = std::make_unique<Node>(key, std::move(value));
     Node* node = node_owner.get();
+    std::size_t hash;
     {
       auto pair = index_.insert(node);
+      hash = recordAccess(key, !pair.second);
       if (!pair.second) {
         // No change. Abandon/destroy new node.
         return std::pair<iterator, bool>(lru_.iterator_to(**pair.first), false);
@@ -655,10 +787,13 @@ class EvictingCacheMap {
 
     // Complete insertion
     lru_.push_front(*node_owner.release());
+    enterWindow(node, hash);
 
     // no evictions if maxSize_ is 0 i.e. unlimited capacity
     if (maxSize_ > 0 && size() > maxSize_) {
-      prune(clearSize_, pruneHook);
+      evict(clearSize_, pruneHook);
+    } else {
+      trimWindow();
     }
 
     return std::pair<iterator, bool>(lru_.iterator_to(*node), true);
@@ -674,6 +809,109 @@ class EvictingCacheMap {
     }
   }
 
+  void pruneNode(Node* node, PruneHookCall& ph) {
+    std::unique_ptr<Node> node_owner(node);
+
+    leaveSegment(node);
+    lru_.erase(lru_.iterator_to(*node));
+    index_.erase(node);
+    if (ph) {
+      // NOTE: might throw, so we are in an exception-safe state
+      ph(node->pr.first, std::move(node->pr.second));
+    }
+  }
+
+  // Records a set or insert of key with the policy, and returns the key's
+  // hash if the policy needs it.
+  template <typename K>
+  std::size_t recordAccess(const K& key, bool exists) {
+    if constexpr (kAdmission) {
+      std::size_t hash = keyHash_(key);
+      if (exists) {
+        policy_.recordLookup(hash, true);
+      } else {
+        policy_.recordInsert(hash);
+      }
+      return hash;
+    } else {
+      return 0;
+    }
+  }
+
+  void enterWindow(Node* node, std::size_t hash) {
+    if constexpr (kAdmission) {
+      node->hash = hash;
+      node->segment = Segment::Window;
+      segments_.window.push_front(*node);
+      if (maxSize_ == 0) {
+        // Sized by something else, e.g. weight: go by the current size.
+        policy_.setCapacity(size());
+      }
+    }
+  }
+
+  void enterProbation(Node* node) {
+    if constexpr (kAdmission) {
+      leaveSegment(node);
+      node->segment = Segment::Probation;
+      segments_.probation.push_front(*node);
+    }
+  }
+
+  // Entries used again while on probation are protected.
+  void recordHit(Node* node) {
+    if constexpr (kAdmission) {
+      if (node->segment == Segment::Probation) {
+        leaveSegment(node);
+      }
+    }
+  }
+
+  void leaveSegment(Node* node) {
+    if constexpr (kAdmission) {
+      auto& list = node->segment == Segment::Window ? segments_.window
+                                                    : segments_.probation;
+      if (node->segment != Segment::Protected) {
+        list.erase(list.iterator_to(*node));
+        node->segment = Segment::Protected;
+      }
+    }
+  }
+
+  // Entries pushed out of the window while the cache has room are put on
+  // probation. Without a maximum size, whether it has is only known when
+  // evict() is called: the window keeps one more entry, as the newest one is
+  // never a candidate.
+  void trimWindow() {
+    if constexpr (kAdmission) {
+      auto windowSize = policy_.windowSize() + (maxSize_ == 0);
+      while (segments_.window.size() > windowSize) {
+        enterProbation(&segments_.window.back());
+      }
+    }
+  }
+
+  // The entry on probation the longest, else the least recently used
+  // protected one, other than the candidate and sparing the head of the LRU
+  // unless it is the only entry. If there is none, nullptr given a
+  // candidate, else the least recently used entry.
+  Node* findVictim(Node* candidate) {
+    auto head = &lru_.front();
+    for (auto it = segments_.probation.rbegin();
+         it != segments_.probation.rend();
+         ++it) {
+      if (&*it != head) {
+        return &*it;
+      }
+    }
+    for (auto it = lru_.rbegin(); &*it != head; ++it) {
+      if (it->segment == Segment::Protected && &*it != candidate) {
+        return &*it;
+      }
+    }
+    return candidate ? nullptr : &lru_.back();
+  }
+
   PruneHookCall pruneHook_;
   KeyHasher keyHash_;
   KeyValueEqual keyEqual_;
@@ -681,6 +919,8 @@ class EvictingCacheMap {
   NodeList lru_;
   std::size_t maxSize_;
   std::size_t clearSize_;
+  FOLLY_ATTR_NO_UNIQUE_ADDRESS TPolicy policy_;
+  FOLLY_ATTR_NO_UNIQUE_ADDRESS Segments segments_;
 };
 
 } // namespace folly
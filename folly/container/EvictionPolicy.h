@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <folly/hash/Hash.h>
+#include <folly/lang/Bits.h>
+
+namespace folly {
+
+/**
+ * Eviction policies for EvictingCacheMap and the weighted variants built on
+ * it, selected with their TPolicy template parameter.
+ *
+ * LruEvictionPolicy, the default, evicts the least recently used entry.
+ *
+ * TinyLfuEvictionPolicy implements W-TinyLFU: new entries go through a small
+ * admission window, and an entry leaving the window only stays in the cache
+ * if it is estimated to be used more often than the entry it would replace.
+ * Admitted entries are on probation until used again, and the victims are
+ * the ones on probation the longest, then the least recently used ones.
+ * Unlike the original, protected entries are not capped to a share of the
+ * cache: they are only evicted once no entry is left on probation.
+ *
+ * Access frequencies of every key looked up or inserted, including the ones
+ * not in the cache, are kept in a compact count-min sketch which is
+ * periodically halved so old popularity fades. This keeps one-off scans from
+ * flushing the frequently used entries out of the cache, at the cost of
+ * hashing each key one more time per operation and a small per-entry
+ * overhead.
+ *
+ * A policy is a class with
+ *   static constexpr bool kAdmission;
+ * and, when kAdmission is true,
+ *   void setCapacity(std::size_t maxEntries);
+ *   std::size_t windowSize() const;
+ *   // Every lookup, and every set of an existing key (a hit)
+ *   void recordLookup(std::size_t keyHash, bool hit);
+ *   // Every insertion of a new entry
+ *   void recordInsert(std::size_t keyHash);
+ *   bool admit(std::size_t candidateHash, std::size_t victimHash) const;
+ */
+struct LruEvictionPolicy {
+  static constexpr bool kAdmission = false;
+};
+
+namespace detail {
+
+/**
+ * Count-min sketch of 4-bit counters, 16 to a word, with depth 4. All
+ * counters are halved once the number of increments reaches ten times the
+ * capacity it was sized for.
+ *
+ * The table is a power of two words and a counter is found by masking its
+ * hash, so growing it by copying it over the new words keeps every estimate.
+ */
+class FrequencySketch {
+ public:
+  static constexpr unsigned kMaxFrequency = 15;
+
+  explicit FrequencySketch(std::size_t capacity = 0) { resize(capacity); }
+
+  FrequencySketch(const FrequencySketch&) = default;
+  FrequencySketch& operator=(const FrequencySketch&) = default;
+  // Leave the moved-from sketch usable, like a moved-from cache is.
+  FrequencySketch(FrequencySketch&& that) { *this = std::move(that); }
+  FrequencySketch& operator=(FrequencySketch&& that) {
+    table_ = std::move(that.table_);
+    mask_ = that.mask_;
+    capacity_ = that.capacity_;
+    sampleSize_ = that.sampleSize_;
+    additions_ = that.additions_;
+    that.resize(0);
+    return *this;
+  }
+
+  /**
+   * Resizes the table for about `capacity` distinct hot keys. Growing keeps
+   * the counts, shrinking forgets them.
+   */
+  void resize(std::size_t capacity) {
+    capacity = std::max<std::size_t>(capacity, 1);
+    auto words = std::max<std::size_t>(nextPowTwo(capacity), 8);
+    if (capacity < capacity_ || table_.empty()) {
+      table_.assign(words, 0);
+      additions_ = 0;
+    } else if (words > table_.size()) {
+      auto size = table_.size();
+      table_.resize(words);
+      for (auto i = size; i < words; ++i) {
+        table_[i] = table_[i & mask_];
+      }
+    }
+    mask_ = table_.size() - 1;
+    capacity_ = capacity;
+    sampleSize_ = 10 * capacity;
+    if (additions_ >= sampleSize_) {
+      age();
+    }
+  }
+
+  std::size_t capacity() const { return capacity_; }
+
+  void increment(std::size_t keyHash) {
+    uint64_t h = hash::twang_mix64(keyHash);
+    unsigned start = (h & 3) << 2;
+    bool added = false;
+    for (unsigned i = 0; i < 4; ++i) {
+      auto& word = table_[indexOf(h, i)];
+      unsigned shift = (start + i) << 2;
+      if (((word >> shift) & 0xf) < kMaxFrequency) {
+        word += uint64_t(1) << shift;
+        added = true;
+      }
+    }
+    if (added && ++additions_ == sampleSize_) {
+      age();
+    }
+  }
+
+  unsigned frequency(std::size_t keyHash) const {
+    uint64_t h = hash::twang_mix64(keyHash);
+    unsigned start = (h & 3) << 2;
+    unsigned frequency = kMaxFrequency;
+    for (unsigned i = 0; i < 4; ++i) {
+      unsigned shift = (start + i) << 2;
+      auto count = unsigned(table_[indexOf(h, i)] >> shift) & 0xf;
+      frequency = std::min(frequency, count);
+    }
+    return frequency;
+  }
+
+ private:
+  std::size_t indexOf(uint64_t h, unsigned i) const {
+    static constexpr uint64_t kSeeds[] = {
+        0xc3a5c85c97cb3127,
+        0xb492b66fbe98f273,
+        0x9ae16a3b2f90404f,
+        0xcbf29ce484222325};
+    uint64_t x = (h + kSeeds[i]) * kSeeds[i];
+    x += x >> 32;
+    return x & mask_;
+  }
+
+  void age() {
+    for (auto& word : table_) {
+      word = (word >> 1) & 0x7777777777777777;
+    }
+    additions_ /= 2;
+  }
+
+  std::vector<uint64_t> table_;
+  std::size_t mask_ = 0;
+  std::size_t capacity_ = 0;
+  std::size_t sampleSize_ = 0;
+  std::size_t additions_ = 0;
+};
+
+} // namespace detail
+
+class TinyLfuEvictionPolicy {
+ public:
+  static constexpr bool kAdmission = true;
+
+  /**
+   * @param windowPercent share of the capacity, in percent, given to the
+   *     admission window. The default suits most workloads; recency-biased
+   *     ones do better with a larger window.
+   */
+  explicit TinyLfuEvictionPolicy(unsigned windowPercent = 1)
+      : windowPercent_(std::min(windowPercent, 100u)) {}
+
+  /**
+   * Cheap enough to be called on every insertion while the cache grows:
+   * the sketch grows geometrically, keeping its counts.
+   */
+  void setCapacity(std::size_t maxEntries) {
+    window_ = std::max<std::size_t>(maxEntries * windowPercent_ / 100, 1);
+    auto capacity = sketch_.capacity();
+    if (maxEntries > capacity) {
+      sketch_.resize(std::max(maxEntries, 2 * capacity));
+    } else if (maxEntries < capacity / 4) {
+      // Shrinking the cache a lot would leave the counters aging too slowly.
+      sketch_.resize(maxEntries);
+    }
+  }
+
+  std::size_t windowSize() const { return window_; }
+
+  // Looking up a missing entry, maybe again, and filling it in right after
+  // is a single use of the key: counting each step would put one-off keys on
+  // a par with keys hit once since.
+  void recordLookup(std::size_t keyHash, bool hit) {
+    if (keyHash != lastMiss_) {
+      sketch_.increment(keyHash);
+    }
+    lastMiss_ = hit ? kNoMiss : keyHash;
+  }
+
+  void recordInsert(std::size_t keyHash) {
+    if (keyHash != lastMiss_) {
+      sketch_.increment(keyHash);
+    }
+    lastMiss_ = kNoMiss;
+  }
+
+  bool admit(std::size_t candidateHash, std::size_t victimHash) const {
+    return sketch_.frequency(candidateHash) > sketch_.frequency(victimHash);
+  }
+
+  unsigned frequency(std::size_t keyHash) const {
+    return sketch_.frequency(keyHash);
+  }
+
+ private:
+  // Inserts of a key hashing to this are never counted, which is harmless.
+  static constexpr std::size_t kNoMiss = ~std::size_t(0);
+
+  detail::FrequencySketch sketch_;
+  unsigned windowPercent_;
+  std::size_t window_ = 1;
+  std::size_t lastMiss_ = kNoMiss;
+};
+
+} // namespace folly
@@ -904,6 +904,44 @@ class F14BasicMap {
     return table_.makeConstIter(table_.find(token, key));
   }
 
+  /**
+   * @overloadbrief Get the iterators for a batch of keys.
+   * @methodset Lookup
+   *
+   * findMany(first, last, out) writes find(key) for each key in [first,
+   * last) to out, in order, and returns the end of the written range. Keys
+   * are of key_type, or of any type usable with heterogeneous find().
+   *
+   * Lookups in a map that is out of the local CPU cache are dominated by
+   * cache misses, which a loop of find() takes one after the other.
+   * findMany() works on batches of keys at a time so that their misses
+   * overlap, like pipelining prehash(), prefetch() and find(token, key) by
+   * hand would, and goes further by also prefetching the entries matching
+   * the keys' tags before comparing the keys.
+   *
+   *   std::vector<FeatureId> ids = ...;
+   *   std::vector<map_type::const_iterator> found(ids.size());
+   *   map.findMany(ids.begin(), ids.end(), found.begin());
+   */
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) {
+    table_.findMany(first, last, [&](ItemIter iter) {
+      *out = table_.makeIter(iter);
+      ++out;
+    });
+    return out;
+  }
+
+  /// Get the const_iterators for a batch of keys.
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) const {
+    table_.findMany(first, last, [&](ItemIter iter) {
+      *out = table_.makeConstIter(iter);
+      ++out;
+    });
+    return out;
+  }
+
   /**
    * @overloadbrief Checks if the container contains an element with the
    * specific key.
@@ -0,0 +1,567 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Immutable hash maps that can be memory mapped from a file.
+ *
+ * Loading a large read-only F14FastMap at startup means hashing and
+ * inserting every entry again, which takes time and transient memory in
+ * every process. A FrozenF14Map is laid out once, in a single buffer with
+ * no pointers in it, and is then used in place: opening one only checks
+ * its header, and the pages of a mapped file are faulted in as lookups
+ * touch them and shared by every process mapping the file.
+ *
+ *     // Once, offline:
+ *     writeFile(FrozenF14Map<int64_t, double>::freeze(scores), path);
+ *
+ *     // At startup:
+ *     auto frozen = FrozenF14Map<int64_t, double>::open(path);
+ *     auto it = frozen.find(id);
+ *
+ * The table uses the F14 layout: chunks of 14 slots with a byte of hash tag
+ * each, so a lookup compares the tags of a whole chunk at once (with SSE2
+ * where available) and rarely looks at more than one chunk, as in
+ * F14ValueMap. The entries are stored in the chunks.
+ *
+ * Keys and values are either trivially copyable types, stored as they are,
+ * or strings (std::string, std::string_view or StringPiece), read back as
+ * StringPiece's into the buffer. Short strings are stored in the entries,
+ * longer ones in a separate area.
+ * Lookups of string keys take anything convertible to StringPiece.
+ *
+ * The format is position independent but not portable across byte orders,
+ * nor across changes to the stored types. The Hasher must give the same
+ * results in the process freezing the map and in the ones opening it; the
+ * default one does, unlike std::hash. Opening checks the header and that
+ * the areas it describes fit in the buffer, but the contents of a file are
+ * trusted.
+ *
+ * @file FrozenF14Map.h
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <folly/Portability.h>
+#include <folly/Range.h>
+#include <folly/hash/FarmHash.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+#include <folly/system/MemoryMapping.h>
+
+#if FOLLY_SSE >= 2
+#include <emmintrin.h>
+#endif
+
+namespace folly {
+
+namespace detail {
+
+template <typename T>
+constexpr bool is_frozen_f14_string_v =
+    std::is_same<T, std::string>::value ||
+    std::is_same<T, std::string_view>::value ||
+    std::is_same<T, StringPiece>::value;
+
+// Strings of up to kInlineSize bytes are kept in the item, which spares
+// lookups of short keys a cache miss, longer ones in the strings area.
+struct FrozenF14String {
+  static constexpr std::size_t kInlineSize = 12;
+
+  // The string, or its offset in the strings area.
+  char data[kInlineSize];
+  uint32_t size;
+};
+
+// How a key or value type is stored in the buffer and read back.
+template <typename T, typename = void>
+struct FrozenF14Layout {
+  static_assert(
+      std::is_trivially_copyable<T>::value && alignof(T) <= 8,
+      "FrozenF14Map keys and values must be trivially copyable or strings");
+
+  using Stored = T;
+  using View = T const&;
+  using Lookup = T;
+
+  static Stored store(T const& value, std::string&) { return value; }
+
+  static View view(Stored const& stored, char const*) { return stored; }
+
+  static bool equal(View a, Lookup const& b) { return a == b; }
+};
+
+template <typename T>
+struct FrozenF14Layout<T, std::enable_if_t<is_frozen_f14_string_v<T>>> {
+  using Stored = FrozenF14String;
+  using View = StringPiece;
+  using Lookup = StringPiece;
+
+  static Stored store(StringPiece value, std::string& strings) {
+    if (value.size() > std::numeric_limits<uint32_t>::max()) {
+      throw_exception<std::length_error>("FrozenF14Map: string too long");
+    }
+    Stored stored{};
+    stored.size = static_cast<uint32_t>(value.size());
+    if (value.size() <= Stored::kInlineSize) {
+      std::memcpy(stored.data, value.data(), value.size());
+    } else {
+      uint64_t offset = strings.size();
+      std::memcpy(stored.data, &offset, sizeof(offset));
+      strings.append(value.data(), value.size());
+    }
+    return stored;
+  }
+
+  static View view(Stored const& stored, char const* strings) {
+    if (stored.size <= Stored::kInlineSize) {
+      return {stored.data, stored.size};
+    }
+    uint64_t offset;
+    std::memcpy(&offset, stored.data, sizeof(offset));
+    return {strings + offset, stored.size};
+  }
+
+  static bool equal(View a, Lookup const& b) {
+    return a.size() == b.size() &&
+        (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+  }
+};
+
+struct FrozenF14Header {
+  // "F14FRZN1" read as a little endian integer.
+  static constexpr uint64_t kMagic = 0x314e5a5246343146;
+
+  uint64_t magic;
+  uint32_t itemSize;
+  uint32_t keySize;
+  uint32_t valueSize;
+  uint32_t chunkShift;
+  uint64_t size;
+  uint64_t chunksOffset;
+  uint64_t stringsOffset;
+  uint64_t stringsSize;
+};
+
+// Chunks of the frozen table, 16 bytes of metadata followed by the items.
+// Their slots are filled in order, so a chunk is full once its last slot is.
+struct FrozenF14Chunk {
+  static constexpr unsigned kCapacity = 14;
+  static constexpr unsigned kDesiredCapacity = 12;
+  static constexpr unsigned kFullMask = (1u << kCapacity) - 1;
+  static constexpr std::size_t kHeaderSize = 16;
+
+  uint8_t tags[kCapacity];
+  // Number of items that would have been stored here if there had been
+  // room, saturating at 255.
+  uint8_t outboundOverflowCount;
+  uint8_t reserved;
+
+  unsigned tagMatch(std::size_t needle) const {
+#if FOLLY_SSE >= 2
+    auto tagV = _mm_loadu_si128(static_cast<__m128i const*>(
+        static_cast<void const*>(&tags[0])));
+    auto needleV = _mm_set1_epi8(static_cast<char>(needle));
+    return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(tagV, needleV))) &
+        kFullMask;
+#else
+    unsigned mask = 0;
+    for (unsigned i = 0; i < kCapacity; ++i) {
+      mask |= unsigned(tags[i] == needle) << i;
+    }
+    return mask;
+#endif
+  }
+};
+
+static_assert(sizeof(FrozenF14Chunk) == FrozenF14Chunk::kHeaderSize, "");
+
+} // namespace detail
+
+/**
+ * Default hasher of FrozenF14Map, stable across processes and builds: the
+ * value of integers and enums, and the farmhash fingerprint of strings.
+ * Other key types need a Hasher of their own.
+ */
+template <typename K, typename = void>
+struct FrozenF14Hasher;
+
+template <typename K>
+struct FrozenF14Hasher<
+    K,
+    std::enable_if_t<std::is_integral<K>::value || std::is_enum<K>::value>> {
+  uint64_t operator()(K key) const { return static_cast<uint64_t>(key); }
+};
+
+template <typename K>
+struct FrozenF14Hasher<
+    K,
+    std::enable_if_t<detail::is_frozen_f14_string_v<K>>> {
+  uint64_t operator()(StringPiece key) const {
+    return hash::farmhash::Fingerprint64(key.data(), key.size());
+  }
+};
+
+template <typename K, typename V, typename Hasher = FrozenF14Hasher<K>>
+class FrozenF14Map {
+  using KeyLayout = detail::FrozenF14Layout<K>;
+  using ValueLayout = detail::FrozenF14Layout<V>;
+  using Header = detail::FrozenF14Header;
+  using Chunk = detail::FrozenF14Chunk;
+
+  struct Item {
+    typename KeyLayout::Stored key;
+    typename ValueLayout::Stored value;
+  };
+
+  // Rounded up to keep every chunk, and so its items, 8-byte aligned.
+  static constexpr std::size_t kChunkSize =
+      (Chunk::kHeaderSize + Chunk::kCapacity * sizeof(Item) + 7) / 8 * 8;
+  static constexpr std::size_t kChunksOffset = 64;
+
+  static_assert(sizeof(Header) <= kChunksOffset, "");
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = std::size_t;
+  using hasher = Hasher;
+  // Arguments of lookups, StringPiece for string keys.
+  using lookup_type = typename KeyLayout::Lookup;
+  // What the entries are read as: references into the buffer, or
+  // StringPiece's of strings in it.
+  using key_view = typename KeyLayout::View;
+  using mapped_view = typename ValueLayout::View;
+  using value_type = std::pair<key_view, mapped_view>;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FrozenF14Map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+
+    struct pointer {
+      value_type value;
+      value_type const* operator->() const { return &value; }
+    };
+
+    const_iterator() = default;
+
+    reference operator*() const { return map_->entry(*item()); }
+    pointer operator->() const { return pointer{**this}; }
+
+    const_iterator& operator++() {
+      ++slot_;
+      skipEmpty();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    friend bool operator==(const_iterator const& a, const_iterator const& b) {
+      return a.chunk_ == b.chunk_ && a.slot_ == b.slot_;
+    }
+    friend bool operator!=(const_iterator const& a, const_iterator const& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class FrozenF14Map;
+
+    const_iterator(FrozenF14Map const* map, std::size_t chunk, unsigned slot)
+        : map_(map), chunk_(chunk), slot_(slot) {}
+
+    Item const* item() const { return map_->itemAt(chunk_, slot_); }
+
+    void skipEmpty() {
+      auto chunkCount = map_->chunkCount();
+      while (chunk_ < chunkCount) {
+        for (; slot_ < Chunk::kCapacity; ++slot_) {
+          if (map_->chunkAt(chunk_)->tags[slot_] != 0) {
+            return;
+          }
+        }
+        ++chunk_;
+        slot_ = 0;
+      }
+    }
+
+    FrozenF14Map const* map_ = nullptr;
+    std::size_t chunk_ = 0;
+    unsigned slot_ = 0;
+  };
+
+  using iterator = const_iterator;
+
+  /**
+   * Lays out the entries of `map`, anything iterable of pairs of a key and
+   * a value, in a new buffer. The first entry for a key wins when there are
+   * several.
+   */
+  template <typename Map>
+  static std::string freeze(Map const& map) {
+    std::size_t capacity = 0;
+    for (auto it = std::begin(map); it != std::end(map); ++it) {
+      ++capacity;
+    }
+    uint32_t chunkShift = 0;
+    while ((std::size_t{Chunk::kDesiredCapacity} << chunkShift) < capacity) {
+      ++chunkShift;
+    }
+
+    std::string buffer(
+        kChunksOffset + (std::size_t{1} << chunkShift) * kChunkSize, '\0');
+    std::string strings;
+    FrozenF14Map frozen(buffer.data(), chunkShift);
+    for (auto const& entry : map) {
+      lookup_type const& key = entry.first;
+      auto hp = splitHash(Hasher{}(key));
+      if (frozen.findItem(hp, key, strings.data())) {
+        continue;
+      }
+      frozen.insertItem(
+          hp,
+          KeyLayout::store(entry.first, strings),
+          ValueLayout::store(entry.second, strings));
+      ++frozen.size_;
+    }
+
+    Header header{};
+    header.magic = Header::kMagic;
+    header.itemSize = sizeof(Item);
+    header.keySize = sizeof(typename KeyLayout::Stored);
+    header.valueSize = sizeof(typename ValueLayout::Stored);
+    header.chunkShift = chunkShift;
+    header.size = frozen.size_;
+    header.chunksOffset = kChunksOffset;
+    header.stringsOffset = buffer.size();
+    header.stringsSize = strings.size();
+    std::memcpy(&buffer[0], &header, sizeof(header));
+    buffer += strings;
+    return buffer;
+  }
+
+  /**
+   * Uses the map frozen in `data`, which must outlive it. Throws
+   * std::invalid_argument if it does not hold a map of these types.
+   */
+  explicit FrozenF14Map(ByteRange data) { init(data); }
+
+  /**
+   * Uses the map frozen in a mapped file, and keeps the mapping.
+   */
+  explicit FrozenF14Map(MemoryMapping mapping) : mapping_(std::move(mapping)) {
+    init(mapping_->range());
+  }
+
+  /**
+   * Maps the file at `path`. Setting options.prefault reads it all at once
+   * rather than on first use.
+   */
+  static FrozenF14Map open(
+      char const* path, MemoryMapping::Options options = {}) {
+    return FrozenF14Map(MemoryMapping(path, 0, -1, options));
+  }
+
+  FrozenF14Map(FrozenF14Map&&) = default;
+  FrozenF14Map& operator=(FrozenF14Map&&) = default;
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const {
+    const_iterator it(this, 0, 0);
+    it.skipEmpty();
+    return it;
+  }
+  const_iterator end() const { return const_iterator(this, chunkCount(), 0); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  const_iterator find(lookup_type const& key) const {
+    auto item = findItem(splitHash(Hasher{}(key)), key, strings_);
+    if (!item) {
+      return end();
+    }
+    auto offset = static_cast<std::size_t>(
+        reinterpret_cast<char const*>(item) - chunks_);
+    return const_iterator(
+        this,
+        offset / kChunkSize,
+        static_cast<unsigned>(
+            (offset % kChunkSize - Chunk::kHeaderSize) / sizeof(Item)));
+  }
+
+  bool contains(lookup_type const& key) const { return find(key) != end(); }
+
+  std::size_t count(lookup_type const& key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  /**
+   * Throws std::out_of_range if the key is missing.
+   */
+  mapped_view at(lookup_type const& key) const {
+    auto item = findItem(splitHash(Hasher{}(key)), key, strings_);
+    if (!item) {
+      throw_exception<std::out_of_range>("FrozenF14Map::at() key not found");
+    }
+    return ValueLayout::view(item->value, strings_);
+  }
+
+ private:
+  using HashPair = std::pair<std::size_t, std::size_t>;
+
+  // Always mixed, so that the hasher does not need to avalanche.
+  static HashPair splitHash(uint64_t hash) {
+    auto mixed = hash::twang_mix64(hash);
+    return {static_cast<std::size_t>(mixed), (mixed >> 56) | 0x80};
+  }
+
+  // Empty table over `chunks`, for freeze().
+  FrozenF14Map(char* buffer, uint32_t chunkShift)
+      : chunks_(buffer + kChunksOffset), chunkShift_(chunkShift) {}
+
+  void init(ByteRange data) {
+    auto fail = [](char const* what) {
+      throw_exception<std::invalid_argument>(
+          std::string("FrozenF14Map: ") + what);
+    };
+    if (data.size() < kChunksOffset) {
+      fail("buffer too small");
+    }
+    if (reinterpret_cast<uintptr_t>(data.data()) % alignof(Header) != 0) {
+      fail("buffer not aligned");
+    }
+    Header header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != Header::kMagic) {
+      fail("not a frozen map");
+    }
+    if (header.itemSize != sizeof(Item) ||
+        header.keySize != sizeof(typename KeyLayout::Stored) ||
+        header.valueSize != sizeof(typename ValueLayout::Stored)) {
+      fail("key or value type mismatch");
+    }
+    auto fits = [&](uint64_t offset, uint64_t size) {
+      return offset <= data.size() && size <= data.size() - offset;
+    };
+    if (header.chunkShift >= 48 || header.chunksOffset % alignof(Header) ||
+        !fits(header.chunksOffset,
+              (uint64_t{1} << header.chunkShift) * kChunkSize) ||
+        !fits(header.stringsOffset, header.stringsSize) ||
+        header.size > (uint64_t{1} << header.chunkShift) * Chunk::kCapacity) {
+      fail("corrupt header");
+    }
+    auto base = reinterpret_cast<char const*>(data.data());
+    chunks_ = base + header.chunksOffset;
+    strings_ = base + header.stringsOffset;
+    chunkShift_ = header.chunkShift;
+    size_ = header.size;
+  }
+
+  std::size_t chunkCount() const { return std::size_t{1} << chunkShift_; }
+
+  Chunk const* chunkAt(std::size_t index) const {
+    return reinterpret_cast<Chunk const*>(chunks_ + index * kChunkSize);
+  }
+
+  Item const* itemAt(std::size_t index, unsigned slot) const {
+    return reinterpret_cast<Item const*>(
+        chunks_ + index * kChunkSize + Chunk::kHeaderSize +
+        slot * sizeof(Item));
+  }
+
+  value_type entry(Item const& item) const {
+    return value_type(
+        KeyLayout::view(item.key, strings_),
+        ValueLayout::view(item.value, strings_));
+  }
+
+  // The same probing as F14Table::findImpl().
+  Item const* findItem(
+      HashPair hp, lookup_type const& key, char const* strings) const {
+    std::size_t index = hp.first;
+    std::size_t step = 2 * hp.second + 1;
+    std::size_t mask = chunkCount() - 1;
+    for (std::size_t tries = 0; tries >> chunkShift_ == 0; ++tries) {
+      auto chunk = chunkAt(index & mask);
+      auto hits = chunk->tagMatch(hp.second);
+      while (hits) {
+        auto item = itemAt(index & mask, findFirstSet(hits) - 1);
+        if (FOLLY_LIKELY(
+                KeyLayout::equal(KeyLayout::view(item->key, strings), key))) {
+          return item;
+        }
+        hits &= hits - 1;
+      }
+      if (FOLLY_LIKELY(chunk->outboundOverflowCount == 0)) {
+        break;
+      }
+      index += step;
+    }
+    return nullptr;
+  }
+
+  void insertItem(
+      HashPair hp,
+      typename KeyLayout::Stored key,
+      typename ValueLayout::Stored value) {
+    std::size_t index = hp.first;
+    std::size_t step = 2 * hp.second + 1;
+    std::size_t mask = chunkCount() - 1;
+    while (true) {
+      auto chunk = const_cast<Chunk*>(chunkAt(index & mask));
+      if (chunk->tags[Chunk::kCapacity - 1] == 0) {
+        unsigned slot = 0;
+        while (chunk->tags[slot] != 0) {
+          ++slot;
+        }
+        chunk->tags[slot] = static_cast<uint8_t>(hp.second);
+        new (const_cast<Item*>(itemAt(index & mask, slot))) Item{key, value};
+        return;
+      }
+      if (chunk->outboundOverflowCount != 255) {
+        ++chunk->outboundOverflowCount;
+      }
+      index += step;
+    }
+  }
+
+  std::optional<MemoryMapping> mapping_;
+  char const* chunks_ = nullptr;
+  char const* strings_ = nullptr;
+  uint32_t chunkShift_ = 0;
+  std::size_t size_ = 0;
+};
+
+} // namespace folly
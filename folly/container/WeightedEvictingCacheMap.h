@@ -51,6 +51,9 @@ namespace folly {
  * constraints from EvictingCacheMap. (Must either match TKey or
  * EligibleForHeterogeneousFind/Insert.)
  *
+ * Like with EvictingCacheMap, TPolicy can replace LRU order with another
+ * eviction policy, see EvictionPolicy.h.
+ *
  * This implementation has not been highly optimized and is a wrapper around
  * EvictingCacheMap.
  */
@@ -59,10 +62,11 @@ template <
     class TValue,
     class TWeightFn,
     class THash = HeterogeneousAccessHash<TKey>,
-    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>>
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class TPolicy = LruEvictionPolicy>
 class ImplicitlyWeightedEvictingCacheMap {
  private: // typedefs
-  using ECM = EvictingCacheMap<TKey, TValue, THash, TKeyEqual>;
+  using ECM = EvictingCacheMap<TKey, TValue, THash, TKeyEqual, TPolicy>;
 
  public:
   using PruneHookCall = std::function<void(TKey, TValue&&)>;
@@ -71,8 +75,9 @@ class ImplicitlyWeightedEvictingCacheMap {
       std::size_t maxTotalWeight,
       const TWeightFn& weightFn = TWeightFn(),
       const THash& keyHash = THash(),
-      const TKeyEqual& keyEqual = TKeyEqual())
-      : ecm_(/* no max size*/ 0, 1, keyHash, keyEqual),
+      const TKeyEqual& keyEqual = TKeyEqual(),
+      const TPolicy& policy = TPolicy())
+      : ecm_(/* no max size*/ 0, 1, keyHash, keyEqual, policy),
         weightFn_(weightFn),
         maxTotalWeight_(maxTotalWeight),
         currentTotalWeight_(0) {
@@ -348,11 +353,16 @@ class ImplicitlyWeightedEvictingCacheMap {
     // NOTE: Avoid infinite loop even in the case of weight tracking bug
     size_t min_count = protect_one ? 1 : 0;
     while (currentTotalWeight_ > maxTotalWeight_ && ecm_.size() > min_count) {
-      ecm_.prune(1);
+      ecm_.evict(1);
     }
   }
 
-  template <class _TKey, class _TValue, class _THash, class _TKeyEqual>
+  template <
+      class _TKey,
+      class _TValue,
+      class _THash,
+      class _TKeyEqual,
+      class _TPolicy>
   friend class WeightedEvictingCacheMap;
 
  private: // data
@@ -387,13 +397,17 @@ class ImplicitlyWeightedEvictingCacheMap {
  * constraints from EvictingCacheMap. (Must either match TKey or
  * EligibleForHeterogeneousFind/Insert.)
  *
+ * Like with EvictingCacheMap, TPolicy can replace LRU order with another
+ * eviction policy, see EvictionPolicy.h.
+ *
  * This implementation has not been highly optimized.
  */
 template <
     class TKey,
     class TValue,
     class THash = HeterogeneousAccessHash<TKey>,
-    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>>
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class TPolicy = LruEvictionPolicy>
 class WeightedEvictingCacheMap {
  public: // types
   struct ValueAndWeight {
@@ -416,7 +430,8 @@ class WeightedEvictingCacheMap {
       ValueAndWeight,
       WeightFn,
       THash,
-      TKeyEqual>;
+      TKeyEqual,
+      TPolicy>;
 
  public:
   using PruneHookCall = std::function<void(TKey, TValue&&, size_t)>;
@@ -424,8 +439,9 @@ class WeightedEvictingCacheMap {
   explicit WeightedEvictingCacheMap(
       std::size_t maxTotalWeight,
       const THash& keyHash = THash(),
-      const TKeyEqual& keyEqual = TKeyEqual())
-      : iwecm_(maxTotalWeight, WeightFn(), keyHash, keyEqual) {}
+      const TKeyEqual& keyEqual = TKeyEqual(),
+      const TPolicy& policy = TPolicy())
+      : iwecm_(maxTotalWeight, WeightFn(), keyHash, keyEqual, policy) {}
 
   // Like EvictingCacheMap
   WeightedEvictingCacheMap(const WeightedEvictingCacheMap&) = delete;
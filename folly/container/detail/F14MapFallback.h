@@ -579,6 +579,22 @@ class F14BasicMap : public std::unordered_map<K, M, H, E, A> {
 
   void prefetch(F14HashToken const&) const {}
 
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) {
+    for (; first != last; ++first, ++out) {
+      *out = find(*first);
+    }
+    return out;
+  }
+
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) const {
+    for (; first != last; ++first, ++out) {
+      *out = find(*first);
+    }
+    return out;
+  }
+
   iterator find(F14HashToken const&, key_type const& key) { return find(key); }
 
   const_iterator find(F14HashToken const&, key_type const& key) const {
@@ -549,6 +549,8 @@ class ValueContainerPolicy : public BasePolicy<
 
   //////// F14Table policy
 
+  static constexpr bool prefetchBeforeFind() { return false; }
+
   static constexpr bool prefetchBeforeRehash() { return false; }
 
   static constexpr bool prefetchBeforeCopy() { return false; }
@@ -791,6 +793,8 @@ class NodeContainerPolicy
 
   //////// F14Table policy
 
+  static constexpr bool prefetchBeforeFind() { return true; }
+
   static constexpr bool prefetchBeforeRehash() { return true; }
 
   static constexpr bool prefetchBeforeCopy() { return true; }
@@ -1051,6 +1055,8 @@ class VectorContainerPolicy : public BasePolicy<
 
   //////// F14Table policy
 
+  static constexpr bool prefetchBeforeFind() { return true; }
+
   static constexpr bool prefetchBeforeRehash() { return true; }
 
   static constexpr bool prefetchBeforeCopy() { return false; }
@@ -1191,6 +1191,7 @@ class F14Table : public Policy {
   using Policy::isAvalanchingHasher;
   using Policy::prefetchBeforeCopy;
   using Policy::prefetchBeforeDestroy;
+  using Policy::prefetchBeforeFind;
   using Policy::prefetchBeforeRehash;
   using Policy::shouldAssume32BitHash;
 
@@ -1595,6 +1596,43 @@ class F14Table : public Policy {
     return findImpl(static_cast<HashPair>(token), key, Prefetch::DISABLED);
   }
 
+  // findMany() performs find() for every key in [first, last), calling
+  // visitor(ItemIter) with each result in order. Keys are processed in
+  // batches so that the cache misses of their lookups overlap: all hashes of
+  // a batch are computed and their first chunks prefetched, then the tags of
+  // those chunks are checked, prefetching the first matching items and the
+  // values they point to, and only then are the keys compared.
+  template <typename ForwardIt, typename F>
+  void findMany(ForwardIt first, ForwardIt last, F&& visitor) const {
+    constexpr std::size_t kBatch = 16;
+    HashPair hps[kBatch];
+    while (first != last) {
+      std::size_t n = 0;
+      auto batchFirst = first;
+      for (; n < kBatch && first != last; ++n, ++first) {
+        hps[n] = splitHash(this->computeKeyHash(*first));
+        prefetchAddr(chunks_ + moduloByChunkCount(hps[n].first));
+      }
+      if (prefetchBeforeFind() || sizeof(Chunk) > 64) {
+        for (std::size_t i = 0; i < n; ++i) {
+          ChunkPtr chunk = chunks_ + moduloByChunkCount(hps[i].first);
+          auto hits = chunk->tagMatchIter(hps[i].second);
+          if (hits.hasNext()) {
+            auto& item = chunk->item(hits.next());
+            if (prefetchBeforeFind()) {
+              this->prefetchValue(item);
+            } else {
+              prefetchAddr(std::addressof(item));
+            }
+          }
+        }
+      }
+      for (std::size_t i = 0; i < n; ++i, ++batchFirst) {
+        visitor(findImpl(hps[i], *batchFirst, Prefetch::DISABLED));
+      }
+    }
+  }
+
   // Searches for a key using a key predicate that is a refinement
   // of key equality.  func(k) should return true only if k is equal
   // to key according to key_eq(), but is allowed to apply additional
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/ConcurrentEvictingCacheMap.h>
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(ConcurrentEvictingCacheMap, SanityTest) {
+  ConcurrentEvictingCacheMap<int, int> map(0, 4);
+  EXPECT_EQ(4, map.numShards());
+
+  EXPECT_EQ(0, map.size());
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.exists(1));
+  EXPECT_FALSE(map.get(1).has_value());
+  map.set(1, 1);
+  EXPECT_EQ(1, map.size());
+  EXPECT_FALSE(map.empty());
+  EXPECT_EQ(1, map.get(1));
+  EXPECT_TRUE(map.exists(1));
+  map.set(1, 2);
+  EXPECT_EQ(1, map.size());
+  EXPECT_EQ(2, map.getWithoutPromotion(1));
+
+  EXPECT_FALSE(map.insert(1, 3));
+  EXPECT_EQ(2, map.get(1));
+  EXPECT_TRUE(map.insert(2, 3));
+  EXPECT_EQ(3, map.get(2));
+
+  EXPECT_TRUE(map.visit(2, [](int& v) { v += 10; }));
+  EXPECT_EQ(13, map.get(2));
+  EXPECT_FALSE(map.visit(3, [](int&) { ADD_FAILURE(); }));
+
+  EXPECT_TRUE(map.erase(1));
+  EXPECT_FALSE(map.erase(1));
+  EXPECT_FALSE(map.exists(1));
+  EXPECT_EQ(1, map.size());
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(ConcurrentEvictingCacheMap, ShardCount) {
+  EXPECT_EQ(1, (ConcurrentEvictingCacheMap<int, int>(10, 1).numShards()));
+  EXPECT_EQ(8, (ConcurrentEvictingCacheMap<int, int>(10, 5).numShards()));
+  EXPECT_LE(
+      hardware_concurrency(),
+      (ConcurrentEvictingCacheMap<int, int>(10).numShards()));
+}
+
+TEST(ConcurrentEvictingCacheMap, SingleShardIsLru) {
+  ConcurrentEvictingCacheMap<int, int> map(10, 1);
+  for (int i = 0; i < 10; ++i) {
+    map.set(i, i);
+  }
+  // Promote 0, leaving 1 least recently used.
+  EXPECT_EQ(0, map.get(0));
+  // Doesn't promote.
+  EXPECT_EQ(1, map.getWithoutPromotion(1));
+  map.set(10, 10);
+  EXPECT_EQ(10, map.size());
+  EXPECT_TRUE(map.exists(0));
+  EXPECT_FALSE(map.exists(1));
+
+  map.set(2, 2, /* promote */ false);
+  map.set(11, 11);
+  EXPECT_FALSE(map.exists(2));
+}
+
+TEST(ConcurrentEvictingCacheMap, ApproximateCapacity) {
+  constexpr std::size_t kMaxSize = 1000;
+  ConcurrentEvictingCacheMap<int, int> map(kMaxSize, 16);
+  EXPECT_EQ(kMaxSize, map.getMaxSize());
+  for (int i = 0; i < 10000; ++i) {
+    map.set(i, i);
+  }
+  // Each shard holds up to ceil(1000 / 16) = 63, and all of them fill up.
+  EXPECT_EQ(16 * 63, map.size());
+
+  // The most recent entries are all still there.
+  for (int i = 9900; i < 10000; ++i) {
+    EXPECT_TRUE(map.exists(i));
+  }
+
+  map.setMaxSize(160);
+  EXPECT_EQ(160, map.size());
+  map.setMaxSize(0);
+  for (int i = 0; i < 10000; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_EQ(10000, map.size());
+  map.prune(160);
+  EXPECT_EQ(10000 - 160, map.size());
+}
+
+TEST(ConcurrentEvictingCacheMap, PruneHook) {
+  ConcurrentEvictingCacheMap<int, int> map(64, 4);
+  std::set<int> pruned;
+  map.setPruneHook([&](int key, int&& value) {
+    EXPECT_EQ(key, -value);
+    pruned.insert(key);
+    // Called without holding the shard's lock.
+    EXPECT_FALSE(map.exists(key));
+  });
+  for (int i = 0; i < 1000; ++i) {
+    map.set(i, -i);
+  }
+  EXPECT_EQ(1000, pruned.size() + map.size());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_NE(map.exists(i), pruned.count(i) == 1) << i;
+  }
+
+  // A hook passed in is used instead of the configured one.
+  std::size_t overridden = 0;
+  auto count = [&](int, int&&) { ++overridden; };
+  auto before = pruned.size();
+  map.set(1000, -1000, true, count);
+  map.insert(1001, -1001, count);
+  map.setMaxSize(32, count);
+  EXPECT_EQ(before, pruned.size());
+  EXPECT_EQ(1002 - before - 32, overridden);
+
+  // Not called on erase, unless passed in.
+  EXPECT_TRUE(map.erase(1001));
+  EXPECT_EQ(before, pruned.size());
+  map.set(1002, -1002);
+  map.set(1003, -1003);
+  int erased = 0;
+  EXPECT_TRUE(map.erase(1003, [&](int key, int&&) { erased = key; }));
+  EXPECT_EQ(1003, erased);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(1004 - overridden - 2, pruned.size());
+}
+
+TEST(ConcurrentEvictingCacheMap, PruneHookThrows) {
+  ConcurrentEvictingCacheMap<int, int> map(1, 1);
+  map.setPruneHook([](int, int&&) { throw std::runtime_error("hook"); });
+  map.set(1, 1);
+  EXPECT_THROW(map.set(2, 2), std::runtime_error);
+  EXPECT_EQ(1, map.size());
+  EXPECT_TRUE(map.exists(2));
+}
+
+TEST(ConcurrentEvictingCacheMap, HeterogeneousAccess) {
+  ConcurrentEvictingCacheMap<std::string, int> map(0, 4);
+  map.set("key", 1);
+  EXPECT_TRUE(map.exists(StringPiece("key")));
+  EXPECT_EQ(1, map.get(std::string_view("key")));
+  EXPECT_TRUE(map.erase("key"));
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(ConcurrentEvictingCacheMap, MultiThreaded) {
+  constexpr int kThreads = 8;
+  constexpr int kKeys = 4096;
+  ConcurrentEvictingCacheMap<int, int> map(kKeys / 2, 8);
+  std::atomic<std::size_t> pruned{0};
+  map.setPruneHook([&](int key, int&& value) {
+    EXPECT_EQ(key, value);
+    ++pruned;
+  });
+
+  std::atomic<std::size_t> inserted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 20000; ++i) {
+        int key = (i * 7919 + t * 104729) % kKeys;
+        if (auto value = map.get(key)) {
+          EXPECT_EQ(key, *value);
+        } else if (map.insert(key, key)) {
+          ++inserted;
+        }
+        if (i % 100 == 0) {
+          map.erase(key, [&](int, int&&) { ++pruned; });
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(inserted.load(), pruned.load() + map.size());
+  EXPECT_LE(map.size(), map.numShards() * (kKeys / 2 / map.numShards()));
+}
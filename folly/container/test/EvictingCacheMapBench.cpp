@@ -16,7 +16,16 @@
 
 #include <folly/container/EvictingCacheMap.h>
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
 #include <folly/Benchmark.h>
+#include <folly/Synchronized.h>
+#include <folly/container/ConcurrentEvictingCacheMap.h>
 
 using namespace folly;
 
@@ -74,6 +83,161 @@ BENCHMARK_PARAM(insertCache, 271108)
 BENCHMARK_PARAM(insertCache, 1754650) // 1.75M
 BENCHMARK_PARAM(insertCache, 11356334) // 11.3M
 
+// Each of `threads` threads does `n` lookups over a key space a bit larger
+// than the cache, filling in misses, as a read-mostly service cache would.
+template <typename LookupOrFill>
+void runThreads(uint32_t n, size_t threads, LookupOrFill lookupOrFill) {
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      for (uint32_t i = 0; i < n; ++i) {
+        lookupOrFill(key((i * 7919 + t * 104729) % 125000));
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void synchronizedCache(uint32_t n, size_t threads) {
+  BenchmarkSuspender suspender;
+  Synchronized<EvictingCacheMap<uint64_t, size_t>> m(std::in_place, 100000);
+  suspender.dismiss();
+
+  runThreads(n, threads, [&](uint64_t k) {
+    auto locked = m.wlock();
+    auto it = locked->find(k);
+    if (it == locked->end()) {
+      locked->insert(k, k);
+    } else {
+      doNotOptimizeAway(it->second);
+    }
+  });
+}
+
+void concurrentCache(uint32_t n, size_t threads) {
+  BenchmarkSuspender suspender;
+  ConcurrentEvictingCacheMap<uint64_t, size_t> m(100000);
+  suspender.dismiss();
+
+  runThreads(n, threads, [&](uint64_t k) {
+    if (auto value = m.get(k)) {
+      doNotOptimizeAway(*value);
+    } else {
+      m.insert(k, k);
+    }
+  });
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(synchronizedCache, 1)
+BENCHMARK_RELATIVE_PARAM(concurrentCache, 1)
+BENCHMARK_PARAM(synchronizedCache, 4)
+BENCHMARK_RELATIVE_PARAM(concurrentCache, 4)
+BENCHMARK_PARAM(synchronizedCache, 16)
+BENCHMARK_RELATIVE_PARAM(concurrentCache, 16)
+BENCHMARK_PARAM(synchronizedCache, 32)
+BENCHMARK_RELATIVE_PARAM(concurrentCache, 32)
+
+// Traces of lookups, each filled in on a miss, of keys drawn from a Zipf
+// distribution (s = 0.99) over 1M keys: the typical skewed popularity of a
+// cache in front of a service.
+constexpr size_t kTraceKeys = 1 << 20;
+constexpr size_t kTraceSize = 1 << 21;
+
+const std::vector<uint64_t>& zipfTrace() {
+  static const auto trace = [] {
+    std::vector<double> cdf(kTraceKeys);
+    double sum = 0;
+    for (size_t i = 0; i < kTraceKeys; ++i) {
+      sum += 1 / std::pow(i + 1, 0.99);
+      cdf[i] = sum;
+    }
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> dist(0, sum);
+    std::vector<uint64_t> keys(kTraceSize);
+    for (auto& k : keys) {
+      auto rank =
+          std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+      k = key(rank);
+    }
+    return keys;
+  }();
+  return trace;
+}
+
+// The same, with a quarter of the lookups replaced by scans, in runs of 16K,
+// of keys used only once.
+const std::vector<uint64_t>& scanMixedTrace() {
+  static const auto trace = [] {
+    auto keys = zipfTrace();
+    size_t next = kTraceKeys;
+    for (size_t i = 0; i < keys.size(); i += 1 << 16) {
+      for (size_t j = 0; j < 1 << 14; ++j) {
+        keys[i + j] = key(next++);
+      }
+    }
+    return keys;
+  }();
+  return trace;
+}
+
+// Each iteration replays a whole trace through a cache of 10K entries, and
+// the hit rate is reported in the hits_per_mille counter.
+template <typename Policy>
+void replayTrace(
+    UserCounters& counters,
+    uint32_t n,
+    const std::vector<uint64_t>& (*getTrace)()) {
+  using Map = EvictingCacheMap<
+      uint64_t,
+      size_t,
+      HeterogeneousAccessHash<uint64_t>,
+      HeterogeneousAccessEqualTo<uint64_t>,
+      Policy>;
+  size_t hits = 0;
+  size_t lookups = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    BenchmarkSuspender suspender;
+    auto& trace = getTrace();
+    auto m = std::make_unique<Map>(10000);
+    suspender.dismiss();
+
+    for (auto k : trace) {
+      auto it = m->find(k);
+      if (it == m->end()) {
+        m->insert(k, lookups);
+      } else {
+        ++hits;
+      }
+    }
+    lookups += trace.size();
+
+    suspender.rehire();
+    m.reset();
+  }
+  BENCHMARK_SUSPEND {
+    counters["hits_per_mille"] = hits * 1000 / std::max<size_t>(lookups, 1);
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_COUNTERS(zipfLru, counters, n) {
+  replayTrace<LruEvictionPolicy>(counters, n, zipfTrace);
+}
+BENCHMARK_COUNTERS_RELATIVE(zipfTinyLfu, counters, n) {
+  replayTrace<TinyLfuEvictionPolicy>(counters, n, zipfTrace);
+}
+BENCHMARK_COUNTERS(scanMixedLru, counters, n) {
+  replayTrace<LruEvictionPolicy>(counters, n, scanMixedTrace);
+}
+BENCHMARK_COUNTERS_RELATIVE(scanMixedTinyLfu, counters, n) {
+  replayTrace<TinyLfuEvictionPolicy>(counters, n, scanMixedTrace);
+}
+
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   runBenchmarks();
@@ -832,3 +832,165 @@ TEST(EvictingCacheMap, ApproximateEntryMemUsage) {
            kApproximateEntryMemUsage),
       48U);
 }
+
+TEST(EvictingCacheMap, FrequencySketch) {
+  detail::FrequencySketch sketch(64);
+  EXPECT_EQ(0, sketch.frequency(1));
+  for (int i = 0; i < 5; ++i) {
+    sketch.increment(1);
+  }
+  EXPECT_EQ(5, sketch.frequency(1));
+  EXPECT_EQ(0, sketch.frequency(2));
+  // Saturates
+  for (int i = 0; i < 20; ++i) {
+    sketch.increment(2);
+  }
+  EXPECT_EQ(detail::FrequencySketch::kMaxFrequency, sketch.frequency(2));
+  // Halved after 10 * 64 increments
+  for (int i = 0; i < 10 * 64 - 25 + 10; ++i) {
+    sketch.increment(1000 + i);
+  }
+  EXPECT_EQ(2, sketch.frequency(1));
+  EXPECT_EQ(7, sketch.frequency(2));
+}
+
+namespace {
+
+// Looks up key, filling it in on a miss. Returns whether it was a hit.
+template <typename Map>
+bool lookupOrFill(Map& map, int key) {
+  if (map.find(key) != map.end()) {
+    return true;
+  }
+  map.set(key, key);
+  return false;
+}
+
+} // namespace
+
+TEST(EvictingCacheMap, TinyLfuScanResistance) {
+  constexpr int kSize = 100;
+  constexpr int kHot = kSize / 2;
+  EvictingCacheMap<int, int> lru(kSize);
+  EvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      TinyLfuEvictionPolicy>
+      lfu(kSize);
+  // A hot working set, used a few times.
+  for (int round = 0; round < 4; ++round) {
+    for (int i = 0; i < kHot; ++i) {
+      lookupOrFill(lru, i);
+      lookupOrFill(lfu, i);
+    }
+  }
+  // A long scan of keys used once, while the hot set keeps being used.
+  int lruHits = 0;
+  int lfuHits = 0;
+  for (int i = 0; i < 20 * kSize; ++i) {
+    lookupOrFill(lru, 1000 + i);
+    lookupOrFill(lfu, 1000 + i);
+    if (i % 4 == 0) {
+      lruHits += lookupOrFill(lru, (i / 4) % kHot);
+      lfuHits += lookupOrFill(lfu, (i / 4) % kHot);
+    }
+  }
+  EXPECT_EQ(kSize, lru.size());
+  EXPECT_EQ(kSize, lfu.size());
+  // Out of 5 * kSize lookups of the hot set.
+  EXPECT_LT(lruHits, 5 * kSize / 10);
+  EXPECT_GT(lfuHits, 5 * kSize * 9 / 10);
+}
+
+TEST(EvictingCacheMap, TinyLfuAdmission) {
+  EvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      TinyLfuEvictionPolicy>
+      map(10, 1, {}, {}, TinyLfuEvictionPolicy(10));
+  EXPECT_EQ(1, map.getPolicy().windowSize());
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 9; ++i) {
+      lookupOrFill(map, i);
+    }
+  }
+  map.set(50, 50);
+  EXPECT_EQ(10, map.size());
+
+  // A new entry is always there right after being set, in the window...
+  map.set(100, 100);
+  EXPECT_EQ(10, map.size());
+  EXPECT_EQ(100, map.get(100));
+  // ... but the one it pushed out of the window was not admitted, as it's
+  // used less than the entry it would replace.
+  EXPECT_FALSE(map.exists(50));
+  map.set(101, 101);
+  EXPECT_FALSE(map.exists(100));
+  EXPECT_TRUE(map.exists(101));
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_TRUE(map.exists(i));
+  }
+
+  // Once used enough, an entry gets in. It replaces the one on probation
+  // the longest, 8: it was still in the window when last used, while the
+  // others were used again after leaving it, which protected them.
+  for (int i = 0; i < 4; ++i) {
+    lookupOrFill(map, 100);
+  }
+  map.set(102, 102);
+  EXPECT_TRUE(map.exists(100));
+  EXPECT_FALSE(map.exists(8));
+  EXPECT_TRUE(map.exists(0));
+  EXPECT_EQ(10, map.size());
+  EXPECT_GT(
+      map.getPolicy().frequency(std::hash<int>()(100)),
+      map.getPolicy().frequency(std::hash<int>()(1)));
+}
+
+TEST(EvictingCacheMap, TinyLfuConsistency) {
+  using Map = EvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      TinyLfuEvictionPolicy>;
+  Map map(50, 3, {}, {}, TinyLfuEvictionPolicy(20));
+  int pruned = 0;
+  map.setPruneHook([&](int key, int&& value) {
+    EXPECT_EQ(key, value);
+    ++pruned;
+  });
+  for (int i = 0; i < 1000; ++i) {
+    lookupOrFill(map, (i * 37) % 211);
+    if (i % 7 == 0) {
+      map.erase((i * 13) % 211);
+    }
+    EXPECT_LE(map.size(), 50);
+  }
+  EXPECT_GT(pruned, 0);
+  EXPECT_EQ(map.size(), std::distance(map.begin(), map.end()));
+
+  map.setMaxSize(10);
+  EXPECT_EQ(10, map.size());
+  map.prune(4);
+  EXPECT_EQ(6, map.size());
+  map.insert(500, 500);
+  EXPECT_TRUE(map.exists(500));
+
+  Map map2 = std::move(map);
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(7, map2.size());
+  map.set(1, 1);
+  map2 = std::move(map);
+  EXPECT_EQ(1, map2.get(1));
+  for (int i = 0; i < 100; ++i) {
+    lookupOrFill(map2, i);
+  }
+  EXPECT_EQ(10, map2.size());
+  map2.clear();
+  EXPECT_TRUE(map2.empty());
+}
@@ -908,6 +908,61 @@ TEST(F14FastMap, prehash) {
   runPrehash<F14FastMap<std::string, std::string>>();
 }
 
+template <typename T>
+void runFindMany() {
+  T h;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; ++i) {
+    keys.push_back(to<std::string>(i));
+    if (i % 3 != 0) {
+      h[keys.back()] = keys.back();
+    }
+  }
+
+  std::vector<typename T::iterator> found(keys.size());
+  EXPECT_TRUE(
+      h.findMany(keys.begin(), keys.end(), found.begin()) == found.end());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(found[i] == h.find(keys[i])) << keys[i];
+    EXPECT_EQ(i % 3 != 0, found[i] != h.end());
+  }
+
+  // Heterogeneous keys, into any output iterator.
+  std::vector<StringPiece> pieces(keys.begin(), keys.end());
+  T const& ch = h;
+  std::vector<typename T::const_iterator> cfound;
+  ch.findMany(pieces.begin(), pieces.end(), std::back_inserter(cfound));
+  ASSERT_EQ(keys.size(), cfound.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(cfound[i] == ch.find(keys[i])) << keys[i];
+  }
+
+  T empty;
+  EXPECT_TRUE(
+      empty.findMany(keys.begin(), keys.begin(), found.begin()) ==
+      found.begin());
+  empty.findMany(keys.begin(), keys.end(), found.begin());
+  for (auto& it : found) {
+    EXPECT_TRUE(it == empty.end());
+  }
+}
+
+TEST(F14ValueMap, findMany) {
+  runFindMany<F14ValueMap<std::string, std::string>>();
+}
+
+TEST(F14NodeMap, findMany) {
+  runFindMany<F14NodeMap<std::string, std::string>>();
+}
+
+TEST(F14VectorMap, findMany) {
+  runFindMany<F14VectorMap<std::string, std::string>>();
+}
+
+TEST(F14FastMap, findMany) {
+  runFindMany<F14FastMap<std::string, std::string>>();
+}
+
 TEST(F14ValueMap, random) {
   runRandom<F14ValueMap<
       uint64_t,
@@ -851,6 +851,57 @@ TEST(F14VectorSet, rehash) {
   runRehash<F14VectorSet<std::string>>();
 }
 
+template <typename T>
+void runFindMany() {
+  T h;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; ++i) {
+    keys.push_back(to<std::string>(i));
+    if (i % 3 != 0) {
+      h.insert(keys.back());
+    }
+  }
+
+  std::vector<typename T::iterator> found(keys.size());
+  EXPECT_TRUE(
+      h.findMany(keys.begin(), keys.end(), found.begin()) == found.end());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(found[i] == h.find(keys[i])) << keys[i];
+    EXPECT_EQ(i % 3 != 0, found[i] != h.end());
+  }
+
+  // Heterogeneous keys, into any output iterator.
+  std::vector<StringPiece> pieces(keys.begin(), keys.end());
+  std::vector<typename T::const_iterator> cfound;
+  h.findMany(pieces.begin(), pieces.end(), std::back_inserter(cfound));
+  ASSERT_EQ(keys.size(), cfound.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(cfound[i] == h.find(keys[i])) << keys[i];
+  }
+
+  T empty;
+  empty.findMany(keys.begin(), keys.end(), found.begin());
+  for (auto& it : found) {
+    EXPECT_TRUE(it == empty.end());
+  }
+}
+
+TEST(F14ValueSet, findMany) {
+  runFindMany<F14ValueSet<std::string>>();
+}
+
+TEST(F14NodeSet, findMany) {
+  runFindMany<F14NodeSet<std::string>>();
+}
+
+TEST(F14VectorSet, findMany) {
+  runFindMany<F14VectorSet<std::string>>();
+}
+
+TEST(F14FastSet, findMany) {
+  runFindMany<F14FastSet<std::string>>();
+}
+
 TEST(F14ValueSet, random) {
   runRandom<F14ValueSet<uint64_t>>();
 }
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/FrozenF14Map.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/container/F14Map.h>
+#include <folly/init/Init.h>
+
+using namespace folly;
+
+namespace {
+
+constexpr std::size_t kEntries = 1000000;
+using Frozen = FrozenF14Map<std::string, int64_t>;
+
+// What a process would read from a file at startup, either as entries to
+// insert one by one or as a frozen map.
+struct Data {
+  Data() {
+    for (std::size_t i = 0; i < kEntries; ++i) {
+      entries.emplace_back(to<std::string>("key", i * 7919), int64_t(i));
+    }
+    map.insert(entries.begin(), entries.end());
+    frozen = Frozen::freeze(entries);
+    for (auto const& entry : entries) {
+      keys.push_back(entry.first);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  }
+
+  std::vector<std::pair<std::string, int64_t>> entries;
+  F14FastMap<std::string, int64_t> map;
+  std::string frozen;
+  std::vector<std::string> keys;
+};
+
+Data const& data() {
+  static Data const* instance = new Data();
+  return *instance;
+}
+
+} // namespace
+
+BENCHMARK(loadF14FastMap, iters) {
+  BenchmarkSuspender braces;
+  auto const& d = data();
+  braces.dismiss();
+  for (std::size_t i = 0; i < iters; ++i) {
+    F14FastMap<std::string, int64_t> map(d.entries.begin(), d.entries.end());
+    doNotOptimizeAway(map.size());
+  }
+}
+
+BENCHMARK_RELATIVE(openFrozenF14Map, iters) {
+  BenchmarkSuspender braces;
+  auto const& d = data();
+  braces.dismiss();
+  for (std::size_t i = 0; i < iters; ++i) {
+    Frozen map(ByteRange(StringPiece(d.frozen)));
+    doNotOptimizeAway(map.size());
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(findF14FastMap, iters) {
+  BenchmarkSuspender braces;
+  auto const& d = data();
+  braces.dismiss();
+  int64_t sum = 0;
+  for (std::size_t i = 0; i < iters; ++i) {
+    sum += d.map.find(d.keys[i % kEntries])->second;
+  }
+  doNotOptimizeAway(sum);
+}
+
+BENCHMARK_RELATIVE(findFrozenF14Map, iters) {
+  BenchmarkSuspender braces;
+  auto const& d = data();
+  Frozen map(ByteRange(StringPiece(d.frozen)));
+  braces.dismiss();
+  int64_t sum = 0;
+  for (std::size_t i = 0; i < iters; ++i) {
+    sum += map.find(d.keys[i % kEntries])->second;
+  }
+  doNotOptimizeAway(sum);
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/FrozenF14Map.h>
+
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/container/F14Map.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+ByteRange bytes(std::string const& buffer) {
+  return ByteRange(StringPiece(buffer));
+}
+
+struct Point {
+  int32_t x;
+  int64_t y;
+};
+
+enum class Color : uint8_t { Red, Green, Blue };
+
+} // namespace
+
+TEST(FrozenF14Map, Integers) {
+  F14FastMap<int64_t, double> map;
+  for (int64_t i = 0; i < 10000; ++i) {
+    map[i * 7919] = i / 2.0;
+  }
+  auto buffer = FrozenF14Map<int64_t, double>::freeze(map);
+  FrozenF14Map<int64_t, double> frozen(bytes(buffer));
+
+  EXPECT_EQ(map.size(), frozen.size());
+  EXPECT_FALSE(frozen.empty());
+  for (auto const& [key, value] : map) {
+    auto it = frozen.find(key);
+    ASSERT_NE(frozen.end(), it) << key;
+    EXPECT_EQ(key, it->first);
+    EXPECT_EQ(value, it->second);
+    EXPECT_EQ(value, frozen.at(key));
+    EXPECT_TRUE(frozen.contains(key));
+  }
+  for (int64_t i = 1; i < 7919; i += 13) {
+    EXPECT_EQ(frozen.end(), frozen.find(i));
+    EXPECT_EQ(0, frozen.count(i));
+  }
+  EXPECT_THROW(frozen.at(-1), std::out_of_range);
+
+  // Iteration sees every entry once.
+  std::set<int64_t> seen;
+  for (auto const& [key, value] : frozen) {
+    EXPECT_EQ(map.at(key), value);
+    EXPECT_TRUE(seen.insert(key).second);
+  }
+  EXPECT_EQ(map.size(), seen.size());
+}
+
+TEST(FrozenF14Map, Strings) {
+  std::map<std::string, std::string> map;
+  for (int i = 0; i < 1000; ++i) {
+    map[to<std::string>("key", i)] = std::string(i % 50, 'a' + i % 26);
+  }
+  map[""] = "empty key";
+  map["empty value"] = "";
+  using Frozen = FrozenF14Map<std::string, std::string>;
+  auto buffer = Frozen::freeze(map);
+  Frozen frozen(bytes(buffer));
+
+  EXPECT_EQ(map.size(), frozen.size());
+  for (auto const& [key, value] : map) {
+    EXPECT_EQ(value, frozen.at(key));
+  }
+  // Lookups take anything convertible to StringPiece.
+  EXPECT_EQ("empty key", frozen.at(""));
+  EXPECT_TRUE(frozen.contains(StringPiece("key7")));
+  EXPECT_TRUE(frozen.contains(std::string_view("key999")));
+  EXPECT_FALSE(frozen.contains("key1000"));
+  EXPECT_FALSE(frozen.contains("key"));
+
+  std::size_t n = 0;
+  for (auto it = frozen.begin(); it != frozen.end(); ++it, ++n) {
+    EXPECT_EQ(map.at(it->first.str()), it->second);
+  }
+  EXPECT_EQ(map.size(), n);
+}
+
+TEST(FrozenF14Map, MixedTypes) {
+  F14FastMap<std::string, Point> points = {
+      {"origin", {0, 0}}, {"a", {1, -2}}, {"b", {-3, 1LL << 40}}};
+  auto pointBuffer = FrozenF14Map<std::string, Point>::freeze(points);
+  FrozenF14Map<std::string, Point> frozenPoints(bytes(pointBuffer));
+  EXPECT_EQ(-3, frozenPoints.at("b").x);
+  EXPECT_EQ(1LL << 40, frozenPoints.at("b").y);
+
+  std::vector<std::pair<Color, std::string>> colors = {
+      {Color::Red, "red"}, {Color::Blue, "blue"}};
+  auto colorBuffer = FrozenF14Map<Color, std::string>::freeze(colors);
+  FrozenF14Map<Color, std::string> frozenColors(bytes(colorBuffer));
+  EXPECT_EQ("blue", frozenColors.at(Color::Blue));
+  EXPECT_FALSE(frozenColors.contains(Color::Green));
+}
+
+TEST(FrozenF14Map, EmptyAndDuplicates) {
+  std::vector<std::pair<int, int>> entries;
+  auto buffer = FrozenF14Map<int, int>::freeze(entries);
+  FrozenF14Map<int, int> empty(bytes(buffer));
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.begin(), empty.end());
+  EXPECT_FALSE(empty.contains(0));
+
+  // The first entry for a key wins.
+  entries = {{1, 10}, {2, 20}, {1, 11}, {3, 30}, {2, 21}};
+  buffer = FrozenF14Map<int, int>::freeze(entries);
+  FrozenF14Map<int, int> frozen(bytes(buffer));
+  EXPECT_EQ(3, frozen.size());
+  EXPECT_EQ(10, frozen.at(1));
+  EXPECT_EQ(20, frozen.at(2));
+  EXPECT_EQ(30, frozen.at(3));
+}
+
+TEST(FrozenF14Map, Collisions) {
+  // A hasher mapping everything to a few values puts most keys in chunks
+  // other than the one they hash to.
+  struct BadHasher {
+    uint64_t operator()(int key) const { return key % 3; }
+  };
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < 500; ++i) {
+    entries.emplace_back(i, -i);
+  }
+  auto buffer = FrozenF14Map<int, int, BadHasher>::freeze(entries);
+  FrozenF14Map<int, int, BadHasher> frozen(bytes(buffer));
+  EXPECT_EQ(500, frozen.size());
+  for (int i = 0; i < 500; ++i) {
+    EXPECT_EQ(-i, frozen.at(i));
+  }
+  EXPECT_FALSE(frozen.contains(500));
+}
+
+TEST(FrozenF14Map, MappedFile) {
+  F14FastMap<std::string, int64_t> map;
+  for (int i = 0; i < 5000; ++i) {
+    map[to<std::string>(i * 31)] = i;
+  }
+  test::TemporaryFile file;
+  ASSERT_TRUE(writeFile(
+      FrozenF14Map<std::string, int64_t>::freeze(map),
+      file.path().string().c_str()));
+
+  auto frozen = FrozenF14Map<std::string, int64_t>::open(
+      file.path().string().c_str());
+  EXPECT_EQ(map.size(), frozen.size());
+  for (auto const& [key, value] : map) {
+    EXPECT_EQ(value, frozen.at(key));
+  }
+
+  // Moving keeps the mapping alive.
+  auto moved = std::move(frozen);
+  EXPECT_EQ(0, moved.at("0"));
+  EXPECT_EQ(4999, moved.at(to<std::string>(4999 * 31)));
+}
+
+TEST(FrozenF14Map, InvalidBuffers) {
+  std::vector<std::pair<int, std::string>> entries = {{1, "one"}};
+  auto buffer = FrozenF14Map<int, std::string>::freeze(entries);
+  using Frozen = FrozenF14Map<int, std::string>;
+
+  EXPECT_THROW(Frozen{ByteRange()}, std::invalid_argument);
+  EXPECT_THROW(Frozen(bytes(buffer).subpiece(0, 63)), std::invalid_argument);
+  // Strings past the end.
+  EXPECT_THROW(
+      Frozen(bytes(buffer).subpiece(0, buffer.size() - 1)),
+      std::invalid_argument);
+  // Other types.
+  EXPECT_THROW(
+      (FrozenF14Map<int64_t, std::string>(bytes(buffer))),
+      std::invalid_argument);
+  EXPECT_THROW((FrozenF14Map<int, int>(bytes(buffer))), std::invalid_argument);
+
+  auto corrupt = buffer;
+  corrupt[0] ^= 1;
+  EXPECT_THROW(Frozen(bytes(corrupt)), std::invalid_argument);
+
+  EXPECT_EQ("one", Frozen(bytes(buffer)).at(1));
+}
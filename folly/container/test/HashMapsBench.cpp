@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <map>
@@ -255,6 +256,57 @@ void benchmarkFind(int runs, int size) {
       2);
 }
 
+// Maps without findMany() look up the keys one after the other.
+template <typename Map, typename It, typename Out>
+auto findMany(Map& m, It first, It last, Out out, int)
+    -> decltype(m.findMany(first, last, out)) {
+  return m.findMany(first, last, out);
+}
+
+template <typename Map, typename It, typename Out>
+Out findMany(Map& m, It first, It last, Out out, long) {
+  for (; first != last; ++first, ++out) {
+    *out = m.find(*first);
+  }
+  return out;
+}
+
+// Like Find, with the keys looked up 64 at a time.
+template <template <class, class> class Map, class K, class V>
+void benchmarkFindMany(int runs, int size) {
+  BenchmarkSuspender braces;
+  Map<K, V> map(size);
+  std::vector<K> toFind;
+  prepare<K>(size);
+  for (int i = 0; i < size; ++i) {
+    toFind.push_back(key<K>(i));
+  }
+  for (int i = 0; i * 2 < size; ++i) {
+    map.insert(std::pair<K, V>(toFind[i], value<V>(i * 3)));
+  }
+  std::random_shuffle(toFind.begin(), toFind.end());
+  toFind.resize((size + 1) / 2);
+  std::vector<typename Map<K, V>::iterator> found(64);
+  folly::makeUnpredictable(map);
+  folly::makeUnpredictable(toFind);
+  int x = 0;
+  braces.dismissing([&] {
+    for (int r = 0; r < runs; ++r) {
+      for (size_t i = 0; i < toFind.size(); i += found.size()) {
+        auto n = std::min(found.size(), toFind.size() - i);
+        auto first = toFind.begin() + i;
+        findMany(map, first, first + n, found.begin(), 0);
+        for (size_t j = 0; j < n; ++j) {
+          if (found[j] != map.end()) {
+            x ^= found[j]->second[0];
+          }
+        }
+        folly::doNotOptimizeAway(x);
+      }
+    }
+  });
+}
+
 template <template <class, class> class Map, class K, class V>
 void benchmarkManyFind(int runs, int size) {
   int x = 0;
@@ -403,6 +455,7 @@ void runAllHashMapTests() {
   X(InsertSqBr);
   X(InsertGrow);
   X(Find);
+  X(FindMany);
   X(ManyFind);
   X(SqBrFind);
   X(Erase);
@@ -798,3 +798,41 @@ TEST(WeightedEvictingCacheMap, PruneHook) {
   EXPECT_EQ(std::get<1>(prunedValues[1]), 5);
   EXPECT_EQ(std::get<2>(prunedValues[1]), 6);
 }
+
+TEST(WeightedEvictingCacheMap, TinyLfu) {
+  WeightedEvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      TinyLfuEvictionPolicy>
+      map{1000};
+  auto lookupOrFill = [&](int key, size_t weight) {
+    if (map.find(key) != map.end()) {
+      return true;
+    }
+    map.set(key, int{key}, weight);
+    return false;
+  };
+  // A hot set filling half the cache, used a few times.
+  for (int round = 0; round < 4; ++round) {
+    for (int i = 0; i < 50; ++i) {
+      lookupOrFill(i, 10);
+    }
+  }
+  // A scan of keys used once, while the hot set keeps being used.
+  int hits = 0;
+  for (int i = 0; i < 2000; ++i) {
+    lookupOrFill(1000 + i, 5 + i % 10);
+    if (i % 4 == 0) {
+      hits += lookupOrFill((i / 4) % 50, 10);
+    }
+    EXPECT_LE(map.getCurrentTotalWeight(), 1000);
+  }
+  EXPECT_GT(hits, 450);
+
+  // The entry just set is never evicted right away.
+  map.set(5000, 5000, 900);
+  EXPECT_TRUE(map.exists(5000));
+  EXPECT_LE(map.getCurrentTotalWeight(), 1000);
+}
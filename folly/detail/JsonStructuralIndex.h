@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace folly {
+namespace detail {
+
+/**
+ * Largest input the structural index can describe: positions are stored as
+ * 32 bit offsets.
+ */
+constexpr std::size_t kJsonStructuralIndexMaxSize =
+    std::numeric_limits<std::uint32_t>::max() - 1;
+
+/**
+ * jsonStructuralIndex
+ *
+ * First stage of the indexed json parser (see folly::parseJsonIndexed).
+ *
+ * Replaces the contents of `out` with the offsets of all structural
+ * positions of `json`, in increasing order, followed by `json.size()` as a
+ * sentinel. A position is structural if it is:
+ *  - an unescaped `"`;
+ *  - one of `{ } [ ] : ,` outside of a string;
+ *  - the first byte of any other run of non-whitespace bytes outside of a
+ *    string (numbers, literals and garbage the second stage will reject).
+ *
+ * A backslash escapes the following byte whether or not it is in a string.
+ * Outside of strings that can only happen in invalid json, and the backslash
+ * itself is part of a scalar the second stage rejects.
+ *
+ * The input is classified 64 bytes at a time with SIMD compares; the
+ * in-string state is tracked with a prefix xor over the quote mask.
+ *
+ * Returns false if the input ends inside a string, the index is still
+ * filled in that case.
+ *
+ * Precondition: json.size() <= kJsonStructuralIndexMaxSize
+ */
+bool jsonStructuralIndex(
+    folly::StringPiece json, std::vector<std::uint32_t>& out);
+
+} // namespace detail
+} // namespace folly
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <folly/Portability.h>
+#include <folly/Range.h>
+#include <folly/detail/SimdCharPlatform.h>
+#include <folly/lang/Bits.h>
+
+// This file is not supposed to be included by users.
+// It should be included in CPP file which exposes apis.
+// It is a header file to test different platforms.
+
+namespace folly {
+namespace detail {
+
+/**
+ * Bitmasks describing one 64 byte block of json: bit i is set if byte i of
+ * the block belongs to the class.
+ */
+struct JsonBlockMasks {
+  std::uint64_t quote = 0;
+  std::uint64_t backslash = 0;
+  std::uint64_t op = 0; // { } [ ] : ,
+  std::uint64_t whitespace = 0; // space \t \n \r
+};
+
+FOLLY_ALWAYS_INLINE std::uint64_t jsonPrefixXor(std::uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+/**
+ * Stateful part of the index: everything that carries over from one block to
+ * the next.
+ */
+struct JsonStructuralState {
+  // 1 if the first byte of the next block is escaped by a backslash.
+  std::uint64_t nextEscaped = 0;
+  // All ones if the next block starts inside of a string.
+  std::uint64_t inString = 0;
+  // 1 if the last byte of the previous block was part of a scalar.
+  std::uint64_t prevScalar = 0;
+
+  // Returns the mask of bytes escaped by a backslash. Backslashes are rare
+  // outside of string heavy documents, so runs are resolved one at a time.
+  FOLLY_ALWAYS_INLINE std::uint64_t escaped(std::uint64_t backslash) {
+    std::uint64_t res = nextEscaped;
+    nextEscaped = 0;
+    backslash &= ~res;
+    while (backslash) {
+      auto i = folly::findFirstSet(backslash) - 1;
+      if (i == 63) {
+        nextEscaped = 1;
+        break;
+      }
+      std::uint64_t next = std::uint64_t(1) << (i + 1);
+      res |= next;
+      backslash &= ~((next << 1) - 1);
+    }
+    return res;
+  }
+
+  // Returns the structural positions of the block.
+  FOLLY_ALWAYS_INLINE std::uint64_t structurals(const JsonBlockMasks& m) {
+    std::uint64_t quote = m.quote & ~escaped(m.backslash);
+    // Includes opening quotes, excludes closing ones.
+    std::uint64_t str = jsonPrefixXor(quote) ^ inString;
+    inString =
+        static_cast<std::uint64_t>(static_cast<std::int64_t>(str) >> 63);
+
+    std::uint64_t scalar = ~(m.op | m.whitespace | quote | str);
+    std::uint64_t scalarStart = scalar & ~((scalar << 1) | prevScalar);
+    prevScalar = scalar >> 63;
+
+    return (m.op & ~str) | quote | scalarStart;
+  }
+};
+
+template <typename Platform>
+struct PlatformJsonStructuralIndex {
+  using reg_t = typename Platform::reg_t;
+  using logical_t = typename Platform::logical_t;
+  using mmask_t = typename Platform::mmask_t;
+
+  static constexpr int kRegsPerBlock = 64 / Platform::kCardinal;
+  static constexpr int kBitsPerReg = Platform::kCardinal;
+
+  // Packs a movemask into one bit per byte.
+  FOLLY_ALWAYS_INLINE static std::uint64_t toBits(mmask_t mmask) {
+    std::uint64_t x = mmask;
+    if (Platform::kMmaskBitsPerElement == 4) {
+      x &= 0x1111111111111111;
+      x = (x | x >> 3) & 0x0303030303030303;
+      x = (x | x >> 6) & 0x000F000F000F000F;
+      x = (x | x >> 12) & 0x000000FF000000FF;
+      x = (x | x >> 24) & 0xFFFF;
+    }
+    return x;
+  }
+
+  FOLLY_ALWAYS_INLINE static JsonBlockMasks classify(const char* p) {
+    JsonBlockMasks res;
+    for (int i = 0; i != kRegsPerBlock; ++i) {
+      reg_t reg =
+          Platform::loadu(p + i * kBitsPerReg, simd_detail::ignore_none{});
+      auto bits = [&](logical_t log) {
+        return toBits(Platform::movemask(log)) << (i * kBitsPerReg);
+      };
+
+      res.quote |= bits(Platform::equal(reg, '"'));
+      res.backslash |= bits(Platform::equal(reg, '\\'));
+      res.op |= bits(Platform::logical_or(
+          Platform::logical_or(
+              Platform::logical_or(
+                  Platform::equal(reg, '{'), Platform::equal(reg, '}')),
+              Platform::logical_or(
+                  Platform::equal(reg, '['), Platform::equal(reg, ']'))),
+          Platform::logical_or(
+              Platform::equal(reg, ':'), Platform::equal(reg, ','))));
+      res.whitespace |= bits(Platform::logical_or(
+          Platform::logical_or(
+              Platform::equal(reg, ' '), Platform::equal(reg, '\t')),
+          Platform::logical_or(
+              Platform::equal(reg, '\n'), Platform::equal(reg, '\r'))));
+    }
+    return res;
+  }
+};
+
+template <>
+struct PlatformJsonStructuralIndex<void> {
+  FOLLY_ALWAYS_INLINE static JsonBlockMasks classify(const char* p) {
+    JsonBlockMasks res;
+    for (int i = 0; i != 64; ++i) {
+      std::uint64_t bit = std::uint64_t(1) << i;
+      switch (p[i]) {
+        case '"':
+          res.quote |= bit;
+          break;
+        case '\\':
+          res.backslash |= bit;
+          break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+          res.op |= bit;
+          break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+          res.whitespace |= bit;
+          break;
+        default:
+          break;
+      }
+    }
+    return res;
+  }
+};
+
+template <typename Platform>
+bool jsonStructuralIndexForPlatform(
+    folly::StringPiece json, std::vector<std::uint32_t>& out) {
+  out.clear();
+  // Grown geometrically, every block may add up to 64 positions.
+  out.resize(json.size() / 8 + 64);
+  std::size_t n = 0;
+
+  JsonStructuralState state;
+  auto indexBlock = [&](const char* block, std::size_t base) {
+    auto structurals = state.structurals(
+        PlatformJsonStructuralIndex<Platform>::classify(block));
+    if (out.size() - n < 64) {
+      out.resize(out.size() * 2);
+    }
+    std::uint32_t* dst = out.data() + n;
+    n += folly::popcount(structurals);
+    while (structurals) {
+      *dst++ = static_cast<std::uint32_t>(
+          base + folly::findFirstSet(structurals) - 1);
+      structurals &= structurals - 1;
+    }
+  };
+
+  const char* f = json.data();
+  std::size_t full = json.size() & ~std::size_t(63);
+  for (std::size_t i = 0; i != full; i += 64) {
+    indexBlock(f + i, i);
+  }
+  if (full != json.size()) {
+    char tail[64];
+    std::memset(tail, ' ', sizeof(tail));
+    std::memcpy(tail, f + full, json.size() - full);
+    indexBlock(tail, full);
+  }
+
+  out.resize(n + 1);
+  out[n] = static_cast<std::uint32_t>(json.size());
+  return !state.inString;
+}
+
+} // namespace detail
+} // namespace folly
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/ParallelForEach.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include <folly/synchronization/Baton.h>
+
+namespace folly {
+namespace detail {
+
+namespace {
+
+struct IndexQueue {
+  IndexQueue(size_t n, FunctionRef<void(size_t, size_t)> f)
+      : size(n), remaining(n), fn(f) {}
+
+  void run(size_t worker) {
+    size_t i;
+    while ((i = next.fetch_add(1, std::memory_order_relaxed)) < size) {
+      if (!failed.load(std::memory_order_relaxed)) {
+        try {
+          fn(i, worker);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+          failed.store(true, std::memory_order_relaxed);
+        }
+      }
+      if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done.post();
+      }
+    }
+  }
+
+  const size_t size;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> remaining;
+  std::atomic<bool> failed{false};
+  Baton<> done;
+  std::mutex mutex;
+  std::exception_ptr error;
+  FunctionRef<void(size_t, size_t)> fn;
+};
+
+} // namespace
+
+void parallelForEach(
+    size_t n,
+    Executor::KeepAlive<> executor,
+    size_t maxWorkers,
+    FunctionRef<void(size_t, size_t)> fn) {
+  if (n == 0) {
+    return;
+  }
+  auto queue = std::make_shared<IndexQueue>(n, fn);
+  size_t workers = std::min(n, std::max(maxWorkers, size_t(1)));
+  try {
+    for (size_t worker = 1; worker < workers; ++worker) {
+      executor->add([queue, worker] { queue->run(worker); });
+    }
+  } catch (...) {
+    // Tasks already added may be running: do the work left and wait for
+    // theirs, so that none calls fn after this returns.
+    queue->run(0);
+    queue->done.wait();
+    throw;
+  }
+  queue->run(0);
+  queue->done.wait();
+  if (queue->error) {
+    std::rethrow_exception(queue->error);
+  }
+}
+
+} // namespace detail
+} // namespace folly
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <folly/Executor.h>
+#include <folly/Function.h>
+
+namespace folly {
+namespace detail {
+
+/**
+ * Calls fn(i, worker) for every i in [0, n), on the calling thread and on at
+ * most maxWorkers - 1 tasks added to executor.  worker, below maxWorkers,
+ * identifies the thread of a call: calls with the same worker don't overlap,
+ * so it may index per-thread state.  The calling thread is worker 0.
+ *
+ * Indices are handed out one by one.  The calling thread works on them too,
+ * and returns when every index is done, not when every task is: a task that
+ * starts late finds no index left and never calls fn, so fn may refer to the
+ * caller's stack, and executor may be one whose threads call this.
+ *
+ * Once fn throws, the indices left are skipped and the first exception is
+ * rethrown.  If executor->add() throws, the calling thread does the work
+ * left, waits for the tasks already added, and rethrows.
+ */
+void parallelForEach(
+    size_t n,
+    Executor::KeepAlive<> executor,
+    size_t maxWorkers,
+    FunctionRef<void(size_t, size_t)> fn);
+
+} // namespace detail
+} // namespace folly
@@ -27,5 +27,10 @@ bool simdHasSpaceOrCntrlSymbols(folly::StringPiece s) {
       simd_detail::SimdCharPlatform>::hasSpaceOrCntrlSymbols(s);
 }
 
+std::size_t simdFirstJsonEscapable(folly::StringPiece s, bool escapeNonAscii) {
+  return SimpleSimdStringUtilsImpl<
+      simd_detail::SimdCharPlatform>::firstJsonEscapable(s, escapeNonAscii);
+}
+
 } // namespace detail
 } // namespace folly
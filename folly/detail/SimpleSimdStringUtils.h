@@ -23,5 +23,10 @@ namespace detail {
 
 bool simdHasSpaceOrCntrlSymbols(folly::StringPiece s);
 
+// Position of the first character of `s` that has to be escaped in a json
+// string: a control character, '"' or '\\', and if `escapeNonAscii` any
+// byte >= 0x80. s.size() if there is none.
+std::size_t simdFirstJsonEscapable(folly::StringPiece s, bool escapeNonAscii);
+
 } // namespace detail
 } // namespace folly
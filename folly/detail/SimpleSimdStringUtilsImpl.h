@@ -16,9 +16,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+
 #include <folly/Range.h>
 #include <folly/detail/SimdAnyOf.h>
 #include <folly/detail/SimdCharPlatform.h>
+#include <folly/detail/SimdForEach.h>
+#include <folly/lang/Bits.h>
 
 namespace folly {
 namespace detail {
@@ -29,6 +34,7 @@ template <typename Platform>
 struct SimpleSimdStringUtilsImpl {
   using reg_t = typename Platform::reg_t;
   using logical_t = typename Platform::logical_t;
+  using mmask_t = typename Platform::mmask_t;
 
   struct HasSpaceOrCntrlSymbolsLambda {
     FOLLY_ALWAYS_INLINE
@@ -44,6 +50,39 @@ struct SimpleSimdStringUtilsImpl {
     return simd_detail::simdAnyOf<Platform, /*unrolling*/ 4>(
         s.data(), s.data() + s.size(), HasSpaceOrCntrlSymbolsLambda{});
   }
+
+  struct FirstJsonEscapableDelegate {
+    template <typename Ignore, typename UnrollStep>
+    FOLLY_ALWAYS_INLINE bool step(const char* it, Ignore ignore, UnrollStep) {
+      reg_t reg = Platform::loada(it, ignore);
+      mmask_t mmask = Platform::movemask(Platform::logical_or(
+          Platform::le_unsigned(reg, 0x1F),
+          Platform::logical_or(
+              Platform::equal(reg, '"'), Platform::equal(reg, '\\'))));
+      if (escapeNonAscii) {
+        mmask |= static_cast<mmask_t>(
+            ~Platform::movemask(Platform::le_unsigned(reg, 0x7F)));
+      }
+      mmask = Platform::clear(mmask, ignore);
+      if (!mmask) {
+        return false;
+      }
+      res = it + (findFirstSet(mmask) - 1) / Platform::kMmaskBitsPerElement;
+      return true;
+    }
+
+    bool escapeNonAscii;
+    const char* res;
+  };
+
+  FOLLY_ALWAYS_INLINE
+  static std::size_t firstJsonEscapable(
+      folly::StringPiece s, bool escapeNonAscii) {
+    FirstJsonEscapableDelegate delegate{escapeNonAscii, s.end()};
+    simd_detail::simdForEachAligning</*unrolling*/ 1>(
+        Platform::kCardinal, s.begin(), s.end(), delegate);
+    return static_cast<std::size_t>(delegate.res - s.begin());
+  }
 };
 
 template <>
@@ -55,6 +94,17 @@ struct SimpleSimdStringUtilsImpl<void> {
       return uc <= 0x20 || c == 0x7F;
     });
   }
+
+  FOLLY_ALWAYS_INLINE
+  static std::size_t firstJsonEscapable(
+      folly::StringPiece s, bool escapeNonAscii) {
+    auto it = std::find_if(s.begin(), s.end(), [&](char c) {
+      std::uint32_t uc = static_cast<std::uint8_t>(c);
+      return uc <= 0x1F || c == '"' || c == '\\' ||
+          (escapeNonAscii && uc > 0x7F);
+    });
+    return static_cast<std::size_t>(it - s.begin());
+  }
 };
 
 } // namespace detail
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/JsonStructuralIndex.h>
+#include <folly/detail/JsonStructuralIndexImpl.h>
+
+#include <random>
+#include <string>
+#include <utility>
+
+#include <folly/portability/GTest.h>
+
+namespace folly {
+namespace detail {
+
+namespace {
+
+// Byte at a time reference implementation.
+bool naiveIndex(folly::StringPiece s, std::vector<std::uint32_t>& out) {
+  out.clear();
+  bool inString = false;
+  bool inScalar = false;
+  bool escaped = false;
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    char c = s[i];
+    bool isEscaped = std::exchange(escaped, !escaped && c == '\\');
+    if (inString) {
+      if (c == '"' && !isEscaped) {
+        out.push_back(std::uint32_t(i));
+        inString = false;
+      }
+      continue;
+    }
+    if (isEscaped && c == '"') {
+      // An escaped quote outside of a string is part of a scalar.
+      c = 'x';
+    }
+    switch (c) {
+      case '"':
+        out.push_back(std::uint32_t(i));
+        inString = true;
+        inScalar = false;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        out.push_back(std::uint32_t(i));
+        inScalar = false;
+        break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        inScalar = false;
+        break;
+      default:
+        if (!inScalar) {
+          out.push_back(std::uint32_t(i));
+        }
+        inScalar = true;
+    }
+  }
+  out.push_back(std::uint32_t(s.size()));
+  return !inString;
+}
+
+void expectSameAsNaive(folly::StringPiece s) {
+  std::vector<std::uint32_t> expected;
+  bool expectedOk = naiveIndex(s, expected);
+
+  auto check = [&](auto platform) {
+    std::vector<std::uint32_t> actual;
+    bool ok = jsonStructuralIndexForPlatform<decltype(platform)>(s, actual);
+    ASSERT_EQ(expectedOk, ok) << s;
+    ASSERT_EQ(expected, actual) << s;
+  };
+
+  std::vector<std::uint32_t> actual;
+  ASSERT_EQ(expectedOk, jsonStructuralIndexForPlatform<void>(s, actual)) << s;
+  ASSERT_EQ(expected, actual) << s;
+
+  ASSERT_EQ(expectedOk, jsonStructuralIndex(s, actual)) << s;
+  ASSERT_EQ(expected, actual) << s;
+
+#if FOLLY_X64
+  check(simd_detail::SimdCharSse2Platform{});
+#if defined(__AVX2__)
+  check(simd_detail::SimdCharAvx2Platform{});
+#endif
+#endif
+
+#if FOLLY_AARCH64
+  check(simd_detail::SimdCharAarch64Platform{});
+#endif
+}
+
+} // namespace
+
+TEST(JsonStructuralIndexTest, Basic) {
+  std::vector<std::uint32_t> index;
+  ASSERT_TRUE(jsonStructuralIndex(R"({"a": [1, true]})", index));
+  ASSERT_EQ(
+      (std::vector<std::uint32_t>{0, 1, 3, 4, 6, 7, 8, 10, 14, 15, 16}),
+      index);
+
+  ASSERT_TRUE(jsonStructuralIndex("", index));
+  ASSERT_EQ((std::vector<std::uint32_t>{0}), index);
+
+  ASSERT_FALSE(jsonStructuralIndex(R"(["abc)", index));
+  ASSERT_EQ((std::vector<std::uint32_t>{0, 1, 5}), index);
+}
+
+TEST(JsonStructuralIndexTest, Escapes) {
+  expectSameAsNaive(R"("\"")");
+  expectSameAsNaive(R"("\\")");
+  expectSameAsNaive(R"("\\\"",1)");
+  expectSameAsNaive("[\"a" + std::string(80, '\\') + "\\\"]");
+  expectSameAsNaive(R"(\"abc")");
+
+  // Escapes crossing a block boundary.
+  for (std::size_t pad = 0; pad != 70; ++pad) {
+    std::string s = "[\"";
+    s.append(pad, 'x');
+    s += R"(\"\\\\\", 1, {"k": null}])";
+    expectSameAsNaive(s);
+  }
+}
+
+TEST(JsonStructuralIndexTest, Scalars) {
+  expectSameAsNaive("1");
+  expectSameAsNaive("  -12.5e7 ,true,false , null");
+  expectSameAsNaive(R"("a"b "c" d)");
+  expectSameAsNaive(std::string(200, '1'));
+  expectSameAsNaive(std::string(200, ' ') + "1");
+}
+
+TEST(JsonStructuralIndexTest, Random) {
+  constexpr folly::StringPiece kAlphabet = "  \"\\\\{}[]:,1a-\n\t";
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<std::size_t> len(0, 300);
+  std::uniform_int_distribution<std::size_t> ch(0, kAlphabet.size() - 1);
+  for (int i = 0; i != 2000; ++i) {
+    std::string s(len(gen), ' ');
+    for (auto& c : s) {
+      c = kAlphabet[ch(gen)];
+    }
+    expectSameAsNaive(s);
+  }
+}
+
+} // namespace detail
+} // namespace folly
@@ -81,6 +81,81 @@ TEST(SpaceOrCntrl, ExplicitExamples) {
   }
 }
 
+template <typename Platform>
+std::size_t firstJsonEscapableForPlatform(
+    folly::StringPiece s, bool escapeNonAscii) {
+  return SimpleSimdStringUtilsImpl<Platform>::firstJsonEscapable(
+      s, escapeNonAscii);
+}
+
+void testFirstJsonEscapable(
+    folly::StringPiece s, bool escapeNonAscii, std::size_t r) {
+  ASSERT_EQ(r, simdFirstJsonEscapable(s, escapeNonAscii)) << s;
+
+  using namespace simd_detail;
+  ASSERT_EQ(r, firstJsonEscapableForPlatform<void>(s, escapeNonAscii)) << s;
+
+#if FOLLY_X64
+  ASSERT_EQ(
+      r,
+      firstJsonEscapableForPlatform<SimdCharSse2Platform>(s, escapeNonAscii))
+      << s;
+#if defined(__AVX2__)
+  ASSERT_EQ(
+      r,
+      firstJsonEscapableForPlatform<SimdCharAvx2Platform>(s, escapeNonAscii))
+      << s;
+#endif
+#endif
+
+#if FOLLY_AARCH64
+  ASSERT_EQ(
+      r,
+      firstJsonEscapableForPlatform<SimdCharAarch64Platform>(
+          s, escapeNonAscii))
+      << s;
+#endif
+}
+
+TEST(FirstJsonEscapable, EachSymbol) {
+  for (std::uint16_t uChar = 0;
+       uChar <= std::numeric_limits<std::uint8_t>::max();
+       ++uChar) {
+    bool special = uChar < 0x20 || uChar == '"' || uChar == '\\';
+    bool nonAscii = uChar >= 0x80;
+
+    char c = static_cast<char>(uChar);
+    ASSERT_NO_FATAL_FAILURE(testFirstJsonEscapable({&c, 1u}, false, !special));
+    ASSERT_NO_FATAL_FAILURE(
+        testFirstJsonEscapable({&c, 1u}, true, !(special || nonAscii)));
+  }
+}
+
+TEST(FirstJsonEscapable, EveryPosition) {
+  // Long enough for several iterations of the widest platform, and every
+  // alignment of the start of the string.
+  std::string buf(200, 'a');
+  for (std::size_t offset = 0; offset < 64; ++offset) {
+    folly::StringPiece s(buf.data() + offset, buf.size() - offset);
+    ASSERT_NO_FATAL_FAILURE(testFirstJsonEscapable(s, true, s.size()));
+    for (std::size_t pos = 0; pos < s.size(); pos += 7) {
+      for (char c : {'"', '\\', '\n', '\x80'}) {
+        buf[offset + pos] = c;
+        bool nonAscii = c == '\x80';
+        ASSERT_NO_FATAL_FAILURE(testFirstJsonEscapable(s, true, pos));
+        ASSERT_NO_FATAL_FAILURE(
+            testFirstJsonEscapable(s, false, nonAscii ? s.size() : pos));
+        // Only the first one counts.
+        buf[buf.size() - 1] = '"';
+        ASSERT_NO_FATAL_FAILURE(testFirstJsonEscapable(
+            s, false, nonAscii ? s.size() - 1 : pos));
+        buf[buf.size() - 1] = 'a';
+        buf[offset + pos] = 'a';
+      }
+    }
+  }
+}
+
 } // namespace
 } // namespace detail
 } // namespace folly
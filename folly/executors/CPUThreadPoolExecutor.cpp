@@ -17,9 +17,16 @@
 #include <folly/Executor.h>
 #include <folly/executors/CPUThreadPoolExecutor.h>
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
 #include <folly/Memory.h>
 #include <folly/Optional.h>
+#include <folly/Random.h>
 #include <folly/executors/QueueObserver.h>
 #include <folly/executors/task_queue/PriorityLifoSemMPMCQueue.h>
 #include <folly/executors/task_queue/PriorityUnboundedBlockingQueue.h>
@@ -36,6 +43,50 @@ namespace folly {
 
 const size_t CPUThreadPoolExecutor::kDefaultMaxQueueSize = 1 << 14;
 
+// The tasks added by a thread of the pool in work stealing mode. The owner
+// pushes and pops at the back, thieves take from the front.
+struct CPUThreadPoolExecutor::WorkerQueue {
+  explicit WorkerQueue(CPUThreadPoolExecutor* ex) : executor(ex) {}
+
+  void push(CPUTask&& task) {
+    std::lock_guard g{mutex};
+    tasks.push_back(std::move(task));
+    size.store(tasks.size(), std::memory_order_relaxed);
+  }
+
+  template <bool kBack>
+  folly::Optional<CPUTask> pop() {
+    std::lock_guard g{mutex};
+    if (tasks.empty()) {
+      return folly::none;
+    }
+    folly::Optional<CPUTask> task;
+    if (kBack) {
+      task.emplace(std::move(tasks.back()));
+      tasks.pop_back();
+    } else {
+      task.emplace(std::move(tasks.front()));
+      tasks.pop_front();
+    }
+    size.store(tasks.size(), std::memory_order_relaxed);
+    return task;
+  }
+
+  bool empty() const { return size.load(std::memory_order_relaxed) == 0; }
+
+  CPUThreadPoolExecutor* const executor;
+  std::mutex mutex;
+  std::deque<CPUTask> tasks;
+  // Only written by the thread holding mutex, read by anyone. Per queue, so
+  // that pushes and pops don't share a cache line with other threads.
+  std::atomic<size_t> size{0};
+  // Tasks taken by the owner, to know when to check the shared queue.
+  uint32_t ticks{0};
+  // The owner took a poison while it had local tasks, it stops once they
+  // are done.
+  bool pendingStop{false};
+};
+
 CPUThreadPoolExecutor::CPUTask::CPUTask(
     Func&& f,
     std::chrono::milliseconds expiration,
@@ -99,7 +150,8 @@ CPUThreadPoolExecutor::CPUThreadPoolExecutor(
     : ThreadPoolExecutor(
           numThreads.first, numThreads.second, std::move(threadFactory)),
       taskQueue_(taskQueue.release()),
-      prohibitBlockingOnThreadPools_{opt.blocking} {
+      prohibitBlockingOnThreadPools_{opt.blocking},
+      workStealing_{opt.workStealing} {
   setNumThreads(numThreads.first);
   if (numThreads.second == 0) {
     minThreads_.store(1, std::memory_order_relaxed);
@@ -124,7 +176,8 @@ CPUThreadPoolExecutor::CPUThreadPoolExecutor(
     : ThreadPoolExecutor(
           numThreads.first, numThreads.second, std::move(threadFactory)),
       taskQueue_(makeDefaultQueue()),
-      prohibitBlockingOnThreadPools_{opt.blocking} {
+      prohibitBlockingOnThreadPools_{opt.blocking},
+      workStealing_{opt.workStealing} {
   setNumThreads(numThreads.first);
   if (numThreads.second == 0) {
     minThreads_.store(1, std::memory_order_relaxed);
@@ -246,6 +299,15 @@ void CPUThreadPoolExecutor::addImpl(
   }
   registerTaskEnqueue(task);
 
+  if (!withPriority && workStealing_) {
+    // No need for a KeepAlive, this runs on one of our threads.
+    auto queue = localWorkerQueue();
+    if (queue && queue->executor == this) {
+      addLocal(*queue, std::move(task));
+      return;
+    }
+  }
+
   // It's not safe to expect that the executor is alive after a task is added to
   // the queue (this task could be holding the last KeepAlive and when finished
   // - it may unblock the executor shutdown).
@@ -267,12 +329,128 @@ void CPUThreadPoolExecutor::addImpl(
   }
 }
 
+CPUThreadPoolExecutor::WorkerQueue*&
+CPUThreadPoolExecutor::localWorkerQueue() {
+  static thread_local WorkerQueue* queue = nullptr;
+  return queue;
+}
+
+void CPUThreadPoolExecutor::addLocal(WorkerQueue& queue, CPUTask task) {
+  queue.push(std::move(task));
+  // Pairs with the fence in takeNextTask(): either an idle thread sees the
+  // task before blocking, or we see it blocked.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto idle = idleThreads_.load(std::memory_order_relaxed);
+  if (idle > pendingWakeUps_.load(std::memory_order_relaxed)) {
+    pendingWakeUps_.fetch_add(1, std::memory_order_relaxed);
+    CPUTask wakeUp([] {}, std::chrono::milliseconds(0), nullptr, 0);
+    wakeUp.wakeUp_ = true;
+    try {
+      taskQueue_->add(std::move(wakeUp));
+    } catch (const QueueFullException&) {
+      // This thread runs the task itself eventually.
+      pendingWakeUps_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  } else if (
+      activeThreads_.load(std::memory_order_relaxed) <
+      maxThreads_.load(std::memory_order_relaxed)) {
+    ensureActiveThreads();
+  }
+}
+
+bool CPUThreadPoolExecutor::isWakeUp(folly::Optional<CPUTask>& task) {
+  if (!task || !task->wakeUp_) {
+    return false;
+  }
+  pendingWakeUps_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+size_t CPUThreadPoolExecutor::localTaskCount() const {
+  std::shared_lock r{workerQueuesLock_};
+  size_t count = 0;
+  for (auto queue : workerQueues_) {
+    count += queue->size.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+auto CPUThreadPoolExecutor::steal(WorkerQueue& self)
+    -> folly::Optional<CPUTask> {
+  std::shared_lock r{workerQueuesLock_};
+  auto n = workerQueues_.size();
+  auto start = n > 1 ? folly::Random::rand32(static_cast<uint32_t>(n)) : 0;
+  for (size_t i = 0; i < n; ++i) {
+    auto victim = workerQueues_[(start + i) % n];
+    if (victim == &self || victim->empty()) {
+      continue;
+    }
+    if (auto task = victim->pop</* kBack */ false>()) {
+      return task;
+    }
+  }
+  return folly::none;
+}
+
+auto CPUThreadPoolExecutor::takeNextTask(WorkerQueue& queue)
+    -> folly::Optional<CPUTask> {
+  // Tasks added from outside the pool, or with a priority, would starve if
+  // the local ones always came first.
+  if (!queue.pendingStop && ++queue.ticks % kGlobalQueuePollInterval == 0) {
+    auto task = taskQueue_->try_take_for(std::chrono::milliseconds(0));
+    if (task && !task->func_ && !queue.empty()) {
+      // Stop once done with the local tasks, no one else will run them.
+      // Putting the poison back could fail on a bounded queue.
+      queue.pendingStop = true;
+    } else if (task && !isWakeUp(task)) {
+      return task;
+    }
+  }
+
+  while (true) {
+    if (!queue.empty()) {
+      if (auto task = queue.pop</* kBack */ true>()) {
+        return task;
+      }
+    }
+    if (queue.pendingStop) {
+      // Only this thread adds to its queue, which is now empty.
+      queue.pendingStop = false;
+      return CPUTask();
+    }
+    if (auto task = steal(queue)) {
+      return task;
+    }
+    idleThreads_.fetch_add(1, std::memory_order_relaxed);
+    // Pairs with the fence in addLocal().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (localTaskCount() > 0) {
+      idleThreads_.fetch_sub(1, std::memory_order_relaxed);
+      std::this_thread::yield();
+      continue;
+    }
+    auto task = taskQueue_->try_take_for(
+        threadTimeout_.load(std::memory_order_relaxed));
+    idleThreads_.fetch_sub(1, std::memory_order_relaxed);
+    if (!isWakeUp(task)) {
+      return task;
+    }
+  }
+}
+
 uint8_t CPUThreadPoolExecutor::getNumPriorities() const {
   return taskQueue_->getNumPriorities();
 }
 
 size_t CPUThreadPoolExecutor::getTaskQueueSize() const {
-  return taskQueue_->size();
+  size_t size = taskQueue_->size();
+  if (!workStealing_) {
+    return size;
+  }
+  // Leave out the wake up tasks. They are counted before being added and
+  // after being taken, so there may briefly be more than the queue holds.
+  auto wakeUps = pendingWakeUps_.load(std::memory_order_relaxed);
+  return (size > wakeUps ? size - wakeUps : 0) + localTaskCount();
 }
 
 WorkerProvider* CPUThreadPoolExecutor::getThreadIdCollector() {
@@ -323,9 +501,29 @@ void CPUThreadPoolExecutor::threadRun(ThreadPtr thread) {
     // so it should block until the collection finishes to exit.
     threadIdCollector_->removeTid(folly::getOSThreadID());
   });
+
+  WorkerQueue workerQueue(this);
+  if (workStealing_) {
+    std::unique_lock w{workerQueuesLock_};
+    workerQueues_.push_back(&workerQueue);
+    localWorkerQueue() = &workerQueue;
+  }
+  // Threads only stop once they have run all their local tasks.
+  auto workerQueueGuard = folly::makeGuard([&] {
+    if (workStealing_) {
+      DCHECK(workerQueue.empty());
+      localWorkerQueue() = nullptr;
+      std::unique_lock w{workerQueuesLock_};
+      workerQueues_.erase(
+          std::find(workerQueues_.begin(), workerQueues_.end(), &workerQueue));
+    }
+  });
+
   while (true) {
-    auto task = taskQueue_->try_take_for(
-        threadTimeout_.load(std::memory_order_relaxed));
+    auto task = workStealing_
+        ? takeNextTask(workerQueue)
+        : taskQueue_->try_take_for(
+              threadTimeout_.load(std::memory_order_relaxed));
 
     // Handle thread stopping, either by task timeout, or
     // by 'poison' task added in join() or stop().
@@ -349,7 +547,8 @@ void CPUThreadPoolExecutor::threadRun(ThreadPtr thread) {
     }
     runTask(thread, std::move(task.value()));
 
-    if (FOLLY_UNLIKELY(threadsToStop_ > 0 && !isJoin_)) {
+    if (FOLLY_UNLIKELY(threadsToStop_ > 0 && !isJoin_) &&
+        workerQueue.empty()) {
       std::unique_lock w{threadListLock_};
       if (tryDecrToStop()) {
         threadList_.remove(thread);
@@ -369,7 +568,7 @@ void CPUThreadPoolExecutor::stopThreads(size_t n) {
 
 // threadListLock_ is read (or write) locked.
 size_t CPUThreadPoolExecutor::getPendingTaskCountImpl() const {
-  return taskQueue_->size();
+  return getTaskQueueSize();
 }
 
 std::unique_ptr<folly::QueueObserverFactory>
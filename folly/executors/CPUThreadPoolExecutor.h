@@ -19,6 +19,7 @@
 #include <limits.h>
 
 #include <array>
+#include <vector>
 
 #include <folly/executors/QueueObserver.h>
 #include <folly/executors/ThreadPoolExecutor.h>
@@ -64,6 +65,17 @@ namespace folly {
  * themselves don't have priorities set, so a series of long running low
  * priority tasks could still hog all the threads. (at last check pthreads
  * thread priorities didn't work very well).
+ *
+ * @note With Options::setWorkStealing(true), tasks added with add() from one
+ * of the pool's own threads go to a deque local to that thread instead of
+ * the shared queue, so that tasks spawning tasks at a high rate don't all
+ * contend on it. A thread runs its own tasks newest first, and idle threads
+ * steal the oldest tasks of the busy ones. Tasks added from outside the pool,
+ * or with a priority, still go through the shared queue, which every thread
+ * also checks once every kGlobalQueuePollInterval tasks: tasks of any
+ * priority wait behind at most that many local ones per thread. Local deques
+ * are unbounded, whatever the shared queue. stop() runs the tasks left in
+ * the local deques before the threads exit, as no other thread could.
  */
 class CPUThreadPoolExecutor : public ThreadPoolExecutor,
                               public GetThreadIdCollector {
@@ -75,14 +87,21 @@ class CPUThreadPoolExecutor : public ThreadPoolExecutor,
       allow,
     };
 
-    constexpr Options() noexcept : blocking{Blocking::allow} {}
+    constexpr Options() noexcept
+        : blocking{Blocking::allow}, workStealing{false} {}
 
     Options& setBlocking(Blocking b) {
       blocking = b;
       return *this;
     }
 
+    Options& setWorkStealing(bool b) {
+      workStealing = b;
+      return *this;
+    }
+
     Blocking blocking;
+    bool workStealing;
   };
 
   // These function return unbounded blocking queues with the default semaphore
@@ -174,9 +193,14 @@ class CPUThreadPoolExecutor : public ThreadPoolExecutor,
     friend class CPUThreadPoolExecutor;
 
     intptr_t queueObserverPayload_;
+    // Only there to wake up an idle thread so that it steals work.
+    bool wakeUp_{false};
   };
 
   static const size_t kDefaultMaxQueueSize;
+  // How many tasks a thread runs, in work stealing mode, between two checks
+  // of the shared queue.
+  static constexpr uint32_t kGlobalQueuePollInterval = 61;
 
  protected:
   BlockingQueue<CPUTask>* getTaskQueue();
@@ -191,6 +215,14 @@ class CPUThreadPoolExecutor : public ThreadPoolExecutor,
   bool tryDecrToStop();
   bool taskShouldStop(folly::Optional<CPUTask>&);
 
+  struct WorkerQueue;
+  static WorkerQueue*& localWorkerQueue();
+  void addLocal(WorkerQueue& queue, CPUTask task);
+  folly::Optional<CPUTask> takeNextTask(WorkerQueue& queue);
+  folly::Optional<CPUTask> steal(WorkerQueue& self);
+  size_t localTaskCount() const;
+  bool isWakeUp(folly::Optional<CPUTask>& task);
+
   template <bool withPriority>
   void addImpl(
       Func func,
@@ -208,6 +240,14 @@ class CPUThreadPoolExecutor : public ThreadPoolExecutor,
       createQueueObserverFactory()};
   std::atomic<ssize_t> threadsToStop_{0};
   Options::Blocking prohibitBlockingOnThreadPools_ = Options::Blocking::allow;
+
+  // Work stealing state.
+  const bool workStealing_;
+  mutable folly::SharedMutex workerQueuesLock_;
+  std::vector<WorkerQueue*> workerQueues_;
+  // Threads blocked on the shared queue, and wake up tasks queued for them.
+  std::atomic<size_t> idleThreads_{0};
+  std::atomic<size_t> pendingWakeUps_{0};
 };
 
 } // namespace folly
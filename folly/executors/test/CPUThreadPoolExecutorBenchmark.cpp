@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <thread>
+
+#include <folly/Benchmark.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/init/Init.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+
+namespace {
+
+// Every task spawns two more until a binary tree of 2^depth - 1 tasks has
+// run, the worst case for a single shared queue.
+void spawn(
+    CPUThreadPoolExecutor& ex,
+    size_t depth,
+    std::atomic<size_t>& remaining,
+    Baton<>& done) {
+  if (depth > 1) {
+    ex.add([&, depth] { spawn(ex, depth - 1, remaining, done); });
+    ex.add([&, depth] { spawn(ex, depth - 1, remaining, done); });
+  }
+  if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    done.post();
+  }
+}
+
+void fanOut(size_t iters, size_t numThreads, bool workStealing) {
+  constexpr size_t kDepth = 14;
+  BenchmarkSuspender braces;
+  CPUThreadPoolExecutor ex(
+      std::make_pair(numThreads, numThreads),
+      CPUThreadPoolExecutor::makeDefaultQueue(),
+      std::make_shared<NamedThreadFactory>("CPUThreadPool"),
+      CPUThreadPoolExecutor::Options().setWorkStealing(workStealing));
+  braces.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    std::atomic<size_t> remaining{(size_t{1} << kDepth) - 1};
+    Baton<> done;
+    ex.add([&] { spawn(ex, kDepth, remaining, done); });
+    done.wait();
+  }
+
+  braces.rehire();
+}
+
+// Tasks added from outside the pool only, which work stealing leaves alone.
+void external(size_t iters, size_t numThreads, bool workStealing) {
+  constexpr size_t kTasks = 10000;
+  BenchmarkSuspender braces;
+  CPUThreadPoolExecutor ex(
+      std::make_pair(numThreads, numThreads),
+      CPUThreadPoolExecutor::makeDefaultQueue(),
+      std::make_shared<NamedThreadFactory>("CPUThreadPool"),
+      CPUThreadPoolExecutor::Options().setWorkStealing(workStealing));
+  braces.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    std::atomic<size_t> remaining{kTasks};
+    Baton<> done;
+    for (size_t j = 0; j < kTasks; ++j) {
+      ex.add([&] {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          done.post();
+        }
+      });
+    }
+    done.wait();
+  }
+
+  braces.rehire();
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(fanOut, 1_thread_shared, 1, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(fanOut, 1_thread_stealing, 1, true)
+BENCHMARK_NAMED_PARAM(fanOut, 4_threads_shared, 4, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(fanOut, 4_threads_stealing, 4, true)
+BENCHMARK_NAMED_PARAM(fanOut, 16_threads_shared, 16, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(fanOut, 16_threads_stealing, 16, true)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(external, 4_threads_shared, 4, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(external, 4_threads_stealing, 4, true)
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -22,7 +22,10 @@
 #include <folly/synchronization/Latch.h>
 
 #include <atomic>
+#include <condition_variable>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <thread>
 
 #include <boost/thread.hpp>
@@ -1037,6 +1040,239 @@ TEST(ThreadPoolExecutorTest, AddPerf) {
   e.stop();
 }
 
+static CPUThreadPoolExecutor::Options workStealing() {
+  return CPUThreadPoolExecutor::Options().setWorkStealing(true);
+}
+
+TEST(ThreadPoolExecutorTest, WorkStealingFanOut) {
+  CPUThreadPoolExecutor e(4, workStealing());
+  std::atomic<size_t> count{0};
+  std::function<void(int)> spawn = [&](int depth) {
+    count.fetch_add(1, std::memory_order_relaxed);
+    if (depth > 0) {
+      e.add([&, depth] { spawn(depth - 1); });
+      e.add([&, depth] { spawn(depth - 1); });
+    }
+  };
+  e.add([&] { spawn(12); });
+  e.join();
+  EXPECT_EQ((1 << 13) - 1, count.load());
+}
+
+TEST(ThreadPoolExecutorTest, WorkStealingSteals) {
+  // The tasks stay in the deque of the blocked thread until stolen.
+  constexpr int kTasks = 8;
+  CPUThreadPoolExecutor e(3, workStealing());
+  folly::Latch done(kTasks);
+  std::atomic<pid_t> owner{0};
+  std::atomic<int> stolen{0};
+  e.add([&] {
+    owner = getOSThreadID();
+    for (int i = 0; i < kTasks; ++i) {
+      e.add([&] {
+        stolen += getOSThreadID() != owner;
+        done.count_down();
+      });
+    }
+    done.wait();
+  });
+  done.wait();
+  e.join();
+  EXPECT_EQ(kTasks, stolen.load());
+}
+
+TEST(ThreadPoolExecutorTest, WorkStealingStopRunsLocalTasks) {
+  // The only thread still has its local tasks when stop() or join() is
+  // called, and runs them before exiting.
+  for (bool join : {false, true}) {
+    CPUThreadPoolExecutor e(1, workStealing());
+    std::atomic<int> count{0};
+    Baton<> added;
+    Baton<> release;
+    e.add([&] {
+      for (int i = 0; i < 1000; ++i) {
+        e.add([&] { ++count; });
+      }
+      added.post();
+      release.wait();
+    });
+    added.wait();
+    std::thread stopper([&] { join ? e.join() : e.stop(); });
+    /* sleep override */ std::this_thread::sleep_for(
+        std::chrono::milliseconds(100));
+    EXPECT_EQ(0, count.load());
+    release.post();
+    stopper.join();
+    EXPECT_EQ(1000, count.load());
+  }
+}
+
+namespace {
+// Throws QueueFullException once limit() tasks have been added after a call
+// to limit(), as if other threads had filled it.
+class LimitedQueue : public BlockingQueue<CPUThreadPoolExecutor::CPUTask> {
+ public:
+  BlockingQueueAddResult add(CPUThreadPoolExecutor::CPUTask item) override {
+    if (room_.fetch_sub(1) <= 0) {
+      throw QueueFullException("LimitedQueue: full");
+    }
+    return queue_.add(std::move(item));
+  }
+  CPUThreadPoolExecutor::CPUTask take() override { return queue_.take(); }
+  folly::Optional<CPUThreadPoolExecutor::CPUTask> try_take_for(
+      std::chrono::milliseconds time) override {
+    return queue_.try_take_for(time);
+  }
+  size_t size() override { return queue_.size(); }
+
+  void limit(int room) { room_ = room; }
+
+ private:
+  std::atomic<int> room_{std::numeric_limits<int>::max()};
+  UnboundedBlockingQueue<CPUThreadPoolExecutor::CPUTask> queue_;
+};
+} // namespace
+
+TEST(ThreadPoolExecutorTest, WorkStealingStopBoundedQueue) {
+  // The thread takes its poison from the shared queue while it still has
+  // local tasks, and can't put it back.
+  for (bool join : {false, true}) {
+    auto queue = std::make_unique<LimitedQueue>();
+    auto limitedQueue = queue.get();
+    CPUThreadPoolExecutor e(
+        1,
+        std::move(queue),
+        std::make_shared<NamedThreadFactory>("CPUThreadPool"),
+        workStealing());
+    std::atomic<int> count{0};
+    Baton<> added;
+    e.add([&] {
+      for (int i = 0; i < 1000; ++i) {
+        e.add([&] {
+          /* sleep override */ usleep(100);
+          ++count;
+        });
+      }
+      added.post();
+    });
+    added.wait();
+    // Room for the poison only.
+    limitedQueue->limit(1);
+    join ? e.join() : e.stop();
+    EXPECT_EQ(1000, count.load());
+  }
+}
+
+namespace {
+// Threads taking tasks wait until let through, so that they stay idle.
+class GatedQueue : public BlockingQueue<CPUThreadPoolExecutor::CPUTask> {
+ public:
+  BlockingQueueAddResult add(CPUThreadPoolExecutor::CPUTask item) override {
+    return queue_.add(std::move(item));
+  }
+  CPUThreadPoolExecutor::CPUTask take() override {
+    gate();
+    return queue_.take();
+  }
+  folly::Optional<CPUThreadPoolExecutor::CPUTask> try_take_for(
+      std::chrono::milliseconds time) override {
+    gate();
+    return queue_.try_take_for(time);
+  }
+  size_t size() override { return queue_.size(); }
+
+  size_t waiting() {
+    std::lock_guard g{mutex_};
+    return waiting_;
+  }
+  void letThrough(size_t n) {
+    std::lock_guard g{mutex_};
+    permits_ += n;
+    cv_.notify_all();
+  }
+  void open() {
+    std::lock_guard g{mutex_};
+    open_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  void gate() {
+    std::unique_lock l{mutex_};
+    ++waiting_;
+    cv_.wait(l, [&] { return open_ || permits_ > 0; });
+    if (!open_) {
+      --permits_;
+    }
+    --waiting_;
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t waiting_{0};
+  size_t permits_{0};
+  bool open_{false};
+  UnboundedBlockingQueue<CPUThreadPoolExecutor::CPUTask> queue_;
+};
+} // namespace
+
+TEST(ThreadPoolExecutorTest, WorkStealingQueueSizeLeavesOutWakeUps) {
+  // The idle thread is woken up through the shared queue, but the wake up
+  // task isn't one of the pending tasks.
+  constexpr size_t kTasks = 10;
+  auto queue = std::make_unique<GatedQueue>();
+  auto gatedQueue = queue.get();
+  CPUThreadPoolExecutor e(
+      std::make_pair(2, 2),
+      std::move(queue),
+      std::make_shared<NamedThreadFactory>("CPUThreadPool"),
+      workStealing());
+  while (gatedQueue->waiting() < 2) {
+    std::this_thread::yield();
+  }
+  Baton<> added;
+  e.add([&] {
+    for (size_t i = 0; i < kTasks; ++i) {
+      e.add([] {});
+    }
+    EXPECT_EQ(1, gatedQueue->size());
+    EXPECT_EQ(kTasks, e.getTaskQueueSize());
+    added.post();
+  });
+  gatedQueue->letThrough(1);
+  added.wait();
+  gatedQueue->open();
+  e.join();
+}
+
+TEST(ThreadPoolExecutorTest, WorkStealingPriorities) {
+  // The shared queue is checked while there are local tasks, and tasks
+  // added with a priority go there.
+  constexpr int kTasks = 500;
+  CPUThreadPoolExecutor e(
+      std::make_pair(1, 1),
+      CPUThreadPoolExecutor::makeDefaultPriorityQueue(3),
+      std::make_shared<NamedThreadFactory>("CPUThreadPool"),
+      workStealing());
+  std::vector<int> order;
+  Baton<> added;
+  e.add([&] {
+    for (int i = 0; i < kTasks; ++i) {
+      e.add([&, i] { order.push_back(i); });
+    }
+    e.addWithPriority([&] { order.push_back(-1); }, Executor::HI_PRI);
+    EXPECT_EQ(kTasks + 1, e.getTaskQueueSize());
+    added.post();
+  });
+  added.wait();
+  e.join();
+  ASSERT_EQ(kTasks + 1, order.size());
+  auto hiPri = std::find(order.begin(), order.end(), -1) - order.begin();
+  EXPECT_LE(hiPri, CPUThreadPoolExecutor::kGlobalQueuePollInterval);
+  // Local tasks run newest first.
+  EXPECT_EQ(kTasks - 1, order.front() == -1 ? order[1] : order[0]);
+}
+
 class ExecutorWorkerProviderTest : public ::testing::Test {
  protected:
   void SetUp() override { kWorkerProviderGlobal = nullptr; }
@@ -1091,8 +1091,10 @@ void IoUringBackend::initSubmissionLinked() {
 
     int sizeShift =
         std::max<int>(get_shift(options_.initialProvidedBuffersEachSize), 5);
-    int ringShift =
-        std::max<int>(get_shift(options_.initialProvidedBuffersCount), 1);
+    size_t maxCount = std::max(
+        options_.initialProvidedBuffersCount,
+        options_.maxProvidedBuffersCount);
+    int ringShift = std::max<int>(get_shift(maxCount), 1);
 
     try {
       bufferProvider_ = makeProvidedBufferRing(
@@ -1100,7 +1102,8 @@ void IoUringBackend::initSubmissionLinked() {
           nextBufferProviderGid(),
           options_.initialProvidedBuffersCount,
           sizeShift,
-          ringShift);
+          ringShift,
+          maxCount);
     } catch (const IoUringProvidedBufferRing::LibUringCallError& ex) {
       throw NotAvailable(ex.what());
     }
@@ -1909,6 +1912,57 @@ static bool doKernelSupportsRecvmsgMultishot() {
   }
 }
 
+static bool doKernelSupportsAcceptMultishot() {
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return false;
+  }
+  SCOPE_EXIT {
+    ::close(fd);
+  };
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) ||
+      ::listen(fd, 1)) {
+    return false;
+  }
+
+  struct io_uring ring;
+  int ret = io_uring_queue_init(4, &ring, 0);
+  if (ret) {
+    LOG(ERROR) << "doKernelSupportsAcceptMultishot: Unexpectedly "
+               << "io_uring_queue_init failed";
+    return false;
+  }
+  SCOPE_EXIT {
+    io_uring_queue_exit(&ring);
+  };
+
+  auto* sqe = ::io_uring_get_sqe(&ring);
+  if (!sqe) {
+    LOG(ERROR) << "doKernelSupportsAcceptMultishot: no sqe?";
+    return false;
+  }
+  ::io_uring_prep_accept(sqe, fd, nullptr, nullptr, 0);
+  // see note in prepAcceptMultishot
+  constexpr uint16_t kMultishotFlag = 1U << 0;
+  sqe->ioprio |= kMultishotFlag;
+  ret = ::io_uring_submit(&ring);
+  if (ret != 1) {
+    return false;
+  }
+
+  // kernels without multishot accept reject the flag right away, otherwise
+  // the request waits for a connection
+  struct io_uring_cqe* cqe = nullptr;
+  if (::io_uring_peek_cqe(&ring, &cqe) == 0 && cqe) {
+    return cqe->res != -EINVAL;
+  }
+  return true;
+}
+
 static bool doKernelSupportsDeferTaskrun() {
 #if FOLLY_IO_URING_UP_TO_DATE
   struct io_uring ring;
@@ -1974,6 +2028,11 @@ bool IoUringBackend::kernelSupportsRecvmsgMultishot() {
   return ret;
 }
 
+bool IoUringBackend::kernelSupportsAcceptMultishot() {
+  static bool const ret = doKernelSupportsAcceptMultishot();
+  return ret;
+}
+
 bool IoUringBackend::kernelSupportsDeferTaskrun() {
   static bool const ret = doKernelSupportsDeferTaskrun();
   return ret;
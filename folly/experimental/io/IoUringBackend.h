@@ -158,6 +158,14 @@ class IoUringBackend : public EventBaseBackendBase {
       return *this;
     }
 
+    // Lets the provided buffer ring double in size, up to `count` buffers,
+    // whenever the kernel runs out of buffers. Memory for all of them is
+    // reserved when the backend is created.
+    Options& setMaxProvidedBuffers(size_t count) {
+      maxProvidedBuffersCount = count;
+      return *this;
+    }
+
     Options& setRegisterRingFd(bool v) {
       registerRingFd = v;
 
@@ -198,6 +206,7 @@ class IoUringBackend : public EventBaseBackendBase {
     size_t sqGroupNumThreads{1};
     size_t initialProvidedBuffersCount{0};
     size_t initialProvidedBuffersEachSize{0};
+    size_t maxProvidedBuffersCount{0};
 
     uint32_t flags{0};
 
@@ -256,6 +265,7 @@ class IoUringBackend : public EventBaseBackendBase {
   static bool isAvailable();
   bool kernelHasNonBlockWriteFixes() const;
   static bool kernelSupportsRecvmsgMultishot();
+  static bool kernelSupportsAcceptMultishot();
   static bool kernelSupportsDeferTaskrun();
   static bool kernelSupportsSendZC();
 
@@ -562,6 +572,18 @@ class IoUringBackend : public EventBaseBackendBase {
               return;
             }
             break;
+          case EventCallback::Type::TYPE_ACCEPT_MULTISHOT:
+            // without kernel support fall back to polling for readability
+            if (kernelSupportsAcceptMultishot()) {
+              if (auto* hdr =
+                      cb.acceptMultishotCb_->allocateAcceptMultishotData()) {
+                prepAcceptMultishot(
+                    sqe, ev->ev_fd, (ev->ev_events & EV_PERSIST) != 0);
+                cbData_.set(hdr);
+                return;
+              }
+            }
+            break;
         }
         prepPollAdd(sqe, ev->ev_fd, getPollFlags(ev->ev_events));
       }
@@ -575,6 +597,7 @@ class IoUringBackend : public EventBaseBackendBase {
         EventReadCallback::IoVec* ioVec_;
         EventRecvmsgCallback::MsgHdr* msgHdr_;
         EventRecvmsgMultishotCallback::Hdr* hdr_;
+        EventAcceptMultishotCallback::Hdr* acceptHdr_;
       };
 
       void set(EventReadCallback::IoVec* ioVec) {
@@ -592,6 +615,11 @@ class IoUringBackend : public EventBaseBackendBase {
         hdr_ = hdr;
       }
 
+      void set(EventAcceptMultishotCallback::Hdr* hdr) {
+        type_ = EventCallback::Type::TYPE_ACCEPT_MULTISHOT;
+        acceptHdr_ = hdr;
+      }
+
       void reset() { type_ = EventCallback::Type::TYPE_NONE; }
 
       bool processCb(IoUringBackend* backend, int res, uint32_t flags) {
@@ -625,6 +653,15 @@ class IoUringBackend : public EventBaseBackendBase {
             }
             break;
           }
+          case EventCallback::Type::TYPE_ACCEPT_MULTISHOT: {
+            ret = true;
+            acceptHdr_->cbFunc_(acceptHdr_, res);
+            if (!(flags & IORING_CQE_F_MORE)) {
+              acceptHdr_->freeFunc_(acceptHdr_);
+              released = true;
+            }
+            break;
+          }
           case EventCallback::Type::TYPE_NONE:
             break;
         }
@@ -651,6 +688,9 @@ class IoUringBackend : public EventBaseBackendBase {
           case EventCallback::Type::TYPE_RECVMSG_MULTISHOT:
             hdr_->freeFunc_(hdr_);
             break;
+          case EventCallback::Type::TYPE_ACCEPT_MULTISHOT:
+            acceptHdr_->freeFunc_(acceptHdr_);
+            break;
           case EventCallback::Type::TYPE_NONE:
             break;
         }
@@ -746,6 +786,22 @@ class IoUringBackend : public EventBaseBackendBase {
       ::io_uring_sqe_set_data(sqe, this);
     }
 
+    void prepAcceptMultishot(
+        struct io_uring_sqe* sqe, int fd, bool registerFd) noexcept {
+      prepUtilFunc(
+          ::io_uring_prep_accept,
+          sqe,
+          registerFd,
+          fd,
+          static_cast<struct sockaddr*>(nullptr),
+          static_cast<socklen_t*>(nullptr),
+          SOCK_NONBLOCK);
+      // IORING_ACCEPT_MULTISHOT, hardcoded for the same reason as in
+      // prepRecvmsgMultishot
+      constexpr uint16_t kMultishotFlag = 1U << 0;
+      sqe->ioprio |= kMultishotFlag;
+    }
+
     FOLLY_ALWAYS_INLINE void prepCancel(
         struct io_uring_sqe* sqe, IoSqe* cancel_sqe) {
       CHECK(sqe);
@@ -84,19 +84,27 @@ IoUringProvidedBufferRing::IoUringProvidedBufferRing(
     uint16_t gid,
     int count,
     int bufferShift,
-    int ringSizeShift)
+    int ringSizeShift,
+    int maxCount)
     : IoUringBufferProviderBase(
           gid, ProvidedBuffersBuffer::calcBufferSize(bufferShift)),
       ioRingPtr_(ioRingPtr),
-      buffer_(count, bufferShift, ringSizeShift, true) {
-  if (count > std::numeric_limits<uint16_t>::max()) {
+      // pages for buffers past `count` are only faulted in once they are
+      // handed to the kernel
+      buffer_(std::max(count, maxCount), bufferShift, ringSizeShift, true) {
+  uint32_t const reserved = buffer_.bufferCount();
+  if (reserved > std::numeric_limits<uint16_t>::max()) {
     throw std::runtime_error("too many buffers");
   }
   if (count <= 0) {
     throw std::runtime_error("not enough buffers");
   }
+  if (reserved > buffer_.ringCount()) {
+    throw std::runtime_error("ring too small for buffers");
+  }
 
-  ioBufCallbacks_.assign((count + (sizeof(void*) - 1)) / sizeof(void*), this);
+  ioBufCallbacks_.assign(
+      (reserved + (sizeof(void*) - 1)) / sizeof(void*), this);
 
   initialRegister();
 
@@ -104,9 +112,27 @@ IoUringProvidedBufferRing::IoUringProvidedBufferRing(
   for (int i = 0; i < count; i++) {
     returnBuffer(i);
   }
+  activeCount_.store(count, std::memory_order_relaxed);
+}
+
+void IoUringProvidedBufferRing::grow() noexcept {
+  uint32_t const current = activeCount_.load(std::memory_order_relaxed);
+  uint32_t const next = std::min(current * 2, buffer_.bufferCount());
+  gottenBuffers_ += next - current;
+  for (uint32_t i = current; i < next; i++) {
+    returnBuffer(static_cast<uint16_t>(i));
+  }
+  activeCount_.store(next, std::memory_order_relaxed);
+  VLOG(2) << "grew provided buffer ring from " << current << " to " << next
+          << " buffers";
 }
 
 void IoUringProvidedBufferRing::enobuf() noexcept {
+  if (count() < buffer_.bufferCount()) {
+    // the kernel ran out of buffers while we still have some in reserve
+    grow();
+    return;
+  }
   {
     // what we want to do is something like
     // if (cachedTail_ != localTail_) {
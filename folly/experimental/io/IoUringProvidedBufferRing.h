@@ -33,25 +33,36 @@ class IoUringProvidedBufferRing : public IoUringBufferProviderBase {
     using std::runtime_error::runtime_error;
   };
 
+  /**
+   * Registers `count` buffers of 2^bufferShift bytes each. If `maxCount` is
+   * larger than `count`, memory for `maxCount` buffers is reserved up front
+   * and the number of registered buffers doubles every time enobuf() is
+   * called until it reaches `maxCount`. The ring must be large enough to
+   * hold all of them.
+   */
   IoUringProvidedBufferRing(
       io_uring* ioRingPtr,
       uint16_t gid,
       int count,
       int bufferShift,
-      int ringSizeShift);
+      int ringSizeShift,
+      int maxCount = 0);
 
   void enobuf() noexcept override;
   void unusedBuf(uint16_t i) noexcept override;
   void destroy() noexcept override;
   std::unique_ptr<IOBuf> getIoBuf(uint16_t i, size_t length) noexcept override;
 
-  uint32_t count() const noexcept override { return buffer_.bufferCount(); }
+  uint32_t count() const noexcept override {
+    return activeCount_.load(std::memory_order_relaxed);
+  }
   bool available() const noexcept override {
     return !enobuf_.load(std::memory_order_relaxed);
   }
 
  private:
   void initialRegister();
+  void grow() noexcept;
   void returnBufferInShutdown() noexcept;
   void returnBuffer(uint16_t i) noexcept;
 
@@ -115,6 +126,7 @@ class IoUringProvidedBufferRing : public IoUringBufferProviderBase {
   io_uring* ioRingPtr_;
   ProvidedBuffersBuffer buffer_;
   std::atomic<bool> enobuf_{false};
+  std::atomic<uint32_t> activeCount_{0};
   std::vector<IoUringProvidedBufferRing*> ioBufCallbacks_;
 
   uint64_t gottenBuffers_{0};
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/resource.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
+#include <folly/experimental/io/AsyncIoUringSocket.h>
+#include <folly/experimental/io/IoUringBackend.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/net/NetOps.h>
+#include <folly/portability/GFlags.h>
+
+DEFINE_int32(idle_connections, 10000, "connections that never see data");
+DEFINE_int32(hot_connections, 1000, "connections written to every iteration");
+DEFINE_int32(message_size, 64, "bytes written to each hot connection");
+DEFINE_int32(provided_buffers, 256, "initial number of provided buffers");
+DEFINE_int32(max_provided_buffers, 4096, "maximum number of provided buffers");
+
+using namespace folly;
+
+namespace {
+
+class CountingReadCallback : public AsyncTransport::ReadCallback {
+ public:
+  explicit CountingReadCallback(size_t& received) : received_(received) {}
+
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf_;
+    *lenReturn = sizeof(buf_);
+  }
+
+  void readDataAvailable(size_t len) noexcept override { received_ += len; }
+
+  bool isBufferMovable() noexcept override { return true; }
+
+  void readBufferAvailable(std::unique_ptr<IOBuf> buf) noexcept override {
+    // returns provided buffers to the ring on destruction
+    received_ += buf->computeChainDataLength();
+  }
+
+  void readEOF() noexcept override {}
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    LOG(FATAL) << ex;
+  }
+
+ private:
+  size_t& received_;
+  char buf_[4096];
+};
+
+std::unique_ptr<EventBaseBackendBase> makeIoUringBackend() {
+  return std::make_unique<IoUringBackend>(
+      IoUringBackend::Options{}
+          .setInitialProvidedBuffers(4096, FLAGS_provided_buffers)
+          .setMaxProvidedBuffers(FLAGS_max_provided_buffers));
+}
+
+// The server side of every connection is read by a transport on one
+// EventBase, the client side is a plain fd written to by the benchmark.
+class Harness {
+ public:
+  explicit Harness(bool ioUring) {
+    if (ioUring) {
+      evb_ = std::make_unique<EventBase>(
+          EventBase::Options{}.setBackendFactory(makeIoUringBackend));
+    } else {
+      evb_ = std::make_unique<EventBase>();
+    }
+
+    size_t total = FLAGS_idle_connections + FLAGS_hot_connections;
+    for (size_t i = 0; i < total; i++) {
+      NetworkSocket fds[2];
+      PCHECK(netops::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+      AsyncTransport::UniquePtr server;
+      if (ioUring) {
+        server = AsyncTransport::UniquePtr(new AsyncIoUringSocket(
+            AsyncSocket::newSocket(evb_.get(), fds[0])));
+      } else {
+        server = AsyncTransport::UniquePtr(
+            AsyncSocket::newSocket(evb_.get(), fds[0]));
+      }
+      callbacks_.push_back(std::make_unique<CountingReadCallback>(received_));
+      server->setReadCB(callbacks_.back().get());
+      servers_.push_back(std::move(server));
+      if (i >= size_t(FLAGS_idle_connections)) {
+        hotClients_.push_back(fds[1]);
+      } else {
+        idleClients_.push_back(fds[1]);
+      }
+    }
+    message_.assign(FLAGS_message_size, 'x');
+    // let the read requests of every connection reach the kernel
+    evb_->loopOnce(EVLOOP_NONBLOCK);
+  }
+
+  ~Harness() {
+    servers_.clear();
+    for (auto fd : idleClients_) {
+      netops::close(fd);
+    }
+    for (auto fd : hotClients_) {
+      netops::close(fd);
+    }
+  }
+
+  void iteration() {
+    for (auto fd : hotClients_) {
+      CHECK_EQ(
+          ssize_t(message_.size()),
+          writeFull(fd.toFd(), message_.data(), message_.size()));
+    }
+    size_t const target = received_ + hotClients_.size() * message_.size();
+    while (received_ < target) {
+      evb_->loopOnce();
+    }
+  }
+
+ private:
+  std::unique_ptr<EventBase> evb_;
+  std::vector<std::unique_ptr<CountingReadCallback>> callbacks_;
+  std::vector<AsyncTransport::UniquePtr> servers_;
+  std::vector<NetworkSocket> idleClients_;
+  std::vector<NetworkSocket> hotClients_;
+  std::string message_;
+  size_t received_{0};
+};
+
+void run(size_t iters, bool ioUring) {
+  BenchmarkSuspender braces;
+  std::unique_ptr<Harness> harness;
+  try {
+    harness = std::make_unique<Harness>(ioUring);
+  } catch (IoUringBackend::NotAvailable const& ex) {
+    LOG(ERROR) << "io_uring not available: " << ex.what();
+    return;
+  }
+  braces.dismiss();
+  for (size_t i = 0; i < iters; i++) {
+    harness->iteration();
+  }
+  braces.rehire();
+}
+
+} // namespace
+
+BENCHMARK(epollAsyncSocket, iters) {
+  run(iters, false);
+}
+
+BENCHMARK_RELATIVE(ioUringMultishotRecv, iters) {
+  run(iters, true);
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  // two descriptors per connection
+  struct rlimit rl;
+  if (::getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+    rl.rlim_cur = rl.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &rl);
+  }
+  folly::runBenchmarks();
+  return 0;
+}
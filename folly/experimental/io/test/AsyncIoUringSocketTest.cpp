@@ -18,6 +18,7 @@
 #include <chrono>
 #include <map>
 #include <random>
+#include <set>
 #include <vector>
 
 #include <folly/FileUtil.h>
@@ -31,6 +32,7 @@
 #include <folly/io/async/AsyncServerSocket.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <folly/io/async/EventBase.h>
+#include <folly/portability/Fcntl.h>
 #include <folly/portability/GTest.h>
 #include <folly/system/Shell.h>
 #include <folly/test/SocketAddressTestHelper.h>
@@ -601,6 +603,132 @@ TEST_P(AsyncIoUringSocketTest, DetachEventBaseClear) {
   base->loopOnce(EVLOOP_NONBLOCK);
 }
 
+TEST_P(AsyncIoUringSocketTest, MultishotAccept) {
+  MAYBE_SKIP();
+  struct AcceptCallback : AsyncServerSocket::AcceptCallback {
+    void connectionAccepted(
+        NetworkSocket ns,
+        const SocketAddress& addr,
+        AcceptInfo) noexcept override {
+      accepted.emplace_back(ns, addr);
+    }
+    void acceptError(exception_wrapper ex) noexcept override {
+      LOG(FATAL) << ex;
+    }
+    std::vector<std::pair<NetworkSocket, SocketAddress>> accepted;
+  } acceptCallback;
+
+  if (!IoUringBackend::kernelSupportsAcceptMultishot()) {
+    GTEST_SKIP() << "Multishot accept is not supported";
+  }
+
+  auto multishotServer = AsyncServerSocket::newSocket(base.get());
+  multishotServer->setMultishotAccept(true);
+  // The accept4() loop run on readability accepts nothing, so connections
+  // can only come from the multishot request.
+  multishotServer->setMaxAcceptAtOnce(0);
+  multishotServer->bind(0);
+  multishotServer->listen(16);
+  multishotServer->addAcceptCallback(&acceptCallback, nullptr);
+  multishotServer->startAccepting();
+  SocketAddress address;
+  multishotServer->getAddress(&address);
+
+  constexpr size_t kClients = 8;
+  std::vector<AsyncSocket::UniquePtr> clients;
+  for (size_t i = 0; i < kClients; i++) {
+    clients.push_back(AsyncSocket::newSocket(base.get(), address));
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (acceptCallback.accepted.size() < kClients &&
+         std::chrono::steady_clock::now() < deadline) {
+    base->loopOnce(EVLOOP_NONBLOCK);
+  }
+  ASSERT_EQ(kClients, acceptCallback.accepted.size());
+
+  std::set<SocketAddress> expected;
+  for (auto& client : clients) {
+    SocketAddress localAddress;
+    client->getLocalAddress(&localAddress);
+    expected.insert(localAddress);
+  }
+  std::set<SocketAddress> actual;
+  for (auto& [ns, addr] : acceptCallback.accepted) {
+    actual.insert(addr);
+    int flags = ::fcntl(ns.toFd(), F_GETFL, 0);
+    EXPECT_EQ(O_NONBLOCK, flags & O_NONBLOCK);
+    netops::close(ns);
+  }
+  EXPECT_EQ(expected, actual);
+}
+
+TEST_P(AsyncIoUringSocketTest, MultishotAcceptReset) {
+  MAYBE_SKIP();
+  struct AcceptCallback : AsyncServerSocket::AcceptCallback {
+    void connectionAccepted(
+        NetworkSocket ns, const SocketAddress&, AcceptInfo) noexcept override {
+      accepted.push_back(ns);
+    }
+    void acceptError(exception_wrapper ex) noexcept override {
+      LOG(FATAL) << ex;
+    }
+    std::vector<NetworkSocket> accepted;
+  } acceptCallback;
+
+  if (!IoUringBackend::kernelSupportsAcceptMultishot()) {
+    GTEST_SKIP() << "Multishot accept is not supported";
+  }
+
+  auto multishotServer = AsyncServerSocket::newSocket(base.get());
+  multishotServer->setMultishotAccept(true);
+  multishotServer->setMaxAcceptAtOnce(0);
+  multishotServer->bind(0);
+  multishotServer->listen(16);
+  multishotServer->addAcceptCallback(&acceptCallback, nullptr);
+  multishotServer->startAccepting();
+  SocketAddress address;
+  multishotServer->getAddress(&address);
+  sockaddr_storage addrStorage;
+  socklen_t addrLen = address.getAddress(&addrStorage);
+
+  // Connect and reset without running the loop, so the connections are
+  // accepted by the kernel but handled only after the RST.
+  constexpr size_t kResets = 4;
+  for (size_t i = 0; i < kResets; i++) {
+    auto fd = netops::socket(address.getFamily(), SOCK_STREAM, 0);
+    ASSERT_NE(NetworkSocket(), fd);
+    ASSERT_EQ(
+        0,
+        netops::connect(
+            fd, reinterpret_cast<sockaddr*>(&addrStorage), addrLen));
+    linger lingerOpt{1, 0};
+    ASSERT_EQ(
+        0,
+        netops::setsockopt(
+            fd, SOL_SOCKET, SO_LINGER, &lingerOpt, sizeof(lingerOpt)));
+    netops::close(fd);
+  }
+  // Give the kernel time to process the resets.
+  /* sleep override */ std::this_thread::sleep_for(
+      std::chrono::milliseconds(100));
+
+  auto client = AsyncSocket::newSocket(base.get(), address);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (acceptCallback.accepted.size() +
+                 multishotServer->getNumDroppedConnections() <
+             kResets + 1 &&
+         std::chrono::steady_clock::now() < deadline) {
+    base->loopOnce(EVLOOP_NONBLOCK);
+  }
+  // The reset connections have no peer address: they are dropped rather
+  // than taking the server down.
+  EXPECT_EQ(kResets, multishotServer->getNumDroppedConnections());
+  EXPECT_EQ(1, acceptCallback.accepted.size());
+  for (auto ns : acceptCallback.accepted) {
+    netops::close(ns);
+  }
+}
+
 TEST_P(AsyncIoUringSocketTest, FastOpen) {
   MAYBE_SKIP();
   bool had_fastopen = false;
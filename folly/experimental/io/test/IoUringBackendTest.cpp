@@ -1377,6 +1377,30 @@ TEST(IoUringBackend, SendmsgRecvmsg) {
   ::close(recvFd);
 }
 
+namespace {
+struct ProvidedBufferReader : folly::IoSqeBase {
+  ProvidedBufferReader(
+      int fd, uint16_t bgid, std::function<void(int, uint32_t)> oncqe)
+      : fd_(fd), bgid_(bgid), oncqe_(oncqe) {}
+
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    io_uring_prep_read(sqe, fd_, nullptr, 2 /* max read 2 per go */, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = bgid_;
+  }
+
+  void callback(const io_uring_cqe* cqe) noexcept override {
+    oncqe_(cqe->res, cqe->flags);
+  }
+
+  void callbackCancelled(const io_uring_cqe*) noexcept override { FAIL(); }
+
+  int fd_;
+  uint16_t bgid_;
+  std::function<void(int, uint32_t)> oncqe_;
+};
+} // namespace
+
 TEST(IoUringBackend, ProvidedBuffers) {
   auto evbPtr = getEventBase();
   std::unique_ptr<folly::IoUringBackend> backend;
@@ -1393,27 +1417,6 @@ TEST(IoUringBackend, ProvidedBuffers) {
 
   EXPECT_EQ(2, bufferProvider->count());
 
-  struct Reader : folly::IoSqeBase {
-    Reader(int fd, uint16_t bgid, std::function<void(int, uint32_t)> oncqe)
-        : fd_(fd), bgid_(bgid), oncqe_(oncqe) {}
-
-    void processSubmit(struct io_uring_sqe* sqe) noexcept override {
-      io_uring_prep_read(sqe, fd_, nullptr, 2 /* max read 2 per go */, 0);
-      sqe->flags |= IOSQE_BUFFER_SELECT;
-      sqe->buf_group = bgid_;
-    }
-
-    void callback(const io_uring_cqe* cqe) noexcept override {
-      oncqe_(cqe->res, cqe->flags);
-    }
-
-    void callbackCancelled(const io_uring_cqe*) noexcept override { FAIL(); }
-
-    int fd_;
-    uint16_t bgid_;
-    std::function<void(int, uint32_t)> oncqe_;
-  };
-
   int fds[2];
   ASSERT_EQ(0, ::pipe(fds));
   SCOPE_EXIT {
@@ -1422,10 +1425,10 @@ TEST(IoUringBackend, ProvidedBuffers) {
   };
 
   std::vector<std::pair<int, uint32_t>> cqes;
-  std::vector<std::unique_ptr<Reader>> readers;
+  std::vector<std::unique_ptr<ProvidedBufferReader>> readers;
   auto addReaders = [&](int n) {
     for (int i = 0; i < n; i++) {
-      readers.push_back(std::make_unique<Reader>(
+      readers.push_back(std::make_unique<ProvidedBufferReader>(
           fds[0], bufferProvider->gid(), [&](int r, uint32_t f) {
             cqes.emplace_back(r, f);
           }));
@@ -1460,6 +1463,85 @@ TEST(IoUringBackend, ProvidedBuffers) {
   EXPECT_EQ("56", toString(bufferProvider->getIoBuf(cqes[0].second >> 16, 2)));
 }
 
+TEST(IoUringBackend, ProvidedBuffersGrow) {
+  auto evbPtr = getEventBase();
+  std::unique_ptr<folly::IoUringBackend> backend;
+  try {
+    /* 2 buffers of size 2, growing up to 5 */
+    backend = std::make_unique<folly::IoUringBackend>(
+        folly::IoUringBackend::Options{}
+            .setInitialProvidedBuffers(2, 2)
+            .setMaxProvidedBuffers(5));
+  } catch (folly::IoUringBackend::NotAvailable const&) {
+  }
+  SKIP_IF(!backend) << "Backend not available";
+
+  auto* bufferProvider = backend->bufferProvider();
+  ASSERT_NE(bufferProvider, nullptr);
+  EXPECT_EQ(2, bufferProvider->count());
+
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+  SCOPE_EXIT {
+    ::close(fds[0]);
+    ::close(fds[1]);
+  };
+
+  std::vector<std::pair<int, uint32_t>> cqes;
+  std::vector<std::unique_ptr<ProvidedBufferReader>> readers;
+  auto addReaders = [&](int n) {
+    for (int i = 0; i < n; i++) {
+      readers.push_back(std::make_unique<ProvidedBufferReader>(
+          fds[0], bufferProvider->gid(), [&](int r, uint32_t f) {
+            cqes.emplace_back(r, f);
+          }));
+      backend->submit(*readers.back());
+    }
+  };
+
+  auto toString = [](std::unique_ptr<folly::IOBuf> const& x) -> std::string {
+    std::string ret;
+    x->appendTo(ret);
+    return ret;
+  };
+
+  // hold on to the buffers so that only growing can make progress
+  std::vector<std::unique_ptr<folly::IOBuf>> held;
+  addReaders(3);
+  ASSERT_EQ(8, ::write(fds[1], "12345678", 8));
+  backend->eb_event_base_loop(EVLOOP_ONCE);
+  ASSERT_EQ(3, cqes.size());
+  EXPECT_EQ(-ENOBUFS, cqes[2].first);
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(2, cqes[i].first);
+    held.push_back(bufferProvider->getIoBuf(cqes[i].second >> 16, 2));
+  }
+  EXPECT_EQ("12", toString(held[0]));
+  EXPECT_EQ("34", toString(held[1]));
+
+  bufferProvider->enobuf();
+  EXPECT_EQ(4, bufferProvider->count());
+  EXPECT_TRUE(bufferProvider->available());
+
+  readers.clear();
+  cqes.clear();
+  addReaders(2);
+  backend->eb_event_base_loop(EVLOOP_ONCE);
+  ASSERT_EQ(2, cqes.size());
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(2, cqes[i].first);
+    held.push_back(bufferProvider->getIoBuf(cqes[i].second >> 16, 2));
+  }
+  EXPECT_EQ("56", toString(held[2]));
+  EXPECT_EQ("78", toString(held[3]));
+
+  // capped at the maximum
+  bufferProvider->enobuf();
+  EXPECT_EQ(5, bufferProvider->count());
+  bufferProvider->enobuf();
+  EXPECT_EQ(5, bufferProvider->count());
+}
+
 TEST(IoUringBackend, ProvidedBufferRing) {
   auto evbPtr = getEventBase();
   int constexpr kBuffs = 3;
@@ -163,6 +163,36 @@ uint32_t crc32c(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
   }
 }
 
+void crc32c_batch(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum) {
+  if (!detail::crc32c_hw_supported()) {
+    for (size_t i = 0; i < count; ++i) {
+      checksums[i] = detail::crc32c_sw(data[i], nbytes[i], startingChecksum);
+    }
+    return;
+  }
+  // Buffers that crc32c() hands to the SIMD implementations above are faster
+  // on their own, runs of the others are interleaved.
+  size_t run = 0;
+#if defined(FOLLY_ENABLE_AVX512_CRC32C_V8S3X4) || \
+    defined(FOLLY_ENABLE_SSE42_CRC32C_V8S3X3)
+  for (size_t i = 0; i < count; ++i) {
+    if (nbytes[i] > 4096) {
+      detail::crc32c_hw_batch(
+          data + run, nbytes + run, i - run, checksums + run, startingChecksum);
+      checksums[i] = crc32c(data[i], nbytes[i], startingChecksum);
+      run = i + 1;
+    }
+  }
+#endif
+  detail::crc32c_hw_batch(
+      data + run, nbytes + run, count - run, checksums + run, startingChecksum);
+}
+
 uint32_t crc32(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
   if (detail::crc32_hw_supported()) {
     return detail::crc32_hw(data, nbytes, startingChecksum);
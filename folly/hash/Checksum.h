@@ -38,6 +38,23 @@ namespace folly {
 uint32_t crc32c(
     const uint8_t* data, size_t nbytes, uint32_t startingChecksum = ~0U);
 
+/**
+ * Compute the CRC-32C checksums of count independent buffers, storing the
+ * checksum of the buffer of nbytes[i] bytes at data[i] in checksums[i].
+ * Each checksum is equal to crc32c(data[i], nbytes[i], startingChecksum).
+ *
+ * With hardware acceleration, buffers of up to 4KB are checksummed three at
+ * a time, interleaving their streams to keep the CRC unit of the core busy,
+ * which is faster than calling crc32c() for each when checksumming many
+ * small buffers, e.g. the blocks of a batch of writes.
+ */
+void crc32c_batch(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum = ~0U);
+
 /**
  * Compute the CRC-32 checksum of a buffer, using a hardware-accelerated
  * implementation if available or a portable software implementation as
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/hash/ParallelChecksum.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/detail/ParallelForEach.h>
+#include <folly/hash/Checksum.h>
+
+namespace folly {
+
+uint32_t crc32c_parallel(
+    const uint8_t* data,
+    size_t nbytes,
+    Executor::KeepAlive<> executor,
+    size_t chunkSize,
+    uint32_t startingChecksum) {
+  if (chunkSize == 0) {
+    throw std::invalid_argument("crc32c_parallel: chunkSize is 0");
+  }
+  if (nbytes <= chunkSize) {
+    return crc32c(data, nbytes, startingChecksum);
+  }
+
+  size_t numChunks = (nbytes + chunkSize - 1) / chunkSize;
+  auto chunkLength = [&](size_t i) {
+    return std::min(chunkSize, nbytes - i * chunkSize);
+  };
+  std::vector<uint32_t> checksums(numChunks);
+  detail::parallelForEach(
+      numChunks, std::move(executor), numChunks, [&](size_t i, size_t) {
+        // The first chunk carries the starting checksum, the others start
+        // from 0, see crc32c_combine().
+        checksums[i] = crc32c(
+            data + i * chunkSize, chunkLength(i), i == 0 ? startingChecksum : 0);
+      });
+
+  uint32_t checksum = checksums[0];
+  for (size_t i = 1; i < numChunks; ++i) {
+    checksum = crc32c_combine(checksum, checksums[i], chunkLength(i));
+  }
+  return checksum;
+}
+
+} // namespace folly
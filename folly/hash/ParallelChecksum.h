@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstddef>
+
+#include <folly/Executor.h>
+
+namespace folly {
+
+/**
+ * Compute the CRC-32C checksum of a large buffer on an executor: the buffer
+ * is split into chunks of chunkSize bytes, which are checksummed by
+ * crc32c() in parallel and joined by crc32c_combine().  Chunks are handed
+ * out by detail::parallelForEach(), so the calling thread checksums chunks
+ * as well.
+ *
+ * The result is equal to crc32c(data, nbytes, startingChecksum).  Buffers
+ * of at most chunkSize bytes are checksummed on the calling thread.
+ *
+ * Throws std::invalid_argument if chunkSize is 0.
+ */
+uint32_t crc32c_parallel(
+    const uint8_t* data,
+    size_t nbytes,
+    Executor::KeepAlive<> executor,
+    size_t chunkSize = 4 << 20,
+    uint32_t startingChecksum = ~0U);
+
+} // namespace folly
@@ -42,6 +42,21 @@ namespace detail {
 uint32_t crc32c_hw(
     const uint8_t* data, size_t nbytes, uint32_t startingChecksum = ~0U);
 
+/**
+ * Compute the CRC-32C checksums of count buffers using a hardware-accelerated
+ * implementation that interleaves the checksums of three buffers at a time.
+ * See crc32c_batch() in Checksum.h.
+ *
+ * @note As for crc32c_hw(), call crc32c_batch() instead unless absolutely
+ *       certain the hardware-accelerated implementation ought to be used.
+ */
+void crc32c_hw_batch(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum = ~0U);
+
 /**
  * Check whether a SSE4.2 hardware-accelerated CRC-32C implementation is
  * supported on the current CPU.
@@ -29,6 +29,8 @@
  * other code cleanup
  */
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/preprocessor/arithmetic/add.hpp>
@@ -286,6 +288,83 @@ uint32_t crc32c_hw(const uint8_t* buf, size_t len, uint32_t crc) {
   return (uint32_t)crc0;
 }
 
+namespace crc32_detail {
+
+FOLLY_ALWAYS_INLINE uint64_t load_u64(const uint8_t* p) {
+  uint64_t word;
+  std::memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+// Computes the crcs of three independent buffers over their common length,
+// a word of each in turn.  The crc32 instruction has a latency of 3 cycles
+// and a throughput of 1 per cycle, so three streams keep it busy, which
+// crc32c_hw() only does for buffers of more than 216 bytes and at the cost
+// of combining the streams of each block.  The rest of each buffer is
+// finished on its own.
+FOLLY_TARGET_ATTRIBUTE("sse4.2")
+void triplet_batch(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    uint32_t* checksums,
+    uint32_t crc) {
+  const size_t common = std::min({nbytes[0], nbytes[1], nbytes[2]}) & ~7;
+  const uint8_t* next0 = data[0];
+  const uint8_t* next1 = data[1];
+  const uint8_t* next2 = data[2];
+  uint64_t crc0 = crc, crc1 = crc, crc2 = crc;
+  for (size_t i = 0; i < common; i += 8) {
+    crc0 = _mm_crc32_u64(crc0, load_u64(next0 + i));
+    crc1 = _mm_crc32_u64(crc1, load_u64(next1 + i));
+    crc2 = _mm_crc32_u64(crc2, load_u64(next2 + i));
+  }
+  checksums[0] = crc32c_hw(next0 + common, nbytes[0] - common, uint32_t(crc0));
+  checksums[1] = crc32c_hw(next1 + common, nbytes[1] - common, uint32_t(crc1));
+  checksums[2] = crc32c_hw(next2 + common, nbytes[2] - common, uint32_t(crc2));
+}
+
+FOLLY_TARGET_ATTRIBUTE("sse4.2")
+void duplet_batch(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    uint32_t* checksums,
+    uint32_t crc) {
+  const size_t common = std::min(nbytes[0], nbytes[1]) & ~7;
+  const uint8_t* next0 = data[0];
+  const uint8_t* next1 = data[1];
+  uint64_t crc0 = crc, crc1 = crc;
+  for (size_t i = 0; i < common; i += 8) {
+    crc0 = _mm_crc32_u64(crc0, load_u64(next0 + i));
+    crc1 = _mm_crc32_u64(crc1, load_u64(next1 + i));
+  }
+  checksums[0] = crc32c_hw(next0 + common, nbytes[0] - common, uint32_t(crc0));
+  checksums[1] = crc32c_hw(next1 + common, nbytes[1] - common, uint32_t(crc1));
+}
+
+} // namespace crc32_detail
+
+void crc32c_hw_batch(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum) {
+  size_t i = 0;
+  for (; i + 3 <= count; i += 3) {
+    crc32_detail::triplet_batch(
+        data + i, nbytes + i, checksums + i, startingChecksum);
+  }
+  switch (count - i) {
+    case 2:
+      crc32_detail::duplet_batch(
+          data + i, nbytes + i, checksums + i, startingChecksum);
+      break;
+    case 1:
+      checksums[i] = crc32c_hw(data[i], nbytes[i], startingChecksum);
+      break;
+  }
+}
+
 #else
 
 uint32_t crc32c_hw(
@@ -293,6 +372,16 @@ uint32_t crc32c_hw(
   throw std::runtime_error("crc32_hw is not implemented on this platform");
 }
 
+void crc32c_hw_batch(
+    const uint8_t* const* /* data */,
+    const size_t* /* nbytes */,
+    size_t /* count */,
+    uint32_t* /* checksums */,
+    uint32_t /* startingChecksum */) {
+  throw std::runtime_error(
+      "crc32c_hw_batch is not implemented on this platform");
+}
+
 #endif
 
 } // namespace detail
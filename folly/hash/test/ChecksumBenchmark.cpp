@@ -14,14 +14,25 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <random>
+#include <thread>
+#include <vector>
 #include <glog/logging.h>
 #include <folly/Benchmark.h>
 #include <folly/Memory.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/external/fast-crc32/avx512_crc32c_v8s3x4.h>
+#include <folly/external/fast-crc32/sse_crc32c_v8s3x3.h>
 #include <folly/hash/Checksum.h>
+#include <folly/hash/ParallelChecksum.h>
+#include <folly/hash/detail/ChecksumDetail.h>
 
 constexpr size_t kBufSize = 512 * 1024;
 uint8_t* buf;
+constexpr size_t kLargeBufSize = 64 * 1024 * 1024;
+uint8_t* largeBuf;
+folly::CPUThreadPoolExecutor* executor;
 
 #define BENCH_CRC32(S)                                   \
   BENCHMARK(crc32_##S) {                                 \
@@ -57,6 +68,109 @@ BENCH_CRC32C(131072)
 BENCH_CRC32C(262144)
 BENCH_CRC32C(524288)
 
+BENCHMARK_DRAW_LINE();
+
+// Many independent blocks, as when checksumming the blocks of a batch of
+// writes: one call per block to crc32c() and to each of its implementations,
+// against a single call to crc32c_batch().
+using Crc32cFn = uint32_t (*)(const uint8_t*, size_t, uint32_t);
+
+size_t numBlocks(size_t blockSize) {
+  return std::min<size_t>(128, kBufSize / blockSize);
+}
+
+void crc32cBlocks(size_t iters, size_t blockSize, Crc32cFn fn) {
+  for (size_t i = 0; i < iters; ++i) {
+    for (size_t b = 0; b < numBlocks(blockSize); ++b) {
+      folly::doNotOptimizeAway(fn(buf + b * blockSize, blockSize, 2));
+    }
+  }
+}
+
+void crc32c_loop(size_t iters, size_t blockSize) {
+  crc32cBlocks(iters, blockSize, folly::crc32c);
+}
+
+void crc32c_hw_loop(size_t iters, size_t blockSize) {
+  if (!folly::detail::crc32c_hw_supported()) {
+    LOG_FIRST_N(WARNING, 1) << "skipping hardware CRC-32C benchmarks"
+                            << " (not supported on this CPU)";
+    return;
+  }
+  crc32cBlocks(iters, blockSize, folly::detail::crc32c_hw);
+}
+
+#if defined(FOLLY_ENABLE_SSE42_CRC32C_V8S3X3)
+void crc32c_sse42_loop(size_t iters, size_t blockSize) {
+  crc32cBlocks(iters, blockSize, folly::detail::sse_crc32c_v8s3x3);
+}
+#endif
+
+#if defined(FOLLY_ENABLE_AVX512_CRC32C_V8S3X4)
+void crc32c_avx512_loop(size_t iters, size_t blockSize) {
+  if (!folly::detail::crc32c_hw_supported_avx512()) {
+    LOG_FIRST_N(WARNING, 1) << "skipping AVX512 CRC-32C benchmarks"
+                            << " (not supported on this CPU)";
+    return;
+  }
+  crc32cBlocks(iters, blockSize, folly::detail::avx512_crc32c_v8s3x4);
+}
+#endif
+
+void crc32c_batch(size_t iters, size_t blockSize) {
+  std::vector<const uint8_t*> data;
+  std::vector<size_t> nbytes;
+  std::vector<uint32_t> checksums(numBlocks(blockSize));
+  BENCHMARK_SUSPEND {
+    for (size_t b = 0; b < numBlocks(blockSize); ++b) {
+      data.push_back(buf + b * blockSize);
+      nbytes.push_back(blockSize);
+    }
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    folly::crc32c_batch(
+        data.data(), nbytes.data(), data.size(), checksums.data(), 2);
+    folly::doNotOptimizeAway(checksums);
+  }
+}
+
+#if defined(FOLLY_ENABLE_SSE42_CRC32C_V8S3X3)
+#define BENCH_CRC32C_SSE42_LOOP(S) \
+  BENCHMARK_RELATIVE_NAMED_PARAM(crc32c_sse42_loop, S, S)
+#else
+#define BENCH_CRC32C_SSE42_LOOP(S)
+#endif
+
+#if defined(FOLLY_ENABLE_AVX512_CRC32C_V8S3X4)
+#define BENCH_CRC32C_AVX512_LOOP(S) \
+  BENCHMARK_RELATIVE_NAMED_PARAM(crc32c_avx512_loop, S, S)
+#else
+#define BENCH_CRC32C_AVX512_LOOP(S)
+#endif
+
+#define BENCH_CRC32C_BLOCKS(S)                         \
+  BENCHMARK_NAMED_PARAM(crc32c_loop, S, S)             \
+  BENCHMARK_RELATIVE_NAMED_PARAM(crc32c_hw_loop, S, S) \
+  BENCH_CRC32C_SSE42_LOOP(S)                           \
+  BENCH_CRC32C_AVX512_LOOP(S)                          \
+  BENCHMARK_RELATIVE_NAMED_PARAM(crc32c_batch, S, S)   \
+  BENCHMARK_DRAW_LINE();
+
+BENCH_CRC32C_BLOCKS(64)
+BENCH_CRC32C_BLOCKS(512)
+BENCH_CRC32C_BLOCKS(4096)
+BENCH_CRC32C_BLOCKS(16384)
+
+// One large buffer split into chunks checksummed on a thread pool.
+BENCHMARK(crc32c_64MB) {
+  folly::doNotOptimizeAway(folly::crc32c(largeBuf, kLargeBufSize, 2));
+}
+
+BENCHMARK_RELATIVE(crc32c_parallel_64MB) {
+  folly::doNotOptimizeAway(
+      folly::crc32c_parallel(largeBuf, kLargeBufSize, executor, 4 << 20, 2));
+}
+
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   google::InitGoogleLogging(argv[0]);
@@ -66,9 +180,17 @@ int main(int argc, char** argv) {
   std::default_random_engine rng(1729); // Deterministic seed.
   std::uniform_int_distribution<uint16_t> dist(0, 255);
   std::generate(buf, buf + kBufSize, [&]() { return dist(rng); });
+  largeBuf = static_cast<uint8_t*>(folly::aligned_malloc(kLargeBufSize, 4096));
+  for (size_t i = 0; i < kLargeBufSize; i += kBufSize) {
+    std::copy(buf, buf + kBufSize, largeBuf + i);
+  }
+  executor = new folly::CPUThreadPoolExecutor(
+      std::max(1u, std::thread::hardware_concurrency()));
 
   folly::runBenchmarks();
 
+  delete executor;
+  folly::aligned_free(largeBuf);
   folly::aligned_free(buf);
 
   return 0;
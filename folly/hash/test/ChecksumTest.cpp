@@ -16,13 +16,21 @@
 
 #include <folly/hash/Checksum.h>
 
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
 #include <boost/crc.hpp>
 
 #include <folly/Benchmark.h>
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/InlineExecutor.h>
 #include <folly/external/fast-crc32/avx512_crc32c_v8s3x4.h>
 #include <folly/external/fast-crc32/sse_crc32c_v8s3x3.h>
 #include <folly/hash/Hash.h>
+#include <folly/hash/ParallelChecksum.h>
 #include <folly/hash/detail/ChecksumDetail.h>
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GTest.h>
@@ -311,6 +319,104 @@ TEST(Checksum, crc32cCombine) {
   }
 }
 
+namespace {
+
+using BatchImpl = std::function<void(
+    const uint8_t* const*, const size_t*, size_t, uint32_t*, uint32_t)>;
+
+void testCRC32CBatch(BatchImpl impl) {
+  // Buffers of mixed alignments and lengths, including empty ones and ones
+  // larger than 4KB, so that interleaved buffers end at different points.
+  std::vector<const uint8_t*> data;
+  std::vector<size_t> nbytes;
+  for (size_t i = 0; i < 200; ++i) {
+    data.push_back(buffer + i * 64 + folly::Random::rand32(64));
+    nbytes.push_back(
+        i % 7 == 0 ? folly::Random::rand32(20000)
+                   : folly::Random::rand32(5000));
+  }
+  nbytes[3] = 0;
+  for (size_t count : {0, 1, 2, 3, 4, 5, 200}) {
+    std::vector<uint32_t> checksums(count);
+    impl(data.data(), nbytes.data(), count, checksums.data(), 42);
+    for (size_t i = 0; i < count; ++i) {
+      ASSERT_EQ(
+          folly::detail::crc32c_sw(data[i], nbytes[i], 42), checksums[i])
+          << "count " << count << " buffer " << i;
+    }
+  }
+}
+
+} // namespace
+
+TEST(Checksum, crc32cBatchHardware) {
+  if (folly::detail::crc32c_hw_supported()) {
+    testCRC32CBatch(folly::detail::crc32c_hw_batch);
+  } else {
+    LOG(WARNING) << "skipping hardware-accelerated CRC-32C tests"
+                 << " (not supported on this CPU)";
+  }
+}
+
+TEST(Checksum, crc32cBatchAutodetect) {
+  testCRC32CBatch(folly::crc32c_batch);
+}
+
+TEST(Checksum, crc32cParallel) {
+  folly::CPUThreadPoolExecutor executor(4);
+  std::pair<size_t, size_t> cases[] = {
+      // {nbytes, chunkSize}
+      {0, 1000},
+      {1, 1000},
+      {999, 1000},
+      {1000, 1000},
+      {1001, 1000},
+      {100, 1},
+      {3 * 4096 + 5, 4096},
+      {BUFFER_SIZE, 1 << 20},
+      {BUFFER_SIZE - 3, 100000},
+  };
+  for (auto [nbytes, chunkSize] : cases) {
+    EXPECT_EQ(
+        folly::crc32c(buffer, nbytes, 7),
+        folly::crc32c_parallel(buffer, nbytes, &executor, chunkSize, 7))
+        << nbytes << " bytes in chunks of " << chunkSize;
+  }
+  // The calling thread takes part, so an inline executor works too.
+  EXPECT_EQ(
+      folly::crc32c(buffer, BUFFER_SIZE),
+      folly::crc32c_parallel(
+          buffer, BUFFER_SIZE, &folly::InlineExecutor::instance(), 65536));
+  EXPECT_THROW(
+      folly::crc32c_parallel(buffer, 10, &executor, 0), std::invalid_argument);
+}
+
+TEST(Checksum, crc32cParallelAddThrows) {
+  // Holds the tasks added and fails the third add.
+  struct FailingExecutor : folly::Executor {
+    void add(folly::Func f) override {
+      if (tasks.size() == 2) {
+        throw std::runtime_error("queue full");
+      }
+      tasks.push_back(std::move(f));
+    }
+    std::vector<folly::Func> tasks;
+  };
+  FailingExecutor executor;
+  auto data = std::make_unique<std::vector<uint8_t>>(
+      buffer, buffer + 10 * 1000);
+  EXPECT_THROW(
+      folly::crc32c_parallel(data->data(), data->size(), &executor, 1000),
+      std::runtime_error);
+  // The calling thread checksummed every chunk before rethrowing, so the
+  // tasks left don't read the buffer.
+  data.reset();
+  EXPECT_EQ(2, executor.tasks.size());
+  for (auto& task : executor.tasks) {
+    task();
+  }
+}
+
 void benchmarkHardwareCRC32C(unsigned long iters, size_t blockSize) {
   if (folly::detail::crc32c_hw_supported()) {
     uint32_t checksum;
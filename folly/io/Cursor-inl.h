@@ -63,6 +63,64 @@ std::string CursorBase<Derived, BufType>::readTerminatedString(
   return result;
 }
 
+template <class Derived, class BufType>
+size_t CursorBase<Derived, BufType>::pullAtMostVectorized(
+    const struct iovec* iov, size_t iovcnt) {
+  size_t copied = 0;
+  for (size_t i = 0; i < iovcnt; ++i) {
+    auto n = pullAtMost(iov[i].iov_base, iov[i].iov_len);
+    copied += n;
+    if (n < iov[i].iov_len) {
+      break;
+    }
+  }
+  return copied;
+}
+
+template <class Derived, class BufType>
+template <typename Fn>
+void CursorBase<Derived, BufType>::visitChunks(size_t len, Fn&& fn) {
+  if (FOLLY_UNLIKELY(!canAdvance(len))) {
+    throw_exception<std::out_of_range>("underflow");
+  }
+  while (len > 0) {
+    auto chunk = peekBytes();
+    chunk.reset(chunk.data(), std::min(len, chunk.size()));
+    fn(chunk);
+    skip(chunk.size());
+    len -= chunk.size();
+  }
+}
+
+template <class Derived, class BufType>
+template <class T, typename Fn>
+void CursorBase<Derived, BufType>::visitArray(size_t count, Fn&& fn) {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "visitArray() requires trivially copyable values");
+  if (FOLLY_UNLIKELY(
+          count > std::numeric_limits<size_t>::max() / sizeof(T) ||
+          !canAdvance(count * sizeof(T)))) {
+    throw_exception<std::out_of_range>("underflow");
+  }
+  while (count > 0) {
+    auto chunk = peekBytes();
+    size_t n = std::min(count, chunk.size() / sizeof(T));
+    if (FOLLY_LIKELY(n > 0)) {
+      chunk.reset(chunk.data(), n * sizeof(T));
+      fn(chunk);
+      skip(chunk.size());
+      count -= n;
+    } else {
+      // The next value is split across IOBufs.
+      alignas(T) uint8_t value[sizeof(T)];
+      pull(value, sizeof(T));
+      fn(ByteRange(value, sizeof(T)));
+      --count;
+    }
+  }
+}
+
 template <class Derived, class BufType>
 template <typename Predicate>
 std::string CursorBase<Derived, BufType>::readWhile(
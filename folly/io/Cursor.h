@@ -641,6 +641,100 @@ class CursorBase {
     }
   }
 
+  /**
+   * Copies from the cursor into the given iovecs, filling each one before
+   * moving on to the next.
+   *
+   * @methodset Consumers
+   *
+   * The cursor will advance by the number of bytes read.  Copies stop at the
+   * end of the chain or once every iovec is full, whichever comes first.
+   *
+   * @returns The number of bytes copied.
+   */
+  size_t pullAtMostVectorized(const struct iovec* iov, size_t iovcnt);
+
+  /**
+   * Read values of type T from the cursor into every element of out.
+   *
+   * @methodset Consumers
+   *
+   * Equivalent to calling read<T>() for each element, but copies each
+   * contiguous piece of the chain at once instead of value by value.
+   *
+   * @throws out_of_range if there aren't enough bytes left in the cursor.
+   */
+  template <class T>
+  void readArray(Range<T*> out) {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "readArray() requires trivially copyable values");
+    pull(out.data(), out.size() * sizeof(T));
+  }
+
+  /**
+   * Read Big-Endian integrals from the cursor into every element of out.
+   *
+   * @methodset Consumers
+   *
+   * @see readArray
+   */
+  template <class T>
+  void readArrayBE(Range<T*> out) {
+    readArray(out);
+    for (auto& val : out) {
+      val = Endian::big(val);
+    }
+  }
+
+  /**
+   * Read Little-Endian integrals from the cursor into every element of out.
+   *
+   * @methodset Consumers
+   *
+   * @see readArray
+   */
+  template <class T>
+  void readArrayLE(Range<T*> out) {
+    readArray(out);
+    for (auto& val : out) {
+      val = Endian::little(val);
+    }
+  }
+
+  /**
+   * Call fn with each contiguous piece of the next len bytes, then advance
+   * the cursor past it.
+   *
+   * @methodset Consumers
+   *
+   * fn is called with a non-empty ByteRange per IOBuf holding part of the
+   * bytes, which lets decoders run tight loops over each piece in place.
+   *
+   * @throws out_of_range if there aren't enough bytes left in the cursor, in
+   * which case fn is not called and the cursor does not move.
+   */
+  template <typename Fn>
+  void visitChunks(size_t len, Fn&& fn);
+
+  /**
+   * Call fn with the next count values of type T, as ByteRanges each holding
+   * a whole number of values, advancing the cursor past every range fn has
+   * been given.
+   *
+   * @methodset Consumers
+   *
+   * Values within a single IOBuf are passed in place, as many at a time as
+   * the IOBuf holds.  A value split across IOBufs is copied into a temporary
+   * and passed on its own.  Ranges are not necessarily aligned for T, so use
+   * loadUnaligned() to read values out of them.
+   *
+   * @throws out_of_range if fewer than count values are left in the cursor,
+   * in which case fn is not called and the cursor does not move.
+   */
+  template <class T, typename Fn>
+  void visitArray(size_t count, Fn&& fn);
+
   /**
    * Return the available data in the current IOBuf.
    *
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/IOBufPool.h>
+
+#include <glog/logging.h>
+
+#include <folly/IndexedMemPool.h>
+#include <folly/ThreadCachedInt.h>
+
+namespace folly {
+
+namespace {
+
+// Buffers are aligned like the ones returned by malloc().
+template <std::size_t Size>
+struct alignas(alignof(std::max_align_t)) Block {
+  unsigned char data[Size];
+};
+
+// Blocks are raw storage, the pool never constructs or destroys them.
+template <typename T>
+struct BlockTraits {
+  static void initialize(T*) {}
+  static void cleanup(T*) {}
+  static void onAllocate(T*) {}
+  static void onRecycle(T*) {}
+};
+
+// Free buffers beyond this many on a per-core list move to the shared list.
+constexpr uint32_t kLocalListLimit = 32;
+
+} // namespace
+
+class IOBufPool::SizeClass {
+ public:
+  explicit SizeClass(std::size_t bufferSize) : bufferSize_(bufferSize) {}
+  virtual ~SizeClass() = default;
+
+  std::size_t bufferSize() const { return bufferSize_; }
+
+  std::unique_ptr<IOBuf> allocate() {
+    void* buf = allocateBuffer();
+    if (!buf) {
+      exhausted_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    allocations_.increment(1);
+    return IOBuf::takeOwnership(buf, bufferSize_, 0, &freeBuffer, this);
+  }
+
+  SizeClassStats getStats() const {
+    SizeClassStats stats;
+    stats.bufferSize = bufferSize_;
+    // Read releases first so that a racing release cannot make the number
+    // of outstanding buffers appear negative.
+    auto releases = releases_.readFull();
+    stats.allocations = allocations_.readFull();
+    stats.outstanding = stats.allocations - releases;
+    stats.exhausted = exhausted_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ protected:
+  // Returns nullptr if every buffer is in use.
+  virtual void* allocateBuffer() = 0;
+  virtual void releaseBuffer(void* buf) = 0;
+
+ private:
+  static void freeBuffer(void* buf, void* userData) {
+    auto sizeClass = static_cast<SizeClass*>(userData);
+    sizeClass->releaseBuffer(buf);
+    sizeClass->releases_.increment(1);
+  }
+
+  const std::size_t bufferSize_;
+  ThreadCachedInt<uint64_t> allocations_;
+  ThreadCachedInt<uint64_t> releases_;
+  std::atomic<uint64_t> exhausted_{0};
+};
+
+template <std::size_t Size>
+class IOBufPool::BlockPool final : public IOBufPool::SizeClass {
+ public:
+  explicit BlockPool(uint32_t capacity) : SizeClass(Size), pool_(capacity) {}
+
+ protected:
+  void* allocateBuffer() override {
+    auto idx = pool_.allocIndex();
+    return idx == 0 ? nullptr : pool_[idx].data;
+  }
+
+  void releaseBuffer(void* buf) override {
+    pool_.recycleIndex(pool_.locateElem(static_cast<Block<Size>*>(buf)));
+  }
+
+ private:
+  IndexedMemPool<
+      Block<Size>,
+      32,
+      kLocalListLimit,
+      std::atomic,
+      BlockTraits<Block<Size>>>
+      pool_;
+};
+
+IOBufPool::IOBufPool(Options options) {
+  static_assert(kNumSizeClasses == 4);
+  auto capacity = options.maxBuffersPerClass;
+  sizeClasses_[0] = std::make_unique<BlockPool<kSizeClasses[0]>>(capacity);
+  sizeClasses_[1] = std::make_unique<BlockPool<kSizeClasses[1]>>(capacity);
+  sizeClasses_[2] = std::make_unique<BlockPool<kSizeClasses[2]>>(capacity);
+  sizeClasses_[3] = std::make_unique<BlockPool<kSizeClasses[3]>>(capacity);
+}
+
+IOBufPool::~IOBufPool() {
+  for (auto& sizeClass : sizeClasses_) {
+    DCHECK_EQ(0, sizeClass->getStats().outstanding)
+        << "IOBufPool destroyed while " << sizeClass->bufferSize()
+        << " byte buffers are in use";
+  }
+}
+
+std::unique_ptr<IOBuf> IOBufPool::allocate(std::size_t capacity) {
+  for (auto& sizeClass : sizeClasses_) {
+    if (capacity <= sizeClass->bufferSize()) {
+      if (auto buf = sizeClass->allocate()) {
+        return buf;
+      }
+      return IOBuf::create(capacity);
+    }
+  }
+  oversized_.fetch_add(1, std::memory_order_relaxed);
+  return IOBuf::create(capacity);
+}
+
+IOBufPool::Stats IOBufPool::getStats() const {
+  Stats stats;
+  for (std::size_t i = 0; i < kNumSizeClasses; ++i) {
+    stats.sizeClasses[i] = sizeClasses_[i]->getStats();
+  }
+  stats.oversized = oversized_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+} // namespace folly
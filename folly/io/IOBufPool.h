@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <folly/io/IOBuf.h>
+
+namespace folly {
+
+/**
+ * IOBufPool hands out IOBufs whose buffers come from a few fixed size
+ * classes instead of malloc().  Free buffers of each size class are kept on
+ * lock-free per-core freelists (see IndexedMemPool), and releasing the last
+ * reference to a pooled IOBuf puts its buffer back on the freelist of the
+ * core doing the release.
+ *
+ * Requests larger than the largest size class, or for a size class whose
+ * buffers are all in use, fall back to IOBuf::create().
+ *
+ * Address space for every size class is reserved when the pool is
+ * constructed; buffers are paged in when first handed out and only given
+ * back to the system when the pool is destroyed.  The pool must outlive
+ * every IOBuf it handed out.
+ *
+ * Besides calling allocate() directly, a pool can be set in
+ * IOBufQueue::Options so that IOBufQueue::preallocate() draws its buffers
+ * from it, e.g. in the getReadBuffer() of an AsyncSocket read callback.
+ */
+class IOBufPool {
+ public:
+  static constexpr std::size_t kNumSizeClasses = 4;
+  static constexpr std::array<std::size_t, kNumSizeClasses> kSizeClasses = {
+      {2 * 1024, 4 * 1024, 16 * 1024, 64 * 1024}};
+
+  struct Options {
+    // Number of buffers of each size class that can be handed out at once.
+    // The pool may hand out somewhat more, up to the number of buffers that
+    // can sit on the per-core freelists.
+    uint32_t maxBuffersPerClass{4096};
+
+    Options& setMaxBuffersPerClass(uint32_t count) {
+      maxBuffersPerClass = count;
+      return *this;
+    }
+  };
+
+  struct SizeClassStats {
+    std::size_t bufferSize{0};
+    // Buffers handed out by this size class since the pool was created.
+    uint64_t allocations{0};
+    // Buffers handed out and not released yet.
+    uint64_t outstanding{0};
+    // Requests that fell back to IOBuf::create() because every buffer of
+    // this size class was in use.
+    uint64_t exhausted{0};
+  };
+
+  struct Stats {
+    std::array<SizeClassStats, kNumSizeClasses> sizeClasses;
+    // Requests that fell back to IOBuf::create() because they were larger
+    // than the largest size class.
+    uint64_t oversized{0};
+  };
+
+  IOBufPool() : IOBufPool(Options()) {}
+  explicit IOBufPool(Options options);
+  ~IOBufPool();
+
+  IOBufPool(const IOBufPool&) = delete;
+  IOBufPool& operator=(const IOBufPool&) = delete;
+
+  /**
+   * Returns an unshared, empty IOBuf with a capacity of at least the given
+   * number of bytes, taken from the smallest size class that fits.
+   */
+  std::unique_ptr<IOBuf> allocate(std::size_t capacity);
+
+  /**
+   * Accounting for the buffers handed out so far.  Counters are updated
+   * per thread and summed here, so this is slow compared to allocate().
+   */
+  Stats getStats() const;
+
+ private:
+  class SizeClass;
+  template <std::size_t Size>
+  class BlockPool;
+
+  std::array<std::unique_ptr<SizeClass>, kNumSizeClasses> sizeClasses_;
+  std::atomic<uint64_t> oversized_{0};
+};
+
+} // namespace folly
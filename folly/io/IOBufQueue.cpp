@@ -19,6 +19,8 @@
 #include <cstring>
 #include <stdexcept>
 
+#include <folly/io/IOBufPool.h>
+
 using std::make_pair;
 using std::pair;
 using std::unique_ptr;
@@ -219,10 +221,10 @@ void IOBufQueue::append(const void* buf, size_t len) {
   while (len != 0) {
     if ((head_ == nullptr) || head_->prev()->isSharedOne() ||
         (head_->prev()->tailroom() == 0)) {
+      auto size = std::max(MIN_ALLOC_SIZE, std::min(len, MAX_ALLOC_SIZE));
       appendToChain(
           head_,
-          IOBuf::create(
-              std::max(MIN_ALLOC_SIZE, std::min(len, MAX_ALLOC_SIZE))),
+          options_.pool ? options_.pool->allocate(size) : IOBuf::create(size),
           false);
     }
     IOBuf* last = head_->prev();
@@ -251,7 +253,9 @@ pair<void*, std::size_t> IOBufQueue::preallocateSlow(
   // Avoid grabbing update guard, since we're manually setting the cache ptrs.
   flushCache();
   // Allocate a new buffer of the requested max size.
-  unique_ptr<IOBuf> newBuf(IOBuf::create(std::max(min, newAllocationSize)));
+  auto size = std::max(min, newAllocationSize);
+  unique_ptr<IOBuf> newBuf(
+      options_.pool ? options_.pool->allocate(size) : IOBuf::create(size));
 
   tailStart_ = newBuf->writableTail();
   cachePtr_->cachedRange = std::pair<uint8_t*, uint8_t*>(
@@ -24,6 +24,8 @@
 
 namespace folly {
 
+class IOBufPool;
+
 namespace io {
 enum class CursorAccess;
 template <CursorAccess>
@@ -81,16 +83,18 @@ class IOBufQueue {
 
  public:
   struct Options {
-    Options() : cacheChainLength(false) {}
+    Options() : cacheChainLength(false), pool(nullptr) {}
     bool cacheChainLength;
+    // If set, buffers allocated by preallocate() and append() come from this
+    // pool, which must outlive them.
+    IOBufPool* pool;
   };
 
   /**
    * Get Options with cacheChainLength=true.
    * @methodset Configuration
    *
-   * Commonly used Options, currently the only possible value other than
-   * the default.
+   * Commonly used Options.
    */
   static Options cacheChainLength() {
     Options options;
@@ -30,12 +30,15 @@ class RecordIOReader::Iterator : public detail::IteratorFacade<
   friend class detail::
       IteratorFacade<Iterator, value_type, std::forward_iterator_tag>;
   friend class RecordIOReader;
+  friend class RecordIOReader::Chunk;
 
  public:
   Iterator() = default;
 
  private:
-  Iterator(ByteRange range, uint32_t fileId, off_t pos);
+  // Iterates over the records whose header starts at or after pos and
+  // before limit.
+  Iterator(ByteRange range, uint32_t fileId, off_t pos, off_t limit = -1);
 
   reference dereference() const { return recordAndPos_; }
   bool equal(const Iterator& other) const { return range_ == other.range_; }
@@ -48,7 +51,9 @@ class RecordIOReader::Iterator : public detail::IteratorFacade<
 
   void advanceToValid();
   ByteRange range_;
+  const uint8_t* searchEnd_ = nullptr;
   uint32_t fileId_ = 0;
+  bool compressed_ = false;
   // stored as a pair so we can return by reference in dereference()
   std::pair<ByteRange, off_t> recordAndPos_;
 };
@@ -69,6 +74,25 @@ inline auto RecordIOReader::seek(off_t pos) const -> Iterator {
   return Iterator(map_.range(), fileId_, pos);
 }
 
+class RecordIOReader::Chunk {
+ public:
+  Iterator cbegin() const { return Iterator(range_, fileId_, begin_, end_); }
+  Iterator begin() const { return cbegin(); }
+  Iterator cend() const { return Iterator(); }
+  Iterator end() const { return cend(); }
+
+ private:
+  friend class RecordIOReader;
+
+  Chunk(ByteRange range, uint32_t fileId, off_t begin, off_t end)
+      : range_(range), fileId_(fileId), begin_(begin), end_(end) {}
+
+  ByteRange range_;
+  uint32_t fileId_;
+  off_t begin_;
+  off_t end_;
+};
+
 namespace recordio_helpers {
 
 namespace recordio_detail {
@@ -80,10 +104,12 @@ struct Header {
   // repeated prefix (that is, if we see kMagic, we know that the next
   // occurrence must start at least 4 bytes later)
   static constexpr uint32_t kMagic = 0xeac313a1;
+  // The data starts with a CodecTag and the rest is compressed.
+  static constexpr uint16_t kFlagCompressed = 1;
   uint32_t magic;
   uint8_t version; // backwards incompatible version, currently 0
   uint8_t hashFunction; // 0 = SpookyHashV2
-  uint16_t flags; // reserved (must be 0)
+  uint16_t flags; // kFlag*, other bits are reserved (must be 0)
   uint32_t fileId; // unique file ID
   uint32_t dataLength;
   std::size_t dataHash;
@@ -95,6 +121,16 @@ static_assert(
     offsetof(Header, headerHash) + sizeof(Header::headerHash) == sizeof(Header),
     "invalid header layout");
 
+FOLLY_PACK_PUSH
+struct CodecTag {
+  uint8_t codecType; // io::CodecType
+  uint8_t reserved1; // must be 0
+  uint16_t reserved2; // must be 0
+  uint32_t dictionaryId; // 0 = no dictionary
+  uint64_t uncompressedLength;
+} FOLLY_PACK_ATTR;
+FOLLY_PACK_POP
+
 } // namespace recordio_detail
 
 constexpr size_t headerSize() {
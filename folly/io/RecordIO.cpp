@@ -18,21 +18,131 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
+#include <limits>
+#include <map>
+
+#include <folly/Conv.h>
 #include <folly/Exception.h>
+#include <folly/ExceptionString.h>
 #include <folly/FileUtil.h>
 #include <folly/Memory.h>
 #include <folly/Portability.h>
 #include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/compression/Compression.h>
 #include <folly/portability/Unistd.h>
 
 namespace folly {
 
 using namespace recordio_helpers;
 
+namespace recordio_helpers {
+namespace recordio_detail {
+
+// Codecs are not thread-safe, so a thread takes a codec out of the pool while
+// using it, and the pool creates more as threads need them.
+class CodecPool {
+ public:
+  using Factory = RecordIOReader::CodecFactory;
+
+  explicit CodecPool(Factory factory) : factory_(std::move(factory)) {}
+
+  template <typename F>
+  auto withCodec(io::CodecType type, uint32_t dictionaryId, F&& f) {
+    auto key = std::make_pair(type, dictionaryId);
+    std::unique_ptr<io::Codec> codec;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& codecs = codecs_[key];
+      if (!codecs.empty()) {
+        codec = std::move(codecs.back());
+        codecs.pop_back();
+      }
+    }
+    if (!codec) {
+      codec = factory_(type, dictionaryId);
+      if (!codec || codec->type() != type) {
+        throw std::runtime_error(to<std::string>(
+            "RecordIO: no codec for codec type ",
+            static_cast<int>(type),
+            " and dictionary ",
+            dictionaryId));
+      }
+    }
+    SCOPE_EXIT {
+      std::lock_guard<std::mutex> lock(mutex_);
+      codecs_[key].push_back(std::move(codec));
+    };
+    return f(*codec);
+  }
+
+ private:
+  Factory factory_;
+  std::mutex mutex_;
+  std::map<
+      std::pair<io::CodecType, uint32_t>,
+      std::vector<std::unique_ptr<io::Codec>>>
+      codecs_;
+};
+
+} // namespace recordio_detail
+} // namespace recordio_helpers
+
+using recordio_detail::CodecPool;
+
+namespace {
+
+std::unique_ptr<CodecPool> makeWriterCodecs(
+    const RecordIOCompression& compression) {
+  if (compression.codecType == io::CodecType::NO_COMPRESSION) {
+    return nullptr;
+  }
+  auto factory = compression.codecFactory;
+  if (!factory) {
+    factory = [type = compression.codecType, level = compression.level] {
+      return io::getCodec(type, level);
+    };
+  }
+  return std::make_unique<CodecPool>(
+      [factory = std::move(factory)](io::CodecType, uint32_t) {
+        return factory();
+      });
+}
+
+// Returns whether the record was compressed.
+bool maybeCompress(
+    std::unique_ptr<IOBuf>& buf,
+    CodecPool* codecs,
+    const RecordIOCompression& compression) {
+  if (!codecs) {
+    return false;
+  }
+  auto length = buf->computeChainDataLength();
+  if (length == 0 || length < compression.minRecordSize) {
+    return false;
+  }
+  return codecs->withCodec(
+      compression.codecType, compression.dictionaryId, [&](io::Codec& codec) {
+        return compressRecord(buf, codec, compression.dictionaryId);
+      });
+}
+
+} // namespace
+
+RecordIOCompression::RecordIOCompression()
+    : codecType(io::CodecType::NO_COMPRESSION),
+      level(io::COMPRESSION_LEVEL_DEFAULT) {}
+
 RecordIOWriter::RecordIOWriter(File file, uint32_t fileId)
+    : RecordIOWriter(std::move(file), fileId, RecordIOCompression()) {}
+
+RecordIOWriter::RecordIOWriter(
+    File file, uint32_t fileId, RecordIOCompression compression)
     : file_(std::move(file)),
       fileId_(fileId),
+      compression_(std::move(compression)),
+      codecs_(makeWriterCodecs(compression_)),
       writeLock_(file_, std::defer_lock),
       filePos_(0) {
   if (!writeLock_.try_lock()) {
@@ -45,8 +155,11 @@ RecordIOWriter::RecordIOWriter(File file, uint32_t fileId)
   filePos_ = st.st_size;
 }
 
+RecordIOWriter::~RecordIOWriter() = default;
+
 void RecordIOWriter::write(std::unique_ptr<IOBuf> buf) {
-  size_t totalLength = prependHeader(buf, fileId_);
+  bool compressed = maybeCompress(buf, codecs_.get(), compression_);
+  size_t totalLength = prependHeader(buf, fileId_, compressed);
   if (totalLength == 0) {
     return; // nothing to do
   }
@@ -69,16 +182,215 @@ void RecordIOWriter::write(std::unique_ptr<IOBuf> buf) {
   DCHECK_EQ(size_t(bytes), totalLength);
 }
 
+AsyncRecordIOWriter::AsyncRecordIOWriter(
+    File file, uint32_t fileId, Options options)
+    : file_(std::move(file)),
+      fileId_(fileId),
+      options_(std::move(options)),
+      codecs_(makeWriterCodecs(options_.compression)),
+      writeLock_(file_, std::defer_lock) {
+  size_t alignment = std::max<size_t>(options_.alignment, 1);
+  if ((alignment & (alignment - 1)) != 0) {
+    throw std::invalid_argument("alignment must be a power of two");
+  }
+  if (!writeLock_.try_lock()) {
+    throw std::runtime_error(
+        "AsyncRecordIOWriter: file locked by another process");
+  }
+
+  struct stat st;
+  checkUnixError(fstat(file_.fd(), &st), "fstat() failed");
+  // Padding up to an aligned offset reads as zeros, which readers skip.
+  filePos_ =
+      off_t((size_t(st.st_size) + alignment - 1) / alignment * alignment);
+
+  stagingSize_ =
+      (std::max<size_t>(options_.batchSize, 1) + alignment - 1) / alignment *
+      alignment;
+  staging_.reset(static_cast<uint8_t*>(aligned_malloc(
+      stagingSize_, std::max(alignment, alignof(std::max_align_t)))));
+  if (!staging_) {
+    throw std::bad_alloc();
+  }
+
+  thread_ = std::thread([this] { run(); });
+}
+
+AsyncRecordIOWriter::~AsyncRecordIOWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queuedCv_.notify_one();
+  thread_.join();
+  if (error_) {
+    LOG(ERROR) << "AsyncRecordIOWriter: records were lost: "
+               << exceptionStr(error_);
+  }
+}
+
+void AsyncRecordIOWriter::write(std::unique_ptr<IOBuf> buf) {
+  bool compressed = maybeCompress(buf, codecs_.get(), options_.compression);
+  size_t totalLength = prependHeader(buf, fileId_, compressed);
+  if (totalLength == 0) {
+    return; // nothing to do
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  writtenCv_.wait(lock, [&] {
+    return queuedBytes_ < options_.maxQueuedBytes || error_;
+  });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  bool wake = queue_.empty() ||
+      (queuedBytes_ < options_.batchSize &&
+       queuedBytes_ + totalLength >= options_.batchSize);
+  queue_.append(std::move(buf));
+  queuedBytes_ += totalLength;
+  totalQueued_ += totalLength;
+  lock.unlock();
+  if (wake) {
+    queuedCv_.notify_one();
+  }
+}
+
+void AsyncRecordIOWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto target = totalQueued_;
+  if (flushTarget_ < target) {
+    flushTarget_ = target;
+    queuedCv_.notify_one();
+  }
+  writtenCv_.wait(lock, [&] { return totalWritten_ >= target || error_; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void AsyncRecordIOWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queuedCv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    // Give other threads a chance to fill up the batch.
+    queuedCv_.wait_for(lock, options_.maxDelay, [&] {
+      return stop_ || queuedBytes_ >= options_.batchSize ||
+          flushTarget_ > totalWritten_;
+    });
+    auto batch = queue_.move();
+    auto bytes = std::exchange(queuedBytes_, 0);
+    bool failed = bool(error_);
+    lock.unlock();
+
+    std::exception_ptr error;
+    if (!failed) {
+      try {
+        writeBatch(*batch);
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    batch.reset();
+
+    lock.lock();
+    if (error) {
+      error_ = error;
+    }
+    totalWritten_ += bytes;
+    writtenCv_.notify_all();
+  }
+}
+
+void AsyncRecordIOWriter::writeBatch(const IOBuf& batch) {
+  size_t alignment = std::max<size_t>(options_.alignment, 1);
+  size_t used = 0;
+  auto writeStaging = [&] {
+    size_t size = (used + alignment - 1) / alignment * alignment;
+    memset(staging_.get() + used, 0, size - used);
+    ssize_t bytes = pwriteFull(file_.fd(), staging_.get(), size, filePos_);
+    checkUnixError(bytes, "pwrite() failed");
+    DCHECK_EQ(size_t(bytes), size);
+    filePos_ += off_t(size);
+    used = 0;
+  };
+  for (auto range : batch) {
+    while (!range.empty()) {
+      size_t n = std::min(range.size(), stagingSize_ - used);
+      memcpy(staging_.get() + used, range.data(), n);
+      range.advance(n);
+      used += n;
+      if (used == stagingSize_) {
+        writeStaging();
+      }
+    }
+  }
+  if (used > 0) {
+    writeStaging();
+  }
+}
+
 RecordIOReader::RecordIOReader(File file, uint32_t fileId)
-    : map_(std::move(file)), fileId_(fileId) {}
+    : RecordIOReader(std::move(file), fileId, nullptr) {}
+
+RecordIOReader::RecordIOReader(
+    File file, uint32_t fileId, CodecFactory codecFactory)
+    : map_(std::move(file)), fileId_(fileId) {
+  if (!codecFactory) {
+    codecFactory = [](io::CodecType type, uint32_t dictionaryId) {
+      if (dictionaryId != 0) {
+        throw std::runtime_error(to<std::string>(
+            "RecordIOReader: no codec for dictionary ", dictionaryId));
+      }
+      return io::getCodec(type);
+    };
+  }
+  codecs_ = std::make_unique<CodecPool>(std::move(codecFactory));
+}
 
-RecordIOReader::Iterator::Iterator(ByteRange range, uint32_t fileId, off_t pos)
+RecordIOReader::RecordIOReader(RecordIOReader&&) noexcept = default;
+RecordIOReader& RecordIOReader::operator=(RecordIOReader&&) = default;
+RecordIOReader::~RecordIOReader() = default;
+
+std::unique_ptr<IOBuf> RecordIOReader::read(const Iterator& it) const {
+  if (!it.compressed_) {
+    return IOBuf::wrapBuffer(it->first);
+  }
+  auto record = parseCompressedRecord(it->first);
+  auto data = IOBuf::wrapBufferAsValue(record.data);
+  return codecs_->withCodec(
+      record.codecType, record.dictionaryId, [&](io::Codec& codec) {
+        return codec.uncompress(&data, record.uncompressedLength);
+      });
+}
+
+std::vector<RecordIOReader::Chunk> RecordIOReader::split(size_t n) const {
+  auto range = map_.range();
+  n = std::max<size_t>(1, std::min(n, range.size()));
+  std::vector<Chunk> chunks;
+  chunks.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    chunks.push_back(Chunk(
+        range,
+        fileId_,
+        off_t(range.size() * i / n),
+        off_t(range.size() * (i + 1) / n)));
+  }
+  return chunks;
+}
+
+RecordIOReader::Iterator::Iterator(
+    ByteRange range, uint32_t fileId, off_t pos, off_t limit)
     : range_(range), fileId_(fileId), recordAndPos_(ByteRange(), 0) {
   if (size_t(pos) >= range_.size()) {
     // Note that this branch can execute if pos is negative as well.
     recordAndPos_.second = off_t(-1);
     range_.clear();
   } else {
+    // A negative limit means the end of the range.
+    searchEnd_ = range_.begin() + std::min(size_t(limit), range_.size());
     recordAndPos_.second = pos;
     range_.advance(size_t(pos));
     advanceToValid();
@@ -86,7 +398,10 @@ RecordIOReader::Iterator::Iterator(ByteRange range, uint32_t fileId, off_t pos)
 }
 
 void RecordIOReader::Iterator::advanceToValid() {
-  ByteRange record = findRecord(range_, fileId_).record;
+  ByteRange searchRange(range_.begin(), std::max(range_.begin(), searchEnd_));
+  auto info = findRecord(searchRange, range_, fileId_);
+  ByteRange record = info.record;
+  compressed_ = info.compressed;
   if (record.empty()) {
     recordAndPos_ = std::make_pair(ByteRange(), off_t(-1));
     range_.clear(); // at end
@@ -102,12 +417,18 @@ void RecordIOReader::Iterator::advanceToValid() {
 
 namespace recordio_helpers {
 
+using recordio_detail::CodecTag;
 using recordio_detail::Header;
 
 namespace {
 
 constexpr uint32_t kHashSeed = 0xdeadbeef; // for mcurtiss
 
+// The record length, header included, must fit in 32 bits.  Compressed
+// records may not uncompress to more either.
+constexpr uint64_t kMaxDataLength =
+    std::numeric_limits<uint32_t>::max() - headerSize() - 1;
+
 uint32_t headerHash(const Header& header) {
   return hash::SpookyHashV2::Hash32(
       &header, offsetof(Header, headerHash), kHashSeed);
@@ -124,7 +445,7 @@ std::pair<size_t, std::size_t> dataLengthAndHash(const IOBuf* buf) {
   uint64_t hash1;
   uint64_t hash2;
   hasher.Final(&hash1, &hash2);
-  if (len + headerSize() >= std::numeric_limits<uint32_t>::max()) {
+  if (len > kMaxDataLength) {
     throw std::invalid_argument("Record length must fit in 32 bits");
   }
   return std::make_pair(len, static_cast<std::size_t>(hash1));
@@ -136,7 +457,8 @@ std::size_t dataHash(ByteRange range) {
 
 } // namespace
 
-size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId) {
+size_t prependHeader(
+    std::unique_ptr<IOBuf>& buf, uint32_t fileId, bool compressed) {
   if (fileId == 0) {
     throw std::invalid_argument("invalid file id");
   }
@@ -159,6 +481,7 @@ size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId) {
   auto header = reinterpret_cast<Header*>(buf->writableData());
   memset(header, 0, sizeof(Header));
   header->magic = Header::kMagic;
+  header->flags = compressed ? Header::kFlagCompressed : 0;
   header->fileId = fileId;
   header->dataLength = uint32_t(lengthAndHash.first);
   header->dataHash = lengthAndHash.second;
@@ -167,13 +490,58 @@ size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId) {
   return lengthAndHash.first + headerSize();
 }
 
+bool compressRecord(
+    std::unique_ptr<IOBuf>& buf, io::Codec& codec, uint32_t dictionaryId) {
+  auto length = buf->computeChainDataLength();
+  if (length > kMaxDataLength) {
+    return false; // prependHeader() rejects it
+  }
+  auto compressed = codec.compress(buf.get());
+  if (compressed->computeChainDataLength() + sizeof(CodecTag) >= length) {
+    return false;
+  }
+  // Leave room for prependHeader().
+  auto b = IOBuf::create(headerSize() + sizeof(CodecTag));
+  b->advance(headerSize());
+  b->append(sizeof(CodecTag));
+  auto tag = reinterpret_cast<CodecTag*>(b->writableData());
+  memset(tag, 0, sizeof(CodecTag));
+  tag->codecType = static_cast<uint8_t>(codec.type());
+  tag->dictionaryId = dictionaryId;
+  tag->uncompressedLength = length;
+  b->appendToChain(std::move(compressed));
+  buf = std::move(b);
+  return true;
+}
+
+CompressedRecord parseCompressedRecord(ByteRange record) {
+  if (record.size() < sizeof(CodecTag)) {
+    throw std::runtime_error("RecordIO: compressed record too short");
+  }
+  auto tag = reinterpret_cast<const CodecTag*>(record.begin());
+  if (tag->reserved1 != 0 || tag->reserved2 != 0 ||
+      tag->codecType >= static_cast<uint8_t>(io::CodecType::NUM_CODEC_TYPES)) {
+    throw std::runtime_error("RecordIO: invalid codec tag");
+  }
+  if (tag->uncompressedLength > kMaxDataLength) {
+    throw std::runtime_error("RecordIO: uncompressed length too large");
+  }
+  record.advance(sizeof(CodecTag));
+  return {
+      static_cast<io::CodecType>(tag->codecType),
+      tag->dictionaryId,
+      tag->uncompressedLength,
+      record};
+}
+
 bool validateRecordHeader(ByteRange range, uint32_t fileId) {
   if (range.size() < headerSize()) { // records may not be empty
     return false;
   }
   auto header = reinterpret_cast<const Header*>(range.begin());
   if (header->magic != Header::kMagic || header->version != 0 ||
-      header->hashFunction != 0 || header->flags != 0 ||
+      header->hashFunction != 0 ||
+      (header->flags & ~Header::kFlagCompressed) != 0 ||
       (fileId != 0 && header->fileId != fileId)) {
     return false;
   }
@@ -189,14 +557,16 @@ RecordInfo validateRecordData(ByteRange range) {
   }
   auto header = reinterpret_cast<const Header*>(range.begin());
   range.advance(sizeof(Header));
-  if (header->dataLength > range.size()) {
+  bool compressed = (header->flags & Header::kFlagCompressed) != 0;
+  if (header->dataLength > range.size() ||
+      (compressed && header->dataLength < sizeof(CodecTag))) {
     return {0, {}};
   }
   range.reset(range.begin(), header->dataLength);
   if (dataHash(range) != header->dataHash) {
     return {0, {}};
   }
-  return {header->fileId, range};
+  return {header->fileId, range, compressed};
 }
 
 RecordInfo validateRecord(ByteRange range, uint32_t fileId) {
@@ -220,7 +590,7 @@ RecordInfo findRecord(
       std::min(searchRange.end(), wholeRange.end() - sizeof(Header));
   // end-1: the last place where a Header could start
   while (start < end) {
-    auto p = ByteRange(start, end + sizeof(magic)).find(magicRange);
+    auto p = ByteRange(start, end + sizeof(magic) - 1).find(magicRange);
     if (p == ByteRange::npos) {
       break;
     }
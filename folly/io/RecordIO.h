@@ -27,16 +27,82 @@
 #define FOLLY_IO_RECORDIO_H_
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include <folly/File.h>
+#include <folly/Memory.h>
 #include <folly/Range.h>
 #include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
 #include <folly/system/MemoryMapping.h>
 
 namespace folly {
 
+namespace io {
+class Codec;
+enum class CodecType;
+} // namespace io
+
+namespace recordio_helpers {
+namespace recordio_detail {
+class CodecPool;
+} // namespace recordio_detail
+} // namespace recordio_helpers
+
+/**
+ * How RecordIO writers compress records.
+ *
+ * Every record is compressed on its own and tagged with the codec type and
+ * dictionary id it was compressed with, so records stay independently
+ * readable (seek() and resynchronization work as for uncompressed files),
+ * and a file may mix records compressed differently or not at all.
+ * Readers that predate compression skip compressed records as invalid.
+ */
+struct RecordIOCompression {
+  RecordIOCompression();
+
+  // NO_COMPRESSION, the default, writes records as they are.
+  io::CodecType codecType;
+  // Defaults to io::COMPRESSION_LEVEL_DEFAULT.
+  int level;
+  // Records smaller than this are written uncompressed, as are records that
+  // do not get smaller when compressed.
+  size_t minRecordSize{64};
+  // Stored in every compressed record so that readers can pick the
+  // dictionary the record was compressed with; 0 means no dictionary.
+  uint32_t dictionaryId{0};
+  // Creates the codecs that compress records, which must be of codecType.
+  // Defaults to io::getCodec(codecType, level); set it to compress with a
+  // dictionary.  Called again whenever more threads compress at once.
+  std::function<std::unique_ptr<io::Codec>()> codecFactory;
+
+  RecordIOCompression& setCodecType(io::CodecType type) {
+    codecType = type;
+    return *this;
+  }
+  RecordIOCompression& setLevel(int value) {
+    level = value;
+    return *this;
+  }
+  RecordIOCompression& setMinRecordSize(size_t size) {
+    minRecordSize = size;
+    return *this;
+  }
+  RecordIOCompression& setDictionary(
+      uint32_t id, std::function<std::unique_ptr<io::Codec>()> factory) {
+    dictionaryId = id;
+    codecFactory = std::move(factory);
+    return *this;
+  }
+};
+
 /**
  * Class to write a stream of RecordIO records to a file.
  *
@@ -59,9 +125,17 @@ class RecordIOWriter {
    */
   explicit RecordIOWriter(File file, uint32_t fileId = 1);
 
+  /**
+   * Create a RecordIOWriter that compresses records.
+   */
+  RecordIOWriter(File file, uint32_t fileId, RecordIOCompression compression);
+
+  ~RecordIOWriter();
+
   /**
    * Write a record.  We will use at most headerSize() bytes of headroom,
    * you might want to arrange that before copying your data into it.
+   * Records are compressed on the calling thread.
    */
   void write(std::unique_ptr<IOBuf> buf);
 
@@ -74,10 +148,121 @@ class RecordIOWriter {
  private:
   File file_;
   uint32_t fileId_;
+  RecordIOCompression compression_;
+  std::unique_ptr<recordio_helpers::recordio_detail::CodecPool> codecs_;
   std::unique_lock<File> writeLock_;
   std::atomic<off_t> filePos_;
 };
 
+/**
+ * Class to write a stream of RecordIO records to a file without waiting for
+ * the file system.
+ *
+ * write() adds the header to a record and queues it; a background thread
+ * coalesces queued records into large writes.  Records written from the same
+ * thread end up in the file in the order they were written.  An error from
+ * the background thread is rethrown by every later write() and flush().
+ *
+ * AsyncRecordIOWriter is thread-safe
+ */
+class AsyncRecordIOWriter {
+ public:
+  struct Options {
+    // Queued records are written out once they add up to this many bytes,
+    // which is also the size of the largest write.
+    size_t batchSize{1 << 20};
+    // Queued records are written out at least this often.
+    std::chrono::milliseconds maxDelay{10};
+    // write() blocks while this many bytes are queued.
+    size_t maxQueuedBytes{64 << 20};
+    // If non-zero, a power of two such that every write starts at a file
+    // offset and has a size that are multiples of it, and comes from a
+    // buffer aligned to it, as required by O_DIRECT.  Writes are padded with
+    // zeros, which readers skip.
+    size_t alignment{0};
+    // Records are compressed by write(), on the calling thread.
+    RecordIOCompression compression;
+
+    Options& setBatchSize(size_t size) {
+      batchSize = size;
+      return *this;
+    }
+    Options& setMaxDelay(std::chrono::milliseconds delay) {
+      maxDelay = delay;
+      return *this;
+    }
+    Options& setMaxQueuedBytes(size_t bytes) {
+      maxQueuedBytes = bytes;
+      return *this;
+    }
+    Options& setAlignment(size_t bytes) {
+      alignment = bytes;
+      return *this;
+    }
+    Options& setCompression(RecordIOCompression value) {
+      compression = std::move(value);
+      return *this;
+    }
+  };
+
+  /**
+   * Create an AsyncRecordIOWriter around a file; will append to the end of
+   * file if it exists.  See RecordIOWriter for the meaning of fileId.
+   */
+  explicit AsyncRecordIOWriter(File file, uint32_t fileId = 1)
+      : AsyncRecordIOWriter(std::move(file), fileId, Options()) {}
+  AsyncRecordIOWriter(File file, uint32_t fileId, Options options);
+
+  /**
+   * Writes out every queued record before returning.
+   */
+  ~AsyncRecordIOWriter();
+
+  /**
+   * Queue a record.  We will use at most headerSize() bytes of headroom,
+   * you might want to arrange that before copying your data into it.
+   */
+  void write(std::unique_ptr<IOBuf> buf);
+
+  /**
+   * Wait until every record queued before the call has been written to the
+   * file.
+   */
+  void flush();
+
+ private:
+  void run();
+  void writeBatch(const IOBuf& batch);
+
+  File file_;
+  uint32_t fileId_;
+  Options options_;
+  std::unique_ptr<recordio_helpers::recordio_detail::CodecPool> codecs_;
+  std::unique_lock<File> writeLock_;
+
+  // Used by the background thread only.
+  off_t filePos_{0};
+  size_t stagingSize_{0};
+  std::unique_ptr<uint8_t, static_function_deleter<void, &aligned_free>>
+      staging_;
+
+  std::mutex mutex_;
+  // Wakes up the background thread.
+  std::condition_variable queuedCv_;
+  // Wakes up threads waiting for queued records to be written.
+  std::condition_variable writtenCv_;
+  IOBufQueue queue_;
+  size_t queuedBytes_{0};
+  // Bytes ever queued, and bytes of those written out so far.
+  uint64_t totalQueued_{0};
+  uint64_t totalWritten_{0};
+  uint64_t flushTarget_{0};
+  bool stop_{false};
+  std::exception_ptr error_;
+
+  std::thread thread_;
+};
+
 /**
  * Class to read from a RecordIO file.  Will skip invalid records.
  */
@@ -90,6 +275,9 @@ class RecordIOReader {
    * and position in file where the record (including header) begins.
    * Note that the position includes the header, that is, it can be passed back
    * to seek().
+   *
+   * The content of a compressed record is what is stored in the file; use
+   * read() to get it uncompressed.
    */
   typedef Iterator iterator;
   typedef Iterator const_iterator;
@@ -104,6 +292,20 @@ class RecordIOReader {
    */
   explicit RecordIOReader(File file, uint32_t fileId = 0);
 
+  /**
+   * Creates the codecs that read() uncompresses records with, given the codec
+   * type and dictionary id stored in the record.  The default only handles
+   * records compressed without a dictionary.
+   */
+  using CodecFactory = std::function<std::unique_ptr<io::Codec>(
+      io::CodecType type, uint32_t dictionaryId)>;
+
+  RecordIOReader(File file, uint32_t fileId, CodecFactory codecFactory);
+
+  RecordIOReader(RecordIOReader&&) noexcept;
+  RecordIOReader& operator=(RecordIOReader&&);
+  ~RecordIOReader();
+
   Iterator cbegin() const;
   Iterator begin() const;
   Iterator cend() const;
@@ -114,9 +316,42 @@ class RecordIOReader {
    */
   Iterator seek(off_t pos) const;
 
+  /**
+   * A part of the file, iterable like the reader itself.  See split().
+   */
+  class Chunk;
+
+  /**
+   * Split the file into at most n chunks of about the same size, which may
+   * be iterated in parallel, e.g. one per thread.
+   *
+   * A chunk returns the valid records whose header starts within it, finding
+   * the first one the same way seek() does, so together the chunks return
+   * the records that iterating over the whole file does.  The exception is a
+   * file holding RecordIO records with the reader's file id inside other
+   * records: records nested in a record that crosses into a chunk may be
+   * returned by that chunk as well.
+   */
+  std::vector<Chunk> split(size_t n) const;
+
+  /**
+   * Return the content of the record that an iterator of this reader (or of
+   * one of its chunks) points to.  Compressed records are uncompressed into
+   * a new buffer, other records are wrapped without copying and the IOBuf
+   * must not outlive the reader.  Throws std::runtime_error if a record
+   * cannot be uncompressed, or, with the default codec factory, if it was
+   * compressed with a dictionary.  The default codec factory throws
+   * std::invalid_argument if the record's codec type is not compiled in, see
+   * io::getCodec().
+   *
+   * read() is thread-safe, it keeps a pool of codecs for concurrent callers.
+   */
+  std::unique_ptr<IOBuf> read(const Iterator& it) const;
+
  private:
   MemoryMapping map_;
   uint32_t fileId_;
+  std::unique_ptr<recordio_helpers::recordio_detail::CodecPool> codecs_;
 };
 
 namespace recordio_helpers {
@@ -140,9 +375,32 @@ constexpr size_t headerSize(); // defined in RecordIO-inl.h
  * The fileId should be unique per stream and allows you to have RecordIO
  * headers stored inside the data (for example, have an entire RecordIO
  * file stored as a record inside another RecordIO file).  The fileId may
- * not be 0.
+ * not be 0.  Set compressed for records produced by compressRecord().
+ */
+size_t prependHeader(
+    std::unique_ptr<IOBuf>& buf, uint32_t fileId = 1, bool compressed = false);
+
+/**
+ * Compress a record with codec, prepending the tag that identifies the codec
+ * type and dictionary, and leaving headerSize() bytes of headroom.  Returns
+ * false, leaving buf alone, if compression does not make the record smaller.
+ * Pass compressed=true to prependHeader() for records compressed this way.
  */
-size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId = 1);
+bool compressRecord(
+    std::unique_ptr<IOBuf>& buf, io::Codec& codec, uint32_t dictionaryId = 0);
+
+/**
+ * The parts of the data of a compressed record.  Throws std::runtime_error
+ * if data is not that of a compressed record, or if its uncompressed length
+ * is more than a record may hold.
+ */
+struct CompressedRecord {
+  io::CodecType codecType;
+  uint32_t dictionaryId;
+  uint64_t uncompressedLength;
+  ByteRange data;
+};
+CompressedRecord parseCompressedRecord(ByteRange record);
 
 /**
  * Search for the first valid record that begins in searchRange (which must be
@@ -156,6 +414,8 @@ size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId = 1);
 struct RecordInfo {
   uint32_t fileId;
   ByteRange record;
+  // The record data is compressed, see parseCompressedRecord().
+  bool compressed = false;
 };
 RecordInfo findRecord(
     ByteRange searchRange, ByteRange wholeRange, uint32_t fileId);
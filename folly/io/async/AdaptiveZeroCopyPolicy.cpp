@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/AdaptiveZeroCopyPolicy.h>
+
+#include <algorithm>
+
+namespace folly {
+
+namespace {
+
+// Weight of a new batch in the moving average of the completion latency,
+// as for the smoothed round-trip time of TCP.
+constexpr double kLatencyGain = 1.0 / 8;
+
+AdaptiveZeroCopyPolicy::Options sanitize(
+    AdaptiveZeroCopyPolicy::Options options) {
+  options.maxWriteSize = std::max(options.maxWriteSize, options.minWriteSize);
+  return options;
+}
+
+} // namespace
+
+AdaptiveZeroCopyPolicy::AdaptiveZeroCopyPolicy(Options options)
+    : options_(sanitize(options)), threshold_(options_.minWriteSize) {}
+
+void AdaptiveZeroCopyPolicy::onZeroCopySend(
+    uint32_t id, Clock::time_point now) {
+  if (!sends_.empty() && id != firstSendId_ + uint32_t(sends_.size())) {
+    // Ids were skipped, start tracking over.
+    sends_.clear();
+  }
+  if (sends_.empty()) {
+    firstSendId_ = id;
+  }
+  sends_.push_back({now});
+}
+
+void AdaptiveZeroCopyPolicy::endCompletionBatch(Clock::time_point now) {
+  if (pending_.empty()) {
+    return;
+  }
+
+  uint64_t completions = 0;
+  uint64_t copied = 0;
+  uint64_t timed = 0;
+  Clock::duration latency{0};
+  for (const auto& completion : pending_) {
+    for (uint32_t id = completion.lo;; ++id) {
+      ++completions;
+      copied += completion.copied ? 1 : 0;
+      uint32_t index = id - firstSendId_;
+      if (index < sends_.size() && !sends_[index].complete) {
+        sends_[index].complete = true;
+        latency += now - sends_[index].time;
+        ++timed;
+      }
+      if (id == completion.hi) {
+        break;
+      }
+    }
+  }
+  pending_.clear();
+  while (!sends_.empty() && sends_.front().complete) {
+    sends_.pop_front();
+    ++firstSendId_;
+  }
+
+  stats_.completions += completions;
+  stats_.copiedCompletions += copied;
+  if (timed > 0) {
+    double latencyNs =
+        std::chrono::duration<double, std::nano>(latency).count() / timed;
+    if (stats_.completionBatches == 0) {
+      avgLatencyNs_ = latencyNs;
+    } else {
+      avgLatencyNs_ += (latencyNs - avgLatencyNs_) * kLatencyGain;
+    }
+  }
+  stats_.completionBatches++;
+
+  bool slow = options_.maxCompletionLatency.count() > 0 &&
+      avgLatencyNs_ >
+          std::chrono::duration<double, std::nano>(
+              options_.maxCompletionLatency)
+              .count();
+  if (copied > 0 || slow) {
+    threshold_ =
+        std::min(std::max<size_t>(threshold_ * 2, 1), options_.maxWriteSize);
+  } else {
+    threshold_ -= (threshold_ - options_.minWriteSize + 1) / 2;
+  }
+}
+
+AdaptiveZeroCopyPolicy::Stats AdaptiveZeroCopyPolicy::getStats() const {
+  auto stats = stats_;
+  stats.avgCompletionLatency = std::chrono::microseconds(
+      static_cast<std::chrono::microseconds::rep>(avgLatencyNs_ / 1000));
+  stats.threshold = threshold_;
+  return stats;
+}
+
+} // namespace folly
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include <folly/small_vector.h>
+
+namespace folly {
+
+/**
+ * Decides which writes of a socket use MSG_ZEROCOPY.
+ *
+ * A zerocopy send saves copying the data into the kernel, but costs pinning
+ * its pages, a completion notification that must be read from the error
+ * queue, and holding on to the buffer until the peer acknowledged the data.
+ * That only pays off for large writes, so writes of at least threshold()
+ * bytes use zerocopy and smaller ones are copied.
+ *
+ * The threshold adapts to the completions the kernel reports:
+ *  - when the kernel copied data sent with zerocopy anyway (e.g. over
+ *    loopback, or a device without scatter-gather), zerocopy only added
+ *    overhead and the threshold doubles;
+ *  - when completions take longer than maxCompletionLatency on average,
+ *    buffers are held for too long and the threshold doubles as well;
+ *  - otherwise it moves back toward minWriteSize.
+ * Some writes below the threshold use zerocopy as probes, otherwise the
+ * threshold could not come down once no write reaches it.
+ *
+ * Completions are handed over as they are read from the error queue and
+ * only accounted for once the queue is drained, in endCompletionBatch(), so
+ * the clock is read and the threshold adapted once per batch.
+ *
+ * Not thread-safe, used from the EventBase thread of its socket.
+ */
+class AdaptiveZeroCopyPolicy {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    // Writes smaller than this are always copied.
+    size_t minWriteSize{16 * 1024};
+    // The threshold never grows beyond this, writes of at least this size
+    // always use zerocopy.
+    size_t maxWriteSize{1024 * 1024};
+    // Completions slower than this on average make the threshold grow.
+    std::chrono::microseconds maxCompletionLatency{
+        std::chrono::milliseconds(50)};
+    // Every probeInterval-th write of at least minWriteSize that is below
+    // the threshold uses zerocopy anyway, so that the threshold can come
+    // down again once zerocopy pays off.  0 disables probing.
+    uint32_t probeInterval{64};
+
+    Options& setMinWriteSize(size_t size) {
+      minWriteSize = size;
+      return *this;
+    }
+    Options& setMaxWriteSize(size_t size) {
+      maxWriteSize = size;
+      return *this;
+    }
+    Options& setMaxCompletionLatency(std::chrono::microseconds latency) {
+      maxCompletionLatency = latency;
+      return *this;
+    }
+    Options& setProbeInterval(uint32_t interval) {
+      probeInterval = interval;
+      return *this;
+    }
+  };
+
+  struct Stats {
+    // Writes sent with zerocopy, and their bytes.
+    uint64_t zeroCopyWrites{0};
+    uint64_t zeroCopyBytes{0};
+    // Writes copied because they were below the threshold, and their bytes.
+    // Probes count as zerocopy writes.
+    uint64_t copyWrites{0};
+    uint64_t copyBytes{0};
+    // Zerocopy sends the kernel reported complete, and those of them whose
+    // data the kernel copied anyway.
+    uint64_t completions{0};
+    uint64_t copiedCompletions{0};
+    // Error queue drains that completed zerocopy sends.
+    uint64_t completionBatches{0};
+    // Moving average of the time from a zerocopy send to its completion.
+    std::chrono::microseconds avgCompletionLatency{0};
+    // The current threshold.
+    size_t threshold{0};
+  };
+
+  AdaptiveZeroCopyPolicy() : AdaptiveZeroCopyPolicy(Options()) {}
+  explicit AdaptiveZeroCopyPolicy(Options options);
+
+  /**
+   * Whether a write of the given size should use zerocopy.
+   */
+  bool shouldZeroCopy(size_t bytes) {
+    if (bytes >= threshold_ || (bytes >= options_.minWriteSize && probe())) {
+      stats_.zeroCopyWrites++;
+      stats_.zeroCopyBytes += bytes;
+      return true;
+    }
+    stats_.copyWrites++;
+    stats_.copyBytes += bytes;
+    return false;
+  }
+
+  size_t threshold() const { return threshold_; }
+
+  /**
+   * A send with zerocopy was made, which the kernel will report complete
+   * with the given id.  Ids are consecutive.
+   */
+  void onZeroCopySend(uint32_t id, Clock::time_point now = Clock::now());
+
+  /**
+   * The kernel reported the sends with ids lo to hi complete, and whether it
+   * copied their data.
+   */
+  void onCompletion(uint32_t lo, uint32_t hi, bool copied) {
+    pending_.push_back({lo, hi, copied});
+  }
+
+  /**
+   * Accounts for the completions since the last call and adapts the
+   * threshold.  Called after draining the error queue.
+   */
+  void endCompletionBatch(Clock::time_point now = Clock::now());
+
+  Stats getStats() const;
+
+ private:
+  bool probe() {
+    return options_.probeInterval != 0 &&
+        ++skipped_ % options_.probeInterval == 0;
+  }
+
+  struct Completion {
+    uint32_t lo;
+    uint32_t hi;
+    bool copied;
+  };
+
+  struct Send {
+    Clock::time_point time;
+    bool complete{false};
+  };
+
+  const Options options_;
+  size_t threshold_;
+  Stats stats_;
+  // Writes of at least minWriteSize that were below the threshold.
+  uint32_t skipped_{0};
+  // Sends that may not have completed yet, by id starting at firstSendId_.
+  std::deque<Send> sends_;
+  uint32_t firstSendId_{0};
+  small_vector<Completion, 4> pending_;
+  // Moving average of the completion latency, in nanoseconds.
+  double avgLatencyNs_{0};
+};
+
+} // namespace folly
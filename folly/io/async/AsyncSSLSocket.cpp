@@ -511,12 +511,7 @@ size_t AsyncSSLSocket::getRawBytesWritten() const {
 }
 
 size_t AsyncSSLSocket::getRawBytesReceived() const {
-  BIO* b;
-  if (!ssl_ || !(b = SSL_get_rbio(ssl_.get()))) {
-    return 0;
-  }
-
-  return BIO_number_read(b);
+  return rawBytesReceived_;
 }
 
 void AsyncSSLSocket::invalidState(HandshakeCB* callback) {
@@ -870,9 +865,24 @@ bool AsyncSSLSocket::setupSSLBio() {
   OpenSSLUtils::setBioAppData(sslBio, this);
   OpenSSLUtils::setBioFd(sslBio, fd_, BIO_NOCLOSE);
   SSL_set_bio(ssl_.get(), sslBio, sslBio);
+#if FOLLY_OPENSSL_HAS_KTLS
+  if (ktlsEnabled_) {
+    // OpenSSL installs the keys in the kernel when they change, if it can.
+    SSL_set_options(ssl_.get(), SSL_OP_ENABLE_KTLS);
+  }
+#endif
   return true;
 }
 
+bool AsyncSSLSocket::isKTLSActive() const {
+#if FOLLY_OPENSSL_HAS_KTLS
+  return sslState_ == STATE_ESTABLISHED && ssl_ &&
+      BIO_get_ktls_send(SSL_get_wbio(ssl_.get()));
+#else
+  return false;
+#endif
+}
+
 void AsyncSSLSocket::sslConn(
     HandshakeCB* callback,
     std::chrono::milliseconds timeout,
@@ -1704,6 +1714,12 @@ AsyncSocket::WriteResult AsyncSSLSocket::interpretSSLError(int rc, int error) {
   }
 }
 
+bool AsyncSSLSocket::canSendFile() const {
+  // sendfile() would bypass encryption, unless the kernel does it.
+  return (sslState_ == STATE_UNENCRYPTED || isKTLSActive()) &&
+      AsyncSocket::canSendFile();
+}
+
 AsyncSocket::WriteResult AsyncSSLSocket::performWrite(
     const iovec* vec,
     uint32_t count,
@@ -1711,7 +1727,8 @@ AsyncSocket::WriteResult AsyncSSLSocket::performWrite(
     uint32_t* countWritten,
     uint32_t* partialWritten,
     WriteRequestTag writeTag) {
-  if (sslState_ == STATE_UNENCRYPTED) {
+  if (sslState_ == STATE_UNENCRYPTED || isKTLSActive()) {
+    // With kTLS the kernel encrypts whatever is written to the socket.
     return AsyncSocket::performWrite(
         vec, count, flags, countWritten, partialWritten, std::move(writeTag));
   }
@@ -1919,6 +1936,22 @@ void AsyncSSLSocket::sslInfoCallback(const SSL* ssl, int where, int ret) {
 }
 
 int AsyncSSLSocket::bioWrite(BIO* b, const char* in, int inl) {
+#if FOLLY_OPENSSL_HAS_KTLS
+  if (BIO_get_ktls_send(b)) {
+    // Only records other than application data (alerts, session tickets)
+    // still go through SSL_write(). The socket BIO knows how to pass their
+    // record type to the kernel.
+    static const auto socketWrite = BIO_meth_get_write(BIO_s_socket());
+    // It writes without MSG_NOSIGNAL.
+    auto ret = int(writeWithoutSigpipe([&] { return socketWrite(b, in, inl); }));
+    if (ret > 0) {
+      auto sslSock =
+          reinterpret_cast<AsyncSSLSocket*>(OpenSSLUtils::getBioAppData(b));
+      sslSock->rawBytesWritten_ += size_t(ret);
+    }
+    return ret;
+  }
+#endif
   // get pointer to AsyncSSLSocket from BioAppData
   auto appData = OpenSSLUtils::getBioAppData(b);
   CHECK(appData);
@@ -1956,6 +1989,22 @@ int AsyncSSLSocket::bioRead(BIO* b, char* out, int outl) {
   if (!out) {
     return 0;
   }
+#if FOLLY_OPENSSL_HAS_KTLS
+  if (BIO_get_ktls_recv(b)) {
+    // The kernel decrypts, and the socket BIO reads its records.
+    static const auto socketRead = BIO_meth_get_read(BIO_s_socket());
+    auto ret = socketRead(b, out, outl);
+    if (ret > SSL3_RT_HEADER_LENGTH) {
+      // The socket BIO puts a record header before the data the kernel
+      // returns. Count the data only, as the sender counts what it gives the
+      // kernel.
+      auto sslSock =
+          reinterpret_cast<AsyncSSLSocket*>(OpenSSLUtils::getBioAppData(b));
+      sslSock->rawBytesReceived_ += size_t(ret - SSL3_RT_HEADER_LENGTH);
+    }
+    return ret;
+  }
+#endif
   BIO_clear_retry_flags(b);
 
   auto appData = OpenSSLUtils::getBioAppData(b);
@@ -1973,11 +2022,14 @@ int AsyncSSLSocket::bioRead(BIO* b, char* out, int outl) {
     queue.append(std::move(sslSock->preReceivedData_));
     queue.trimStart(len);
     sslSock->preReceivedData_ = queue.move();
+    sslSock->rawBytesReceived_ += len;
     return static_cast<int>(len);
   } else {
     auto result = int(netops::recv(OpenSSLUtils::getBioFd(b), out, outl, 0));
     if (result <= 0 && OpenSSLUtils::getBioShouldRetryWrite(result)) {
       BIO_set_retry_read(b);
+    } else if (result > 0) {
+      sslSock->rawBytesReceived_ += size_t(result);
     }
     return result;
   }
@@ -841,6 +841,22 @@ class AsyncSSLSocket : public AsyncSocket {
    */
   void forceCacheAddrOnFailure(bool force) { cacheAddrOnFailure_ = force; }
 
+  /**
+   * Offload encryption of outgoing records to the kernel (kTLS) once the
+   * handshake completes. Writes then go to the socket as plain data, without
+   * a copy through SSL_write(), and writeFile() can use sendfile().
+   *
+   * Must be called before the handshake starts. If OpenSSL, the kernel or
+   * the negotiated cipher doesn't support kTLS, the socket keeps encrypting
+   * in user space; isKTLSActive() tells which happened.
+   */
+  void enableKTLS() { ktlsEnabled_ = true; }
+
+  /**
+   * Whether outgoing records are currently encrypted by the kernel.
+   */
+  bool isKTLSActive() const;
+
   const std::string& getSessionKey() const { return sessionKey_; }
 
   void setSessionKey(std::string sessionKey) {
@@ -920,6 +936,7 @@ class AsyncSSLSocket : public AsyncSocket {
   void handleInitialReadWrite() noexcept override {}
 
   WriteResult interpretSSLError(int rc, int error);
+  bool canSendFile() const override;
   ReadResult performReadMsg(
       struct ::msghdr&, AsyncReader::ReadCallback::ReadMode) override;
   WriteResult performWrite(
@@ -1007,6 +1024,9 @@ class AsyncSSLSocket : public AsyncSocket {
   // Try to avoid calling SSL_write() for buffers smaller than this.
   // It doesn't take effect when it is 0.
   size_t minWriteSize_{1500};
+  // Bytes read from the socket by bioRead(). With kTLS, the data the kernel
+  // returned after decrypting it.
+  size_t rawBytesReceived_{0};
 
   std::shared_ptr<const folly::SSLContext> handshakeCtx_;
   std::string tlsextHostname_;
@@ -1022,6 +1042,7 @@ class AsyncSSLSocket : public AsyncSocket {
 
   bool parseClientHello_{false};
   bool cacheAddrOnFailure_{false};
+  bool ktlsEnabled_{false};
   bool certCacheHit_{false};
   std::unique_ptr<ssl::ClientHelloInfo> clientHelloInfo_;
   std::vector<std::pair<char, StringPiece>> alertsReceived_;
@@ -797,6 +797,13 @@ NetworkSocket AsyncServerSocket::createSocket(int family) {
   return fd;
 }
 
+void AsyncServerSocket::setMultishotAccept(bool enable) {
+  multishotAccept_ = enable;
+  for (auto& handler : sockets_) {
+    handler.setMultishotAccept(enable);
+  }
+}
+
 /**
  * Enable/Disable TOS reflection for the server socket
  * If enabled, the 'accepted' connections will reflect the
@@ -983,128 +990,195 @@ void AsyncServerSocket::handlerReady(
     auto clientSocket = netops::accept(fd, saddr, &addrLen);
 #endif
 
+    int acceptErrno = clientSocket == NetworkSocket() ? errno : 0;
+
     address.setFromSockaddr(saddr, addrLen);
 
-    if (clientSocket != NetworkSocket() && connectionEventCallback_) {
-      connectionEventCallback_->onConnectionAccepted(clientSocket, address);
+    if (!handleAccepted(
+            clientSocket, std::move(address), addressFamily, acceptErrno)) {
+      return;
     }
 
-    // Connection accepted, get the SYN packet from the client if
-    // TOS reflect is enabled
-    if (kIsLinux && clientSocket != NetworkSocket() && tosReflect_) {
-      std::array<uint32_t, 64> buffer;
-      socklen_t len = sizeof(buffer);
-      int ret = netops::getsockopt(
-          clientSocket, IPPROTO_TCP, TCP_SAVED_SYN, &buffer, &len);
-
-      if (ret == 0) {
-        uint32_t tosWord = folly::Endian::big(buffer[0]);
-        if (addressFamily == AF_INET6) {
-          tosWord = (tosWord & 0x0FC00000) >> 20;
-          // Set the TOS on the return socket only if it is non-zero
-          if (tosWord) {
-            ret = netops::setsockopt(
-                clientSocket,
-                IPPROTO_IPV6,
-                IPV6_TCLASS,
-                &tosWord,
-                sizeof(tosWord));
-          }
-        } else if (addressFamily == AF_INET) {
-          tosWord = (tosWord & 0x00FC0000) >> 16;
-          if (tosWord) {
-            ret = netops::setsockopt(
-                clientSocket, IPPROTO_IP, IP_TOS, &tosWord, sizeof(tosWord));
-          }
-        }
-
-        if (ret != 0) {
-          LOG(ERROR) << "Unable to set TOS for accepted socket "
-                     << clientSocket;
-        }
-      } else {
-        LOG(ERROR) << "Unable to get SYN packet for accepted socket "
-                   << clientSocket;
-      }
+    // If we aren't accepting any more, break out of the loop
+    if (!accepting_ || callbacks_.empty()) {
+      break;
     }
+  }
+}
 
-    std::chrono::time_point<std::chrono::steady_clock> nowMs =
-        std::chrono::steady_clock::now();
-    auto timeSinceLastAccept = std::max<int64_t>(
-        0,
-        nowMs.time_since_epoch().count() -
-            lastAccepTimestamp_.time_since_epoch().count());
-    lastAccepTimestamp_ = nowMs;
-    if (acceptRate_ < 1) {
-      acceptRate_ *= 1 + acceptRateAdjustSpeed_ * timeSinceLastAccept;
-      if (acceptRate_ >= 1) {
-        acceptRate_ = 1;
-      } else if (rand() > acceptRate_ * RAND_MAX) {
-        ++numDroppedConnections_;
-        if (clientSocket != NetworkSocket()) {
-          closeNoInt(clientSocket);
-          if (connectionEventCallback_) {
-            connectionEventCallback_->onConnectionDropped(
-                clientSocket,
-                address,
-                fmt::format(
-                    "Server is rate limiting new connections. Current accept rate is {}",
-                    acceptRate_));
-          }
-        }
-        continue;
+void AsyncServerSocket::multishotAcceptReady(
+    int res, sa_family_t addressFamily) noexcept {
+  DestructorGuard dg(this);
+  if (res == -ECANCELED) {
+    return;
+  }
+
+  NetworkSocket clientSocket;
+  SocketAddress address;
+  int acceptErrno = 0;
+  if (res >= 0) {
+    clientSocket = NetworkSocket::fromFd(res);
+
+    // The multishot request does not return the peer address.
+    sockaddr_storage addrStorage = {};
+    socklen_t addrLen = sizeof(addrStorage);
+    auto saddr = reinterpret_cast<sockaddr*>(&addrStorage);
+    saddr->sa_family = addressFamily;
+    if (addressFamily == AF_UNIX) {
+      addrLen = sizeof(struct sockaddr_un);
+    }
+    const char* dropReason = nullptr;
+    if (netops::getpeername(clientSocket, saddr, &addrLen) != 0) {
+      // Usually ENOTCONN: the client reset the connection after the kernel
+      // accepted it. There is no peer address to report.
+      dropReason = "Connection reset before accept";
+    } else {
+      address.setFromSockaddr(saddr, addrLen);
+      if (callbacks_.empty()) {
+        // The last accept callback was removed since the request was armed.
+        dropReason = "No accept callback";
       }
     }
 
-    if (clientSocket == NetworkSocket()) {
-      if (errno == EAGAIN) {
-        // No more sockets to accept right now.
-        // Check for this code first, since it's the most common.
-        return;
-      } else if (errno == EMFILE || errno == ENFILE) {
-        // We're out of file descriptors.  Perhaps we're accepting connections
-        // too quickly. Pause accepting briefly to back off and give the server
-        // a chance to recover.
-        LOG(ERROR) << "accept failed: out of file descriptors; entering accept "
-                      "back-off state";
-        enterBackoff();
-
-        // Dispatch the error message
-        dispatchError("accept() failed", errno);
-      } else {
-        dispatchError("accept() failed", errno);
-      }
+    if (dropReason) {
+      ++numDroppedConnections_;
+      // Report the accept while the fd is still open and can't be reused.
       if (connectionEventCallback_) {
-        connectionEventCallback_->onConnectionAcceptError(errno);
+        connectionEventCallback_->onConnectionAccepted(clientSocket, address);
       }
-      return;
-    }
-
-#if !FOLLY_HAVE_ACCEPT4
-    // Explicitly set the new connection to non-blocking mode
-    if (netops::set_socket_non_blocking(clientSocket) != 0) {
       closeNoInt(clientSocket);
-      std::string errorMsg =
-          "Failed to set accepted socket to non-blocking mode.";
-      dispatchError(errorMsg.c_str(), errno);
       if (connectionEventCallback_) {
         connectionEventCallback_->onConnectionDropped(
-            clientSocket,
-            address,
-            fmt::format("{} errno ({})", std::move(errorMsg), errno));
+            clientSocket, address, dropReason);
       }
       return;
     }
-#endif
+  } else {
+    acceptErrno = -res;
+  }
 
-    // Inform the callback about the new connection
-    dispatchSocket(clientSocket, std::move(address));
+  handleAccepted(clientSocket, std::move(address), addressFamily, acceptErrno);
+}
 
-    // If we aren't accepting any more, break out of the loop
-    if (!accepting_ || callbacks_.empty()) {
-      break;
+bool AsyncServerSocket::handleAccepted(
+    NetworkSocket clientSocket,
+    SocketAddress&& address,
+    sa_family_t addressFamily,
+    int acceptErrno) noexcept {
+  if (clientSocket != NetworkSocket() && connectionEventCallback_) {
+    connectionEventCallback_->onConnectionAccepted(clientSocket, address);
+  }
+
+  // Connection accepted, get the SYN packet from the client if
+  // TOS reflect is enabled
+  if (kIsLinux && clientSocket != NetworkSocket() && tosReflect_) {
+    std::array<uint32_t, 64> buffer;
+    socklen_t len = sizeof(buffer);
+    int ret = netops::getsockopt(
+        clientSocket, IPPROTO_TCP, TCP_SAVED_SYN, &buffer, &len);
+
+    if (ret == 0) {
+      uint32_t tosWord = folly::Endian::big(buffer[0]);
+      if (addressFamily == AF_INET6) {
+        tosWord = (tosWord & 0x0FC00000) >> 20;
+        // Set the TOS on the return socket only if it is non-zero
+        if (tosWord) {
+          ret = netops::setsockopt(
+              clientSocket,
+              IPPROTO_IPV6,
+              IPV6_TCLASS,
+              &tosWord,
+              sizeof(tosWord));
+        }
+      } else if (addressFamily == AF_INET) {
+        tosWord = (tosWord & 0x00FC0000) >> 16;
+        if (tosWord) {
+          ret = netops::setsockopt(
+              clientSocket, IPPROTO_IP, IP_TOS, &tosWord, sizeof(tosWord));
+        }
+      }
+
+      if (ret != 0) {
+        LOG(ERROR) << "Unable to set TOS for accepted socket " << clientSocket;
+      }
+    } else {
+      LOG(ERROR) << "Unable to get SYN packet for accepted socket "
+                 << clientSocket;
     }
   }
+
+  std::chrono::time_point<std::chrono::steady_clock> nowMs =
+      std::chrono::steady_clock::now();
+  auto timeSinceLastAccept = std::max<int64_t>(
+      0,
+      nowMs.time_since_epoch().count() -
+          lastAccepTimestamp_.time_since_epoch().count());
+  lastAccepTimestamp_ = nowMs;
+  if (acceptRate_ < 1) {
+    acceptRate_ *= 1 + acceptRateAdjustSpeed_ * timeSinceLastAccept;
+    if (acceptRate_ >= 1) {
+      acceptRate_ = 1;
+    } else if (rand() > acceptRate_ * RAND_MAX) {
+      ++numDroppedConnections_;
+      if (clientSocket != NetworkSocket()) {
+        closeNoInt(clientSocket);
+        if (connectionEventCallback_) {
+          connectionEventCallback_->onConnectionDropped(
+              clientSocket,
+              address,
+              fmt::format(
+                  "Server is rate limiting new connections. Current accept rate is {}",
+                  acceptRate_));
+        }
+      }
+      return true;
+    }
+  }
+
+  if (clientSocket == NetworkSocket()) {
+    if (acceptErrno == EAGAIN) {
+      // No more sockets to accept right now.
+      // Check for this code first, since it's the most common.
+      return false;
+    } else if (acceptErrno == EMFILE || acceptErrno == ENFILE) {
+      // We're out of file descriptors.  Perhaps we're accepting connections
+      // too quickly. Pause accepting briefly to back off and give the server
+      // a chance to recover.
+      LOG(ERROR) << "accept failed: out of file descriptors; entering accept "
+                    "back-off state";
+      enterBackoff();
+
+      // Dispatch the error message
+      dispatchError("accept() failed", acceptErrno);
+    } else {
+      dispatchError("accept() failed", acceptErrno);
+    }
+    if (connectionEventCallback_) {
+      connectionEventCallback_->onConnectionAcceptError(acceptErrno);
+    }
+    return false;
+  }
+
+#if !FOLLY_HAVE_ACCEPT4
+  // Explicitly set the new connection to non-blocking mode
+  if (netops::set_socket_non_blocking(clientSocket) != 0) {
+    closeNoInt(clientSocket);
+    std::string errorMsg =
+        "Failed to set accepted socket to non-blocking mode.";
+    dispatchError(errorMsg.c_str(), errno);
+    if (connectionEventCallback_) {
+      connectionEventCallback_->onConnectionDropped(
+          clientSocket,
+          address,
+          fmt::format("{} errno ({})", std::move(errorMsg), errno));
+    }
+    return false;
+  }
+#endif
+
+  // Inform the callback about the new connection
+  dispatchSocket(clientSocket, std::move(address));
+  return true;
 }
 
 void AsyncServerSocket::dispatchSocket(
@@ -682,6 +682,19 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
    */
   uint32_t getListenerTos() const { return listenerTos_; }
 
+  /**
+   * Accept connections with one multishot accept request per listening
+   * socket when the EventBase backend supports it (IoUringBackend on kernels
+   * with multishot IORING_OP_ACCEPT). Accepted sockets go through the same
+   * AcceptCallback dispatch as with the default accept4() loop, which other
+   * backends keep using. maxAcceptAtOnce does not apply in this mode.
+   *
+   * Must be called before startAccepting().
+   */
+  void setMultishotAccept(bool enable);
+
+  bool getMultishotAccept() const { return multishotAccept_; }
+
   /**
    * Get the number of connections dropped by the AsyncServerSocket
    */
@@ -928,6 +941,12 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
 
   virtual void handlerReady(
       uint16_t events, NetworkSocket fd, sa_family_t family) noexcept;
+  void multishotAcceptReady(int res, sa_family_t family) noexcept;
+  bool handleAccepted(
+      NetworkSocket clientSocket,
+      SocketAddress&& address,
+      sa_family_t addressFamily,
+      int acceptErrno) noexcept;
 
   NetworkSocket createSocket(int family);
   void setupSocket(NetworkSocket fd, int family);
@@ -959,7 +978,8 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
     return info;
   }
 
-  struct ServerEventHandler : public EventHandler {
+  struct ServerEventHandler : public EventHandler,
+                              public EventAcceptMultishotCallback {
     ServerEventHandler(
         EventBase* eventBase,
         NetworkSocket socket,
@@ -969,14 +989,18 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
           eventBase_(eventBase),
           socket_(socket),
           parent_(parent),
-          addressFamily_(addressFamily) {}
+          addressFamily_(addressFamily) {
+      setMultishotAccept(parent_->multishotAccept_);
+    }
 
     ServerEventHandler(const ServerEventHandler& other)
         : EventHandler(other.eventBase_, other.socket_),
           eventBase_(other.eventBase_),
           socket_(other.socket_),
           parent_(other.parent_),
-          addressFamily_(other.addressFamily_) {}
+          addressFamily_(other.addressFamily_) {
+      setMultishotAccept(parent_->multishotAccept_);
+    }
 
     ServerEventHandler& operator=(const ServerEventHandler& other) {
       if (this != &other) {
@@ -988,6 +1012,7 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
         detachEventBase();
         attachEventBase(other.eventBase_);
         changeHandlerFD(other.socket_);
+        setMultishotAccept(parent_->multishotAccept_);
       }
       return *this;
     }
@@ -997,6 +1022,26 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
       parent_->handlerReady(events, socket_, addressFamily_);
     }
 
+    void setMultishotAccept(bool enable) {
+      if (enable) {
+        setAcceptMultishotCallback(this);
+      } else {
+        resetEventCallback();
+      }
+    }
+
+    // Inherited from EventAcceptMultishotCallback
+    Hdr* allocateAcceptMultishotData() noexcept override {
+      auto* hdr = new Hdr();
+      hdr->arg_ = this;
+      hdr->freeFunc_ = [](Hdr* h) { delete h; };
+      hdr->cbFunc_ = [](Hdr* h, int res) {
+        auto* handler = static_cast<ServerEventHandler*>(h->arg_);
+        handler->parent_->multishotAcceptReady(res, handler->addressFamily_);
+      };
+      return hdr;
+    }
+
     EventBase* eventBase_;
     NetworkSocket socket_;
     AsyncServerSocket* parent_;
@@ -1031,6 +1076,7 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
   bool tosReflect_{false};
   uint32_t listenerTos_{0};
   bool zeroCopyVal_{false};
+  bool multishotAccept_{false};
   folly::observer::AtomicObserver<std::chrono::nanoseconds> queueTimeout_{
       folly::observer::makeStaticObserver(std::chrono::nanoseconds::zero())};
 };
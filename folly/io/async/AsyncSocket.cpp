@@ -27,6 +27,7 @@
 
 #include <folly/Exception.h>
 #include <folly/ExceptionWrapper.h>
+#include <folly/FileUtil.h>
 #include <folly/Format.h>
 #include <folly/Portability.h>
 #include <folly/SocketAddress.h>
@@ -45,7 +46,10 @@
 #if defined(__linux__)
 #include <linux/if_packet.h>
 #include <linux/sockios.h>
+#include <pthread.h>
+#include <signal.h>
 #include <sys/ioctl.h>
+#include <sys/sendfile.h>
 #endif
 
 using ZeroCopyMemStore = folly::AsyncReader::ReadCallback::ZeroCopyMemStore;
@@ -223,6 +227,12 @@ cmsgToScmTimestamping(const cmsghdr& cmsg) {
 }
 
 #endif // FOLLY_HAVE_SO_TIMESTAMPING
+
+std::unique_ptr<const AsyncSocketException> shortFileException() {
+  return std::make_unique<AsyncSocketException>(
+      AsyncSocketException::END_OF_FILE,
+      "file ended before the requested length was written");
+}
 } // namespace
 
 // TODO: It might help performance to provide a version of BytesWriteRequest
@@ -352,7 +362,7 @@ class AsyncSocket::BytesWriteRequest : public AsyncSocket::WriteRequest {
 
     // Increment the totalBytesWritten_ count by bytesWritten_;
     assert(bytesWritten_ >= 0);
-    totalBytesWritten_ += uint32_t(bytesWritten_);
+    totalBytesWritten_ += uint64_t(bytesWritten_);
   }
 
  private:
@@ -405,6 +415,135 @@ class AsyncSocket::BytesWriteRequest : public AsyncSocket::WriteRequest {
   struct iovec writeOps_[]; ///< write operation(s) list
 };
 
+/* The WriteRequest used by writeFile()
+ *
+ * Sends the file with sendfile() when the socket allows it. Otherwise reads
+ * the file into a buffer, one chunk at a time, and writes each chunk with
+ * performWrite() like any other data, so that sockets which transform their
+ * data (e.g. TLS) see every byte.
+ */
+class AsyncSocket::FileWriteRequest : public AsyncSocket::WriteRequest {
+ public:
+  FileWriteRequest(
+      AsyncSocket* socket,
+      WriteCallbackWithState callbackWithState,
+      int fd,
+      off_t offset,
+      size_t length,
+      WriteFlags flags)
+      : AsyncSocket::WriteRequest(socket, callbackWithState),
+        fd_(fd),
+        offset_(offset),
+        remaining_(length),
+        // Chunks are copied, and sendfile() never sends from user memory.
+        flags_(flags & ~WriteFlags::WRITE_MSG_ZEROCOPY) {}
+
+  void destroy() override { delete this; }
+
+  WriteResult performWrite() override {
+    bytesWritten_ = 0;
+    while (bytesWritten_ < remaining_) {
+      size_t attempted = 0;
+      auto writeResult = (buf_ || !socket_->canSendFile())
+          ? writeChunk(attempted)
+          : sendFile(attempted);
+      if (writeResult.writeReturn < 0) {
+        // Report what was written; the error recurs on the next attempt.
+        return bytesWritten_ == 0 ? std::move(writeResult)
+                                  : WriteResult(ssize_t(bytesWritten_));
+      }
+      if (size_t(writeResult.writeReturn) < attempted) {
+        // The socket buffer is full.
+        break;
+      }
+    }
+    return WriteResult(ssize_t(bytesWritten_));
+  }
+
+  bool isComplete() override { return bytesWritten_ == remaining_; }
+
+  void consume() override {
+    offset_ += off_t(bytesWritten_);
+    remaining_ -= bytesWritten_;
+    totalBytesWritten_ += uint64_t(bytesWritten_);
+  }
+
+ private:
+  // The size of the chunks read when sendfile() can't be used.
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  WriteResult sendFile(size_t& attempted) {
+    attempted = remaining_ - bytesWritten_;
+    auto writeResult = socket_->performSendFile(
+        fd_, offset_ + off_t(bytesWritten_), attempted);
+    if (writeResult.writeReturn < 0 && !writeResult.exception &&
+        (errno == EINVAL || errno == ENOSYS)) {
+      // This file can't be sent with sendfile() (e.g. it isn't mmap()-able),
+      // so read it instead.
+      return writeChunk(attempted);
+    }
+    if (writeResult.writeReturn > 0) {
+      bytesWritten_ += size_t(writeResult.writeReturn);
+    }
+    return writeResult;
+  }
+
+  WriteResult writeChunk(size_t& attempted) {
+    if (!buf_) {
+      buf_ = IOBuf::create(std::min(remaining_, kChunkSize));
+    }
+    if (buf_->empty()) {
+      buf_->clear();
+      auto size = std::min(remaining_ - bytesWritten_, buf_->capacity());
+      auto n = preadNoInt(
+          fd_, buf_->writableData(), size, offset_ + off_t(bytesWritten_));
+      if (n < 0) {
+        return WriteResult(
+            WRITE_ERROR,
+            std::make_unique<AsyncSocketException>(
+                AsyncSocketException::INTERNAL_ERROR,
+                "failed to read file for writing",
+                errno));
+      }
+      if (n == 0) {
+        return WriteResult(WRITE_ERROR, shortFileException());
+      }
+      buf_->append(size_t(n));
+    }
+
+    // Only the last chunk of the last request may end a record.
+    WriteFlags flags = flags_;
+    if (buf_->length() < remaining_ - bytesWritten_ || getNext() != nullptr) {
+      flags = (flags & ~WriteFlags::EOR) | WriteFlags::CORK;
+    }
+    iovec op;
+    op.iov_base = buf_->writableData();
+    op.iov_len = buf_->length();
+    attempted = op.iov_len;
+    uint32_t countWritten = 0;
+    uint32_t partialWritten = 0;
+    auto writeResult = socket_->performWrite(
+        &op,
+        1,
+        flags,
+        &countWritten,
+        &partialWritten,
+        WriteRequestTag{buf_.get()});
+    if (writeResult.writeReturn > 0) {
+      buf_->trimStart(size_t(writeResult.writeReturn));
+      bytesWritten_ += size_t(writeResult.writeReturn);
+    }
+    return writeResult;
+  }
+
+  const int fd_;
+  off_t offset_; ///< offset in the file of the next byte to write
+  size_t remaining_; ///< bytes left to write, as of the last consume()
+  const WriteFlags flags_;
+  size_t bytesWritten_{0}; ///< bytes written by the last performWrite()
+  std::unique_ptr<IOBuf> buf_; ///< chunk being written, if not sendfile()
+};
+
 int AsyncSocket::SendMsgParamsCallback::getDefaultFlags(
     folly::WriteFlags flags, bool zeroCopyEnabled) noexcept {
   int msg_flags = MSG_DONTWAIT;
@@ -1387,6 +1526,18 @@ void AsyncSocket::setZeroCopyReenableThreshold(size_t threshold) {
   zeroCopyReenableThreshold_ = threshold;
 }
 
+void AsyncSocket::setAdaptiveZeroCopy(AdaptiveZeroCopyPolicy::Options options) {
+  adaptiveZeroCopy_ = std::make_unique<AdaptiveZeroCopyPolicy>(options);
+}
+
+Optional<AdaptiveZeroCopyPolicy::Stats> AsyncSocket::getAdaptiveZeroCopyStats()
+    const {
+  if (!adaptiveZeroCopy_) {
+    return none;
+  }
+  return adaptiveZeroCopy_->getStats();
+}
+
 bool AsyncSocket::isZeroCopyRequest(WriteFlags flags) {
   return (zeroCopyEnabled_ && isSet(flags, WriteFlags::WRITE_MSG_ZEROCOPY));
 }
@@ -1409,6 +1560,9 @@ void AsyncSocket::adjustZeroCopyFlags(folly::WriteFlags& flags) {
 void AsyncSocket::addZeroCopyBuf(
     std::unique_ptr<folly::IOBuf>&& buf, ReleaseIOBufCallback* cb) {
   uint32_t id = getNextZeroCopyBufId();
+  if (adaptiveZeroCopy_) {
+    adaptiveZeroCopy_->onZeroCopySend(id);
+  }
   folly::IOBuf* ptr = buf.get();
 
   idZeroCopyBufPtrMap_[id] = ptr;
@@ -1421,6 +1575,9 @@ void AsyncSocket::addZeroCopyBuf(
 
 void AsyncSocket::addZeroCopyBuf(folly::IOBuf* ptr) {
   uint32_t id = getNextZeroCopyBufId();
+  if (adaptiveZeroCopy_) {
+    adaptiveZeroCopy_->onZeroCopySend(id);
+  }
   idZeroCopyBufPtrMap_[id] = ptr;
 
   idZeroCopyBufInfoMap_[ptr].count_++;
@@ -1474,8 +1631,12 @@ void AsyncSocket::processZeroCopyMsg(const cmsghdr& cmsg) {
       reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(&cmsg));
   uint32_t hi = serr->ee_data;
   uint32_t lo = serr->ee_info;
-  // disable zero copy if the buffer was actually copied
-  if ((serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) && zeroCopyEnabled_) {
+  bool copied = serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED;
+  if (adaptiveZeroCopy_) {
+    // accounted for once the error queue is drained
+    adaptiveZeroCopy_->onCompletion(lo, hi, copied);
+  } else if (copied && zeroCopyEnabled_) {
+    // disable zero copy if the buffer was actually copied
     VLOG(2) << "AsyncSocket::processZeroCopyMsg(): setting "
             << "zeroCopyEnabled_ = false due to SO_EE_CODE_ZEROCOPY_COPIED "
             << "on " << fd_;
@@ -1725,7 +1886,15 @@ void AsyncSocket::writeChain(
   adjustZeroCopyFlags(flags);
 
   // adjustZeroCopyFlags can set zeroCopyEnabled_ to true
-  if (zeroCopyEnabled_ && !isSet(flags, WriteFlags::WRITE_MSG_ZEROCOPY) &&
+  if (zeroCopyEnabled_ && adaptiveZeroCopy_) {
+    if (buf->isManaged() &&
+        adaptiveZeroCopy_->shouldZeroCopy(buf->computeChainDataLength())) {
+      flags |= WriteFlags::WRITE_MSG_ZEROCOPY;
+    } else {
+      flags = unSet(flags, WriteFlags::WRITE_MSG_ZEROCOPY);
+    }
+  } else if (
+      zeroCopyEnabled_ && !isSet(flags, WriteFlags::WRITE_MSG_ZEROCOPY) &&
       zeroCopyEnableFunc_ && zeroCopyEnableFunc_(buf) && buf->isManaged()) {
     flags |= WriteFlags::WRITE_MSG_ZEROCOPY;
   }
@@ -1880,6 +2049,85 @@ void AsyncSocket::writeImpl(
     return failWrite(__func__, callback, size_t(bytesWritten), tex);
   }
   req->consume();
+  queueWriteRequest(req, mustRegister);
+}
+
+void AsyncSocket::writeFile(
+    WriteCallback* callback,
+    int fd,
+    off_t offset,
+    size_t length,
+    WriteFlags flags) {
+  VLOG(6) << "AsyncSocket::writeFile() this=" << this << ", fd=" << fd_
+          << ", callback=" << callback << ", file=" << fd
+          << ", offset=" << offset << ", length=" << length
+          << ", state=" << state_;
+  DestructorGuard dg(this);
+  eventBase_->dcheckIsInEventBaseThread();
+  WriteCallbackWithState callbackWithState(callback);
+
+  totalAppBytesScheduledForWrite_ += length;
+
+  if (shutdownFlags_ & (SHUT_WRITE | SHUT_WRITE_PENDING)) {
+    // See writeImpl().
+    return invalidState(callback);
+  }
+
+  bool writeNow = false;
+  if ((state_ == StateEnum::ESTABLISHED || state_ == StateEnum::FAST_OPEN) &&
+      !connecting()) {
+    writeNow = writeReqHead_ == nullptr;
+  } else if (!connecting()) {
+    // Invalid state for writing
+    return invalidState(callback);
+  }
+
+  WriteRequest* req;
+  try {
+    req = new FileWriteRequest(
+        this, callbackWithState, fd, offset, length, flags);
+  } catch (const std::exception& ex) {
+    AsyncSocketException tex(
+        AsyncSocketException::INTERNAL_ERROR,
+        withAddr(string("failed to append new WriteRequest: ") + ex.what()));
+    return failWrite(__func__, callback, 0, tex);
+  }
+
+  bool mustRegister = false;
+  if (writeNow) {
+    // If there are no other writes pending, attempt the write immediately.
+    assert(writeReqTail_ == nullptr);
+    assert((eventFlags_ & EventHandler::WRITE) == 0);
+
+    req->getCallbackWithState().notifyOnWrite();
+    auto writeResult = req->performWrite();
+    if (writeResult.writeReturn < 0) {
+      auto errnoCopy = errno;
+      req->destroy();
+      if (writeResult.exception) {
+        return failWrite(__func__, callback, 0, *writeResult.exception);
+      }
+      AsyncSocketException ex(
+          AsyncSocketException::INTERNAL_ERROR,
+          withAddr("sendfile failed"),
+          errnoCopy);
+      return failWrite(__func__, callback, 0, ex);
+    } else if (req->isComplete()) {
+      req->destroy();
+      if (callback) {
+        callback->writeSuccess();
+      }
+      return;
+    }
+    req->consume();
+    // Writes might put the socket back into connecting state if TFO is
+    // enabled, and using TFO fails.
+    mustRegister = !connecting();
+  }
+  queueWriteRequest(req, mustRegister);
+}
+
+void AsyncSocket::queueWriteRequest(WriteRequest* req, bool mustRegister) {
   if (writeReqTail_ == nullptr) {
     assert(writeReqHead_ == nullptr);
     writeReqHead_ = writeReqTail_ = req;
@@ -2799,6 +3047,9 @@ size_t AsyncSocket::handleErrMessages() noexcept {
         failErrMessageRead(__func__, ex);
       }
 
+      if (adaptiveZeroCopy_) {
+        adaptiveZeroCopy_->endCompletionBatch();
+      }
       return num;
     }
 
@@ -2860,6 +3111,9 @@ size_t AsyncSocket::handleErrMessages() noexcept {
       }
     }
   }
+  if (adaptiveZeroCopy_) {
+    adaptiveZeroCopy_->endCompletionBatch();
+  }
   return num;
 #else
   return 0;
@@ -3875,6 +4129,105 @@ AsyncSocket::WriteResult AsyncSocket::sendSocketMessage(
   return WriteResult(totalWritten);
 }
 
+#if defined(__linux__)
+namespace {
+
+// Whether a write may raise SIGPIPE on this thread: not if SIGPIPE is
+// ignored, as servers usually do at startup, or blocked. Checked on the first
+// call of each thread, as the check costs two system calls.
+bool sigpipeMayBeRaised() {
+  static thread_local const bool mayBeRaised = [] {
+    struct sigaction action;
+    if (sigaction(SIGPIPE, nullptr, &action) == 0 &&
+        !(action.sa_flags & SA_SIGINFO) && action.sa_handler == SIG_IGN) {
+      return false;
+    }
+    sigset_t mask;
+    return !(
+        pthread_sigmask(SIG_BLOCK, nullptr, &mask) == 0 &&
+        sigismember(&mask, SIGPIPE) == 1);
+  }();
+  return mayBeRaised;
+}
+
+} // namespace
+#endif
+
+ssize_t AsyncSocket::writeWithoutSigpipe(FunctionRef<ssize_t()> op) {
+#if defined(__linux__)
+  if (!sigpipeMayBeRaised()) {
+    return op();
+  }
+  // SIGPIPE is blocked around the write, and the one raised when the peer
+  // has gone away is discarded, unless the thread already had one pending.
+  // This costs two to four system calls on top of the write.
+  sigset_t sigpipe;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  sigset_t oldMask;
+  if (pthread_sigmask(SIG_BLOCK, &sigpipe, &oldMask) != 0) {
+    return op();
+  }
+  sigset_t pending;
+  bool const wasPending =
+      sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE) == 1;
+
+  auto rv = op();
+  if (rv < 0 && errno == EPIPE && !wasPending) {
+    struct timespec const zero = {0, 0};
+    while (sigtimedwait(&sigpipe, nullptr, &zero) < 0 && errno == EINTR) {
+    }
+    errno = EPIPE;
+  }
+  auto savedErrno = errno;
+  pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+  errno = savedErrno;
+  return rv;
+#else
+  return op();
+#endif
+}
+
+bool AsyncSocket::canSendFile() const {
+#if defined(__linux__)
+  // TFO sends its data along with the SYN, which needs sendmsg().
+  return state_ == StateEnum::ESTABLISHED;
+#else
+  return false;
+#endif
+}
+
+AsyncSocket::WriteResult AsyncSocket::performSendFile(
+    int fd, off_t offset, size_t length) {
+#if defined(__linux__)
+  // sendfile() has no MSG_NOSIGNAL.
+  auto totalWritten = writeWithoutSigpipe([&] {
+    return ::sendfile(
+        fd_.toFd(), fd, &offset, std::min<size_t>(length, SSIZE_MAX));
+  });
+  if (totalWritten < 0) {
+    if (errno == EAGAIN) {
+      // TCP buffer is full; we can't write any more data right now.
+      return WriteResult(0);
+    }
+    return WriteResult(WRITE_ERROR);
+  }
+  if (totalWritten == 0 && length != 0) {
+    // A full socket buffer fails with EAGAIN, so this is the end of the file.
+    return WriteResult(WRITE_ERROR, shortFileException());
+  }
+  appBytesWritten_ += totalWritten;
+  rawBytesWritten_ += totalWritten;
+  return WriteResult(totalWritten);
+#else
+  (void)fd;
+  (void)offset;
+  (void)length;
+  errno = ENOSYS;
+  return WriteResult(WRITE_ERROR);
+#endif
+}
+
 AsyncSocket::WriteResult AsyncSocket::performWrite(
     const iovec* vec,
     uint32_t count,
@@ -4097,7 +4450,7 @@ void AsyncSocket::failWrite(const char* fn, const AsyncSocketException& ex) {
     WriteRequest* req = writeReqHead_;
     writeReqHead_ = req->getNext();
     WriteCallback* callback = req->getCallback();
-    uint32_t bytesWritten = req->getTotalBytesWritten();
+    uint64_t bytesWritten = req->getTotalBytesWritten();
     req->destroy();
     if (callback) {
       callback->writeErr(bytesWritten, ex);
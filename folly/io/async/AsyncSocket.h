@@ -23,6 +23,7 @@
 #include <memory>
 
 #include <folly/ConstructorCallbackList.h>
+#include <folly/Function.h>
 #include <folly/Optional.h>
 #include <folly/SocketAddress.h>
 #include <folly/detail/SocketFastOpen.h>
@@ -30,6 +31,7 @@
 #include <folly/io/IOBufIovecBuilder.h>
 #include <folly/io/ShutdownSocketSet.h>
 #include <folly/io/SocketOptionMap.h>
+#include <folly/io/async/AdaptiveZeroCopyPolicy.h>
 #include <folly/io/async/AsyncSocketException.h>
 #include <folly/io/async/AsyncSocketTransport.h>
 #include <folly/io/async/AsyncTimeout.h>
@@ -826,6 +828,23 @@ class AsyncSocket : public AsyncSocketTransport {
 
   void setZeroCopyReenableThreshold(size_t threshold);
 
+  /**
+   * Let an AdaptiveZeroCopyPolicy pick the writes that use MSG_ZEROCOPY,
+   * once zerocopy is enabled with setZeroCopy(true).
+   *
+   * The policy decides for every writeChain() of a managed IOBuf whether it
+   * uses zerocopy, regardless of WRITE_MSG_ZEROCOPY and any
+   * ZeroCopyEnableFunc.  Other writes are copied.  The kernel copying the
+   * data of a zerocopy send makes the policy use zerocopy for larger writes
+   * only, instead of disabling zerocopy for the socket.
+   */
+  void setAdaptiveZeroCopy(AdaptiveZeroCopyPolicy::Options options);
+
+  /**
+   * Counters of the adaptive zerocopy policy, none if it isn't enabled.
+   */
+  Optional<AdaptiveZeroCopyPolicy::Stats> getAdaptiveZeroCopyStats() const;
+
   void write(
       WriteCallback* callback,
       const void* buf,
@@ -841,6 +860,37 @@ class AsyncSocket : public AsyncSocketTransport {
       std::unique_ptr<folly::IOBuf>&& buf,
       WriteFlags flags = WriteFlags::NONE) override;
 
+  /**
+   * Write length bytes of the file fd, starting at offset.
+   *
+   * The write is queued behind any earlier writes and completes through
+   * callback exactly like writeChain(). Where possible the data is sent
+   * with sendfile(), straight from the page cache, without being copied
+   * into user space. Sockets whose bytes on the wire differ from the bytes
+   * written (e.g. TLS), and platforms without sendfile(), read the file in
+   * chunks and write them as regular buffers instead.
+   *
+   * The caller must keep fd open until the callback is invoked. Writes sent
+   * with sendfile() are not seen by prewrite observers and do not generate
+   * byte events. Like other writes they don't raise SIGPIPE if the peer has
+   * gone away: SIGPIPE is blocked around sendfile(), unless it was already
+   * ignored or blocked at the first such write of the thread, which then
+   * costs nothing per call. A file shorter than offset + length fails the
+   * write.
+   *
+   * @param callback  Write completion/error callback.
+   * @param fd        File to read from; its file offset is not changed.
+   * @param offset    Offset in the file of the first byte to write.
+   * @param length    Number of bytes to write.
+   * @param flags     Set of write flags, like EOR.
+   */
+  void writeFile(
+      WriteCallback* callback,
+      int fd,
+      off_t offset,
+      size_t length,
+      WriteFlags flags = WriteFlags::NONE);
+
   class WriteRequest;
   virtual void writeRequest(WriteRequest* req);
   void writeRequestReady() { handleWrite(); }
@@ -1284,7 +1334,7 @@ class AsyncSocket : public AsyncSocketTransport {
       return callbackWithState_;
     }
 
-    uint32_t getTotalBytesWritten() const { return totalBytesWritten_; }
+    uint64_t getTotalBytesWritten() const { return totalBytesWritten_; }
 
     void append(WriteRequest* next) {
       assert(next_ == nullptr);
@@ -1296,7 +1346,7 @@ class AsyncSocket : public AsyncSocketTransport {
     }
 
     void bytesWritten(size_t count) {
-      totalBytesWritten_ += uint32_t(count);
+      totalBytesWritten_ += count;
       socket_->appBytesWritten_ += count;
     }
 
@@ -1308,7 +1358,7 @@ class AsyncSocket : public AsyncSocketTransport {
     WriteRequest* next_{nullptr}; ///< pointer to next WriteRequest
     WriteCallbackWithState callbackWithState_; ///< completion callback
     ReleaseIOBufCallback* releaseIOBufCallback_; ///< release IOBuf callback
-    uint32_t totalBytesWritten_{0}; ///< total bytes written
+    uint64_t totalBytesWritten_{0}; ///< total bytes written
   };
 
  public:
@@ -1585,6 +1635,7 @@ class AsyncSocket : public AsyncSocketTransport {
   };
 
   class BytesWriteRequest;
+  class FileWriteRequest;
 
   class WriteTimeout : public AsyncTimeout {
    public:
@@ -1716,6 +1767,17 @@ class AsyncSocket : public AsyncSocketTransport {
       size_t totalBytes,
       WriteFlags flags = WriteFlags::NONE);
 
+  /**
+   * Append a request that could not be completed immediately to the write
+   * queue.
+   *
+   * @param req           The request to queue.
+   * @param mustRegister  Whether the request was partially written by the
+   *                      caller, so write events and the send timeout must
+   *                      be set up now.
+   */
+  void queueWriteRequest(WriteRequest* req, bool mustRegister);
+
   /**
    * Attempt to write to the socket.
    *
@@ -1739,6 +1801,34 @@ class AsyncSocket : public AsyncSocketTransport {
       uint32_t* partialWritten,
       WriteRequestTag writeTag);
 
+  /**
+   * Whether writeFile() may send file data with sendfile(), i.e. whether the
+   * socket sends the bytes it is given unchanged.
+   */
+  virtual bool canSendFile() const;
+
+  /**
+   * Attempt to send part of a file to the socket with sendfile().
+   *
+   * @param fd      The file to send from.
+   * @param offset  Offset in the file of the first byte to send.
+   * @param length  Number of bytes to send.
+   *
+   * @return Returns a WriteResult with the number of bytes sent, which is 0
+   *         if the socket buffer is full. See WriteResult for more details.
+   */
+  WriteResult performSendFile(int fd, off_t offset, size_t length);
+
+  /**
+   * Calls op, which writes to a socket with a system call that has no
+   * MSG_NOSIGNAL, such that it doesn't raise SIGPIPE if the peer has gone
+   * away, like the other writes. Threads on which SIGPIPE was ignored or
+   * blocked at their first call skip the signal mask changes.
+   *
+   * @return Returns what op returns, with errno preserved.
+   */
+  static ssize_t writeWithoutSigpipe(FunctionRef<ssize_t()> op);
+
   /**
    * Prepares a msghdr and sends the message over the socket using sendmsg
    *
@@ -1879,6 +1969,7 @@ class AsyncSocket : public AsyncSocketTransport {
   virtual void enableByteEvents();
 
   AsyncWriter::ZeroCopyEnableFunc zeroCopyEnableFunc_;
+  std::unique_ptr<AdaptiveZeroCopyPolicy> adaptiveZeroCopy_;
 
   // a folly::IOBuf can be used in multiple partial requests
   // there is a that maps a buffer id to a raw folly::IOBuf ptr
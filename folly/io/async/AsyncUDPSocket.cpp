@@ -1226,6 +1226,9 @@ void AsyncUDPSocket::handleRead() noexcept {
   if (readCallback_->shouldOnlyNotify()) {
     return readCallback_->onNotifyDataAvailable(*this);
   }
+  if (auto batchSize = readCallback_->getReadBatchSize()) {
+    return handleReadBatch(batchSize);
+  }
 
   size_t numReads = maxReadsPerEvent_ ? maxReadsPerEvent_ : size_t(-1);
   EventBase* originalEventBase = eventBase_;
@@ -1356,6 +1359,126 @@ void AsyncUDPSocket::handleRead() noexcept {
   }
 }
 
+void AsyncUDPSocket::handleReadBatch(size_t batchSize) noexcept {
+  size_t bufferSize = readCallback_->getReadBatchBufferSize();
+  if (bufferSize == 0) {
+    AsyncSocketException ex(
+        AsyncSocketException::BAD_ARGS,
+        "AsyncUDPSocket::getReadBatchBufferSize() returned 0");
+
+    auto cob = readCallback_;
+    readCallback_ = nullptr;
+
+    cob->onReadError(ex);
+    updateRegistration();
+    return;
+  }
+
+  size_t controlSize = 0;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  bool use_gro = gro_.has_value() && (gro_.value() > 0);
+  bool use_ts = ts_.has_value() && (ts_.value() > 0);
+  if (use_gro || use_ts || recvTos_) {
+    controlSize = ReadCallback::OnDataAvailableParams::kCmsgSpace;
+  }
+#endif
+
+  auto& batch = readBatch_;
+  batch.msgs.resize(batchSize);
+  batch.iovecs.resize(batchSize);
+  batch.addrs.resize(batchSize);
+  batch.control.resize(batchSize * controlSize);
+  batch.datagrams.resize(batchSize);
+
+  size_t numReads = maxReadsPerEvent_ ? maxReadsPerEvent_ : size_t(-1);
+  EventBase* originalEventBase = eventBase_;
+  while (numReads-- && readCallback_ && eventBase_ == originalEventBase) {
+    // Reuse the slab unless the previous callback kept a reference to it
+    if (!batch.slab || batch.slab->isShared() ||
+        batch.slab->capacity() < batchSize * bufferSize) {
+      batch.slab = IOBuf::create(batchSize * bufferSize);
+    }
+    uint8_t* slabData = batch.slab->writableData();
+
+    for (size_t i = 0; i < batchSize; ++i) {
+      auto& msg = batch.msgs[i].msg_hdr;
+      msg = {};
+
+      batch.iovecs[i].iov_base = slabData + i * bufferSize;
+      batch.iovecs[i].iov_len = bufferSize;
+      msg.msg_iov = &batch.iovecs[i];
+      msg.msg_iovlen = 1;
+
+      auto rawAddr = reinterpret_cast<sockaddr*>(&batch.addrs[i]);
+      memset(rawAddr, 0, sizeof(batch.addrs[i]));
+      rawAddr->sa_family = localAddress_.getFamily();
+      msg.msg_name = rawAddr;
+      msg.msg_namelen = sizeof(batch.addrs[i]);
+
+      if (controlSize) {
+        memset(&batch.control[i * controlSize], 0, controlSize);
+        msg.msg_control = &batch.control[i * controlSize];
+        msg.msg_controllen = controlSize;
+      }
+    }
+
+#ifdef _WIN32
+    unsigned int flags = 0;
+#else
+    unsigned int flags = MSG_TRUNC;
+#endif
+    int ret =
+        recvmmsg(batch.msgs.data(), (unsigned int)batchSize, flags, nullptr);
+    if (ret < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // No data could be read without blocking the socket
+        return;
+      }
+
+      AsyncSocketException ex(
+          AsyncSocketException::INTERNAL_ERROR, "::recvmmsg() failed", errno);
+
+      // As in handleRead(), the caller has to resume reading
+      auto cob = readCallback_;
+      readCallback_ = nullptr;
+
+      cob->onReadError(ex);
+      updateRegistration();
+      return;
+    }
+
+    // Empty datagrams are delivered too, as by handleRead().
+    size_t numDatagrams = size_t(ret);
+    for (size_t i = 0; i < numDatagrams; ++i) {
+      auto& msg = batch.msgs[i].msg_hdr;
+      size_t len = batch.msgs[i].msg_len;
+
+      auto& datagram = batch.datagrams[i];
+      datagram.client.setFromSockaddr(
+          reinterpret_cast<sockaddr*>(&batch.addrs[i]), msg.msg_namelen);
+      datagram.truncated = len > bufferSize;
+      datagram.data = ByteRange(
+          slabData + i * bufferSize, std::min(len, bufferSize));
+      datagram.params = ReadCallback::OnDataAvailableParams();
+      if (controlSize) {
+        fromMsg(datagram.params, msg);
+      }
+    }
+
+    if (numDatagrams > 0) {
+      readCallback_->onDataAvailableBatch(
+          Range<const ReadCallback::Datagram*>(
+              batch.datagrams.data(), numDatagrams),
+          *batch.slab);
+    }
+
+    if (size_t(ret) < batchSize) {
+      // The socket has been drained
+      return;
+    }
+  }
+}
+
 bool AsyncUDPSocket::updateRegistration() noexcept {
   uint16_t flags = NONE;
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <folly/io/SocketOptionMap.h>
 
 #include <folly/Function.h>
@@ -59,6 +60,20 @@ class AsyncUDPSocket : public EventHandler {
 #endif
     };
 
+    /**
+     * A datagram read as part of a batch, see getReadBatchSize().
+     * `data` points into the slab passed to onDataAvailableBatch() and is
+     * only valid for the duration of that call.
+     */
+    struct Datagram {
+      folly::SocketAddress client;
+      folly::ByteRange data;
+      bool truncated{false};
+      OnDataAvailableParams params;
+    };
+
+    static constexpr size_t kDefaultReadBatchBufferSize = 2048;
+
     /**
      * Invoked when the socket becomes readable and we want buffer
      * to write to.
@@ -97,6 +112,37 @@ class AsyncUDPSocket : public EventHandler {
      */
     virtual bool shouldOnlyNotify() { return false; }
 
+    /**
+     * Returns the maximum number of datagrams to read with a single
+     * recvmmsg() call. If this returns a non-zero value, AsyncUDPSocket
+     * reads into a buffer slab it owns and invokes onDataAvailableBatch()
+     * instead of getReadBuffer() and onDataAvailable().
+     *
+     * Each read of maxReadsPerEvent is then one batch.
+     */
+    virtual size_t getReadBatchSize() noexcept { return 0; }
+
+    /**
+     * Returns the space reserved for each datagram of a batch. Bytes past
+     * this are dropped and the datagram is marked as truncated.
+     */
+    virtual size_t getReadBatchBufferSize() noexcept {
+      return kDefaultReadBatchBufferSize;
+    }
+
+    /**
+     * Invoked with the datagrams read by one recvmmsg() call when
+     * getReadBatchSize() returns a non-zero value.
+     *
+     * The slab is reused for the next batch unless the callback keeps a
+     * reference to it: to hold on to a datagram without copying it, clone
+     * the slab and trim the clone down to `data`. A new slab is then
+     * allocated for the next batch.
+     */
+    virtual void onDataAvailableBatch(
+        folly::Range<const Datagram*> /* datagrams */,
+        const folly::IOBuf& /* slab */) noexcept {}
+
     /**
      * Invoked when there is an error reading from the socket.
      *
@@ -571,6 +617,7 @@ class AsyncUDPSocket : public EventHandler {
   void handlerReady(uint16_t events) noexcept override;
 
   void handleRead() noexcept;
+  void handleReadBatch(size_t batchSize) noexcept;
   bool updateRegistration() noexcept;
   void maybeUpdateDynamicCmsgs() noexcept;
 
@@ -583,6 +630,17 @@ class AsyncUDPSocket : public EventHandler {
   // Temp space to receive client address
   folly::SocketAddress clientAddress_;
 
+  // Buffers for batched reads, kept across events to avoid reallocating
+  struct ReadBatch {
+    std::unique_ptr<folly::IOBuf> slab;
+    std::vector<struct mmsghdr> msgs;
+    std::vector<struct iovec> iovecs;
+    std::vector<struct sockaddr_storage> addrs;
+    std::vector<char> control;
+    std::vector<ReadCallback::Datagram> datagrams;
+  };
+  ReadBatch readBatch_;
+
   // If the socket is connected.
   folly::SocketAddress connectedAddress_;
   bool connected_{false};
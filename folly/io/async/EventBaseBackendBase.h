@@ -97,18 +97,40 @@ class EventRecvmsgMultishotCallback {
   virtual Hdr* allocateRecvmsgMultishotData() noexcept = 0;
 };
 
+// Lets a backend that can accept connections itself (e.g. with a multishot
+// IORING_OP_ACCEPT) do so on a listening socket instead of reporting it as
+// readable. The callback is invoked with the accepted fd or -errno.
+class EventAcceptMultishotCallback {
+ public:
+  struct Hdr {
+    virtual ~Hdr() = default;
+    using FreeFunc = void (*)(Hdr*);
+    using CallbackFunc = void (*)(Hdr*, int);
+    void* arg_{nullptr};
+    FreeFunc freeFunc_{nullptr};
+    CallbackFunc cbFunc_{nullptr};
+  };
+
+  EventAcceptMultishotCallback() = default;
+  virtual ~EventAcceptMultishotCallback() = default;
+
+  virtual Hdr* allocateAcceptMultishotData() noexcept = 0;
+};
+
 struct EventCallback {
   enum class Type {
     TYPE_NONE = 0,
     TYPE_READ = 1,
     TYPE_RECVMSG = 2,
-    TYPE_RECVMSG_MULTISHOT = 3
+    TYPE_RECVMSG_MULTISHOT = 3,
+    TYPE_ACCEPT_MULTISHOT = 4
   };
   Type type_{Type::TYPE_NONE};
   union {
     EventReadCallback* readCb_;
     EventRecvmsgCallback* recvmsgCb_;
     EventRecvmsgMultishotCallback* recvmsgMultishotCb_;
+    EventAcceptMultishotCallback* acceptMultishotCb_;
   };
 
   void set(EventReadCallback* cb) {
@@ -126,6 +148,11 @@ struct EventCallback {
     recvmsgMultishotCb_ = cb;
   }
 
+  void set(EventAcceptMultishotCallback* cb) {
+    type_ = Type::TYPE_ACCEPT_MULTISHOT;
+    acceptMultishotCb_ = cb;
+  }
+
   void reset() { type_ = Type::TYPE_NONE; }
 };
 
@@ -173,6 +200,8 @@ class EventBaseEvent {
 
   void setCallback(EventRecvmsgMultishotCallback* cb) { cb_.set(cb); }
 
+  void setCallback(EventAcceptMultishotCallback* cb) { cb_.set(cb); }
+
   void resetCallback() { cb_.reset(); }
 
   const EventCallback& getCallback() const { return cb_; }
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/AdaptiveZeroCopyPolicy.h>
+
+#include <limits>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace std::chrono_literals;
+using folly::AdaptiveZeroCopyPolicy;
+
+namespace {
+
+AdaptiveZeroCopyPolicy::Options options() {
+  return AdaptiveZeroCopyPolicy::Options()
+      .setMinWriteSize(1000)
+      .setMaxWriteSize(8000)
+      .setMaxCompletionLatency(10ms);
+}
+
+} // namespace
+
+TEST(AdaptiveZeroCopyPolicy, Threshold) {
+  AdaptiveZeroCopyPolicy policy(options());
+  EXPECT_FALSE(policy.shouldZeroCopy(999));
+  EXPECT_TRUE(policy.shouldZeroCopy(1000));
+
+  auto stats = policy.getStats();
+  EXPECT_EQ(1, stats.zeroCopyWrites);
+  EXPECT_EQ(1000, stats.zeroCopyBytes);
+  EXPECT_EQ(1, stats.copyWrites);
+  EXPECT_EQ(999, stats.copyBytes);
+  EXPECT_EQ(1000, stats.threshold);
+}
+
+TEST(AdaptiveZeroCopyPolicy, Copied) {
+  AdaptiveZeroCopyPolicy policy(options());
+  auto now = AdaptiveZeroCopyPolicy::Clock::now();
+  uint32_t id = 0;
+  for (size_t expected : {2000, 4000, 8000, 8000}) {
+    policy.onZeroCopySend(id, now);
+    policy.onCompletion(id, id, true);
+    policy.endCompletionBatch(now + 1ms);
+    ++id;
+    EXPECT_EQ(expected, policy.threshold());
+  }
+  EXPECT_FALSE(policy.shouldZeroCopy(7999));
+  EXPECT_TRUE(policy.shouldZeroCopy(8000));
+
+  // Back toward the minimum once the kernel stops copying.
+  for (size_t expected : {4500, 2750, 1875}) {
+    policy.onZeroCopySend(id, now);
+    policy.onCompletion(id, id, false);
+    policy.endCompletionBatch(now + 1ms);
+    ++id;
+    EXPECT_EQ(expected, policy.threshold());
+  }
+  for (size_t i = 0; i < 20; ++i) {
+    policy.onZeroCopySend(id, now);
+    policy.onCompletion(id, id, false);
+    policy.endCompletionBatch(now + 1ms);
+    ++id;
+  }
+  EXPECT_EQ(1000, policy.threshold());
+
+  auto stats = policy.getStats();
+  EXPECT_EQ(id, stats.completions);
+  EXPECT_EQ(4, stats.copiedCompletions);
+  EXPECT_EQ(id, stats.completionBatches);
+  EXPECT_EQ(1ms, stats.avgCompletionLatency);
+}
+
+TEST(AdaptiveZeroCopyPolicy, Probe) {
+  AdaptiveZeroCopyPolicy policy(options().setProbeInterval(4));
+  auto now = AdaptiveZeroCopyPolicy::Clock::now();
+  policy.onZeroCopySend(0, now);
+  policy.onCompletion(0, 0, true);
+  policy.endCompletionBatch(now);
+  EXPECT_EQ(2000, policy.threshold());
+
+  std::vector<bool> decisions;
+  for (size_t i = 0; i < 8; ++i) {
+    decisions.push_back(policy.shouldZeroCopy(1500));
+  }
+  // Small writes are never probed.
+  EXPECT_FALSE(policy.shouldZeroCopy(999));
+  EXPECT_EQ(
+      std::vector<bool>(
+          {false, false, false, true, false, false, false, true}),
+      decisions);
+}
+
+TEST(AdaptiveZeroCopyPolicy, Latency) {
+  AdaptiveZeroCopyPolicy policy(options());
+  auto now = AdaptiveZeroCopyPolicy::Clock::now();
+  // Completions within one batch are accounted for together.
+  for (uint32_t id = 0; id < 4; ++id) {
+    policy.onZeroCopySend(id, now);
+  }
+  policy.onCompletion(0, 1, false);
+  policy.onCompletion(3, 3, false);
+  policy.endCompletionBatch(now + 20ms);
+  EXPECT_EQ(20ms, policy.getStats().avgCompletionLatency);
+  EXPECT_EQ(2000, policy.threshold());
+
+  // Out of order completion of the remaining send.
+  policy.onCompletion(2, 2, false);
+  policy.endCompletionBatch(now + 20ms + 80ms);
+  // 20ms + (100ms - 20ms) / 8
+  EXPECT_EQ(30ms, policy.getStats().avgCompletionLatency);
+  EXPECT_EQ(4000, policy.threshold());
+
+  auto stats = policy.getStats();
+  EXPECT_EQ(4, stats.completions);
+  EXPECT_EQ(0, stats.copiedCompletions);
+  EXPECT_EQ(2, stats.completionBatches);
+
+  // An empty batch changes nothing.
+  policy.endCompletionBatch(now);
+  EXPECT_EQ(2, policy.getStats().completionBatches);
+}
+
+TEST(AdaptiveZeroCopyPolicy, IdWrapAround) {
+  AdaptiveZeroCopyPolicy policy(options());
+  auto now = AdaptiveZeroCopyPolicy::Clock::now();
+  uint32_t first = std::numeric_limits<uint32_t>::max() - 1;
+  for (uint32_t i = 0; i < 4; ++i) {
+    policy.onZeroCopySend(first + i, now);
+  }
+  policy.onCompletion(first, first + 3, false);
+  policy.endCompletionBatch(now + 1ms);
+  auto stats = policy.getStats();
+  EXPECT_EQ(4, stats.completions);
+  EXPECT_EQ(1ms, stats.avgCompletionLatency);
+}
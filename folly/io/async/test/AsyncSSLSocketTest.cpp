@@ -28,6 +28,8 @@
 #include <set>
 #include <thread>
 
+#include <folly/FileUtil.h>
+#include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
 #include <folly/experimental/TestUtil.h>
@@ -3976,6 +3978,194 @@ TEST(AsyncSSLSocketTest, BytesWrittenWithMove) {
   EXPECT_EQ(socket1RawBytes, socket3->getRawBytesWritten());
 }
 
+namespace {
+// kTLS only applies to TCP sockets, unlike getfds()'s socketpair().
+// Returns false with errno set if the connection could not be set up.
+bool getTcpFds(NetworkSocket fds[2]) {
+  auto listener = netops::socket(AF_INET, SOCK_STREAM, 0);
+  fds[0] = fds[1] = NetworkSocket();
+  bool ok = false;
+  SCOPE_EXIT {
+    auto savedErrno = errno;
+    netops::close(listener);
+    if (!ok) {
+      for (int idx = 0; idx < 2; ++idx) {
+        if (fds[idx] != NetworkSocket()) {
+          netops::close(fds[idx]);
+        }
+      }
+    }
+    errno = savedErrno;
+  };
+  if (listener == NetworkSocket()) {
+    return false;
+  }
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addrlen = sizeof(addr);
+  auto sa = reinterpret_cast<sockaddr*>(&addr);
+  if (netops::bind(listener, sa, addrlen) != 0 ||
+      netops::listen(listener, 1) != 0 ||
+      netops::getsockname(listener, sa, &addrlen) != 0) {
+    return false;
+  }
+  fds[0] = netops::socket(AF_INET, SOCK_STREAM, 0);
+  if (fds[0] == NetworkSocket() ||
+      netops::connect(fds[0], sa, addrlen) != 0) {
+    return false;
+  }
+  fds[1] = netops::accept(listener, nullptr, nullptr);
+  if (fds[1] == NetworkSocket()) {
+    return false;
+  }
+  for (int idx = 0; idx < 2; ++idx) {
+    if (netops::set_socket_non_blocking(fds[idx]) != 0) {
+      return false;
+    }
+  }
+  ok = true;
+  return true;
+}
+
+class StringReadCallback : public AsyncTransport::ReadCallback {
+ public:
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    buf_.resize(4096);
+    *bufReturn = buf_.data();
+    *lenReturn = buf_.size();
+  }
+
+  void readDataAvailable(size_t len) noexcept override {
+    data.append(buf_.data(), len);
+  }
+
+  void readEOF() noexcept override { eof = true; }
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    ADD_FAILURE() << "read error: " << ex.what();
+    eof = true;
+  }
+
+  std::string data;
+  bool eof{false};
+
+ private:
+  std::vector<char> buf_;
+};
+
+class CountingWriteCallback : public AsyncTransport::WriteCallback {
+ public:
+  void writeSuccess() noexcept override { ++succeeded; }
+
+  void writeErr(size_t, const AsyncSocketException& ex) noexcept override {
+    ADD_FAILURE() << "write error: " << ex.what();
+  }
+
+  int succeeded{0};
+};
+
+// Whether OpenSSL and the kernel support kTLS, probed by attaching the TLS
+// upper layer protocol to a connected socket like OpenSSL does.
+bool kernelSupportsKTLS() {
+#if FOLLY_OPENSSL_HAS_KTLS && defined(TCP_ULP)
+  std::array<NetworkSocket, 2> fds;
+  if (!getTcpFds(fds.data())) {
+    return false;
+  }
+  bool supported =
+      netops::setsockopt(fds[0], IPPROTO_TCP, TCP_ULP, "tls", 3) == 0;
+  netops::close(fds[0]);
+  netops::close(fds[1]);
+  return supported;
+#else
+  return false;
+#endif
+}
+
+// Writes a buffer and part of a file from client to server, after a
+// handshake with kTLS enabled on both sides or neither.
+void writeOverTLS(bool ktls) {
+  if (ktls && !kernelSupportsKTLS()) {
+    GTEST_SKIP() << "kTLS is not supported";
+  }
+  EventBase evb;
+  auto clientCtx = std::make_shared<SSLContext>();
+  auto serverCtx = std::make_shared<SSLContext>();
+  getctx(clientCtx, serverCtx);
+  if (ktls) {
+    // AES-128-GCM is supported by every kernel with kTLS.
+    for (auto& ctx : {clientCtx, serverCtx}) {
+      ctx->ciphers("ECDHE-RSA-AES128-GCM-SHA256");
+      ctx->setCiphersuitesOrThrow("TLS_AES_128_GCM_SHA256");
+    }
+  }
+  std::array<NetworkSocket, 2> fds;
+  ASSERT_TRUE(getTcpFds(fds.data()))
+      << "failed to connect over TCP: " << errnoStr(errno);
+
+  AsyncSSLSocket::UniquePtr clientSock(
+      new AsyncSSLSocket(clientCtx, &evb, fds[0], false));
+  AsyncSSLSocket::UniquePtr serverSock(
+      new AsyncSSLSocket(serverCtx, &evb, fds[1], true));
+  if (ktls) {
+    clientSock->enableKTLS();
+    serverSock->enableKTLS();
+  }
+  SSLHandshakeClient client(std::move(clientSock), true, true);
+  SSLHandshakeServer server(std::move(serverSock), true, true);
+  while (!(client.handshakeSuccess_ && server.handshakeSuccess_) &&
+         !client.handshakeError_ && !server.handshakeError_) {
+    evb.loopOnce();
+  }
+  ASSERT_TRUE(client.handshakeSuccess_);
+  ASSERT_TRUE(server.handshakeSuccess_);
+  clientSock = std::move(client).moveSocket();
+  serverSock = std::move(server).moveSocket();
+  ASSERT_EQ(ktls, clientSock->isKTLSActive());
+
+  std::string contents(1 << 20, 0);
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = char(i * 13 + i / 1024);
+  }
+  TemporaryFile file;
+  ASSERT_EQ(
+      contents.size(), writeFull(file.fd(), contents.data(), contents.size()));
+
+  StringReadCallback rcb;
+  serverSock->setReadCB(&rcb);
+  // Closing with unread session tickets would reset the connection.
+  StringReadCallback clientRcb;
+  clientSock->setReadCB(&clientRcb);
+  CountingWriteCallback wcb;
+  clientSock->write(&wcb, "head", 4);
+  clientSock->writeFile(&wcb, file.fd(), 1, contents.size() - 1);
+  clientSock->write(&wcb, "tail", 4);
+  while (wcb.succeeded < 3) {
+    evb.loopOnce();
+  }
+  clientSock->close();
+  while (!rcb.eof) {
+    evb.loopOnce();
+  }
+
+  auto expected = "head" + contents.substr(1) + "tail";
+  ASSERT_EQ(expected.size(), rcb.data.size());
+  EXPECT_TRUE(expected == rcb.data);
+  EXPECT_EQ(contents.size() + 7, clientSock->getAppBytesWritten());
+  // Data decrypted by the kernel counts as received too.
+  EXPECT_GE(serverSock->getRawBytesReceived(), expected.size());
+}
+} // namespace
+
+TEST(AsyncSSLSocketTest, WriteFile) {
+  writeOverTLS(false);
+}
+
+TEST(AsyncSSLSocketTest, KTLSWriteFile) {
+  writeOverTLS(true);
+}
+
 #ifdef SIGPIPE
 ///////////////////////////////////////////////////////////////////////////
 // init_unit_test_suite
@@ -16,10 +16,13 @@
 
 #include <folly/io/async/AsyncSocket.h>
 
+#include <chrono>
 #include <iostream>
+#include <string>
 
 #include <folly/io/async/AsyncServerSocket.h>
 #include <folly/io/async/EventBase.h>
+#include <folly/io/async/test/AsyncSocketTest.h>
 #include <folly/portability/GTest.h>
 
 using namespace folly;
@@ -218,3 +221,75 @@ TEST(AsyncSocketTest, listenerTosV4) {
   ASSERT_EQ(rc, 0);
   ASSERT_EQ(value, 140);
 }
+
+TEST(AsyncSocketTest, AdaptiveZeroCopy) {
+  test::TestServer server;
+  EventBase evb;
+  auto client = AsyncSocket::newSocket(&evb, server.getAddress(), 1000);
+  auto accepted = server.acceptAsync(&evb, 1000);
+  if (!client->setZeroCopy(true)) {
+    GTEST_SKIP() << "MSG_ZEROCOPY is not supported";
+  }
+  constexpr size_t kSmall = 64 * 1024;
+  constexpr size_t kLarge = 256 * 1024;
+  client->setAdaptiveZeroCopy(AdaptiveZeroCopyPolicy::Options()
+                                  .setMinWriteSize(kSmall)
+                                  .setMaxWriteSize(kLarge)
+                                  .setProbeInterval(0));
+  test::ReadCallback rcb(kLarge);
+  accepted->setReadCB(&rcb);
+  // Completions are read from the error queue when the socket is readable.
+  test::ReadCallback clientRcb;
+  client->setReadCB(&clientRcb);
+
+  std::string expected;
+  // Writes a buffer, and waits for it to be read and for the completion of
+  // a zerocopy send.
+  auto send = [&](size_t size) {
+    auto buf = IOBuf::create(size);
+    for (size_t i = 0; i < size; ++i) {
+      buf->writableData()[i] = uint8_t((expected.size() + i) * 7 + i / 4096);
+    }
+    buf->append(size);
+    expected.append(reinterpret_cast<const char*>(buf->data()), size);
+    test::WriteCallback wcb;
+    client->writeChain(&wcb, std::move(buf));
+    auto done = [&] {
+      auto stats = *client->getAdaptiveZeroCopyStats();
+      return wcb.state != test::STATE_WAITING &&
+          rcb.dataRead() == expected.size() &&
+          stats.completions == stats.zeroCopyWrites;
+    };
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done() && std::chrono::steady_clock::now() < deadline) {
+      evb.loopOnce(EVLOOP_NONBLOCK);
+    }
+    EXPECT_EQ(test::STATE_SUCCEEDED, wcb.state);
+  };
+
+  // The kernel copies the data of zerocopy sends over loopback, which makes
+  // the policy copy writes of the same size from then on.
+  send(kSmall);
+  auto stats = *client->getAdaptiveZeroCopyStats();
+  EXPECT_EQ(1, stats.zeroCopyWrites);
+  EXPECT_EQ(1, stats.completions);
+  EXPECT_EQ(1, stats.copiedCompletions);
+  EXPECT_EQ(1, stats.completionBatches);
+  EXPECT_EQ(2 * kSmall, stats.threshold);
+
+  send(kSmall);
+  stats = *client->getAdaptiveZeroCopyStats();
+  EXPECT_EQ(1, stats.zeroCopyWrites);
+  EXPECT_EQ(1, stats.copyWrites);
+  EXPECT_EQ(kSmall, stats.copyBytes);
+
+  // Writes of maxWriteSize always use zerocopy.
+  send(kLarge);
+  stats = *client->getAdaptiveZeroCopyStats();
+  EXPECT_EQ(2, stats.zeroCopyWrites);
+  EXPECT_EQ(kSmall + kLarge, stats.zeroCopyBytes);
+  EXPECT_EQ(2, stats.completions);
+  EXPECT_EQ(kLarge, stats.threshold);
+
+  rcb.verifyData(expected.data(), expected.size());
+}
@@ -17,6 +17,7 @@
 #include <folly/io/async/test/AsyncSocketTest2.h>
 
 #include <fcntl.h>
+#include <signal.h>
 #include <sys/types.h>
 
 #include <time.h>
@@ -25,7 +26,9 @@
 #include <thread>
 
 #include <folly/ExceptionWrapper.h>
+#include <folly/FileUtil.h>
 #include <folly/Random.h>
+#include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/experimental/TestUtil.h>
 #include <folly/io/IOBuf.h>
@@ -2002,6 +2005,159 @@ TEST(AsyncSocketTest, WriteIOBufCorked) {
   ASSERT_FALSE(socket->isClosedByPeer());
 }
 
+namespace {
+// A socket that writes files as regular buffers, like a TLS socket would.
+class NoSendFileSocket : public AsyncSocket {
+ public:
+  using AsyncSocket::AsyncSocket;
+
+ protected:
+  bool canSendFile() const override { return false; }
+};
+
+void testWriteFile(AsyncSocket::UniquePtr socket, EventBase& evb) {
+  TestServer server;
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+  std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+  ReadCallback rcb(64 * 1024);
+  acceptedSocket->setReadCB(&rcb);
+
+  // Large enough to fill the socket buffers, so that the file is written
+  // over several event loop iterations.
+  string contents(4 << 20, 0);
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = char(i * 7 + i / 4096);
+  }
+  TemporaryFile file;
+  ASSERT_EQ(
+      contents.size(), writeFull(file.fd(), contents.data(), contents.size()));
+  auto filePos = lseek(file.fd(), 0, SEEK_CUR);
+
+  // The file is written in order with the writes around it.
+  constexpr size_t kOffset = 1000;
+  auto length = contents.size() - 2 * kOffset;
+  WriteCallback wcb1;
+  socket->write(&wcb1, "head", 4);
+  WriteCallback wcb2;
+  socket->writeFile(&wcb2, file.fd(), kOffset, length);
+  WriteCallback wcb3;
+  socket->writeFile(&wcb3, file.fd(), 0, 0);
+  WriteCallback wcb4;
+  socket->write(&wcb4, "tail", 4);
+  socket->shutdownWrite();
+
+  evb.loop();
+
+  ASSERT_EQ(STATE_SUCCEEDED, ccb.state);
+  ASSERT_EQ(STATE_SUCCEEDED, wcb1.state);
+  ASSERT_EQ(STATE_SUCCEEDED, wcb2.state);
+  ASSERT_EQ(STATE_SUCCEEDED, wcb3.state);
+  ASSERT_EQ(STATE_SUCCEEDED, wcb4.state);
+  ASSERT_EQ(STATE_SUCCEEDED, rcb.state);
+  auto expected = "head" + contents.substr(kOffset, length) + "tail";
+  rcb.verifyData(expected.data(), expected.size());
+  EXPECT_EQ(expected.size(), socket->getAppBytesWritten());
+  EXPECT_EQ(filePos, lseek(file.fd(), 0, SEEK_CUR));
+
+  acceptedSocket->close();
+  socket->close();
+}
+} // namespace
+
+/**
+ * Test writing part of a file with sendfile()
+ */
+TEST(AsyncSocketTest, WriteFile) {
+  EventBase evb;
+  testWriteFile(AsyncSocket::newSocket(&evb), evb);
+}
+
+/**
+ * Test writing part of a file through regular writes
+ */
+TEST(AsyncSocketTest, WriteFileWithoutSendFile) {
+  EventBase evb;
+  testWriteFile(AsyncSocket::UniquePtr(new NoSendFileSocket(&evb)), evb);
+}
+
+/**
+ * Test writing more of a file than it contains
+ */
+TEST(AsyncSocketTest, WriteFileTooShort) {
+  TestServer server;
+  EventBase evb;
+  auto socket = AsyncSocket::newSocket(&evb);
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+  std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+  ReadCallback rcb;
+  acceptedSocket->setReadCB(&rcb);
+  evb.loopOnce();
+
+  TemporaryFile file;
+  ASSERT_EQ(5, writeFull(file.fd(), "hello", 5));
+  WriteCallback wcb;
+  socket->writeFile(&wcb, file.fd(), 0, 6);
+  evb.loop();
+
+  ASSERT_EQ(STATE_FAILED, wcb.state);
+  EXPECT_EQ(AsyncSocketException::END_OF_FILE, wcb.exception.getType());
+  EXPECT_EQ(5, wcb.bytesWritten);
+  rcb.verifyData("hello", 5);
+}
+
+#ifndef _WIN32
+namespace {
+// Writes a file to a socket shut down for writes, on a new thread so that
+// the SIGPIPE disposition at its first write is the given one.
+void writeFileNoSigPipe(void (*handler)(int)) {
+  auto oldHandler = signal(SIGPIPE, handler);
+  SCOPE_EXIT { signal(SIGPIPE, oldHandler); };
+  std::thread([] {
+    TestServer server;
+    EventBase evb;
+    auto socket = AsyncSocket::newSocket(&evb);
+    ConnCallback ccb;
+    socket->connect(&ccb, server.getAddress(), 30);
+    std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+    evb.loopOnce();
+    ASSERT_EQ(STATE_SUCCEEDED, ccb.state);
+    ASSERT_EQ(0, ::shutdown(socket->getNetworkSocket().toFd(), SHUT_WR));
+
+    TemporaryFile file;
+    ASSERT_EQ(5, writeFull(file.fd(), "hello", 5));
+    WriteCallback wcb;
+    socket->writeFile(&wcb, file.fd(), 0, 5);
+    evb.loop();
+
+    ASSERT_EQ(STATE_FAILED, wcb.state);
+    EXPECT_EQ(EPIPE, wcb.exception.getErrno());
+    sigset_t pending;
+    ASSERT_EQ(0, sigpending(&pending));
+    EXPECT_EQ(0, sigismember(&pending, SIGPIPE));
+  }).join();
+}
+} // namespace
+
+/**
+ * Test that writing a file to a socket shut down for writes fails without
+ * raising SIGPIPE
+ */
+TEST(AsyncSocketTest, WriteFileNoSigPipe) {
+  // sendfile() fails with EPIPE, which would kill the process with the
+  // default action of SIGPIPE.
+  writeFileNoSigPipe(SIG_DFL);
+}
+
+/**
+ * Test the same with SIGPIPE ignored, where the signal mask is left alone
+ */
+TEST(AsyncSocketTest, WriteFileSigPipeIgnored) {
+  writeFileNoSigPipe(SIG_IGN);
+}
+#endif
+
 /**
  * Test performing a zero-length write
  */
@@ -2341,6 +2497,38 @@ TEST(AsyncSocketTest, ServerAcceptOptions) {
 #endif
 }
 
+TEST(AsyncSocketTest, ServerAcceptMultishotFallback) {
+  // Backends that cannot accept by themselves keep using accept4()
+  EventBase eventBase;
+  std::shared_ptr<AsyncServerSocket> serverSocket(
+      AsyncServerSocket::newSocket(&eventBase));
+  serverSocket->setMultishotAccept(true);
+  EXPECT_TRUE(serverSocket->getMultishotAccept());
+  serverSocket->bind(0);
+  serverSocket->listen(16);
+  folly::SocketAddress serverAddress;
+  serverSocket->getAddress(&serverAddress);
+
+  TestAcceptCallback acceptCallback;
+  acceptCallback.setConnectionAcceptedFn(
+      [&](NetworkSocket /* fd */, const folly::SocketAddress& /* addr */) {
+        serverSocket->removeAcceptCallback(&acceptCallback, &eventBase);
+      });
+  serverSocket->addAcceptCallback(&acceptCallback, &eventBase);
+  serverSocket->startAccepting();
+
+  std::shared_ptr<AsyncSocket> socket(
+      AsyncSocket::newSocket(&eventBase, serverAddress));
+  eventBase.loop();
+
+  ASSERT_EQ(acceptCallback.getEvents()->size(), 3);
+  ASSERT_EQ(
+      acceptCallback.getEvents()->at(1).type, TestAcceptCallback::TYPE_ACCEPT);
+  folly::SocketAddress localAddress;
+  socket->getLocalAddress(&localAddress);
+  EXPECT_EQ(localAddress, acceptCallback.getEvents()->at(1).address);
+}
+
 /**
  * Test AsyncServerSocket::removeAcceptCallback()
  */
@@ -1478,3 +1478,150 @@ TEST_F(AsyncUDPSocketTest, TestWritemNontrivialCmsgs) {
 #endif // FOLLY_HAVE_MSG_ERRQUEUE
   socket_->close();
 }
+
+namespace {
+
+class BatchReadCallback : public AsyncUDPSocket::ReadCallback {
+ public:
+  BatchReadCallback(size_t batchSize, size_t bufferSize)
+      : batchSize_(batchSize), bufferSize_(bufferSize) {}
+
+  size_t getReadBatchSize() noexcept override { return batchSize_; }
+  size_t getReadBatchBufferSize() noexcept override { return bufferSize_; }
+
+  void onDataAvailableBatch(
+      folly::Range<const Datagram*> datagrams,
+      const folly::IOBuf& slab) noexcept override {
+    batches.push_back(datagrams.size());
+    slabs.push_back(slab.data());
+    for (const auto& datagram : datagrams) {
+      clients.push_back(datagram.client);
+      truncated.push_back(datagram.truncated);
+      // Keep the first datagram of every batch without copying it
+      if (&datagram == datagrams.begin()) {
+        auto buf = slab.cloneOne();
+        buf->trimStart(datagram.data.begin() - slab.data());
+        buf->trimEnd(buf->length() - datagram.data.size());
+        kept.push_back(std::move(buf));
+      }
+      data.push_back(folly::StringPiece(datagram.data).str());
+    }
+  }
+
+  void getReadBuffer(void**, size_t*) noexcept override { ADD_FAILURE(); }
+
+  void onDataAvailable(
+      const folly::SocketAddress&,
+      size_t,
+      bool,
+      OnDataAvailableParams) noexcept override {
+    ADD_FAILURE();
+  }
+
+  void onReadError(const folly::AsyncSocketException& ex) noexcept override {
+    ADD_FAILURE() << ex.what();
+  }
+
+  void onReadClosed() noexcept override {}
+
+  std::vector<size_t> batches;
+  std::vector<const uint8_t*> slabs;
+  std::vector<folly::SocketAddress> clients;
+  std::vector<bool> truncated;
+  std::vector<std::string> data;
+  std::vector<std::unique_ptr<folly::IOBuf>> kept;
+
+ private:
+  size_t batchSize_;
+  size_t bufferSize_;
+};
+
+} // namespace
+
+TEST_F(AsyncUDPSocketTest, ReadBatch) {
+  BatchReadCallback cb(4, 8);
+  socket_->setMaxReadsPerEvent(2);
+  socket_->resumeRead(&cb);
+
+  AsyncUDPSocket client(&evb_);
+  client.bind(folly::SocketAddress("127.0.0.1", 0));
+  // The last datagram does not fit in its slot
+  std::vector<std::string> sent;
+  for (int i = 0; i < 9; ++i) {
+    sent.push_back(folly::to<std::string>("msg", i));
+  }
+  sent.push_back("toolongmessage");
+  for (const auto& msg : sent) {
+    client.write(socket_->address(), folly::IOBuf::copyBuffer(msg));
+  }
+
+  evb_.timer().scheduleTimeoutFn(
+      [&] { evb_.terminateLoopSoon(); }, std::chrono::milliseconds(50));
+  evb_.loopForever();
+
+  ASSERT_EQ(sent.size(), cb.data.size());
+  EXPECT_EQ((std::vector<size_t>{4, 4, 2}), cb.batches);
+  for (size_t i = 0; i < sent.size(); ++i) {
+    EXPECT_EQ(client.address(), cb.clients[i]);
+    EXPECT_EQ(i == sent.size() - 1, cb.truncated[i]);
+    EXPECT_EQ(sent[i].substr(0, 8), cb.data[i]);
+  }
+
+  // Kept datagrams stay valid and force a new slab for every batch
+  ASSERT_EQ(3, cb.kept.size());
+  EXPECT_EQ("msg0", cb.kept[0]->moveToFbString());
+  EXPECT_EQ("msg4", cb.kept[1]->moveToFbString());
+  EXPECT_EQ("msg8", cb.kept[2]->moveToFbString());
+  EXPECT_NE(cb.slabs[0], cb.slabs[1]);
+  EXPECT_NE(cb.slabs[1], cb.slabs[2]);
+}
+
+TEST_F(AsyncUDPSocketTest, ReadBatchEmptyDatagram) {
+  // Empty datagrams are delivered, as in the non batch mode.
+  BatchReadCallback cb(4, 8);
+  socket_->resumeRead(&cb);
+
+  AsyncUDPSocket client(&evb_);
+  client.bind(folly::SocketAddress("127.0.0.1", 0));
+  client.write(socket_->address(), folly::IOBuf::copyBuffer("a"));
+  client.write(socket_->address(), folly::IOBuf::create(0));
+  client.write(socket_->address(), folly::IOBuf::copyBuffer("b"));
+
+  evb_.timer().scheduleTimeoutFn(
+      [&] { evb_.terminateLoopSoon(); }, std::chrono::milliseconds(50));
+  evb_.loopForever();
+
+  EXPECT_EQ((std::vector<std::string>{"a", "", "b"}), cb.data);
+  ASSERT_EQ(3, cb.clients.size());
+  EXPECT_EQ(client.address(), cb.clients[1]);
+  EXPECT_FALSE(cb.truncated[1]);
+}
+
+TEST_F(AsyncUDPSocketTest, ReadBatchReusesSlab) {
+  struct Callback : BatchReadCallback {
+    using BatchReadCallback::BatchReadCallback;
+    void onDataAvailableBatch(
+        folly::Range<const Datagram*> datagrams,
+        const folly::IOBuf& slab) noexcept override {
+      batches.push_back(datagrams.size());
+      slabs.push_back(slab.data());
+    }
+  } cb(2, 64);
+  socket_->setMaxReadsPerEvent(0);
+  socket_->resumeRead(&cb);
+
+  AsyncUDPSocket client(&evb_);
+  client.bind(folly::SocketAddress("127.0.0.1", 0));
+  for (int i = 0; i < 5; ++i) {
+    client.write(socket_->address(), folly::IOBuf::copyBuffer("hello"));
+  }
+
+  evb_.timer().scheduleTimeoutFn(
+      [&] { evb_.terminateLoopSoon(); }, std::chrono::milliseconds(50));
+  evb_.loopForever();
+
+  EXPECT_EQ((std::vector<size_t>{2, 2, 1}), cb.batches);
+  ASSERT_EQ(3, cb.slabs.size());
+  EXPECT_EQ(cb.slabs[0], cb.slabs[1]);
+  EXPECT_EQ(cb.slabs[1], cb.slabs[2]);
+}
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <folly/Benchmark.h>
 #include <folly/Format.h>
 #include <folly/Range.h>
@@ -143,6 +146,49 @@ BENCHMARK_RELATIVE(prefix, iters) {
   }
 }
 
+// A column of little-endian uint32_t values in IOBufs whose sizes are not a
+// multiple of 4, so that some values straddle IOBufs.
+constexpr size_t kColumnValues = 16 * 1024;
+unique_ptr<IOBuf> iobuf_column_benchmark;
+
+BENCHMARK(readLEColumn, iters) {
+  while (iters--) {
+    Cursor c(iobuf_column_benchmark.get());
+    uint32_t sum = 0;
+    for (size_t i = 0; i < kColumnValues; ++i) {
+      sum += c.readLE<uint32_t>();
+    }
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
+BENCHMARK_RELATIVE(readArrayLEColumn, iters) {
+  std::vector<uint32_t> values(kColumnValues);
+  while (iters--) {
+    Cursor c(iobuf_column_benchmark.get());
+    c.readArrayLE(folly::range(values));
+    uint32_t sum = 0;
+    for (auto value : values) {
+      sum += value;
+    }
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
+BENCHMARK_RELATIVE(visitArrayColumn, iters) {
+  while (iters--) {
+    Cursor c(iobuf_column_benchmark.get());
+    uint32_t sum = 0;
+    c.visitArray<uint32_t>(kColumnValues, [&](folly::ByteRange chunk) {
+      for (size_t i = 0; i < chunk.size(); i += sizeof(uint32_t)) {
+        sum += folly::Endian::little(
+            folly::loadUnaligned<uint32_t>(chunk.data() + i));
+      }
+    });
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
 /**
  * ============================================================================
  * folly/io/test/IOBufCursorBenchmark.cpp          relative  time/iter  iters/s
@@ -171,6 +217,16 @@ int main(int argc, char** argv) {
     iobuf_read_benchmark->prependChain(std::move(iobuf2));
   }
 
+  iobuf_column_benchmark = IOBuf::create(0);
+  for (size_t left = kColumnValues * sizeof(uint32_t); left > 0;) {
+    auto size = std::min<size_t>(left, 1001);
+    unique_ptr<IOBuf> iobuf2(IOBuf::create(size));
+    memset(iobuf2->writableData(), 1, size);
+    iobuf2->append(size);
+    iobuf_column_benchmark->prependChain(std::move(iobuf2));
+    left -= size;
+  }
+
   folly::runBenchmarks();
   return 0;
 }
@@ -1655,3 +1655,131 @@ TEST(IOBuf, ThinCursorBorrowing) {
   EXPECT_EQ(0x44, thinCursor.read<uint8_t>(rcursor));
   rcursor.unborrow(std::move(thinCursor));
 }
+
+namespace {
+
+// The bytes 0, 1, 2, ... split into IOBufs of the given sizes, with an empty
+// IOBuf in the middle.
+std::unique_ptr<IOBuf> splitBytes(std::vector<size_t> sizes) {
+  std::unique_ptr<IOBuf> head;
+  uint8_t next = 0;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    auto buf = IOBuf::create(sizes[i]);
+    for (size_t j = 0; j < sizes[i]; ++j) {
+      buf->writableTail()[j] = next++;
+    }
+    buf->append(sizes[i]);
+    if (!head) {
+      head = std::move(buf);
+    } else {
+      head->prependChain(std::move(buf));
+    }
+    if (i == sizes.size() / 2) {
+      head->prependChain(IOBuf::create(0));
+    }
+  }
+  return head;
+}
+
+} // namespace
+
+TEST(IOBuf, readArray) {
+  auto buf = splitBytes({3, 8, 1, 13, 7});
+  Cursor cursor(buf.get());
+  std::array<uint32_t, 4> le;
+  cursor.readArrayLE(folly::range(le));
+  EXPECT_EQ(0x03020100u, le[0]);
+  EXPECT_EQ(0x07060504u, le[1]);
+  EXPECT_EQ(0x0f0e0d0cu, le[3]);
+  std::array<uint16_t, 3> be;
+  cursor.readArrayBE(folly::range(be));
+  EXPECT_EQ(0x1011u, be[0]);
+  EXPECT_EQ(0x1415u, be[2]);
+  EXPECT_EQ(22, cursor.getCurrentPosition());
+
+  std::array<uint8_t, 4> bytes;
+  cursor.readArray(folly::range(bytes));
+  EXPECT_EQ(25, bytes[3]);
+  std::array<uint64_t, 1> tooMany;
+  EXPECT_THROW(cursor.readArray(folly::range(tooMany)), std::out_of_range);
+}
+
+TEST(IOBuf, pullAtMostVectorized) {
+  auto buf = splitBytes({3, 8, 1, 13, 7});
+  Cursor cursor(buf.get());
+  std::array<uint8_t, 5> a;
+  std::array<uint8_t, 10> b;
+  std::array<uint8_t, 20> c;
+  std::array<struct iovec, 3> iov = {{
+      {a.data(), a.size()},
+      {b.data(), b.size()},
+      {c.data(), c.size()},
+  }};
+  EXPECT_EQ(32, cursor.pullAtMostVectorized(iov.data(), iov.size()));
+  EXPECT_TRUE(cursor.isAtEnd());
+  EXPECT_EQ(4, a[4]);
+  EXPECT_EQ(5, b[0]);
+  EXPECT_EQ(14, b[9]);
+  EXPECT_EQ(15, c[0]);
+  EXPECT_EQ(31, c[16]);
+
+  Cursor bounded(buf.get(), 12);
+  EXPECT_EQ(10, bounded.pullAtMostVectorized(iov.data() + 1, 1));
+  EXPECT_EQ(2, bounded.pullAtMostVectorized(iov.data(), iov.size()));
+  EXPECT_EQ(10, a[0]);
+}
+
+TEST(IOBuf, visitChunks) {
+  auto buf = splitBytes({3, 8, 1, 13, 7});
+  Cursor cursor(buf.get());
+  cursor.skip(2);
+  std::vector<size_t> sizes;
+  uint8_t expected = 2;
+  cursor.visitChunks(20, [&](ByteRange chunk) {
+    sizes.push_back(chunk.size());
+    for (auto byte : chunk) {
+      EXPECT_EQ(expected++, byte);
+    }
+  });
+  EXPECT_EQ((std::vector<size_t>{1, 8, 1, 10}), sizes);
+  EXPECT_EQ(22, cursor.getCurrentPosition());
+
+  bool called = false;
+  EXPECT_THROW(
+      cursor.visitChunks(11, [&](ByteRange) { called = true; }),
+      std::out_of_range);
+  EXPECT_FALSE(called);
+  EXPECT_EQ(22, cursor.getCurrentPosition());
+}
+
+TEST(IOBuf, visitArray) {
+  auto buf = splitBytes({3, 8, 1, 13, 7});
+  Cursor cursor(buf.get());
+  std::vector<size_t> sizes;
+  std::vector<uint32_t> values;
+  cursor.visitArray<uint32_t>(7, [&](ByteRange chunk) {
+    EXPECT_EQ(0, chunk.size() % sizeof(uint32_t));
+    sizes.push_back(chunk.size() / sizeof(uint32_t));
+    for (size_t i = 0; i < chunk.size(); i += sizeof(uint32_t)) {
+      values.push_back(folly::Endian::little(
+          folly::loadUnaligned<uint32_t>(chunk.data() + i)));
+    }
+  });
+  // Values 0, 2 and 6 straddle IOBufs and are passed one at a time, and the
+  // empty IOBuf after the third one is skipped.
+  EXPECT_EQ((std::vector<size_t>{1, 1, 1, 3, 1}), sizes);
+  ASSERT_EQ(7, values.size());
+  for (uint32_t i = 0; i < values.size(); ++i) {
+    uint32_t b = i * 4;
+    EXPECT_EQ(b | (b + 1) << 8 | (b + 2) << 16 | (b + 3) << 24, values[i]);
+  }
+  EXPECT_EQ(28, cursor.getCurrentPosition());
+
+  EXPECT_THROW(
+      cursor.visitArray<uint32_t>(2, [](ByteRange) { FAIL(); }),
+      std::out_of_range);
+  cursor.visitArray<uint32_t>(1, [](ByteRange chunk) {
+    EXPECT_EQ(28, chunk[0]);
+  });
+  EXPECT_TRUE(cursor.isAtEnd());
+}
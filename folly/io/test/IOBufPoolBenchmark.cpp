@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/IOBufPool.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+using folly::IOBuf;
+using folly::IOBufPool;
+
+namespace {
+
+IOBufPool& pool() {
+  static auto instance = new IOBufPool();
+  return *instance;
+}
+
+// Keeps a window of buffers alive so that allocation and release do not
+// simply bounce the same buffer, like reads waiting to be processed.
+template <typename Allocate>
+void allocateAndRelease(
+    size_t iters, size_t numThreads, size_t size, Allocate allocate) {
+  constexpr size_t kWindow = 64;
+  auto work = [&](size_t n) {
+    std::vector<std::unique_ptr<IOBuf>> window(kWindow);
+    for (size_t i = 0; i < n; ++i) {
+      auto& slot = window[i % kWindow];
+      slot = allocate(size);
+      // Touch the buffer like a read into it would.
+      slot->writableData()[0] = 1;
+      folly::doNotOptimizeAway(slot->capacity());
+    }
+  };
+  if (numThreads == 1) {
+    work(iters);
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; ++t) {
+    threads.emplace_back(work, iters / numThreads);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void create(size_t iters, size_t numThreads, size_t size) {
+  allocateAndRelease(
+      iters, numThreads, size, [](size_t n) { return IOBuf::create(n); });
+}
+
+void pooled(size_t iters, size_t numThreads, size_t size) {
+  allocateAndRelease(
+      iters, numThreads, size, [](size_t n) { return pool().allocate(n); });
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(create, 2k, 1, 2048)
+BENCHMARK_RELATIVE_NAMED_PARAM(pooled, 2k, 1, 2048)
+BENCHMARK_NAMED_PARAM(create, 4k, 1, 4096)
+BENCHMARK_RELATIVE_NAMED_PARAM(pooled, 4k, 1, 4096)
+BENCHMARK_NAMED_PARAM(create, 16k, 1, 16384)
+BENCHMARK_RELATIVE_NAMED_PARAM(pooled, 16k, 1, 16384)
+BENCHMARK_NAMED_PARAM(create, 64k, 1, 65536)
+BENCHMARK_RELATIVE_NAMED_PARAM(pooled, 64k, 1, 65536)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(create, 4k_8_threads, 8, 4096)
+BENCHMARK_RELATIVE_NAMED_PARAM(pooled, 4k_8_threads, 8, 4096)
+BENCHMARK_NAMED_PARAM(create, 64k_8_threads, 8, 65536)
+BENCHMARK_RELATIVE_NAMED_PARAM(pooled, 64k_8_threads, 8, 65536)
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
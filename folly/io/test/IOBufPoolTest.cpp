@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/IOBufPool.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <folly/io/IOBufQueue.h>
+#include <folly/portability/GTest.h>
+
+using folly::IOBuf;
+using folly::IOBufPool;
+using folly::IOBufQueue;
+
+TEST(IOBufPool, SizeClasses) {
+  IOBufPool pool;
+  std::vector<std::pair<size_t, size_t>> sizes = {
+      {1, 2048},
+      {2048, 2048},
+      {2049, 4096},
+      {10000, 16384},
+      {65536, 65536},
+  };
+  for (auto [requested, expected] : sizes) {
+    auto buf = pool.allocate(requested);
+    EXPECT_EQ(expected, buf->capacity()) << requested;
+    EXPECT_EQ(0, buf->length());
+    EXPECT_EQ(0, buf->headroom());
+    EXPECT_FALSE(buf->isShared());
+    memset(buf->writableData(), 'x', buf->capacity());
+  }
+  auto big = pool.allocate(65537);
+  EXPECT_GE(big->capacity(), 65537);
+
+  auto stats = pool.getStats();
+  EXPECT_EQ(2, stats.sizeClasses[0].allocations);
+  EXPECT_EQ(1, stats.sizeClasses[1].allocations);
+  EXPECT_EQ(1, stats.sizeClasses[2].allocations);
+  EXPECT_EQ(1, stats.sizeClasses[3].allocations);
+  EXPECT_EQ(65536, stats.sizeClasses[3].bufferSize);
+  EXPECT_EQ(1, stats.oversized);
+  for (auto const& sizeClass : stats.sizeClasses) {
+    EXPECT_EQ(0, sizeClass.outstanding);
+    EXPECT_EQ(0, sizeClass.exhausted);
+  }
+}
+
+TEST(IOBufPool, Reuse) {
+  IOBufPool pool;
+  auto buf = pool.allocate(4000);
+  auto data = buf->data();
+  buf.reset();
+  // Freed buffers go back to this core's freelist, which is LIFO.
+  buf = pool.allocate(4000);
+  EXPECT_EQ(data, buf->data());
+  EXPECT_EQ(2, pool.getStats().sizeClasses[1].allocations);
+  EXPECT_EQ(1, pool.getStats().sizeClasses[1].outstanding);
+}
+
+TEST(IOBufPool, SharedBuffers) {
+  IOBufPool pool;
+  auto buf = pool.allocate(100);
+  buf->append(10);
+  auto clone = buf->clone();
+  buf.reset();
+  EXPECT_EQ(1, pool.getStats().sizeClasses[0].outstanding);
+  clone.reset();
+  EXPECT_EQ(0, pool.getStats().sizeClasses[0].outstanding);
+}
+
+TEST(IOBufPool, Exhausted) {
+  IOBufPool pool(IOBufPool::Options().setMaxBuffersPerClass(1));
+  // More than the capacity plus what the per-core freelists can hold.
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  for (size_t i = 0; i < 2000; ++i) {
+    bufs.push_back(pool.allocate(2048));
+    EXPECT_GE(bufs.back()->capacity(), 2048);
+  }
+  auto stats = pool.getStats().sizeClasses[0];
+  EXPECT_GT(stats.exhausted, 0);
+  EXPECT_EQ(2000, stats.allocations + stats.exhausted);
+  EXPECT_EQ(stats.allocations, stats.outstanding);
+  bufs.clear();
+  EXPECT_EQ(0, pool.getStats().sizeClasses[0].outstanding);
+}
+
+TEST(IOBufPool, ReleaseOnOtherThreads) {
+  IOBufPool pool;
+  constexpr size_t kThreads = 4;
+  constexpr size_t kBufs = 1000;
+  std::vector<std::vector<std::unique_ptr<IOBuf>>> bufs(kThreads);
+  for (size_t i = 0; i < kThreads * kBufs; ++i) {
+    bufs[i % kThreads].push_back(pool.allocate(16384));
+  }
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < kBufs; ++i) {
+        bufs[t][i].reset();
+        auto buf = pool.allocate(i % 2 ? 2048 : 16384);
+        memset(buf->writableData(), int(t), buf->capacity());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto stats = pool.getStats();
+  EXPECT_EQ(kThreads * kBufs * 3 / 2, stats.sizeClasses[2].allocations);
+  EXPECT_EQ(kThreads * kBufs / 2, stats.sizeClasses[0].allocations);
+  for (auto const& sizeClass : stats.sizeClasses) {
+    EXPECT_EQ(0, sizeClass.outstanding);
+  }
+}
+
+TEST(IOBufPool, IOBufQueue) {
+  IOBufPool pool;
+  IOBufQueue::Options options;
+  options.cacheChainLength = true;
+  options.pool = &pool;
+  {
+    IOBufQueue queue(options);
+    auto [buf, len] = queue.preallocate(100, 4096);
+    EXPECT_EQ(4096, len);
+    memset(buf, 'a', 100);
+    queue.postallocate(100);
+    std::string data(10000, 'b');
+    queue.append(data.data(), data.size());
+    EXPECT_EQ(10100, queue.chainLength());
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(1, stats.sizeClasses[1].allocations);
+    EXPECT_EQ(1, stats.sizeClasses[2].allocations);
+    EXPECT_EQ(0, stats.oversized);
+  }
+  for (auto const& sizeClass : pool.getStats().sizeClasses) {
+    EXPECT_EQ(0, sizeClass.outstanding);
+  }
+}
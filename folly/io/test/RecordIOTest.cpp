@@ -19,12 +19,14 @@
 #include <sys/types.h>
 
 #include <random>
+#include <thread>
 
 #include <glog/logging.h>
 
 #include <folly/Conv.h>
 #include <folly/FBString.h>
 #include <folly/Random.h>
+#include <folly/compression/Compression.h>
 #include <folly/experimental/TestUtil.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/portability/GFlags.h>
@@ -52,6 +54,17 @@ std::unique_ptr<IOBuf> iobufs(std::initializer_list<T> ranges) {
   return queue.move();
 }
 
+// The first codec compiled in that RecordIO files would typically use.
+io::CodecType anyCodec() {
+  for (auto type :
+       {io::CodecType::ZSTD, io::CodecType::LZ4_FRAME, io::CodecType::ZLIB}) {
+    if (io::hasCodec(type)) {
+      return type;
+    }
+  }
+  return io::CodecType::NO_COMPRESSION;
+}
+
 } // namespace
 
 TEST(RecordIOTest, Simple) {
@@ -263,6 +276,355 @@ TEST(RecordIOTest, Randomized) {
   }
 }
 
+TEST(RecordIOTest, AsyncWriter) {
+  constexpr size_t kThreads = 8;
+  constexpr size_t kRecordsPerThread = 500;
+  TemporaryFile file;
+  {
+    RecordIOWriter writer(File(file.fd()));
+    writer.write(iobufs({"first"}));
+  }
+  {
+    AsyncRecordIOWriter writer(
+        File(file.fd()),
+        1,
+        AsyncRecordIOWriter::Options().setBatchSize(4096).setMaxQueuedBytes(
+            1 << 16));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&, t] {
+        for (size_t i = 0; i < kRecordsPerThread; ++i) {
+          auto record = to<std::string>(t, ":", i, ":");
+          record.append(i % 100, 'x');
+          writer.write(IOBuf::copyBuffer(record));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  {
+    RecordIOReader reader(File(file.fd()));
+    auto it = reader.begin();
+    ASSERT_FALSE(it == reader.end());
+    EXPECT_EQ("first", sp((it++)->first));
+    std::vector<size_t> next(kThreads, 0);
+    size_t count = 0;
+    for (; it != reader.end(); ++it, ++count) {
+      auto record = sp(it->first);
+      auto t = to<size_t>(record.split_step(':'));
+      auto i = to<size_t>(record.split_step(':'));
+      ASSERT_LT(t, kThreads);
+      // Records from one thread are in order.
+      EXPECT_EQ(next[t]++, i);
+    }
+    EXPECT_EQ(kThreads * kRecordsPerThread, count);
+  }
+}
+
+TEST(RecordIOTest, AsyncWriterFlushAndAlignment) {
+  constexpr size_t kAlignment = 4096;
+  TemporaryFile file;
+  AsyncRecordIOWriter writer(
+      File(file.fd()),
+      1,
+      AsyncRecordIOWriter::Options()
+          .setBatchSize(3 * kAlignment)
+          .setMaxDelay(std::chrono::hours(1))
+          .setAlignment(kAlignment));
+  std::vector<std::string> records;
+  for (size_t i = 0; i < 20; ++i) {
+    records.push_back(std::string(i * 1000 + 1, 'a' + i));
+    writer.write(IOBuf::copyBuffer(records.back()));
+    if (i % 3 == 0) {
+      writer.flush();
+      struct stat st;
+      ASSERT_EQ(0, fstat(file.fd(), &st));
+      EXPECT_EQ(0, st.st_size % kAlignment);
+
+      RecordIOReader reader(File(file.fd()));
+      size_t n = 0;
+      for (auto& record : reader) {
+        ASSERT_LT(n, records.size());
+        EXPECT_EQ(records[n++], sp(record.first));
+      }
+      EXPECT_EQ(records.size(), n);
+    }
+  }
+  EXPECT_THROW(
+      AsyncRecordIOWriter(
+          File(file.fd()), 1, AsyncRecordIOWriter::Options().setAlignment(3)),
+      std::invalid_argument);
+}
+
+TEST(RecordIOTest, AsyncWriterError) {
+  TemporaryFile file;
+  AsyncRecordIOWriter writer(File(file.path().string(), O_RDONLY));
+  writer.write(iobufs({"hello"}));
+  EXPECT_THROW(writer.flush(), std::system_error);
+  EXPECT_THROW(writer.write(iobufs({"world"})), std::system_error);
+}
+
+TEST(RecordIOTest, Split) {
+  SCOPED_TRACE(to<std::string>("Random seed is ", FLAGS_random_seed));
+  std::mt19937 rnd(FLAGS_random_seed);
+  std::uniform_int_distribution<uint32_t> recordSizeDist(1, 1 << 12);
+  std::uniform_int_distribution<uint32_t> junkDist(0, 3);
+
+  TemporaryFile file;
+  for (size_t i = 0; i < 1000; ++i) {
+    RecordIOWriter(File(file.fd()))
+        .write(IOBuf::copyBuffer(
+            to<std::string>(i, std::string(recordSizeDist(rnd), ' '))));
+    if (junkDist(rnd) == 0) {
+      // Junk between records, starting with a magic.
+      std::string junk(recordSizeDist(rnd) + 4, 'j');
+      const uint32_t magic = recordio_helpers::recordio_detail::Header::kMagic;
+      memcpy(&junk[0], &magic, sizeof(magic));
+      struct stat st;
+      ASSERT_EQ(0, fstat(file.fd(), &st));
+      ASSERT_EQ(
+          junk.size(), pwrite(file.fd(), junk.data(), junk.size(), st.st_size));
+    }
+  }
+
+  RecordIOReader reader(File(file.fd()));
+  std::vector<std::pair<ByteRange, off_t>> expected(
+      reader.begin(), reader.end());
+  ASSERT_EQ(1000, expected.size());
+  for (size_t n : {1, 2, 3, 7, 64, 1000000}) {
+    SCOPED_TRACE(n);
+    auto chunks = reader.split(n);
+    EXPECT_LE(chunks.size(), n);
+    std::vector<std::vector<std::pair<ByteRange, off_t>>> results(
+        chunks.size());
+    auto scan = [&](size_t i) {
+      for (auto& record : chunks[i]) {
+        results[i].push_back(record);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      if (chunks.size() <= 64) {
+        threads.emplace_back(scan, i);
+      } else {
+        scan(i);
+      }
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    size_t n = 0;
+    for (auto& result : results) {
+      for (auto& record : result) {
+        ASSERT_LT(n, expected.size());
+        EXPECT_EQ(expected[n].second, record.second);
+        EXPECT_EQ(expected[n].first, record.first);
+        ++n;
+      }
+    }
+    EXPECT_EQ(expected.size(), n);
+  }
+}
+
+TEST(RecordIOTest, Compressed) {
+  auto codecType = anyCodec();
+  if (codecType == io::CodecType::NO_COMPRESSION) {
+    GTEST_SKIP() << "no codec available";
+  }
+  // A few KB of repeated text, which every codec compresses well.
+  std::string text;
+  for (size_t i = 0; i < 100; ++i) {
+    text += to<std::string>("line ", i % 10, ": the quick brown fox\n");
+  }
+  std::vector<std::string> records = {
+      std::string(10000, 'a'),
+      "short",
+      std::string(100, 'b') + std::string(100, 'c'),
+      text,
+  };
+  TemporaryFile file;
+  {
+    RecordIOWriter writer(
+        File(file.fd()),
+        1,
+        RecordIOCompression().setCodecType(codecType).setMinRecordSize(16));
+    for (auto& record : records) {
+      writer.write(IOBuf::copyBuffer(record));
+    }
+    // Compressed and uncompressed records mix in one file.
+    RecordIOWriter(File(file.fd())).write(iobufs({records[0]}));
+  }
+  records.push_back(records[0]);
+
+  struct stat st;
+  ASSERT_EQ(0, fstat(file.fd(), &st));
+  EXPECT_LT(st.st_size, 10000 + text.size() / 2);
+
+  RecordIOReader reader(File(file.fd()));
+  size_t n = 0;
+  std::vector<off_t> positions;
+  for (auto it = reader.begin(); it != reader.end(); ++it) {
+    ASSERT_LT(n, records.size());
+    auto buf = reader.read(it);
+    EXPECT_EQ(records[n], buf->moveToFbString().toStdString());
+    // The record as stored.
+    EXPECT_EQ(n == 1 || n == 4, sp(it->first) == records[n]);
+    positions.push_back(it->second);
+    ++n;
+  }
+  EXPECT_EQ(records.size(), n);
+
+  // Records compressed on their own can be sought to.
+  auto it = reader.seek(positions[2]);
+  ASSERT_NE(reader.end(), it);
+  EXPECT_EQ(records[2], reader.read(it)->moveToFbString().toStdString());
+  it = reader.seek(positions[2] + 1);
+  ASSERT_NE(reader.end(), it);
+  EXPECT_EQ(records[3], reader.read(it)->moveToFbString().toStdString());
+}
+
+TEST(RecordIOTest, CompressedCorruption) {
+  auto codecType = anyCodec();
+  if (codecType == io::CodecType::NO_COMPRESSION) {
+    GTEST_SKIP() << "no codec available";
+  }
+  TemporaryFile file;
+  {
+    RecordIOWriter writer(
+        File(file.fd()), 1, RecordIOCompression().setCodecType(codecType));
+    for (size_t i = 0; i < 3; ++i) {
+      writer.write(
+          IOBuf::copyBuffer(to<std::string>(i, std::string(500, 'x'))));
+    }
+  }
+  RecordIOReader reader(File(file.fd()));
+  auto second = std::next(reader.begin())->second;
+  // Flip a byte of the compressed data of the second record.
+  char c;
+  auto pos = second + off_t(recordio_helpers::headerSize() + 20);
+  ASSERT_EQ(1, pread(file.fd(), &c, 1, pos));
+  c ^= 1;
+  ASSERT_EQ(1, pwrite(file.fd(), &c, 1, pos));
+
+  std::vector<std::string> read;
+  RecordIOReader corrupted(File(file.fd()));
+  for (auto it = corrupted.begin(); it != corrupted.end(); ++it) {
+    read.push_back(corrupted.read(it)->moveToFbString().toStdString());
+  }
+  ASSERT_EQ(2, read.size());
+  EXPECT_EQ('0', read[0][0]);
+  EXPECT_EQ('2', read[1][0]);
+}
+
+TEST(RecordIOTest, CompressedAsyncWriter) {
+  auto codecType = anyCodec();
+  if (codecType == io::CodecType::NO_COMPRESSION) {
+    GTEST_SKIP() << "no codec available";
+  }
+  constexpr size_t kThreads = 4;
+  constexpr size_t kRecordsPerThread = 200;
+  TemporaryFile file;
+  {
+    AsyncRecordIOWriter writer(
+        File(file.fd()),
+        1,
+        AsyncRecordIOWriter::Options().setCompression(
+            RecordIOCompression().setCodecType(codecType)));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&, t] {
+        for (size_t i = 0; i < kRecordsPerThread; ++i) {
+          writer.write(IOBuf::copyBuffer(
+              to<std::string>(t, ":", i, ":", std::string(1000, 'z'))));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  struct stat st;
+  ASSERT_EQ(0, fstat(file.fd(), &st));
+  EXPECT_LT(st.st_size, kThreads * kRecordsPerThread * 1000 / 2);
+
+  RecordIOReader reader(File(file.fd()));
+  size_t count = 0;
+  for (auto chunk : reader.split(kThreads)) {
+    for (auto it = chunk.begin(); it != chunk.end(); ++it, ++count) {
+      auto record = reader.read(it)->moveToFbString().toStdString();
+      StringPiece rest(record);
+      rest.split_step(':');
+      rest.split_step(':');
+      EXPECT_EQ(std::string(1000, 'z'), rest);
+    }
+  }
+  EXPECT_EQ(kThreads * kRecordsPerThread, count);
+}
+
+TEST(RecordIOTest, CompressedDictionary) {
+  auto codecType = anyCodec();
+  if (codecType == io::CodecType::NO_COMPRESSION) {
+    GTEST_SKIP() << "no codec available";
+  }
+  constexpr uint32_t kDictionaryId = 7;
+  std::string record(1000, 'd');
+  TemporaryFile file;
+  RecordIOWriter(
+      File(file.fd()),
+      1,
+      RecordIOCompression().setCodecType(codecType).setDictionary(
+          kDictionaryId, [&] { return io::getCodec(codecType); }))
+      .write(IOBuf::copyBuffer(record));
+
+  // The default reader has no dictionaries.
+  RecordIOReader noDictionaries(File(file.fd()));
+  ASSERT_NE(noDictionaries.end(), noDictionaries.begin());
+  EXPECT_THROW(noDictionaries.read(noDictionaries.begin()), std::runtime_error);
+
+  auto info =
+      recordio_helpers::parseCompressedRecord(noDictionaries.begin()->first);
+  EXPECT_EQ(codecType, info.codecType);
+  EXPECT_EQ(kDictionaryId, info.dictionaryId);
+  EXPECT_EQ(record.size(), info.uncompressedLength);
+
+  std::vector<uint32_t> requested;
+  RecordIOReader reader(
+      File(file.fd()), 0, [&](io::CodecType type, uint32_t dictionaryId) {
+        requested.push_back(dictionaryId);
+        return io::getCodec(type);
+      });
+  for (size_t i = 0; i < 2; ++i) {
+    EXPECT_EQ(record, reader.read(reader.begin())->moveToFbString());
+  }
+  // Codecs are reused.
+  EXPECT_EQ(std::vector<uint32_t>{kDictionaryId}, requested);
+}
+
+TEST(RecordIOTest, CompressedLengthTooLarge) {
+  auto codecType = anyCodec();
+  if (codecType == io::CodecType::NO_COMPRESSION) {
+    GTEST_SKIP() << "no codec available";
+  }
+  auto buf = IOBuf::copyBuffer(std::string(1000, 'l'));
+  ASSERT_TRUE(
+      recordio_helpers::compressRecord(buf, *io::getCodec(codecType)));
+  buf->coalesce();
+  // A corrupt tag must not size the allocation of read().
+  uint64_t length = uint64_t(1) << 40;
+  memcpy(
+      buf->writableData() +
+          offsetof(recordio_helpers::recordio_detail::CodecTag,
+                   uncompressedLength),
+      &length,
+      sizeof(length));
+  EXPECT_THROW(
+      recordio_helpers::parseCompressedRecord(
+          ByteRange(buf->data(), buf->length())),
+      std::runtime_error);
+}
+
 TEST(RecordIOTest, validateRecordAPI) {
   uint32_t hdrSize = recordio_helpers::headerSize();
   std::vector<uint32_t> testSizes = {
@@ -30,6 +30,8 @@
 #include <folly/Range.h>
 #include <folly/Unicode.h>
 #include <folly/Utility.h>
+#include <folly/detail/JsonStructuralIndex.h>
+#include <folly/detail/SimpleSimdStringUtils.h>
 #include <folly/lang/Bits.h>
 #include <folly/portability/Constexpr.h>
 
@@ -306,6 +308,17 @@ struct Input {
     storeCurrent();
   }
 
+  // Starts in the middle of `document`. Lines before the start are only
+  // counted if an error is reported.
+  Input(
+      StringPiece range,
+      json::serialization_opts const* opts,
+      StringPiece document)
+      : Input(range, opts) {
+    documentBegin_ = document.begin();
+    rangeBegin_ = range.begin();
+  }
+
   Input(Input const&) = delete;
   Input& operator=(Input const&) = delete;
 
@@ -371,7 +384,7 @@ struct Input {
   void expect(char c) {
     if (**this != c) {
       throw json::make_parse_error(
-          lineNum_, context(), to<std::string>("expected '", c, '\''));
+          errorLineNum(), context(), to<std::string>("expected '", c, '\''));
     }
     ++*this;
   }
@@ -408,7 +421,7 @@ struct Input {
   }
 
   [[noreturn]] void error(char const* what) const {
-    throw json::make_parse_error(lineNum_, context(), what);
+    throw json::make_parse_error(errorLineNum(), context(), what);
   }
   template <typename R>
   R error(char const* what) const {
@@ -429,12 +442,19 @@ struct Input {
  private:
   void storeCurrent() { current_ = range_.empty() ? EOF : range_.front(); }
 
+  unsigned errorLineNum() const {
+    return lineNum_ +
+        unsigned(std::count(documentBegin_, rangeBegin_, '\n'));
+  }
+
  private:
   StringPiece range_;
   json::serialization_opts const& opts_;
   unsigned lineNum_;
   int current_;
   unsigned int currentRecursionLevel_{0};
+  char const* documentBegin_{nullptr};
+  char const* rangeBegin_{nullptr};
 };
 
 class RecursionGuard {
@@ -743,6 +763,267 @@ dynamic parseValue(Input& in, json::metadata_map* map) {
   // clang-format on
 }
 
+// Second stage of parseJsonIndexed(): walks the structural positions found
+// by detail::jsonStructuralIndex(). Strings without escapes are copied in one
+// go, everything else defers to the scalar parser above.
+class IndexedParser {
+ public:
+  IndexedParser(
+      StringPiece json,
+      uint32_t const* index,
+      json::serialization_opts const& opts)
+      : json_(json), pos_(index), opts_(opts) {}
+
+  IndexedParser(IndexedParser const&) = delete;
+  IndexedParser& operator=(IndexedParser const&) = delete;
+
+  dynamic parseDocument() {
+    auto ret = parseValue();
+    if (*pos_ != json_.size() && json_[*pos_] != '\0') {
+      error(*pos_, "parsing didn't consume all input");
+    }
+    return ret;
+  }
+
+ private:
+  class RecursionGuard {
+   public:
+    explicit RecursionGuard(IndexedParser& p) : p_(p) {
+      if (p_.depth_ > p_.opts_.recursion_limit) {
+        p_.error(*p_.pos_, "recursion limit exceeded");
+      }
+      ++p_.depth_;
+    }
+
+    ~RecursionGuard() { --p_.depth_; }
+
+   private:
+    IndexedParser& p_;
+  };
+
+  int peek() const { return *pos_ < json_.size() ? json_[*pos_] : EOF; }
+
+  [[noreturn]] void error(uint32_t offset, char const* what) const {
+    auto at = json_.begin() + offset;
+    throw json::make_parse_error(
+        unsigned(std::count(json_.begin(), at, '\n')),
+        json_.subpiece(offset, 16).str(),
+        what);
+  }
+
+  void expect(char c) {
+    if (peek() != c) {
+      error(*pos_, to<std::string>("expected '", c, '\'').c_str());
+    }
+    ++pos_;
+  }
+
+  dynamic parseValue() {
+    RecursionGuard guard(*this);
+    switch (peek()) {
+      case '[':
+        return parseArray();
+      case '{':
+        return parseObject();
+      case '\"':
+        return parseString();
+      default:
+        return parseScalar();
+    }
+  }
+
+  dynamic parseArray() {
+    ++pos_;
+    dynamic ret = dynamic::array;
+    if (peek() == ']') {
+      ++pos_;
+      return ret;
+    }
+    for (;;) {
+      if (opts_.allow_trailing_comma && peek() == ']') {
+        break;
+      }
+      ret.push_back(parseValue());
+      if (peek() != ',') {
+        break;
+      }
+      ++pos_;
+    }
+    expect(']');
+    return ret;
+  }
+
+  dynamic parseObject() {
+    auto const begin = *pos_;
+    ++pos_;
+    dynamic ret = dynamic::object;
+    if (peek() == '}') {
+      ++pos_;
+      return ret;
+    }
+    const bool distinct = opts_.validate_keys || opts_.convert_int_keys;
+    for (;;) {
+      if (opts_.allow_trailing_comma && peek() == '}') {
+        break;
+      }
+      auto const keyBegin = *pos_;
+      dynamic key = parseValue();
+      if (opts_.convert_int_keys && key.isInt()) {
+        key = key.asString();
+      } else if (!opts_.allow_non_string_keys && !key.isString()) {
+        error(
+            keyBegin,
+            opts_.convert_int_keys ? "expected string or integer for object key"
+                                   : "expected string for object key");
+      }
+      expect(':');
+      auto value = parseValue();
+      auto [it, inserted] = ret.try_emplace(std::move(key), std::move(value));
+      if (!inserted) {
+        if (distinct) {
+          error(begin, "duplicate key inserted");
+        }
+        it->second = std::move(value);
+      }
+      if (peek() != ',') {
+        break;
+      }
+      ++pos_;
+    }
+    expect('}');
+    return ret;
+  }
+
+  dynamic parseString() {
+    auto const quote = *pos_++;
+    if (*pos_ == json_.size()) {
+      error(quote, "unterminated string");
+    }
+    auto body = json_.subpiece(quote + 1, *pos_ - quote - 1);
+    ++pos_;
+    if (FOLLY_UNLIKELY(body.find('\0') != StringPiece::npos)) {
+      return parseStringSlow(quote);
+    }
+    auto esc = body.find('\\');
+    if (FOLLY_LIKELY(esc == StringPiece::npos)) {
+      return body;
+    }
+
+    // Short escapes are handled here, \u and errors by the scalar parser.
+    std::string ret;
+    ret.reserve(body.size());
+    while (esc != StringPiece::npos) {
+      ret.append(body.data(), esc);
+      if (esc + 1 == body.size()) {
+        return parseStringSlow(quote);
+      }
+      switch (body[esc + 1]) {
+          // clang-format off
+        case '\"':    ret.push_back('\"'); break;
+        case '\\':    ret.push_back('\\'); break;
+        case '/':     ret.push_back('/');  break;
+        case 'b':     ret.push_back('\b'); break;
+        case 'f':     ret.push_back('\f'); break;
+        case 'n':     ret.push_back('\n'); break;
+        case 'r':     ret.push_back('\r'); break;
+        case 't':     ret.push_back('\t'); break;
+        // clang-format on
+        default:
+          return parseStringSlow(quote);
+      }
+      body.advance(esc + 2);
+      esc = body.find('\\');
+    }
+    ret.append(body.data(), body.size());
+    return ret;
+  }
+
+  dynamic parseStringSlow(uint32_t quote) {
+    Input in(json_.subpiece(quote), &opts_, json_);
+    return json::parseString(in);
+  }
+
+  // True if only whitespace separates `p` from the next structural position.
+  bool endsToken(char const* p) const {
+    auto const next = json_.begin() + *pos_;
+    while (p != next && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) {
+      ++p;
+    }
+    return p == next;
+  }
+
+  // Fast path for literals and integers that fit in 18 digits, which make up
+  // most scalars in practice. Everything else goes through parseValue().
+  bool tryParseSimpleScalar(char const* p, dynamic& out) const {
+    auto literal = [&](StringPiece word, dynamic value) {
+      if (StringPiece(p, json_.end()).startsWith(word) &&
+          endsToken(p + word.size())) {
+        out = std::move(value);
+        return true;
+      }
+      return false;
+    };
+    switch (*p) {
+      case 't':
+        return literal("true", true);
+      case 'f':
+        return literal("false", false);
+      case 'n':
+        return literal("null", nullptr);
+      default:
+        break;
+    }
+
+    auto const begin = p;
+    bool const negative = *p == '-';
+    p += negative;
+    int64_t value = 0;
+    auto const digits = p;
+    while (p != json_.end() && *p >= '0' && *p <= '9' && p - digits < 18) {
+      value = value * 10 + (*p - '0');
+      ++p;
+    }
+    if (p == digits ||
+        (p != json_.end() &&
+         ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E')) ||
+        !endsToken(p)) {
+      return false;
+    }
+    if (opts_.parse_numbers_as_strings) {
+      out = StringPiece(begin, p);
+    } else {
+      out = negative ? -value : value;
+    }
+    return true;
+  }
+
+  // Numbers and literals. The scalar must extend up to the next structural
+  // position, modulo whitespace.
+  dynamic parseScalar() {
+    if (*pos_ == json_.size()) {
+      error(*pos_, "expected json value");
+    }
+    auto const begin = *pos_++;
+    dynamic simple;
+    if (tryParseSimpleScalar(json_.begin() + begin, simple)) {
+      return simple;
+    }
+    Input in(json_.subpiece(begin), &opts_, json_);
+    auto ret = json::parseValue(in, nullptr);
+    in.skipWhitespace();
+    if (in.begin() != json_.begin() + *pos_ &&
+        !(depth_ == 1 && *in == '\0')) {
+      in.error("unexpected characters after value");
+    }
+    return ret;
+  }
+
+  StringPiece json_;
+  uint32_t const* pos_;
+  json::serialization_opts const& opts_;
+  unsigned int depth_{0};
+};
+
 } // namespace
 
 //////////////////////////////////////////////////////////////////////
@@ -757,8 +1038,31 @@ std::array<uint64_t, 2> buildExtraAsciiToEscapeBitmap(StringPiece chars) {
   return escapes;
 }
 
+namespace {
+
+// Estimate of the size of the compact serialization of `v`, to size the
+// output up front. Only looks at the top level to stay cheap; strings are
+// exact unless they need escaping.
+std::size_t estimateSerializedSize(dynamic const& v) {
+  constexpr std::size_t kElementSize = 8;
+  switch (v.type()) {
+    case dynamic::STRING:
+      return v.stringPiece().size() + 2;
+    case dynamic::ARRAY:
+      return 2 + v.size() * kElementSize;
+    case dynamic::OBJECT:
+      return 2 + v.size() * 2 * kElementSize;
+    default:
+      // Short enough that growing the string is cheap.
+      return 0;
+  }
+}
+
+} // namespace
+
 std::string serialize(dynamic const& dyn, serialization_opts const& opts) {
   std::string ret;
+  ret.reserve(estimateSerializedSize(dyn));
   unsigned indentLevel = 0;
   Printer p(ret, opts.pretty_formatting ? &indentLevel : nullptr, &opts);
   p(dyn, nullptr);
@@ -823,6 +1127,10 @@ size_t firstEscapableInWord(T s, const serialization_opts& opts) {
   }
 }
 
+// Strings shorter than this are scanned a word at a time, as the call into
+// the vectorized scan would cost more than it saves.
+constexpr std::ptrdiff_t kMinSimdEscapeScan = 16;
+
 // Escape a string so that it is legal to print it in JSON text.
 template <bool EnableExtraAsciiEscapes>
 void escapeStringImpl(
@@ -837,23 +1145,34 @@ void escapeStringImpl(
   auto* q = reinterpret_cast<const unsigned char*>(input.begin());
   auto* e = reinterpret_cast<const unsigned char*>(input.end());
 
+  // Bytes >= 0x80 are only ever escaped or validated on request.
+  const bool escapeNonAscii =
+      opts.encode_non_ascii || opts.validate_utf8 || opts.skip_invalid_utf8;
+
   while (p < e) {
     // Find the longest prefix that does not need escaping, and copy
     // it literally into the output string.
     auto firstEsc = p;
-    while (firstEsc < e) {
-      auto avail = to_unsigned(e - firstEsc);
-      uint64_t word = 0;
-      if (avail >= 8) {
-        word = folly::loadUnaligned<uint64_t>(firstEsc);
-      } else {
-        word = folly::partialLoadUnaligned<uint64_t>(firstEsc, avail);
-      }
-      auto prefix = firstEscapableInWord<EnableExtraAsciiEscapes>(word, opts);
-      DCHECK_LE(prefix, avail);
-      firstEsc += prefix;
-      if (prefix < 8) {
-        break;
+    if (!EnableExtraAsciiEscapes && e - p >= kMinSimdEscapeScan) {
+      firstEsc += detail::simdFirstJsonEscapable(
+          StringPiece(reinterpret_cast<const char*>(p), e - p),
+          escapeNonAscii);
+    } else {
+      while (firstEsc < e) {
+        auto avail = to_unsigned(e - firstEsc);
+        uint64_t word = 0;
+        if (avail >= 8) {
+          word = folly::loadUnaligned<uint64_t>(firstEsc);
+        } else {
+          word = folly::partialLoadUnaligned<uint64_t>(firstEsc, avail);
+        }
+        auto prefix =
+            firstEscapableInWord<EnableExtraAsciiEscapes>(word, opts);
+        DCHECK_LE(prefix, avail);
+        firstEsc += prefix;
+        if (prefix < 8) {
+          break;
+        }
       }
     }
     if (firstEsc > p) {
@@ -1075,6 +1394,21 @@ dynamic parseJson(StringPiece range, json::serialization_opts const& opts) {
   return ret;
 }
 
+dynamic parseJsonIndexed(StringPiece range) {
+  return parseJsonIndexed(range, json::serialization_opts());
+}
+
+dynamic parseJsonIndexed(
+    StringPiece range, json::serialization_opts const& opts) {
+  if (FOLLY_UNLIKELY(range.size() > detail::kJsonStructuralIndexMaxSize)) {
+    return parseJson(range, opts);
+  }
+  std::vector<uint32_t> index;
+  detail::jsonStructuralIndex(range, index);
+  json::IndexedParser parser(range, index.data(), opts);
+  return parser.parseDocument();
+}
+
 std::string toJson(dynamic const& dyn) {
   return json::serialize(dyn, json::serialization_opts());
 }
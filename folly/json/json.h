@@ -210,6 +210,18 @@ using metadata_map = std::unordered_map<dynamic const*, parse_metadata>;
 dynamic parseJson(StringPiece, json::serialization_opts const&);
 dynamic parseJson(StringPiece);
 
+/**
+ * Same as parseJson(), but parses in two stages: a vectorized pass over the
+ * whole input first indexes the structural characters (brackets, colons,
+ * commas, quotes and the starts of scalars), then the index is walked to
+ * build the dynamic. Strings without escapes are copied in one go.
+ *
+ * Produces the same dynamic and honors the same options as parseJson(), and
+ * is considerably faster on large documents. Error messages may differ.
+ */
+dynamic parseJsonIndexed(StringPiece, json::serialization_opts const&);
+dynamic parseJsonIndexed(StringPiece);
+
 dynamic parseJsonWithMetadata(StringPiece range, json::metadata_map* map);
 dynamic parseJsonWithMetadata(
     StringPiece range,
@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_arena.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <folly/Conv.h>
+#include <folly/Format.h>
+#include <folly/Likely.h>
+#include <folly/hash/Hash.h>
+#include <folly/json/json_stream.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+namespace json {
+
+namespace {
+
+// Objects with more members than this get a hash index.
+constexpr uint32_t kMaxLinearLookup = 8;
+
+// Capacity of the hash index of an object with `size` members: a power of
+// two, at most half full. Slots hold member index + 1, or 0 when empty.
+std::size_t indexCapacity(uint32_t size) {
+  return size > kMaxLinearLookup ? nextPowTwo(std::size_t(size) * 2) : 0;
+}
+
+std::size_t hashKey(StringPiece key) {
+  return hasher<StringPiece>()(key);
+}
+
+// The index lives right after the members.
+uint32_t const* indexOf(arena_member const* members, uint32_t size) {
+  return reinterpret_cast<uint32_t const*>(members + size);
+}
+
+// Block size for a document of `size` bytes: a large document gets large
+// blocks, so that it only takes a few of them.
+std::size_t blockSizeFor(std::size_t size) {
+  constexpr std::size_t kMaxBlockSize = std::size_t(1) << 20;
+  return std::clamp(size, SysArena::kDefaultMinBlockSize, kMaxBlockSize);
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+// Builds the tree bottom up: values are collected on a stack until their
+// container is complete, then copied into the arena in one piece.
+class arena_builder final : public json_stream_handler {
+ public:
+  arena_builder(SysArena& arena, serialization_opts const& opts)
+      : arena_(arena), validateKeys_(opts.validate_keys) {}
+
+  arena_dynamic result() const { return stack_.back().value; }
+
+  void onNull() override { add(arena_dynamic()); }
+  void onBool(bool value) override {
+    arena_dynamic v;
+    v.type_ = dynamic::BOOL;
+    v.bool_ = value;
+    add(v);
+  }
+  void onInt(int64_t value) override {
+    arena_dynamic v;
+    v.type_ = dynamic::INT64;
+    v.int_ = value;
+    add(v);
+  }
+  void onDouble(double value) override {
+    arena_dynamic v;
+    v.type_ = dynamic::DOUBLE;
+    v.double_ = value;
+    add(v);
+  }
+  void onString(StringPiece value) override {
+    arena_dynamic v;
+    v.type_ = dynamic::STRING;
+    auto copy = copyString(value);
+    v.size_ = uint32_t(copy.size());
+    v.string_ = copy.data();
+    add(v);
+  }
+
+  void onBeginArray() override { open(); }
+  void onEndArray() override;
+
+  void onBeginObject() override { open(); }
+  void onKey(StringPiece key) override { key_ = copyString(key); }
+  void onEndObject() override;
+
+ private:
+  struct frame {
+    std::size_t start;
+    StringPiece key;
+  };
+
+  void add(arena_dynamic value) {
+    stack_.push_back({std::exchange(key_, {}), value});
+  }
+
+  void open() { open_.push_back({stack_.size(), std::exchange(key_, {})}); }
+
+  // Pops the values of the container being closed.
+  std::pair<frame, uint32_t> close() {
+    auto f = open_.back();
+    open_.pop_back();
+    return {f, checkedSize(stack_.size() - f.start)};
+  }
+
+  static uint32_t checkedSize(std::size_t size) {
+    if (FOLLY_UNLIKELY(size > std::numeric_limits<uint32_t>::max())) {
+      throw_exception<parse_error>("json parse error: value too large");
+    }
+    return uint32_t(size);
+  }
+
+  template <class T>
+  T* allocate(std::size_t count, std::size_t extraBytes = 0) {
+    return static_cast<T*>(arena_.allocate(count * sizeof(T) + extraBytes));
+  }
+
+  StringPiece copyString(StringPiece s) {
+    checkedSize(s.size());
+    if (s.empty()) {
+      return {};
+    }
+    auto* data = allocate<char>(s.size());
+    std::memcpy(data, s.data(), s.size());
+    return {data, s.size()};
+  }
+
+  static void buildIndex(arena_member* members, uint32_t size);
+
+  void duplicateKey(arena_member& existing, arena_member const& member) {
+    if (validateKeys_) {
+      throw_exception<parse_error>("json parse error: duplicate key inserted");
+    }
+    existing.value = member.value;
+  }
+
+  SysArena& arena_;
+  bool const validateKeys_;
+
+  std::vector<arena_member> stack_;
+  std::vector<frame> open_;
+  StringPiece key_;
+};
+
+void arena_builder::onEndArray() {
+  auto [f, size] = close();
+  auto* elements = allocate<arena_dynamic>(size);
+  for (uint32_t i = 0; i < size; ++i) {
+    elements[i] = stack_[f.start + i].value;
+  }
+  stack_.erase(stack_.begin() + f.start, stack_.end());
+
+  arena_dynamic v;
+  v.type_ = dynamic::ARRAY;
+  v.size_ = size;
+  v.elements_ = elements;
+  key_ = f.key;
+  add(v);
+}
+
+void arena_builder::onEndObject() {
+  auto [f, count] = close();
+  auto* first = stack_.data() + f.start;
+
+  // Duplicate keys only ever make the object smaller, so room for `count`
+  // members and their index is enough.
+  auto capacity = indexCapacity(count);
+  auto* members = allocate<arena_member>(count, capacity * sizeof(uint32_t));
+  uint32_t size = 0;
+  auto* index = const_cast<uint32_t*>(indexOf(members, count));
+  std::fill(index, index + capacity, 0);
+  for (auto* m = first; m != first + count; ++m) {
+    arena_member* existing = nullptr;
+    if (capacity == 0) {
+      auto* last = members + size;
+      existing = std::find_if(
+          members, last, [&](auto const& e) { return e.key == m->key; });
+      existing = existing != last ? existing : nullptr;
+    } else {
+      auto slot = hashKey(m->key) & (capacity - 1);
+      while (index[slot] != 0 && members[index[slot] - 1].key != m->key) {
+        slot = (slot + 1) & (capacity - 1);
+      }
+      if (index[slot] != 0) {
+        existing = &members[index[slot] - 1];
+      } else {
+        index[slot] = size + 1;
+      }
+    }
+    if (existing) {
+      duplicateKey(*existing, *m);
+    } else {
+      members[size++] = *m;
+    }
+  }
+  if (size != count && indexCapacity(size) != 0) {
+    // The index has to follow the members actually kept.
+    buildIndex(members, size);
+  }
+  stack_.erase(stack_.begin() + f.start, stack_.end());
+
+  arena_dynamic v;
+  v.type_ = dynamic::OBJECT;
+  v.size_ = size;
+  v.members_ = members;
+  key_ = f.key;
+  add(v);
+}
+
+void arena_builder::buildIndex(
+    arena_member* members, uint32_t size) {
+  auto capacity = indexCapacity(size);
+  auto* index = const_cast<uint32_t*>(indexOf(members, size));
+  std::fill(index, index + capacity, 0);
+  for (uint32_t i = 0; i < size; ++i) {
+    auto slot = hashKey(members[i].key) & (capacity - 1);
+    while (index[slot] != 0) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    index[slot] = i + 1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+
+arena_document::arena_document(
+    StringPiece json, serialization_opts const& opts)
+    : arena_(blockSizeFor(json.size())) {
+  arena_builder b(arena_, opts);
+  json_stream_parser parser(b, opts);
+  parser.feed(json);
+  parser.finish();
+  root_ = b.result();
+}
+
+arena_document::arena_document(
+    IOBuf const& chain, serialization_opts const& opts)
+    : arena_(blockSizeFor(chain.computeChainDataLength())) {
+  arena_builder b(arena_, opts);
+  json_stream_parser parser(b, opts);
+  parser.feed(chain);
+  parser.finish();
+  root_ = b.result();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void arena_dynamic::expectType(
+    dynamic::Type expected, char const* name) const {
+  if (FOLLY_UNLIKELY(type_ != expected)) {
+    throw_exception<TypeError>(name, type_);
+  }
+}
+
+bool arena_dynamic::getBool() const {
+  expectType(dynamic::BOOL, "boolean");
+  return bool_;
+}
+
+int64_t arena_dynamic::getInt() const {
+  expectType(dynamic::INT64, "int64");
+  return int_;
+}
+
+double arena_dynamic::getDouble() const {
+  expectType(dynamic::DOUBLE, "double");
+  return double_;
+}
+
+StringPiece arena_dynamic::getString() const {
+  expectType(dynamic::STRING, "string");
+  return {string_, size_};
+}
+
+std::size_t arena_dynamic::size() const {
+  if (FOLLY_UNLIKELY(!isString() && !isArray() && !isObject())) {
+    throw_exception<TypeError>("array/object/string", type_);
+  }
+  return size_;
+}
+
+arena_dynamic const* arena_dynamic::begin() const {
+  expectType(dynamic::ARRAY, "array");
+  return elements_;
+}
+
+arena_dynamic const* arena_dynamic::end() const {
+  return begin() + size_;
+}
+
+arena_member const* arena_dynamic::members() const {
+  expectType(dynamic::OBJECT, "object");
+  return members_;
+}
+
+arena_dynamic const& arena_dynamic::at(std::size_t idx) const {
+  auto* elements = begin();
+  if (FOLLY_UNLIKELY(idx >= size_)) {
+    throw_exception<std::out_of_range>("out of range in dynamic array");
+  }
+  return elements[idx];
+}
+
+arena_dynamic const* arena_dynamic::get_ptr(StringPiece key) const {
+  auto* first = members();
+  auto capacity = indexCapacity(size_);
+  if (capacity == 0) {
+    for (auto* m = first; m != first + size_; ++m) {
+      if (m->key == key) {
+        return &m->value;
+      }
+    }
+    return nullptr;
+  }
+  auto* index = indexOf(first, size_);
+  for (auto slot = hashKey(key) & (capacity - 1); index[slot] != 0;
+       slot = (slot + 1) & (capacity - 1)) {
+    auto& m = first[index[slot] - 1];
+    if (m.key == key) {
+      return &m.value;
+    }
+  }
+  return nullptr;
+}
+
+arena_dynamic const& arena_dynamic::at(StringPiece key) const {
+  auto* value = get_ptr(key);
+  if (FOLLY_UNLIKELY(!value)) {
+    throw_exception<std::out_of_range>(
+        sformat("couldn't find key {} in dynamic object", key));
+  }
+  return *value;
+}
+
+arena_dynamic const* arena_dynamic::get_ptr(
+    json_pointer const& jsonPtr) const {
+  auto* curr = this;
+  for (auto const& token : jsonPtr.tokens()) {
+    switch (curr->type_) {
+      case dynamic::ARRAY: {
+        if (token.size() > 1 && token[0] == '0') {
+          throw_exception<std::invalid_argument>(
+              "leading zero not allowed when indexing arrays");
+        }
+        if (token == "-") {
+          // Appending, there is nothing to resolve.
+          return nullptr;
+        }
+        auto idx = tryTo<std::size_t>(token);
+        if (!idx.hasValue()) {
+          throw_exception<std::invalid_argument>("array index is not numeric");
+        }
+        if (idx.value() >= curr->size_) {
+          return nullptr;
+        }
+        curr = curr->elements_ + idx.value();
+        break;
+      }
+      case dynamic::OBJECT:
+        curr = curr->get_ptr(StringPiece(token));
+        if (!curr) {
+          return nullptr;
+        }
+        break;
+      default:
+        throw_exception<TypeError>("object/array", curr->type_);
+    }
+  }
+  return curr;
+}
+
+dynamic arena_dynamic::toDynamic() const {
+  switch (type_) {
+    case dynamic::NULLT:
+      return nullptr;
+    case dynamic::BOOL:
+      return bool_;
+    case dynamic::INT64:
+      return int_;
+    case dynamic::DOUBLE:
+      return double_;
+    case dynamic::STRING:
+      return StringPiece(string_, size_);
+    case dynamic::ARRAY: {
+      dynamic ret = dynamic::array;
+      ret.reserve(size_);
+      for (auto const& elem : *this) {
+        ret.push_back(elem.toDynamic());
+      }
+      return ret;
+    }
+    case dynamic::OBJECT: {
+      dynamic ret = dynamic::object;
+      ret.reserve(size_);
+      for (auto const& m : items()) {
+        ret.insert(m.key, m.value.toDynamic());
+      }
+      return ret;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace json
+} // namespace folly
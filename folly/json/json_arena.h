@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Parsed json documents that live in a single arena.
+ *
+ * A dynamic allocates every string, array and object node on its own, so
+ * parsing a large document makes hundreds of thousands of small allocations
+ * and destroying it frees them one by one. An arena_document instead puts
+ * the whole tree, strings included, in a SysArena: parsing makes a handful
+ * of block allocations and destruction releases them in one go.
+ *
+ *     arena_document doc(body);
+ *     auto const& user = doc.root()["user"];
+ *     int64_t id = user["id"].getInt();
+ *     StringPiece name = user["name"].getString(); // points into the arena
+ *     dynamic settings = doc.root()["settings"].toDynamic();
+ *
+ * arena_dynamic is the read-only counterpart of dynamic: the same types,
+ * the same accessors throwing the same exceptions, but strings are returned
+ * as StringPiece's and nothing can be modified. Arrays are indexed in
+ * constant time, object members are kept in document order and looked up
+ * in constant time too. Values and the strings they return are valid as
+ * long as their arena_document.
+ *
+ * Parsing goes through json_stream_parser, see json_stream.h for the options
+ * honored.
+ *
+ * @file json_arena.h
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <folly/Range.h>
+#include <folly/io/IOBuf.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+#include <folly/json/json_pointer.h>
+#include <folly/memory/Arena.h>
+
+namespace folly {
+namespace json {
+
+class arena_builder;
+struct arena_member;
+
+class arena_dynamic {
+ public:
+  dynamic::Type type() const { return type_; }
+
+  bool isNull() const { return type_ == dynamic::NULLT; }
+  bool isBool() const { return type_ == dynamic::BOOL; }
+  bool isInt() const { return type_ == dynamic::INT64; }
+  bool isDouble() const { return type_ == dynamic::DOUBLE; }
+  bool isNumber() const { return isInt() || isDouble(); }
+  bool isString() const { return type_ == dynamic::STRING; }
+  bool isArray() const { return type_ == dynamic::ARRAY; }
+  bool isObject() const { return type_ == dynamic::OBJECT; }
+
+  /**
+   * Like dynamic's, these do not convert between types and throw TypeError
+   * if the value has a different one.
+   */
+  bool getBool() const;
+  int64_t getInt() const;
+  double getDouble() const;
+  StringPiece getString() const;
+  StringPiece stringPiece() const { return getString(); }
+
+  /**
+   * Number of elements of an array, members of an object or bytes of a
+   * string. Throws TypeError for anything else.
+   */
+  std::size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Array elements. Throws TypeError if this is not an array.
+   */
+  arena_dynamic const* begin() const;
+  arena_dynamic const* end() const;
+
+  /**
+   * Object members, in document order. A duplicated key appears once, where
+   * it first occurred, with the last value given to it. Throws TypeError if
+   * this is not an object.
+   */
+  Range<arena_member const*> items() const;
+
+  /**
+   * Array element lookup. Throws std::out_of_range if idx >= size().
+   */
+  arena_dynamic const& at(std::size_t idx) const;
+  arena_dynamic const& operator[](std::size_t idx) const { return at(idx); }
+
+  /**
+   * Object member lookup. get_ptr() returns nullptr if the key is missing,
+   * at() throws std::out_of_range.
+   */
+  arena_dynamic const* get_ptr(StringPiece key) const;
+  arena_dynamic const& at(StringPiece key) const;
+  arena_dynamic const& operator[](StringPiece key) const { return at(key); }
+
+  /**
+   * Resolves a json pointer relative to this value, with the same results
+   * as dynamic::get_ptr().
+   */
+  arena_dynamic const* get_ptr(json_pointer const& jsonPtr) const;
+
+  /**
+   * Copies this value and everything below it out of the arena.
+   */
+  dynamic toDynamic() const;
+
+ private:
+  friend class arena_builder;
+  friend class arena_document;
+
+  arena_dynamic() : type_(dynamic::NULLT), size_(0), int_(0) {}
+
+  void expectType(dynamic::Type expected, char const* name) const;
+  arena_member const* members() const;
+
+  dynamic::Type type_;
+  // Length of a string, number of elements of an array or of members of an
+  // object.
+  uint32_t size_;
+  union {
+    bool bool_;
+    int64_t int_;
+    double double_;
+    char const* string_;
+    arena_dynamic const* elements_;
+    arena_member const* members_;
+  };
+};
+
+struct arena_member {
+  StringPiece key;
+  arena_dynamic value;
+};
+
+class arena_document {
+ public:
+  /**
+   * Parses `json` into a new arena. The input can go away afterwards.
+   * Throws json::parse_error like parseJson().
+   */
+  explicit arena_document(
+      StringPiece json, serialization_opts const& opts = serialization_opts());
+
+  /**
+   * Parses a document held in an IOBuf chain, without coalescing it.
+   */
+  explicit arena_document(
+      IOBuf const& chain,
+      serialization_opts const& opts = serialization_opts());
+
+  arena_document(arena_document const&) = delete;
+  arena_document& operator=(arena_document const&) = delete;
+
+  arena_dynamic const& root() const { return root_; }
+
+  /**
+   * Memory held by the document.
+   */
+  std::size_t totalSize() const { return arena_.totalSize(); }
+
+ private:
+  SysArena arena_;
+  arena_dynamic root_;
+};
+
+inline Range<arena_member const*> arena_dynamic::items() const {
+  auto* first = members();
+  return {first, first + size_};
+}
+
+} // namespace json
+} // namespace folly
@@ -0,0 +1,565 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_stream.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include <folly/Conv.h>
+#include <folly/Unicode.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+namespace json {
+
+namespace {
+
+bool isJsonWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Bytes that end a number or literal.
+bool isScalarEnd(char c) {
+  switch (c) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case ',':
+    case ':':
+    case '[':
+    case ']':
+    case '{':
+    case '}':
+    case '"':
+    case '\0':
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+json_stream_parser::json_stream_parser(
+    json_stream_handler& handler, serialization_opts const& opts)
+    : handler_(handler),
+      allowTrailingComma_(opts.allow_trailing_comma),
+      parseNumbersAsStrings_(opts.parse_numbers_as_strings),
+      doubleFallback_(opts.double_fallback),
+      recursionLimit_(opts.recursion_limit) {
+  if (opts.allow_non_string_keys || opts.convert_int_keys) {
+    throw std::invalid_argument(
+        "json_stream_parser: object keys must be strings, "
+        "allow_non_string_keys and convert_int_keys are not supported");
+  }
+}
+
+void json_stream_parser::feed(ByteRange data) {
+  auto p = reinterpret_cast<char const*>(data.begin());
+  auto const e = reinterpret_cast<char const*>(data.end());
+  tokenBegin_ = p;
+  while (p != e) {
+    switch (state_) {
+      case State::String:
+        p = continueString(p, e);
+        break;
+      case State::Scalar:
+        p = continueScalar(p, e);
+        break;
+      case State::Tail:
+        return;
+      default:
+        p = structural(p, e);
+        break;
+    }
+  }
+  if (state_ == State::String || state_ == State::Scalar) {
+    token_.append(tokenBegin_, e);
+  }
+}
+
+void json_stream_parser::feed(IOBuf const& chain) {
+  for (auto range : chain) {
+    feed(range);
+  }
+}
+
+void json_stream_parser::feed(io::Cursor cursor) {
+  while (!cursor.isAtEnd()) {
+    auto range = cursor.peekBytes();
+    feed(range);
+    cursor.skip(range.size());
+  }
+}
+
+void json_stream_parser::finish() {
+  if (state_ == State::Scalar) {
+    // A scalar in progress always has its first byte buffered by feed().
+    completeScalar(token_);
+  }
+  switch (state_) {
+    case State::Done:
+    case State::Tail:
+      return;
+    case State::String:
+      error(token_, "unterminated string");
+    case State::Value:
+      if (stack_.empty()) {
+        error(StringPiece(), "expected json value");
+      }
+      [[fallthrough]];
+    default:
+      error(StringPiece(), "unexpected end of input");
+  }
+}
+
+char const* json_stream_parser::structural(char const* p, char const* e) {
+  char c = *p;
+  if (isJsonWhitespace(c)) {
+    line_ += c == '\n';
+    return p + 1;
+  }
+  switch (state_) {
+    case State::ArrayNext:
+      if (c == ']' && allowTrailingComma_) {
+        endContainer(c);
+        break;
+      }
+      return beginValue(p, e);
+    case State::Value:
+      return beginValue(p, e);
+    case State::ArrayFirst:
+      if (c == ']') {
+        endContainer(c);
+        break;
+      }
+      return beginValue(p, e);
+    case State::ObjectNext:
+    case State::ObjectFirst:
+      if (c == '}' &&
+          (state_ == State::ObjectFirst || allowTrailingComma_)) {
+        endContainer(c);
+      } else if (c == '"') {
+        isKey_ = true;
+        beginToken(p + 1, State::String);
+      } else {
+        error(p, e, "expected string for object key");
+      }
+      break;
+    case State::Colon:
+      if (c != ':') {
+        error(p, e, "expected ':'");
+      }
+      state_ = State::Value;
+      break;
+    case State::AfterValue:
+      if (c == ',') {
+        state_ = stack_.back() == '[' ? State::ArrayNext : State::ObjectNext;
+      } else if (c == (stack_.back() == '[' ? ']' : '}')) {
+        endContainer(c);
+      } else {
+        error(
+            p,
+            e,
+            stack_.back() == '[' ? "expected ',' or ']'"
+                                 : "expected ',' or '}'");
+      }
+      break;
+    case State::Done:
+      if (c != '\0') {
+        error(p, e, "parsing didn't consume all input");
+      }
+      state_ = State::Tail;
+      return e;
+    default:
+      break;
+  }
+  return p + 1;
+}
+
+char const* json_stream_parser::beginValue(char const* p, char const* e) {
+  if (stack_.size() > recursionLimit_) {
+    error(p, e, "recursion limit exceeded");
+  }
+  switch (*p) {
+    case '[':
+      handler_.onBeginArray();
+      stack_.push_back('[');
+      state_ = State::ArrayFirst;
+      break;
+    case '{':
+      handler_.onBeginObject();
+      stack_.push_back('{');
+      state_ = State::ObjectFirst;
+      break;
+    case '"':
+      isKey_ = false;
+      beginToken(p + 1, State::String);
+      break;
+    case ']':
+    case '}':
+    case ',':
+    case ':':
+    case '\0':
+      error(p, e, "expected json value");
+    default:
+      // The first byte is part of the token.
+      beginToken(p, State::Scalar);
+      return p;
+  }
+  return p + 1;
+}
+
+void json_stream_parser::beginToken(char const* p, State state) {
+  tokenBegin_ = p;
+  token_.clear();
+  hasEscapes_ = false;
+  state_ = state;
+}
+
+void json_stream_parser::endContainer(char close) {
+  DCHECK_EQ(stack_.back(), close == ']' ? '[' : '{');
+  stack_.pop_back();
+  if (close == ']') {
+    handler_.onEndArray();
+  } else {
+    handler_.onEndObject();
+  }
+  afterValue();
+}
+
+void json_stream_parser::afterValue() {
+  state_ = stack_.empty() ? State::Done : State::AfterValue;
+}
+
+char const* json_stream_parser::continueString(char const* p, char const* e) {
+  if (escapeNext_) {
+    escapeNext_ = false;
+    ++p;
+  }
+  while (p != e) {
+    // Long runs of plain bytes are the common case, memchr is vectorized.
+    auto end = static_cast<char const*>(std::memchr(p, '"', size_t(e - p)));
+    end = end ? end : e;
+    if (auto esc = std::memchr(p, '\\', size_t(end - p))) {
+      end = static_cast<char const*>(esc);
+    }
+    line_ += unsigned(std::count(p, end, '\n'));
+    if (end == e) {
+      break;
+    }
+    if (*end == '"') {
+      completeString(end);
+      return end + 1;
+    }
+    hasEscapes_ = true;
+    p = end + 1;
+    if (p == e) {
+      escapeNext_ = true;
+      break;
+    }
+    ++p;
+  }
+  return e;
+}
+
+void json_stream_parser::completeString(char const* end) {
+  auto str = takeToken(end);
+  if (hasEscapes_) {
+    unescape(str);
+    str = unescaped_;
+  }
+  if (isKey_) {
+    handler_.onKey(str);
+    state_ = State::Colon;
+  } else {
+    handler_.onString(str);
+    afterValue();
+  }
+}
+
+char const* json_stream_parser::continueScalar(char const* p, char const* e) {
+  auto end = std::find_if(p, e, isScalarEnd);
+  if (end != e) {
+    completeScalar(takeToken(end));
+  }
+  return end;
+}
+
+StringPiece json_stream_parser::takeToken(char const* end) {
+  if (token_.empty()) {
+    return StringPiece(tokenBegin_, end);
+  }
+  token_.append(tokenBegin_, end);
+  return token_;
+}
+
+void json_stream_parser::completeScalar(StringPiece token) {
+  switch (token.front()) {
+    case 't':
+      if (token == "true") {
+        handler_.onBool(true);
+        break;
+      }
+      error(token, "expected json value");
+    case 'f':
+      if (token == "false") {
+        handler_.onBool(false);
+        break;
+      }
+      error(token, "expected json value");
+    case 'n':
+      if (token == "null") {
+        handler_.onNull();
+        break;
+      }
+      error(token, "expected json value");
+    default:
+      completeNumber(token);
+      break;
+  }
+  afterValue();
+}
+
+void json_stream_parser::completeNumber(StringPiece token) {
+  // Same rules as parseNumber() in json.cpp.
+  if (token == "Infinity" || token == "-Infinity" || token == "NaN") {
+    if (parseNumbersAsStrings_) {
+      handler_.onString(token);
+    } else if (token == "NaN") {
+      handler_.onDouble(std::numeric_limits<double>::quiet_NaN());
+    } else {
+      handler_.onDouble(
+          token.front() == '-' ? -std::numeric_limits<double>::infinity()
+                               : std::numeric_limits<double>::infinity());
+    }
+    return;
+  }
+
+  bool const negative = token.front() == '-';
+  auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+  auto p = std::find_if_not(token.begin() + negative, token.end(), isDigit);
+  StringPiece integral(token.begin(), p);
+  if (integral.size() == size_t(negative)) {
+    error(
+        token, negative ? "expected digits after `-'" : "expected json value");
+  }
+
+  if (p == token.end()) {
+    if (parseNumbersAsStrings_) {
+      handler_.onString(token);
+      return;
+    }
+    constexpr StringPiece maxIntStr = "9223372036854775807";
+    constexpr StringPiece minIntStr = "-9223372036854775808";
+    auto extrema = negative ? minIntStr : maxIntStr;
+    if (!doubleFallback_ || integral.size() < extrema.size() ||
+        (integral.size() == extrema.size() && integral <= extrema)) {
+      handler_.onInt(to<int64_t>(integral));
+    } else {
+      handler_.onDouble(to<double>(integral));
+    }
+    return;
+  }
+
+  if (*p == '.') {
+    p = std::find_if_not(p + 1, token.end(), isDigit);
+  }
+  if (p != token.end() && (*p == 'e' || *p == 'E')) {
+    ++p;
+    if (p != token.end() && (*p == '+' || *p == '-')) {
+      ++p;
+    }
+    p = std::find_if_not(p, token.end(), isDigit);
+  }
+  if (p != token.end()) {
+    error(token, "invalid number");
+  }
+  if (parseNumbersAsStrings_) {
+    handler_.onString(token);
+  } else {
+    handler_.onDouble(to<double>(token));
+  }
+}
+
+void json_stream_parser::unescape(StringPiece in) {
+  unescaped_.clear();
+  auto p = in.begin();
+  auto const e = in.end();
+
+  auto readHex = [&]() -> uint16_t {
+    if (e - p < 4) {
+      error(StringPiece(p, e), "expected 4 hex digits");
+    }
+    uint16_t ret = 0;
+    for (int i = 0; i < 4; ++i, ++p) {
+      char c = *p;
+      // clang-format off
+      ret = uint16_t(ret * 16 + (
+          c >= '0' && c <= '9' ? c - '0' :
+          c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+          c >= 'A' && c <= 'F' ? c - 'A' + 10 :
+          (error(StringPiece(p, e), "invalid hex digit"), 0)));
+      // clang-format on
+    }
+    return ret;
+  };
+
+  for (;;) {
+    auto esc = std::find(p, e, '\\');
+    unescaped_.append(p, esc);
+    if (esc == e) {
+      break;
+    }
+    // A string never ends with an unescaped backslash.
+    p = esc + 2;
+    switch (esc[1]) {
+        // clang-format off
+      case '\"': unescaped_.push_back('\"'); break;
+      case '\\': unescaped_.push_back('\\'); break;
+      case '/':  unescaped_.push_back('/');  break;
+      case 'b':  unescaped_.push_back('\b'); break;
+      case 'f':  unescaped_.push_back('\f'); break;
+      case 'n':  unescaped_.push_back('\n'); break;
+      case 'r':  unescaped_.push_back('\r'); break;
+      case 't':  unescaped_.push_back('\t'); break;
+      // clang-format on
+      case 'u': {
+        uint16_t prefix = readHex();
+        char32_t codePoint = prefix;
+        if (utf16_code_unit_is_high_surrogate(prefix)) {
+          if (e - p < 2 || p[0] != '\\' || p[1] != 'u') {
+            error(
+                StringPiece(p, e),
+                "expected another unicode escape for second half of "
+                "surrogate pair");
+          }
+          p += 2;
+          uint16_t suffix = readHex();
+          if (!utf16_code_unit_is_low_surrogate(suffix)) {
+            error(
+                StringPiece(p, e),
+                "second character in surrogate pair is invalid");
+          }
+          codePoint =
+              unicode_code_point_from_utf16_surrogate_pair(prefix, suffix);
+        } else if (!utf16_code_unit_is_bmp(prefix)) {
+          error(
+              StringPiece(p, e),
+              "invalid unicode code point (in range [0xdc00,0xdfff])");
+        }
+        appendCodePointToUtf8(codePoint, unescaped_);
+        break;
+      }
+      default:
+        error(
+            StringPiece(esc, e),
+            to<std::string>("unknown escape ", esc[1], " in string").c_str());
+    }
+  }
+}
+
+void json_stream_parser::error(StringPiece context, char const* what) const {
+  throw_exception<parse_error>(to<std::string>(
+      "json parse error on line ",
+      line_,
+      !context.empty()
+          ? to<std::string>(" near `", context.subpiece(0, 16), '\'')
+          : "",
+      ": ",
+      what));
+}
+
+void json_stream_parser::error(
+    char const* p, char const* e, char const* what) const {
+  error(StringPiece(p, e), what);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+dynamic* json_dynamic_builder::add(dynamic&& value) {
+  if (open_.empty()) {
+    result_ = std::move(value);
+    return &result_;
+  }
+  dynamic& parent = *open_.back();
+  if (parent.isArray()) {
+    parent.push_back(std::move(value));
+    return &parent[parent.size() - 1];
+  }
+  auto [it, inserted] = parent.try_emplace(std::move(key_), std::move(value));
+  if (!inserted) {
+    if (validateKeys_) {
+      throw_exception<parse_error>(
+          "json parse error: duplicate key inserted");
+    }
+    it->second = std::move(value);
+  }
+  return &it->second;
+}
+
+void serialize(
+    dynamic const& dyn, serialization_opts const& opts, IOBufQueue& out) {
+  // Below this, copying into the tail of the queue is cheaper than another
+  // IOBuf.
+  constexpr std::size_t kMinTakeOwnership = 4096;
+
+  auto str = serialize(dyn, opts);
+  if (str.size() < kMinTakeOwnership) {
+    out.append(str);
+    return;
+  }
+  // Moving the string keeps its buffer, which the IOBuf then frees.
+  auto owned = std::make_unique<std::string>(std::move(str));
+  auto* data = owned->data();
+  auto capacity = owned->capacity();
+  auto length = owned->size();
+  out.append(IOBuf::takeOwnership(
+      data,
+      capacity,
+      0,
+      length,
+      [](void*, void* userData) { delete static_cast<std::string*>(userData); },
+      owned.release()));
+}
+
+} // namespace json
+
+dynamic parseJson(IOBuf const& chain) {
+  return parseJson(chain, json::serialization_opts());
+}
+
+dynamic parseJson(IOBuf const& chain, json::serialization_opts const& opts) {
+  if (opts.allow_non_string_keys || opts.convert_int_keys) {
+    // json_stream_parser only parses string keys.
+    auto const buf = chain.cloneCoalescedAsValue();
+    return parseJson(
+        StringPiece(reinterpret_cast<char const*>(buf.data()), buf.length()),
+        opts);
+  }
+  json::json_dynamic_builder builder(opts);
+  json::json_stream_parser parser(builder, opts);
+  parser.feed(chain);
+  parser.finish();
+  return std::move(builder).result();
+}
+
+} // namespace folly
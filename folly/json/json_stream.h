@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Incremental json parsing.
+ *
+ * json_stream_parser accepts a document in arbitrary fragments, e.g. the
+ * buffers of an IOBuf chain as they come off a socket, and reports what it
+ * finds to a json_stream_handler as soon as each value is complete. Nothing
+ * needs to be coalesced: strings that fit in one fragment and contain no
+ * escapes are handed to the handler in place, only values that straddle a
+ * fragment boundary are buffered.
+ *
+ *     json_dynamic_builder builder;
+ *     json_stream_parser parser(builder);
+ *     // For every chunk read:
+ *     parser.feed(*buf);
+ *     // At EOF:
+ *     parser.finish();
+ *     dynamic doc = std::move(builder).result();
+ *
+ * The accepted grammar and the options honored are those of parseJson(),
+ * except that object keys must be strings: the parser throws
+ * std::invalid_argument if allow_non_string_keys or convert_int_keys is set.
+ * Errors in the document throw json::parse_error.
+ *
+ * json::serialize() into an IOBufQueue is the writing counterpart.
+ *
+ * @file json_stream.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/Range.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+
+namespace folly {
+namespace json {
+
+/**
+ * Receives the events of a json_stream_parser in document order. Strings
+ * passed in are only valid for the duration of the call.
+ *
+ * Exceptions thrown by the handler propagate out of feed() or finish().
+ */
+class json_stream_handler {
+ public:
+  virtual ~json_stream_handler() = default;
+
+  virtual void onNull() = 0;
+  virtual void onBool(bool value) = 0;
+  virtual void onInt(int64_t value) = 0;
+  virtual void onDouble(double value) = 0;
+  // Also called for numbers when parse_numbers_as_strings is set.
+  virtual void onString(StringPiece value) = 0;
+
+  virtual void onBeginArray() = 0;
+  virtual void onEndArray() = 0;
+
+  // Every member of an object is a key followed by a value.
+  virtual void onBeginObject() = 0;
+  virtual void onKey(StringPiece key) = 0;
+  virtual void onEndObject() = 0;
+};
+
+class json_stream_parser {
+ public:
+  explicit json_stream_parser(
+      json_stream_handler& handler,
+      serialization_opts const& opts = serialization_opts());
+
+  json_stream_parser(json_stream_parser const&) = delete;
+  json_stream_parser& operator=(json_stream_parser const&) = delete;
+
+  /**
+   * Parses the next fragment of the document. Only needs to stay valid for
+   * the duration of the call.
+   */
+  void feed(ByteRange data);
+  void feed(StringPiece data) { feed(ByteRange(data)); }
+
+  /**
+   * Parses every buffer of the chain, without coalescing it.
+   */
+  void feed(IOBuf const& chain);
+
+  /**
+   * Parses the bytes from the cursor to the end of its chain.
+   */
+  void feed(io::Cursor cursor);
+
+  /**
+   * Signals the end of the document. Throws if it is incomplete.
+   */
+  void finish();
+
+  /**
+   * True once the top level value has been fully parsed. A top level number
+   * or literal is only known to be complete when followed by whitespace or
+   * by finish().
+   */
+  bool done() const { return state_ == State::Done || state_ == State::Tail; }
+
+ private:
+  enum class State : uint8_t {
+    Value, // Top level or object value.
+    ArrayFirst, // Value or ']'.
+    ArrayNext, // Value, or ']' if trailing commas are allowed.
+    ObjectFirst, // Key or '}'.
+    ObjectNext, // Key, or '}' if trailing commas are allowed.
+    Colon,
+    AfterValue, // ',' or the closing bracket.
+    String,
+    Scalar,
+    Done, // Only whitespace left.
+    Tail, // After a NUL, everything is ignored like parseJson() does.
+  };
+
+  // Each returns the position right after what it consumed.
+  char const* structural(char const* p, char const* e);
+  char const* beginValue(char const* p, char const* e);
+  void beginToken(char const* p, State state);
+  void endContainer(char close);
+  void afterValue();
+
+  char const* continueString(char const* p, char const* e);
+  void completeString(char const* end);
+  char const* continueScalar(char const* p, char const* e);
+  void completeScalar(StringPiece token);
+  void completeNumber(StringPiece token);
+  StringPiece takeToken(char const* end);
+  void unescape(StringPiece in);
+
+  [[noreturn]] void error(StringPiece context, char const* what) const;
+  [[noreturn]] void error(char const* p, char const* e, char const* what) const;
+
+  json_stream_handler& handler_;
+
+  bool const allowTrailingComma_;
+  bool const parseNumbersAsStrings_;
+  bool const doubleFallback_;
+  unsigned const recursionLimit_;
+
+  State state_{State::Value};
+  // Whether the string being parsed is an object key.
+  bool isKey_{false};
+  // Whether the first byte of the next fragment is escaped.
+  bool escapeNext_{false};
+  bool hasEscapes_{false};
+  unsigned line_{0};
+
+  // Open brackets.
+  std::vector<char> stack_;
+
+  // Start of the current string or scalar in the current fragment, and the
+  // part of it seen in previous fragments.
+  char const* tokenBegin_{nullptr};
+  std::string token_;
+  std::string unescaped_;
+};
+
+/**
+ * json_stream_handler that builds a dynamic, with the same result as
+ * parseJson().
+ */
+class json_dynamic_builder : public json_stream_handler {
+ public:
+  json_dynamic_builder() = default;
+  explicit json_dynamic_builder(serialization_opts const& opts)
+      : validateKeys_(opts.validate_keys) {}
+
+  /**
+   * The parsed document, once the parser is done().
+   */
+  dynamic&& result() && { return std::move(result_); }
+  dynamic const& result() const& { return result_; }
+
+  void onNull() override { add(nullptr); }
+  void onBool(bool value) override { add(value); }
+  void onInt(int64_t value) override { add(value); }
+  void onDouble(double value) override { add(value); }
+  void onString(StringPiece value) override { add(value); }
+
+  void onBeginArray() override { open_.push_back(add(dynamic::array)); }
+  void onEndArray() override { open_.pop_back(); }
+
+  void onBeginObject() override { open_.push_back(add(dynamic::object)); }
+  void onKey(StringPiece key) override { key_.assign(key.begin(), key.end()); }
+  void onEndObject() override { open_.pop_back(); }
+
+ private:
+  dynamic* add(dynamic&& value);
+
+  bool validateKeys_{false};
+  dynamic result_;
+  // Containers being filled. Elements of dynamic arrays and objects only
+  // move when their parent grows, and a parent only grows once they are
+  // complete.
+  std::vector<dynamic*> open_;
+  std::string key_;
+};
+
+/**
+ * Serialize dynamic to json, appending it to `out`.
+ *
+ * Equivalent to appending the result of serialize(), but large outputs are
+ * handed over to the queue as they are instead of being copied into it.
+ */
+void serialize(dynamic const&, serialization_opts const&, IOBufQueue& out);
+
+} // namespace json
+
+/**
+ * Parses a json document held in an IOBuf chain, like parseJson() would
+ * after coalescing it. The chain is only coalesced if opts allows non string
+ * keys, which json_stream_parser does not parse.
+ */
+dynamic parseJson(IOBuf const& chain);
+dynamic parseJson(IOBuf const& chain, json::serialization_opts const& opts);
+
+} // namespace folly
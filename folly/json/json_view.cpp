@@ -0,0 +1,458 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_view.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include <folly/Conv.h>
+#include <folly/Likely.h>
+#include <folly/detail/JsonStructuralIndex.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+namespace json {
+
+namespace {
+
+bool isJsonWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Integers short enough that they can't overflow, anything else goes through
+// parseJson().
+bool tryParseShortInt(StringPiece token, int64_t& out) {
+  bool negative = !token.empty() && token.front() == '-';
+  if (negative) {
+    token.advance(1);
+  }
+  if (token.empty() || token.size() > 18) {
+    return false;
+  }
+  int64_t val = 0;
+  for (char c : token) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    val = val * 10 + (c - '0');
+  }
+  out = negative ? -val : val;
+  return true;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+json_document::json_document(StringPiece json) : json_(json) {
+  if (FOLLY_UNLIKELY(json.size() > detail::kJsonStructuralIndexMaxSize)) {
+    throw_exception<parse_error>("json document too large to index");
+  }
+  detail::jsonStructuralIndex(json_, index_);
+  close_.resize(index_.size());
+
+  // Match the brackets of the top level value. Everything inside of a string
+  // is already excluded from the index, so its quotes come in pairs.
+  uint32_t const end = sentinel();
+  std::vector<uint32_t> open;
+  uint32_t pos = 0;
+  do {
+    if (pos == end) {
+      error(pos, open.empty() ? "expected json value" : "unterminated value");
+    }
+    switch (at(pos)) {
+      case '"':
+        if (pos + 1 == end) {
+          error(pos, "unterminated string");
+        }
+        pos += 2;
+        break;
+      case '{':
+      case '[':
+        open.push_back(pos++);
+        break;
+      case '}':
+      case ']':
+        if (open.empty() || at(open.back()) != (at(pos) == '}' ? '{' : '[')) {
+          error(pos, "unbalanced brackets");
+        }
+        close_[open.back()] = pos++;
+        open.pop_back();
+        break;
+      case ',':
+      case ':':
+        if (open.empty()) {
+          error(pos, "expected json value");
+        }
+        ++pos;
+        break;
+      default:
+        ++pos;
+        break;
+    }
+  } while (!open.empty());
+
+  // Like parseJson(), ignore anything after a NUL following the value, even
+  // one glued to a top level scalar.
+  auto nulAt = [&](uint32_t p) {
+    return std::memchr(
+               json_.data() + index_[p], '\0', index_[p + 1] - index_[p]) !=
+        nullptr;
+  };
+  if (pos != end && at(pos) != '\0' && !(pos == 1 && nulAt(0))) {
+    error(pos, "parsing didn't consume all input");
+  }
+}
+
+uint32_t json_document::skip(uint32_t pos) const {
+  switch (at(pos)) {
+    case '{':
+    case '[':
+      return close_[pos] + 1;
+    case '"':
+      return pos + 2;
+    case '}':
+    case ']':
+    case ',':
+    case ':':
+    case '\0':
+      error(pos, "expected json value");
+    default:
+      return pos + 1;
+  }
+}
+
+uint32_t json_document::next(uint32_t pos, char close) const {
+  char c = at(pos);
+  if (c == close) {
+    return pos;
+  }
+  if (c != ',') {
+    error(pos, close == ']' ? "expected ',' or ']'" : "expected ',' or '}'");
+  }
+  ++pos;
+  if (at(pos) == close) {
+    error(pos, "expected json value");
+  }
+  checkMember(pos, close);
+  return pos;
+}
+
+uint32_t json_document::first(uint32_t pos, char close) const {
+  ++pos;
+  if (at(pos) != close) {
+    checkMember(pos, close);
+  }
+  return pos;
+}
+
+void json_document::checkMember(uint32_t pos, char close) const {
+  if (close != '}') {
+    return;
+  }
+  if (at(pos) != '"') {
+    error(pos, "expected string for object key");
+  }
+  if (at(pos + 2) != ':') {
+    error(pos + 2, "expected ':'");
+  }
+}
+
+void json_document::error(uint32_t pos, char const* what) const {
+  auto offset = pos < index_.size() ? index_[pos] : json_.size();
+  throw_exception<parse_error>(to<std::string>(
+      "json parse error on line ",
+      std::count(json_.begin(), json_.begin() + offset, '\n'),
+      offset < json_.size()
+          ? to<std::string>(" near `", json_.subpiece(offset, 16), '\'')
+          : "",
+      ": ",
+      what));
+}
+
+//////////////////////////////////////////////////////////////////////
+
+dynamic::Type json_view::type() const {
+  switch (doc_->at(pos_)) {
+    case '{':
+      return dynamic::OBJECT;
+    case '[':
+      return dynamic::ARRAY;
+    case '"':
+      return dynamic::STRING;
+    default:
+      break;
+  }
+  doc_->skip(pos_);
+  auto token = scalarToken();
+  switch (token.empty() ? '\0' : token.front()) {
+    case 't':
+    case 'f':
+      if (token == "true" || token == "false") {
+        return dynamic::BOOL;
+      }
+      break;
+    case 'n':
+      if (token == "null") {
+        return dynamic::NULLT;
+      }
+      break;
+    case 'N':
+    case 'I':
+      if (token == "NaN" || token == "Infinity") {
+        return dynamic::DOUBLE;
+      }
+      break;
+    case '-':
+      if (token == "-Infinity") {
+        return dynamic::DOUBLE;
+      }
+      [[fallthrough]];
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      return token.find_first_of(".eE") == StringPiece::npos
+          ? dynamic::INT64
+          : dynamic::DOUBLE;
+    default:
+      break;
+  }
+  doc_->error(pos_, "expected json value");
+}
+
+void json_view::expectType(dynamic::Type expected, char const* name) const {
+  auto actual = type();
+  if (actual != expected) {
+    throw_exception<TypeError>(name, actual);
+  }
+}
+
+StringPiece json_view::scalarToken() const {
+  auto const& index = doc_->index_;
+  auto const& json = doc_->json_;
+  auto b = json.begin() + index[pos_];
+  auto e = json.begin() + index[pos_ + 1];
+  while (isJsonWhitespace(e[-1])) {
+    --e;
+  }
+  if (pos_ == 0) {
+    // parseJson() ignores everything after a NUL following the top level
+    // value.
+    e = std::find(b, e, '\0');
+  }
+  return StringPiece(b, e);
+}
+
+void json_view::checkContainer(char open) const {
+  if (doc_->at(pos_) != open) {
+    throw_exception<TypeError>(open == '[' ? "array" : "object", type());
+  }
+}
+
+bool json_view::getBool() const {
+  expectType(dynamic::BOOL, "boolean");
+  return scalarToken().front() == 't';
+}
+
+int64_t json_view::getInt() const {
+  expectType(dynamic::INT64, "int64");
+  int64_t val;
+  if (tryParseShortInt(scalarToken(), val)) {
+    return val;
+  }
+  return toDynamic().getInt();
+}
+
+double json_view::getDouble() const {
+  expectType(dynamic::DOUBLE, "double");
+  return toDynamic().getDouble();
+}
+
+std::string json_view::getString() const {
+  expectType(dynamic::STRING, "string");
+  if (!hasEscapes()) {
+    return rawString().str();
+  }
+  return toDynamic().getString();
+}
+
+StringPiece json_view::rawString() const {
+  expectType(dynamic::STRING, "string");
+  auto const& index = doc_->index_;
+  return doc_->json_.subpiece(
+      index[pos_] + 1, index[pos_ + 1] - index[pos_] - 1);
+}
+
+bool json_view::hasEscapes() const {
+  auto str = rawString();
+  return std::memchr(str.data(), '\\', str.size()) != nullptr;
+}
+
+StringPiece json_view::raw() const {
+  auto const& index = doc_->index_;
+  switch (doc_->at(pos_)) {
+    case '{':
+    case '[':
+      return doc_->json_.subpiece(
+          index[pos_], index[doc_->close_[pos_]] - index[pos_] + 1);
+    case '"':
+      return doc_->json_.subpiece(
+          index[pos_], index[pos_ + 1] - index[pos_] + 1);
+    default:
+      doc_->skip(pos_);
+      return scalarToken();
+  }
+}
+
+std::size_t json_view::size() const {
+  if (doc_->at(pos_) == '[') {
+    auto r = elements();
+    return std::size_t(std::distance(r.begin(), r.end()));
+  }
+  auto r = items();
+  return std::size_t(std::distance(r.begin(), r.end()));
+}
+
+bool json_view::empty() const {
+  char c = doc_->at(pos_);
+  if (c != '[' && c != '{') {
+    throw_exception<TypeError>("object/array", type());
+  }
+  return doc_->close_[pos_] == pos_ + 1;
+}
+
+json_view json_view::at(std::size_t idx) const {
+  for (auto v : elements()) {
+    if (idx-- == 0) {
+      return v;
+    }
+  }
+  throw_exception<std::out_of_range>("out of range in json_view::at");
+}
+
+Optional<json_view> json_view::find(StringPiece key) const {
+  Optional<json_view> ret;
+  for (auto const& [k, v] : items()) {
+    if (FOLLY_LIKELY(!k.hasEscapes())) {
+      if (k.rawString() == key) {
+        ret = v;
+      }
+    } else if (k.getString() == key) {
+      ret = v;
+    }
+  }
+  return ret;
+}
+
+json_view json_view::at(StringPiece key) const {
+  auto ret = find(key);
+  if (!ret) {
+    throw_exception<std::out_of_range>(
+        to<std::string>("couldn't find key ", key, " in json object"));
+  }
+  return *ret;
+}
+
+Optional<json_view> json_view::get_ptr(json_pointer const& jsonPtr) const {
+  json_view curr = *this;
+  for (auto const& token : jsonPtr.tokens()) {
+    switch (doc_->at(curr.pos_)) {
+      case '[': {
+        if (token.size() > 1 && token[0] == '0') {
+          throw_exception<std::invalid_argument>(
+              "leading zero not allowed when indexing arrays");
+        }
+        if (token == "-") {
+          // Appending, there is nothing to resolve.
+          return none;
+        }
+        auto idx = tryTo<std::size_t>(token);
+        if (!idx.hasValue()) {
+          throw_exception<std::invalid_argument>("array index is not numeric");
+        }
+        Optional<json_view> elem;
+        std::size_t i = 0;
+        for (auto v : curr.elements()) {
+          if (i++ == idx.value()) {
+            elem = v;
+            break;
+          }
+        }
+        if (!elem) {
+          return none;
+        }
+        curr = *elem;
+        break;
+      }
+      case '{': {
+        auto member = curr.find(token);
+        if (!member) {
+          return none;
+        }
+        curr = *member;
+        break;
+      }
+      default:
+        throw_exception<TypeError>("object/array", curr.type());
+    }
+  }
+  return curr;
+}
+
+auto json_view::elements() const -> iterator_range<element_iterator> {
+  checkContainer('[');
+  return {
+      element_iterator(doc_, doc_->first(pos_, ']')),
+      element_iterator(doc_, doc_->close_[pos_])};
+}
+
+auto json_view::items() const -> iterator_range<item_iterator> {
+  checkContainer('{');
+  return {
+      item_iterator(doc_, doc_->first(pos_, '}')),
+      item_iterator(doc_, doc_->close_[pos_])};
+}
+
+dynamic json_view::toDynamic() const {
+  return parseJsonIndexed(raw());
+}
+
+dynamic json_view::toDynamic(serialization_opts const& opts) const {
+  return parseJsonIndexed(raw(), opts);
+}
+
+json_view::element_iterator& json_view::element_iterator::operator++() {
+  pos_ = doc_->next(doc_->skip(pos_), ']');
+  return *this;
+}
+
+json_view::item_iterator& json_view::item_iterator::operator++() {
+  pos_ = doc_->next(doc_->skip(pos_ + 3), '}');
+  return *this;
+}
+
+} // namespace json
+} // namespace folly
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Read-only, lazily parsed views over json text.
+ *
+ * A json_document indexes the structural characters of its input once (see
+ * folly::parseJsonIndexed) and hands out json_view's that refer directly to
+ * the input buffer. Nothing is copied or unescaped until asked for, so
+ * reading a handful of fields out of a large document costs one vectorized
+ * pass plus the lookups themselves, instead of materializing a dynamic.
+ *
+ *     json_document doc(body);
+ *     auto user = doc.root().at("user");
+ *     int64_t id = user.at("id").getInt();
+ *     StringPiece name = user.at("name").rawString(); // no copy
+ *     auto city = doc.root().get_ptr(json_pointer::parse("/address/city"));
+ *
+ * Validation is lazy too: bracket nesting and string termination are
+ * checked up front, everything else only when the offending value is
+ * accessed, in which case json::parse_error is thrown. Accessors on the
+ * wrong type throw TypeError, like dynamic's.
+ *
+ * The input buffer and the json_document must outlive all the views.
+ *
+ * @file json_view.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+#include <folly/json/json_pointer.h>
+
+namespace folly {
+namespace json {
+
+class json_document;
+
+class json_view {
+ public:
+  class element_iterator;
+  class item_iterator;
+
+  template <class Iterator>
+  struct iterator_range {
+    Iterator begin() const { return first; }
+    Iterator end() const { return last; }
+    Iterator first;
+    Iterator last;
+  };
+
+  /**
+   * The type the value would have once parsed into a dynamic.
+   */
+  dynamic::Type type() const;
+
+  bool isNull() const { return type() == dynamic::NULLT; }
+  bool isBool() const { return type() == dynamic::BOOL; }
+  bool isInt() const { return type() == dynamic::INT64; }
+  bool isDouble() const { return type() == dynamic::DOUBLE; }
+  bool isNumber() const { return isInt() || isDouble(); }
+  bool isString() const { return type() == dynamic::STRING; }
+  bool isArray() const { return type() == dynamic::ARRAY; }
+  bool isObject() const { return type() == dynamic::OBJECT; }
+
+  /**
+   * Like dynamic's get*() accessors, these do not convert between types and
+   * throw TypeError if the value has a different one.
+   */
+  bool getBool() const;
+  int64_t getInt() const;
+  double getDouble() const;
+
+  /**
+   * The unescaped contents of a string. Only copies, and only unescapes,
+   * when called.
+   */
+  std::string getString() const;
+
+  /**
+   * The bytes between the quotes of a string, escape sequences included.
+   * Equal to getString() if !hasEscapes().
+   */
+  StringPiece rawString() const;
+  bool hasEscapes() const;
+
+  /**
+   * The json text of this value, e.g. `[1, 2]` or `"a\nb"`.
+   */
+  StringPiece raw() const;
+
+  /**
+   * Number of elements of an array or members of an object, duplicate keys
+   * included. Linear in that number, nested values are skipped in constant
+   * time.
+   */
+  std::size_t size() const;
+  bool empty() const;
+
+  /**
+   * Array element lookup. Linear in the index.
+   */
+  json_view at(std::size_t idx) const;
+  json_view operator[](std::size_t idx) const { return at(idx); }
+
+  /**
+   * Object member lookup. Linear in the number of members. As with
+   * parseJson(), the last occurrence of a duplicated key wins.
+   */
+  Optional<json_view> find(StringPiece key) const;
+  json_view at(StringPiece key) const;
+  json_view operator[](StringPiece key) const { return at(key); }
+
+  /**
+   * Resolves a json pointer relative to this value. Returns none where
+   * dynamic::get_ptr() returns nullptr, and throws where it throws.
+   */
+  Optional<json_view> get_ptr(json_pointer const& jsonPtr) const;
+
+  iterator_range<element_iterator> elements() const;
+  iterator_range<item_iterator> items() const;
+
+  /**
+   * Materializes this value and everything below it.
+   */
+  dynamic toDynamic() const;
+  dynamic toDynamic(serialization_opts const& opts) const;
+
+ private:
+  friend class json_document;
+
+  json_view(json_document const* doc, uint32_t pos) : doc_(doc), pos_(pos) {}
+
+  void expectType(dynamic::Type expected, char const* name) const;
+  StringPiece scalarToken() const;
+  void checkContainer(char open) const;
+
+  json_document const* doc_;
+  // Position of the first structural character of the value in the index.
+  uint32_t pos_;
+};
+
+class json_view::element_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = json_view;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = json_view;
+
+  json_view operator*() const { return json_view(doc_, pos_); }
+  element_iterator& operator++();
+  element_iterator operator++(int) {
+    auto ret = *this;
+    ++*this;
+    return ret;
+  }
+
+  friend bool operator==(element_iterator const& a, element_iterator const& b) {
+    return a.pos_ == b.pos_;
+  }
+  friend bool operator!=(element_iterator const& a, element_iterator const& b) {
+    return a.pos_ != b.pos_;
+  }
+
+ private:
+  friend class json_view;
+  element_iterator(json_document const* doc, uint32_t pos)
+      : doc_(doc), pos_(pos) {}
+
+  json_document const* doc_;
+  uint32_t pos_;
+};
+
+class json_view::item_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::pair<json_view, json_view>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  // The key is a string view, see getString() and rawString().
+  value_type operator*() const {
+    return {json_view(doc_, pos_), json_view(doc_, pos_ + 3)};
+  }
+  item_iterator& operator++();
+  item_iterator operator++(int) {
+    auto ret = *this;
+    ++*this;
+    return ret;
+  }
+
+  friend bool operator==(item_iterator const& a, item_iterator const& b) {
+    return a.pos_ == b.pos_;
+  }
+  friend bool operator!=(item_iterator const& a, item_iterator const& b) {
+    return a.pos_ != b.pos_;
+  }
+
+ private:
+  friend class json_view;
+  item_iterator(json_document const* doc, uint32_t pos)
+      : doc_(doc), pos_(pos) {}
+
+  json_document const* doc_;
+  uint32_t pos_;
+};
+
+class json_document {
+ public:
+  /**
+   * Indexes `json`, which must outlive this and all views into it.
+   * Throws json::parse_error if a string is left unterminated, brackets are
+   * unbalanced or there is more than one top level value.
+   */
+  explicit json_document(StringPiece json);
+
+  json_document(json_document const&) = delete;
+  json_document& operator=(json_document const&) = delete;
+
+  json_view root() const { return json_view(this, 0); }
+
+  StringPiece input() const { return json_; }
+
+ private:
+  friend class json_view;
+
+  char at(uint32_t pos) const {
+    return index_[pos] < json_.size() ? json_[index_[pos]] : '\0';
+  }
+
+  // Position right after the value starting at `pos`.
+  uint32_t skip(uint32_t pos) const;
+
+  // Given the position right after a value inside of a container, returns
+  // the position of the next value, or of the closing bracket.
+  uint32_t next(uint32_t pos, char close) const;
+
+  // Position of the first element of the container at `pos`, or of its
+  // closing bracket if it is empty.
+  uint32_t first(uint32_t pos, char close) const;
+
+  // Checks that `pos` starts a `"key":` pair when `close` is '}'.
+  void checkMember(uint32_t pos, char close) const;
+
+  uint32_t sentinel() const { return uint32_t(index_.size() - 1); }
+
+  [[noreturn]] void error(uint32_t pos, char const* what) const;
+
+  StringPiece json_;
+  std::vector<uint32_t> index_;
+  // For the position of an opening bracket, the position of the matching
+  // closing one.
+  std::vector<uint32_t> close_;
+};
+
+} // namespace json
+} // namespace folly
@@ -15,8 +15,12 @@
  */
 
 #include <folly/json/json.h>
+#include <folly/json/json_arena.h>
+#include <folly/json/json_stream.h>
+#include <folly/json/json_view.h>
 
 #include <folly/Benchmark.h>
+#include <folly/io/IOBufQueue.h>
 
 #include <fstream>
 #include <streambuf>
@@ -240,6 +244,175 @@ BENCHMARK(PerfJson2Obj, iters) {
   }
 }
 
+BENCHMARK_RELATIVE(PerfJson2ObjIndexed, iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(parseJsonIndexed(kJsonBenchmarkString));
+  }
+}
+
+// A few MB of records, roughly what a config or RPC ingest payload looks like.
+static std::string makeLargeJsonDocument(size_t records) {
+  std::string out = "[";
+  for (size_t i = 0; i < records; ++i) {
+    if (i != 0) {
+      out += ",\n";
+    }
+    folly::toAppend(
+        R"({"id":)",
+        i,
+        R"(,"name":"record number )",
+        i,
+        R"(","enabled":)",
+        i % 3 == 0 ? "true" : "false",
+        R"(,"weight":)",
+        double(i) / 7,
+        R"(,"tags":["alpha","beta","gamma"],"owner":{"team":"storage",)",
+        R"("oncall":null,"path":"\/srv\/data\/)",
+        i,
+        R"(","description":"quoted \"value\" with a tab\t"}})",
+        &out);
+  }
+  out += "]";
+  return out;
+}
+
+BENCHMARK(PerfLargeJson2Obj, iters) {
+  BenchmarkSuspender s;
+  auto doc = makeLargeJsonDocument(20000);
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(parseJson(doc));
+  }
+}
+
+BENCHMARK_RELATIVE(PerfLargeJson2ObjIndexed, iters) {
+  BenchmarkSuspender s;
+  auto doc = makeLargeJsonDocument(20000);
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(parseJsonIndexed(doc));
+  }
+}
+
+BENCHMARK(PerfLargeStrings2Obj, iters) {
+  BenchmarkSuspender s;
+  std::string doc = "[";
+  for (size_t i = 0; i < 2000; ++i) {
+    folly::toAppend(i == 0 ? "" : ",", '"', kLargeAsciiString, '"', &doc);
+  }
+  doc += "]";
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(parseJson(doc));
+  }
+}
+
+BENCHMARK_RELATIVE(PerfLargeStrings2ObjIndexed, iters) {
+  BenchmarkSuspender s;
+  std::string doc = "[";
+  for (size_t i = 0; i < 2000; ++i) {
+    folly::toAppend(i == 0 ? "" : ",", '"', kLargeAsciiString, '"', &doc);
+  }
+  doc += "]";
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(parseJsonIndexed(doc));
+  }
+}
+
+// A large document as it comes off a socket, in 4KB buffers.
+static std::unique_ptr<IOBuf> makeLargeJsonChain(StringPiece doc) {
+  IOBufQueue queue;
+  for (size_t i = 0; i < doc.size(); i += 4096) {
+    queue.append(IOBuf::copyBuffer(doc.subpiece(i, 4096)));
+  }
+  return queue.move();
+}
+
+BENCHMARK(PerfLargeJsonChainCoalesce, iters) {
+  BenchmarkSuspender s;
+  auto chain = makeLargeJsonChain(makeLargeJsonDocument(20000));
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    auto copy = chain->cloneCoalescedAsValue();
+    folly::doNotOptimizeAway(
+        parseJson(StringPiece(copy.coalesce())));
+  }
+}
+
+BENCHMARK_RELATIVE(PerfLargeJsonChainStream, iters) {
+  BenchmarkSuspender s;
+  auto chain = makeLargeJsonChain(makeLargeJsonDocument(20000));
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(parseJson(*chain));
+  }
+}
+
+// Parse, read and destroy: the whole lifetime of a request body.
+BENCHMARK(PerfLargeJson2ObjLifetime, iters) {
+  BenchmarkSuspender s;
+  auto doc = makeLargeJsonDocument(20000);
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    auto parsed = parseJson(doc);
+    folly::doNotOptimizeAway(parsed[100]["name"].getString().size());
+  }
+}
+
+BENCHMARK_RELATIVE(PerfLargeJson2ArenaLifetime, iters) {
+  BenchmarkSuspender s;
+  auto doc = makeLargeJsonDocument(20000);
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    json::arena_document parsed(doc);
+    folly::doNotOptimizeAway(parsed.root()[100]["name"].getString().size());
+  }
+}
+
+// Reading a few fields out of a large request, the rest is payload.
+static std::string makeLargeRequest() {
+  return folly::to<std::string>(
+      R"({"payload":)",
+      makeLargeJsonDocument(1000),
+      R"(,"route":{"service":"storage","shard":1234},"trace":"abc"})");
+}
+
+BENCHMARK(PerfLargeRequestFields, iters) {
+  BenchmarkSuspender s;
+  auto doc = makeLargeRequest();
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    auto parsed = parseJson(doc);
+    folly::doNotOptimizeAway(parsed["route"]["service"].getString());
+    folly::doNotOptimizeAway(parsed["route"]["shard"].getInt());
+    folly::doNotOptimizeAway(parsed["trace"].getString());
+  }
+}
+
+BENCHMARK_RELATIVE(PerfLargeRequestFieldsView, iters) {
+  BenchmarkSuspender s;
+  auto doc = makeLargeRequest();
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    json::json_document view(doc);
+    auto route = view.root()["route"];
+    folly::doNotOptimizeAway(route["service"].rawString());
+    folly::doNotOptimizeAway(route["shard"].getInt());
+    folly::doNotOptimizeAway(view.root()["trace"].rawString());
+  }
+}
+
 BENCHMARK(PerfObj2Json, iters) {
   BenchmarkSuspender s;
   dynamic parsed = parseJson(kJsonBenchmarkString);
@@ -250,6 +423,38 @@ BENCHMARK(PerfObj2Json, iters) {
   }
 }
 
+// Parsed once, so that neither parsing nor destroying it is measured.
+static dynamic const& largeJsonObject() {
+  static const dynamic obj = parseJson(makeLargeJsonDocument(20000));
+  return obj;
+}
+
+BENCHMARK(PerfLargeObj2Json, iters) {
+  auto const& obj = largeJsonObject();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(toJson(obj));
+  }
+}
+
+BENCHMARK(PerfLargeObj2JsonQueueCopy, iters) {
+  auto const& obj = largeJsonObject();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::IOBufQueue queue;
+    queue.append(toJson(obj));
+    folly::doNotOptimizeAway(queue.front());
+  }
+}
+
+BENCHMARK_RELATIVE(PerfLargeObj2JsonQueue, iters) {
+  auto const& obj = largeJsonObject();
+  folly::json::serialization_opts opts;
+  for (size_t i = 0; i < iters; ++i) {
+    folly::IOBufQueue queue;
+    folly::json::serialize(obj, opts, queue);
+    folly::doNotOptimizeAway(queue.front());
+  }
+}
+
 // Benchmark results in a Macbook Pro 2015 (i7-4870HQ, 4th gen)
 // ============================================================================
 // folly/test/JsonBenchmark.cpp                   relative  time/iter   iters/s
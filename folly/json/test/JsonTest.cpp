@@ -16,10 +16,16 @@
 
 #include <folly/json/json.h>
 
+#include <cmath>
 #include <cstdint>
 #include <iterator>
 #include <limits>
+#include <string>
+#include <vector>
 
+#include <folly/Optional.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/json/json_stream.h>
 #include <folly/portability/GTest.h>
 
 using folly::dynamic;
@@ -28,6 +34,7 @@ using folly::parseJsonWithMetadata;
 using folly::toJson;
 using folly::json::parse_error;
 using folly::json::print_error;
+using namespace std::string_literals;
 
 TEST(Json, Unicode) {
   auto val = parseJson(reinterpret_cast<const char*>(u8"\"I \u2665 UTF-8\""));
@@ -549,6 +556,26 @@ TEST(Json, EscapeCornerCases) {
   }
 }
 
+TEST(Json, EscapeLongStrings) {
+  // Longer strings are scanned with SIMD. Plant a character that needs
+  // escaping, or a non-ascii one that doesn't, at each position.
+  folly::json::serialization_opts opts;
+  for (size_t len = 1; len < 100; ++len) {
+    for (size_t i = 0; i < len; ++i) {
+      for (auto special : {"\"", "\x1f", "\xc3\xa9"}) {
+        std::string s(len, 'x');
+        s.replace(i, 1, special);
+        std::string expected = "\"" + std::string(i, 'x');
+        expected += special[0] == '"' ? "\\\""
+            : special[0] == '\x1f'   ? "\\u001f"
+                                     : "\xc3\xa9";
+        expected += std::string(len - i - 1, 'x') + "\"";
+        EXPECT_EQ(expected, folly::json::serialize(s, opts)) << len << i;
+      }
+    }
+  }
+}
+
 TEST(Json, JsonNonAsciiEncoding) {
   folly::json::serialization_opts opts;
   opts.encode_non_ascii = true;
@@ -1151,3 +1178,168 @@ TEST(Json, CharsToUnicodeEscape) {
       (1ULL << 63) | (1ULL << 36) | (1ULL << 33),
       (1ULL << (64 - 64)) | (1ULL << (93 - 64)));
 }
+
+TEST(Json, ParseIndexedMatchesParseJson) {
+  auto expectSame = [](folly::StringPiece in,
+                       folly::json::serialization_opts const& opts) {
+    folly::Optional<dynamic> expected;
+    try {
+      expected = parseJson(in, opts);
+    } catch (std::exception const&) {
+    }
+    if (!expected) {
+      EXPECT_ANY_THROW(folly::parseJsonIndexed(in, opts)) << in;
+      return;
+    }
+    auto actual = folly::parseJsonIndexed(in, opts);
+    if (expected->isDouble() && std::isnan(expected->asDouble())) {
+      EXPECT_TRUE(actual.isDouble() && std::isnan(actual.asDouble())) << in;
+    } else {
+      EXPECT_EQ(*expected, actual) << in;
+    }
+  };
+
+  std::string longString(300, 'x');
+  std::string nested;
+  for (int i = 0; i < 50; ++i) {
+    nested.append("{\"k\": [");
+  }
+  nested.append("1");
+  for (int i = 0; i < 50; ++i) {
+    nested.append("]}");
+  }
+
+  std::vector<std::string> inputs = {
+      "",
+      " ",
+      "1",
+      "-1",
+      "-",
+      "1.5e10",
+      "1.",
+      "0123",
+      "12abc",
+      "1 2",
+      "1\0"s,
+      "1\0garbage"s,
+      "9223372036854775807",
+      "9223372036854775808",
+      "-9223372036854775809",
+      "true",
+      "truefalse",
+      "nul",
+      "null",
+      "NaN",
+      "Infinity",
+      "-Infinity",
+      "\"\"",
+      "\"abc\"",
+      "\"abc",
+      "\"a\\\"b\"",
+      "\"a\\\\\"",
+      "\"\\u2665 \\uD834\\uDD1E\"",
+      "\"\\uD834\"",
+      "\"\\q\"",
+      "\"a\0b\""s,
+      "\"a\"b",
+      "\\\"a\"",
+      "[]",
+      "[ ]",
+      "[1,2,3]",
+      "[1 2]",
+      "[1,]",
+      "[,]",
+      "[1,,2]",
+      "[\"a\",{\"b\":[null,true,false]}]",
+      "[1\\\", 2]",
+      "{}",
+      "{ }",
+      "{\"a\":1}",
+      "{\"a\":1,}",
+      "{\"a\" 1}",
+      "{\"a\":}",
+      "{1:2}",
+      "{\"1\":2, 1:3}",
+      "{\"a\":1,\"a\":2}",
+      "{\"a\":{\"b\":{\"c\":[1,2,{\"d\":\"e\"}]}}}",
+      "{\"a\":1}}",
+      "[[[[",
+      "]",
+      "{\"" + longString + "\": \"" + longString + "\"}",
+      "[\"" + longString + "\\n\", 1.25, -3]",
+      "\n\n  [1,\n  2,\n  }",
+      nested,
+  };
+
+  std::vector<folly::json::serialization_opts> optsList(7);
+  optsList[1].allow_trailing_comma = true;
+  optsList[2].allow_non_string_keys = true;
+  optsList[3].convert_int_keys = true;
+  optsList[4].validate_keys = true;
+  optsList[5].double_fallback = true;
+  optsList[6].parse_numbers_as_strings = true;
+
+  for (auto const& opts : optsList) {
+    for (auto const& in : inputs) {
+      expectSame(in, opts);
+    }
+  }
+
+  folly::json::serialization_opts lowLimit;
+  lowLimit.recursion_limit = 10;
+  expectSame(nested, lowLimit);
+}
+
+TEST(Json, ParseIndexedErrors) {
+  try {
+    folly::parseJsonIndexed("{\n\"a\": 1,\n\"b\": [1, 2\n}");
+    ADD_FAILURE();
+  } catch (parse_error const& e) {
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("on line 3"))
+        << e.what();
+  }
+
+  try {
+    folly::parseJsonIndexed("[\n1,\ntru\n]");
+    ADD_FAILURE();
+  } catch (parse_error const& e) {
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("on line 2"))
+        << e.what();
+  }
+}
+
+TEST(Json, SerializeToIOBufQueue) {
+  auto doc = parseJson(R"({
+    "a": [1, -2, 3.5, true, false, null, "x\ty\u00e9"],
+    "b": {"c": {}, "d": [], "e": "a fairly long string that needs no escape"},
+    "f": 9223372036854775807
+  })");
+  auto serialize = [](dynamic const& d, auto const& opts) {
+    folly::IOBufQueue queue(folly::IOBufQueue::cacheChainLength());
+    queue.append("prefix");
+    folly::json::serialize(d, opts, queue);
+    return queue.move()->to<std::string>();
+  };
+
+  folly::json::serialization_opts opts;
+  EXPECT_EQ("prefix" + folly::json::serialize(doc, opts), serialize(doc, opts));
+  opts.pretty_formatting = true;
+  opts.sort_keys = true;
+  EXPECT_EQ("prefix" + folly::json::serialize(doc, opts), serialize(doc, opts));
+  opts.encode_non_ascii = true;
+  EXPECT_EQ("prefix" + folly::json::serialize(doc, opts), serialize(doc, opts));
+
+  // Spans several buffers.
+  dynamic big = dynamic::array;
+  for (int i = 0; i < 100000; ++i) {
+    big.push_back(std::string(i % 100, 'a' + i % 26));
+  }
+  opts = folly::json::serialization_opts();
+  EXPECT_EQ("prefix" + folly::json::serialize(big, opts), serialize(big, opts));
+
+  opts.allow_nan_inf = false;
+  folly::IOBufQueue queue;
+  EXPECT_THROW(
+      folly::json::serialize(dynamic::array(1, NAN), opts, queue),
+      print_error);
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_arena.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/portability/GTest.h>
+
+using folly::dynamic;
+using folly::IOBuf;
+using folly::json_pointer;
+using folly::parseJson;
+using folly::StringPiece;
+using folly::TypeError;
+using folly::json::arena_document;
+using folly::json::arena_dynamic;
+using folly::json::parse_error;
+using folly::json::serialization_opts;
+
+namespace {
+
+constexpr StringPiece kDoc = R"({
+  "id": 1234,
+  "name": "a\"bé",
+  "ratio": -1.5e3,
+  "ok": true,
+  "none": null,
+  "tags": ["x", 2, [3, 4], {"k": "v"}, []],
+  "nested": {"a~b": {"c/d": [10, 20, 30]}, "empty": {}},
+  "dup": 1,
+  "dup": 2
+})";
+
+// Checks that every value agrees with parseJson().
+void expectSameAsDynamic(arena_dynamic const& value, dynamic const& expected) {
+  ASSERT_EQ(expected.type(), value.type());
+  switch (expected.type()) {
+    case dynamic::NULLT:
+      break;
+    case dynamic::BOOL:
+      EXPECT_EQ(expected.getBool(), value.getBool());
+      break;
+    case dynamic::INT64:
+      EXPECT_EQ(expected.getInt(), value.getInt());
+      break;
+    case dynamic::DOUBLE:
+      if (std::isnan(expected.getDouble())) {
+        EXPECT_TRUE(std::isnan(value.getDouble()));
+        return;
+      }
+      EXPECT_EQ(expected.getDouble(), value.getDouble());
+      break;
+    case dynamic::STRING:
+      EXPECT_EQ(expected.getString(), value.getString());
+      break;
+    case dynamic::ARRAY: {
+      ASSERT_EQ(expected.size(), value.size());
+      size_t i = 0;
+      for (auto const& elem : value) {
+        expectSameAsDynamic(elem, expected[i++]);
+      }
+      break;
+    }
+    case dynamic::OBJECT:
+      ASSERT_EQ(expected.size(), value.size());
+      for (auto const& [k, v] : expected.items()) {
+        auto* member = value.get_ptr(k.stringPiece());
+        ASSERT_NE(nullptr, member) << k;
+        expectSameAsDynamic(*member, v);
+      }
+      break;
+  }
+  EXPECT_EQ(expected, value.toDynamic());
+}
+
+} // namespace
+
+TEST(JsonArena, Accessors) {
+  arena_document doc(kDoc);
+  auto const& root = doc.root();
+  ASSERT_TRUE(root.isObject());
+  // Duplicate keys are merged like in a dynamic.
+  EXPECT_EQ(8, root.size());
+
+  EXPECT_EQ(1234, root["id"].getInt());
+  EXPECT_TRUE(root["id"].isNumber());
+  EXPECT_EQ("a\"bé", root["name"].getString());
+  EXPECT_EQ(-1500.0, root["ratio"].getDouble());
+  EXPECT_TRUE(root["ok"].getBool());
+  EXPECT_TRUE(root["none"].isNull());
+  EXPECT_EQ(2, root["dup"].getInt());
+
+  auto const& tags = root["tags"];
+  ASSERT_TRUE(tags.isArray());
+  EXPECT_EQ(5, tags.size());
+  EXPECT_EQ("x", tags[0].getString());
+  EXPECT_EQ(2, tags[1].getInt());
+  EXPECT_EQ(4, tags[2][1].getInt());
+  EXPECT_EQ("v", tags[3]["k"].getString());
+  EXPECT_TRUE(tags[4].empty());
+  EXPECT_THROW(tags[5], std::out_of_range);
+
+  EXPECT_TRUE(root["nested"]["empty"].empty());
+  EXPECT_EQ(nullptr, root.get_ptr("missing"));
+  EXPECT_THROW(root["missing"], std::out_of_range);
+
+  EXPECT_THROW(root["id"].getDouble(), TypeError);
+  EXPECT_THROW(root["id"].getString(), TypeError);
+  EXPECT_THROW(root["name"].getInt(), TypeError);
+  EXPECT_THROW(tags["k"], TypeError);
+  EXPECT_THROW(root[0], TypeError);
+  EXPECT_THROW(root["ok"].size(), TypeError);
+  EXPECT_THROW(root.begin(), TypeError);
+  EXPECT_THROW(tags.items(), TypeError);
+
+  // Members are kept in document order, a duplicate where it first was.
+  std::vector<std::string> keys;
+  for (auto const& member : root.items()) {
+    keys.push_back(member.key.str());
+  }
+  EXPECT_EQ(
+      (std::vector<std::string>{
+          "id", "name", "ratio", "ok", "none", "tags", "nested", "dup"}),
+      keys);
+
+  expectSameAsDynamic(root, parseJson(kDoc));
+}
+
+TEST(JsonArena, Scalars) {
+  for (auto s :
+       {"0",
+        "-7",
+        "9223372036854775807",
+        "-9223372036854775808",
+        "0.5",
+        "-2E-3",
+        "NaN",
+        "-Infinity",
+        "true",
+        "false",
+        "null",
+        "\"\"",
+        "\"\\u00e9\\n\"",
+        "  42  ",
+        "{}",
+        "[]",
+        "[[[[]]]]"}) {
+    arena_document doc(s);
+    expectSameAsDynamic(doc.root(), parseJson(s));
+  }
+}
+
+TEST(JsonArena, LargeObjects) {
+  // Objects past a few members are looked up through a hash index.
+  for (int size : {8, 9, 100, 1000}) {
+    std::string json = "{";
+    for (int i = 0; i < size; ++i) {
+      folly::toAppend(i ? "," : "", "\"key", i, "\": ", i, &json);
+    }
+    // Duplicates shrink the object, and move where the index has to be.
+    for (int i = 0; i < size; i += 3) {
+      folly::toAppend(",\"key", i, "\": ", -i, &json);
+    }
+    json += "}";
+
+    arena_document doc(json);
+    auto const& root = doc.root();
+    ASSERT_EQ(size, root.size());
+    for (int i = 0; i < size; ++i) {
+      auto key = folly::to<std::string>("key", i);
+      EXPECT_EQ(i % 3 ? i : -i, root[key].getInt()) << key;
+    }
+    EXPECT_EQ(nullptr, root.get_ptr("key"));
+    EXPECT_EQ(nullptr, root.get_ptr(folly::to<std::string>("key", size)));
+    expectSameAsDynamic(root, parseJson(json));
+  }
+}
+
+TEST(JsonArena, JsonPointer) {
+  arena_document doc(kDoc);
+  auto const& root = doc.root();
+  auto get = [&](StringPiece ptr) {
+    return root.get_ptr(json_pointer::parse(ptr));
+  };
+
+  EXPECT_EQ(&root, get(""));
+  EXPECT_EQ(1234, get("/id")->getInt());
+  EXPECT_EQ(20, get("/nested/a~0b/c~1d/1")->getInt());
+  EXPECT_EQ("v", get("/tags/3/k")->getString());
+  EXPECT_EQ(nullptr, get("/missing"));
+  EXPECT_EQ(nullptr, get("/tags/5"));
+  EXPECT_EQ(nullptr, get("/tags/-"));
+  EXPECT_THROW(get("/tags/01"), std::invalid_argument);
+  EXPECT_THROW(get("/tags/x"), std::invalid_argument);
+  EXPECT_THROW(get("/id/0"), TypeError);
+
+  // Same answers as dynamic.
+  auto dyn = parseJson(kDoc);
+  for (auto ptr : {"/id", "/nested/a~0b/c~1d/2", "/tags/2/0", "/nope"}) {
+    auto const* expected = dyn.get_ptr(json_pointer::parse(ptr));
+    auto const* actual = get(ptr);
+    ASSERT_EQ(expected != nullptr, actual != nullptr) << ptr;
+    if (expected) {
+      EXPECT_EQ(*expected, actual->toDynamic());
+    }
+  }
+}
+
+TEST(JsonArena, OwnsItsData) {
+  auto json = std::make_unique<std::string>(kDoc.str());
+  arena_document doc(*json);
+  json.reset();
+  EXPECT_EQ("a\"bé", doc.root()["name"].getString());
+  EXPECT_EQ("v", doc.root()["tags"][3]["k"].getString());
+  EXPECT_GT(doc.totalSize(), 0);
+}
+
+TEST(JsonArena, IOBufChain) {
+  std::string json = kDoc.str();
+  auto chain = IOBuf::copyBuffer(json.data(), 10);
+  chain->appendToChain(IOBuf::copyBuffer(json.data() + 10, json.size() - 10));
+  arena_document doc(*chain);
+  expectSameAsDynamic(doc.root(), parseJson(json));
+}
+
+TEST(JsonArena, Options) {
+  serialization_opts opts;
+  opts.validate_keys = true;
+  EXPECT_THROW(arena_document(R"({"a": 1, "a": 2})", opts), parse_error);
+  std::string large = "{";
+  for (int i = 0; i < 20; ++i) {
+    folly::toAppend("\"k", i, "\": 0,", &large);
+  }
+  large += "\"k7\": 1}";
+  EXPECT_THROW(arena_document(large, opts), parse_error);
+  EXPECT_EQ(1, arena_document(large).root()["k7"].getInt());
+
+  opts = serialization_opts();
+  opts.parse_numbers_as_strings = true;
+  EXPECT_EQ("1.50", arena_document("[1.50]", opts).root()[0].getString());
+
+  for (auto s : {"", "[1,", "{\"a\" 1}", "[1 2]", "tru", "\"abc"}) {
+    EXPECT_THROW(arena_document{s}, parse_error) << s;
+  }
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_stream.h>
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using folly::dynamic;
+using folly::IOBuf;
+using folly::parseJson;
+using folly::StringPiece;
+using folly::json::json_dynamic_builder;
+using folly::json::json_stream_handler;
+using folly::json::json_stream_parser;
+using folly::json::parse_error;
+using folly::json::serialization_opts;
+using namespace std::string_literals;
+
+namespace {
+
+const std::vector<std::string> kDocuments = {
+    "null",
+    " true ",
+    "false",
+    "0",
+    "-12",
+    "9223372036854775807",
+    "-9223372036854775808",
+    "1.5",
+    "-2.5e-3",
+    "1E6",
+    "NaN",
+    "-Infinity",
+    R"("")",
+    R"("abc")",
+    R"("a\"b\\c\/d\b\f\n\r\t")",
+    R"("é😀 A")",
+    "\"multi\nline\"",
+    "[]",
+    "{}",
+    "[1, [2, [3, []]], {}]",
+    R"({"a": 1, "b": [true, false, null], "c": {"d": "e"}})",
+    R"({"dup": 1, "dup": 2})",
+    R"({"A": {"": ""}})",
+    "\n\t[\r\n 1 ,\n 2 ]\n",
+    "\"a\0b\""s,
+    "{\"a\0\": 1}"s,
+    "1\0garbage"s,
+    "[1]\0{"s,
+};
+
+const std::vector<std::string> kInvalidDocuments = {
+    "",
+    "  ",
+    "[",
+    "[1,",
+    "[1 2]",
+    "[1,]",
+    "{\"a\" 1}",
+    "{\"a\": 1,}",
+    "{1: 2}",
+    "]",
+    "[}",
+    "1 2",
+    "tru",
+    "nul",
+    "-",
+    "1.5x",
+    "+1",
+    "\"abc",
+    R"("\x")",
+    R"("\u12")",
+    R"("\ud83d")",
+    R"("\ud83dA")",
+    R"("\udc00")",
+    "[\0]"s,
+};
+
+dynamic parseFragments(
+    std::vector<StringPiece> const& fragments,
+    serialization_opts const& opts = serialization_opts()) {
+  json_dynamic_builder builder(opts);
+  json_stream_parser parser(builder, opts);
+  for (auto fragment : fragments) {
+    parser.feed(fragment);
+  }
+  parser.finish();
+  return std::move(builder).result();
+}
+
+// Every way to split `doc` in two, and one byte at a time.
+void forEachSplit(
+    StringPiece doc,
+    std::function<void(std::vector<StringPiece> const&)> const& fn) {
+  for (size_t i = 0; i <= doc.size(); ++i) {
+    fn({doc.subpiece(0, i), doc.subpiece(i)});
+  }
+  std::vector<StringPiece> bytes;
+  for (size_t i = 0; i < doc.size(); ++i) {
+    bytes.push_back(doc.subpiece(i, 1));
+  }
+  fn(bytes);
+}
+
+void expectEqual(dynamic const& expected, dynamic const& actual) {
+  if (expected.isDouble() && std::isnan(expected.getDouble())) {
+    ASSERT_TRUE(actual.isDouble() && std::isnan(actual.getDouble()));
+  } else {
+    ASSERT_EQ(expected, actual);
+  }
+}
+
+struct EventRecorder : json_stream_handler {
+  void onNull() override { events.push_back("null"); }
+  void onBool(bool value) override {
+    events.push_back(value ? "true" : "false");
+  }
+  void onInt(int64_t value) override {
+    events.push_back("int:" + std::to_string(value));
+  }
+  void onDouble(double value) override {
+    events.push_back("double:" + std::to_string(value));
+  }
+  void onString(StringPiece value) override {
+    events.push_back("string:" + value.str());
+    strings.push_back(value);
+  }
+  void onBeginArray() override { events.push_back("["); }
+  void onEndArray() override { events.push_back("]"); }
+  void onBeginObject() override { events.push_back("{"); }
+  void onKey(StringPiece key) override {
+    events.push_back("key:" + key.str());
+    strings.push_back(key);
+  }
+  void onEndObject() override { events.push_back("}"); }
+
+  std::vector<std::string> events;
+  std::vector<StringPiece> strings;
+};
+
+} // namespace
+
+TEST(JsonStream, MatchesParseJson) {
+  for (auto const& doc : kDocuments) {
+    auto expected = parseJson(doc);
+    forEachSplit(doc, [&](auto const& fragments) {
+      expectEqual(expected, parseFragments(fragments));
+    });
+  }
+}
+
+TEST(JsonStream, InvalidDocuments) {
+  for (auto const& doc : kInvalidDocuments) {
+    EXPECT_THROW(parseJson(doc), parse_error) << doc;
+    forEachSplit(doc, [&](auto const& fragments) {
+      EXPECT_THROW(parseFragments(fragments), parse_error) << doc;
+    });
+  }
+}
+
+TEST(JsonStream, Options) {
+  serialization_opts opts;
+  opts.allow_trailing_comma = true;
+  EXPECT_EQ(
+      parseJson(R"([1, {"a": 2,},])", opts),
+      parseFragments({R"([1, {"a": 2,},])"}, opts));
+
+  opts = serialization_opts();
+  opts.parse_numbers_as_strings = true;
+  EXPECT_EQ(
+      parseJson("[1, -2.5e3, NaN, 12345678901234567890]", opts),
+      parseFragments({"[1, -2.5e3, NaN, 123456789", "01234567890]"}, opts));
+
+  opts = serialization_opts();
+  opts.double_fallback = true;
+  EXPECT_EQ(
+      parseJson("[12345678901234567890]", opts),
+      parseFragments({"[12345678901234567890]"}, opts));
+  EXPECT_ANY_THROW(parseFragments({"[12345678901234567890]"}));
+
+  opts = serialization_opts();
+  opts.validate_keys = true;
+  EXPECT_THROW(parseFragments({R"({"a": 1, "a": 2})"}, opts), parse_error);
+
+  opts = serialization_opts();
+  opts.recursion_limit = 3;
+  EXPECT_NO_THROW(parseFragments({"[[[1]]]"}, opts));
+  EXPECT_THROW(parseFragments({"[[[[1]]]]"}, opts), parse_error);
+  EXPECT_THROW(parseJson("[[[[1]]]]", opts), parse_error);
+
+  // Object keys must be strings, parseJson(IOBuf) coalesces the chain
+  // instead.
+  opts = serialization_opts();
+  opts.allow_non_string_keys = true;
+  EXPECT_THROW(parseFragments({"{1: 2}"}, opts), std::invalid_argument);
+  auto chain = IOBuf::copyBuffer("{1: ");
+  chain->appendToChain(IOBuf::copyBuffer("2}"));
+  EXPECT_EQ(parseJson("{1: 2}", opts), parseJson(*chain, opts));
+  opts.convert_int_keys = true;
+  EXPECT_THROW(parseFragments({"{1: 2}"}, opts), std::invalid_argument);
+  EXPECT_EQ(parseJson("{1: 2}", opts), parseJson(*chain, opts));
+}
+
+TEST(JsonStream, Events) {
+  std::string doc = R"({"key": ["str", 1, 2.5, true, null, {}]})";
+  EventRecorder recorder;
+  json_stream_parser parser(recorder);
+  parser.feed(StringPiece(doc));
+  EXPECT_TRUE(parser.done());
+  parser.finish();
+  EXPECT_EQ(
+      (std::vector<std::string>{
+          "{",
+          "key:key",
+          "[",
+          "string:str",
+          "int:1",
+          "double:2.500000",
+          "true",
+          "null",
+          "{",
+          "}",
+          "]",
+          "}"}),
+      recorder.events);
+
+  // Unescaped strings within one fragment point into it.
+  ASSERT_EQ(2, recorder.strings.size());
+  EXPECT_EQ(doc.data() + 2, recorder.strings[0].data());
+  EXPECT_EQ(doc.data() + 10, recorder.strings[1].data());
+}
+
+TEST(JsonStream, Done) {
+  json_dynamic_builder builder;
+  json_stream_parser parser(builder);
+  parser.feed(StringPiece("[1, 2"));
+  EXPECT_FALSE(parser.done());
+  parser.feed(StringPiece("]"));
+  EXPECT_TRUE(parser.done());
+  parser.feed(StringPiece("  \n"));
+  parser.finish();
+  EXPECT_EQ(dynamic::array(1, 2), builder.result());
+
+  json_stream_parser scalar(builder);
+  scalar.feed(StringPiece("12"));
+  EXPECT_FALSE(scalar.done());
+  scalar.feed(StringPiece("3 "));
+  EXPECT_TRUE(scalar.done());
+  scalar.finish();
+  EXPECT_EQ(123, builder.result());
+}
+
+TEST(JsonStream, IOBufChain) {
+  std::string doc = R"({"name": "a fairly long string", "values": [1, 2, 3]})";
+  auto expected = parseJson(doc);
+  for (size_t step = 1; step < doc.size(); step += 3) {
+    std::unique_ptr<IOBuf> chain;
+    for (size_t i = 0; i < doc.size(); i += step) {
+      auto buf = IOBuf::copyBuffer(StringPiece(doc).subpiece(i, step));
+      if (chain) {
+        chain->appendToChain(std::move(buf));
+      } else {
+        chain = std::move(buf);
+      }
+    }
+    EXPECT_EQ(expected, parseJson(*chain));
+
+    json_dynamic_builder builder;
+    json_stream_parser parser(builder);
+    folly::io::Cursor cursor(chain.get());
+    cursor.skip(1);
+    parser.feed(StringPiece("{"));
+    parser.feed(cursor);
+    parser.finish();
+    EXPECT_EQ(expected, builder.result());
+  }
+}
+
+TEST(JsonStream, ErrorLine) {
+  try {
+    parseFragments({"[1,\n2,\n", "3 4]"});
+    ADD_FAILURE();
+  } catch (parse_error const& e) {
+    EXPECT_EQ(
+        std::string("json parse error on line 2 near `4]': "
+                    "expected ',' or ']'"),
+        e.what());
+  }
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_view.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using folly::dynamic;
+using folly::json_pointer;
+using folly::parseJson;
+using folly::StringPiece;
+using folly::TypeError;
+using folly::json::json_document;
+using folly::json::json_view;
+using folly::json::parse_error;
+
+namespace {
+
+constexpr StringPiece kDoc = R"({
+  "id": 1234,
+  "name": "a\"bé",
+  "plain": "xyz",
+  "ratio": -1.5e3,
+  "ok": true,
+  "none": null,
+  "tags": ["x", 2, [3, 4], {"k": "v"}],
+  "nested": {"a~b": {"c/d": [10, 20, 30]}, "empty": {}, "arr": []},
+  "dup": 1,
+  "dup": 2
+})";
+
+// Checks that the view of every value agrees with parseJson().
+void expectSameAsDynamic(json_view view, dynamic const& expected) {
+  ASSERT_EQ(expected.type(), view.type()) << view.raw();
+  switch (expected.type()) {
+    case dynamic::NULLT:
+      EXPECT_TRUE(view.isNull());
+      break;
+    case dynamic::BOOL:
+      EXPECT_EQ(expected.getBool(), view.getBool());
+      break;
+    case dynamic::INT64:
+      EXPECT_EQ(expected.getInt(), view.getInt());
+      break;
+    case dynamic::DOUBLE:
+      if (std::isnan(expected.getDouble())) {
+        EXPECT_TRUE(std::isnan(view.getDouble()));
+        return;
+      }
+      EXPECT_EQ(expected.getDouble(), view.getDouble());
+      break;
+    case dynamic::STRING:
+      EXPECT_EQ(expected.getString(), view.getString());
+      break;
+    case dynamic::ARRAY: {
+      ASSERT_EQ(expected.size(), view.size());
+      size_t i = 0;
+      for (auto elem : view.elements()) {
+        expectSameAsDynamic(elem, expected[i++]);
+      }
+      break;
+    }
+    case dynamic::OBJECT:
+      for (auto const& [k, v] : view.items()) {
+        auto key = k.getString();
+        expectSameAsDynamic(*view.find(key), expected[key]);
+      }
+      break;
+  }
+  EXPECT_EQ(expected, view.toDynamic());
+}
+
+} // namespace
+
+TEST(JsonView, Accessors) {
+  json_document doc(kDoc);
+  auto root = doc.root();
+  ASSERT_TRUE(root.isObject());
+  // Duplicate keys are counted, unlike in a dynamic.
+  EXPECT_EQ(10, root.size());
+
+  EXPECT_EQ(1234, root["id"].getInt());
+  EXPECT_TRUE(root["id"].isNumber());
+  EXPECT_EQ("a\"bé", root["name"].getString());
+  EXPECT_TRUE(root["name"].hasEscapes());
+  EXPECT_EQ(R"(a\"bé)", root["name"].rawString());
+  EXPECT_EQ("xyz", root["plain"].rawString());
+  EXPECT_FALSE(root["plain"].hasEscapes());
+  EXPECT_EQ(-1500.0, root["ratio"].getDouble());
+  EXPECT_TRUE(root["ok"].getBool());
+  EXPECT_TRUE(root["none"].isNull());
+  EXPECT_EQ(2, root["dup"].getInt());
+
+  auto tags = root["tags"];
+  ASSERT_TRUE(tags.isArray());
+  EXPECT_EQ(4, tags.size());
+  EXPECT_EQ("x", tags[0].getString());
+  EXPECT_EQ(2, tags[1].getInt());
+  EXPECT_EQ("[3, 4]", tags[2].raw());
+  EXPECT_EQ("v", tags[3]["k"].getString());
+  EXPECT_THROW(tags[4], std::out_of_range);
+
+  EXPECT_TRUE(root["nested"]["empty"].empty());
+  EXPECT_EQ(0, root["nested"]["arr"].size());
+  EXPECT_FALSE(root.find("missing").hasValue());
+  EXPECT_THROW(root["missing"], std::out_of_range);
+
+  EXPECT_THROW(root["id"].getDouble(), TypeError);
+  EXPECT_THROW(root["id"].getString(), TypeError);
+  EXPECT_THROW(root["name"].getInt(), TypeError);
+  EXPECT_THROW(root["tags"]["k"], TypeError);
+  EXPECT_THROW(root[0], TypeError);
+  EXPECT_THROW(root["ok"].size(), TypeError);
+
+  expectSameAsDynamic(root, parseJson(kDoc));
+}
+
+TEST(JsonView, Scalars) {
+  for (auto s :
+       {"0",
+        "-7",
+        "123456789012345678",
+        "9223372036854775807",
+        "-9223372036854775808",
+        "0.5",
+        "1e10",
+        "-2E-3",
+        "NaN",
+        "Infinity",
+        "-Infinity",
+        "true",
+        "false",
+        "null",
+        "\"\"",
+        "\"\\u00e9\\n\"",
+        "  42  ",
+        "{}",
+        "[]",
+        "[[[[]]]]"}) {
+    json_document doc(s);
+    expectSameAsDynamic(doc.root(), parseJson(s));
+  }
+
+  // parseJson() stops at a NUL after the value.
+  StringPiece nul("42\0{trailing", 13);
+  json_document doc(nul);
+  EXPECT_EQ(42, doc.root().getInt());
+  EXPECT_EQ("42", doc.root().raw());
+}
+
+TEST(JsonView, JsonPointer) {
+  json_document doc(kDoc);
+  auto root = doc.root();
+  auto get = [&](StringPiece ptr) {
+    return root.get_ptr(json_pointer::parse(ptr));
+  };
+
+  EXPECT_EQ(kDoc, get("")->raw());
+  EXPECT_EQ(1234, get("/id")->getInt());
+  EXPECT_EQ(20, get("/nested/a~0b/c~1d/1")->getInt());
+  EXPECT_EQ("v", get("/tags/3/k")->getString());
+  EXPECT_FALSE(get("/missing").hasValue());
+  EXPECT_FALSE(get("/tags/4").hasValue());
+  EXPECT_FALSE(get("/tags/-").hasValue());
+  EXPECT_FALSE(get("/tags/-/0").hasValue());
+  EXPECT_THROW(get("/tags/01"), std::invalid_argument);
+  EXPECT_THROW(get("/tags/x"), std::invalid_argument);
+  EXPECT_THROW(get("/id/0"), TypeError);
+
+  // Same answers as dynamic.
+  auto dyn = parseJson(kDoc);
+  for (auto ptr : {"/id", "/nested/a~0b/c~1d/2", "/tags/2/0", "/nope"}) {
+    auto const* expected = dyn.get_ptr(json_pointer::parse(ptr));
+    auto actual = get(ptr);
+    ASSERT_EQ(expected != nullptr, actual.hasValue()) << ptr;
+    if (expected) {
+      EXPECT_EQ(*expected, actual->toDynamic());
+    }
+  }
+}
+
+TEST(JsonView, EscapedKeys) {
+  json_document doc(R"({"a\"b": 1, "c": 2, "c\\": 3})");
+  auto root = doc.root();
+  EXPECT_EQ(1, root["a\"b"].getInt());
+  EXPECT_EQ(2, root["c"].getInt());
+  EXPECT_EQ(3, root["c\\"].getInt());
+}
+
+TEST(JsonView, Errors) {
+  // Caught up front.
+  for (auto s :
+       {"",
+        "   ",
+        "[1, 2",
+        "{\"a\": [1}",
+        "]",
+        "\"abc",
+        "[\"abc]",
+        "1 2",
+        "{} []",
+        ","}) {
+    EXPECT_THROW(json_document{s}, parse_error) << s;
+  }
+
+  // Caught when the offending value is accessed.
+  auto expectLazyError = [](StringPiece s, auto access) {
+    json_document doc(s);
+    EXPECT_THROW(access(doc.root()), parse_error) << s;
+  };
+  expectLazyError("[1 2]", [](json_view v) { return v.size(); });
+  expectLazyError("[1,]", [](json_view v) { return v.size(); });
+  expectLazyError("[,1]", [](json_view v) { return v.size(); });
+  expectLazyError("{1: 2}", [](json_view v) { return v.size(); });
+  expectLazyError(R"({"a" 2})", [](json_view v) { return v.size(); });
+  expectLazyError(R"({"a": })", [](json_view v) { return v["a"].type(); });
+  expectLazyError("[tru]", [](json_view v) { return v[0].type(); });
+  expectLazyError("[1x]", [](json_view v) { return v[0].getInt(); });
+  expectLazyError("[1.5.5]", [](json_view v) { return v[0].getDouble(); });
+
+  // Everything else is left alone.
+  json_document doc("[1, {\"a\": [tru]}]");
+  EXPECT_EQ(1, doc.root()[0].getInt());
+
+  try {
+    json_document{"[1,\n2,\n3 4]"}.root().size();
+    ADD_FAILURE();
+  } catch (parse_error const& e) {
+    EXPECT_EQ(
+        std::string("json parse error on line 2 near `4]': "
+                    "expected ',' or ']'"),
+        e.what());
+  }
+}
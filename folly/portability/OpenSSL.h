@@ -109,3 +109,12 @@
 #else
 #define FOLLY_OPENSSL_HAS_CHACHA 0
 #endif
+
+// Kernel TLS offload (SSL_OP_ENABLE_KTLS) was introduced in OpenSSL 3.0, and
+// is only present when OpenSSL was built with it.
+#if !defined(OPENSSL_IS_BORINGSSL) && !defined(OPENSSL_NO_KTLS) && \
+    OPENSSL_VERSION_NUMBER >= 0x30000000L
+#define FOLLY_OPENSSL_HAS_KTLS 1
+#else
+#define FOLLY_OPENSSL_HAS_KTLS 0
+#endif